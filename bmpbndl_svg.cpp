@@ -0,0 +1,258 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg.cpp
+// Purpose:     Base class for wxBitmapBundleImpls rasterizing SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg.h"
+
+#include "wx/rawbmp.h"
+
+#include <cstring>
+#include <vector>
+
+#include "bmpbndl_svg_pixels.h"
+
+namespace
+{
+
+// whether the pixels of wxBitmap accessed with wxAlphaPixelData are premultiplied
+#if defined(__WXMSW__) || defined(__WXOSX__)
+const bool BitmapPixelsPremultiplied = true;
+#else
+const bool BitmapPixelsPremultiplied = false;
+#endif // #if defined(__WXMSW__) || defined(__WXOSX__)
+
+typedef wxAlphaPixelData::PixelFormat BitmapPixelFormat;
+
+const bool BitmapPixelsRGBA = BitmapPixelFormat::RED == 0 && BitmapPixelFormat::GREEN == 1
+                              && BitmapPixelFormat::BLUE == 2 && BitmapPixelFormat::ALPHA == 3;
+const bool BitmapPixelsBGRA = BitmapPixelFormat::BLUE == 0 && BitmapPixelFormat::GREEN == 1
+                              && BitmapPixelFormat::RED == 2 && BitmapPixelFormat::ALPHA == 3;
+
+// converts a row of RGBA pixels to the wxBitmap row,
+// which must be in RGBA or BGRA order
+void ConvertRowRGBA(const unsigned char* src, unsigned char* dst, size_t pixelCount, bool premultiplied)
+{
+    if ( premultiplied == BitmapPixelsPremultiplied )
+    {
+        if ( BitmapPixelsRGBA )
+            memcpy(dst, src, pixelCount * 4);
+        else
+            wxSVGPixelConverter::SwapRedBlue(src, dst, pixelCount);
+    }
+    else if ( BitmapPixelsPremultiplied )
+    {
+        if ( BitmapPixelsRGBA )
+            wxSVGPixelConverter::Premultiply(src, dst, pixelCount);
+        else
+            wxSVGPixelConverter::PremultiplySwapRedBlue(src, dst, pixelCount);
+    }
+    else
+    {
+        if ( BitmapPixelsRGBA )
+            wxSVGPixelConverter::Unpremultiply(src, dst, pixelCount);
+        else
+            wxSVGPixelConverter::UnpremultiplySwapRedBlue(src, dst, pixelCount);
+    }
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxBitmapBundleImplSVG implementation
+// ============================================================================
+
+// Three bitmaps cover e.g. a toolbar using 16, 24, and 32 px icons or
+// windows on three monitors with different DPI, 2 MB fit two 512x512 bitmaps.
+size_t wxBitmapBundleImplSVG::ms_defaultCacheMaxEntries = 3;
+size_t wxBitmapBundleImplSVG::ms_defaultCacheMaxBytes   = 2 * 1024 * 1024;
+
+wxBitmap wxBitmapBundleImplSVG::GetBitmap(const wxSize& size)
+{
+    for ( std::list<wxBitmap>::iterator it = m_cache.begin(); it != m_cache.end(); ++it )
+    {
+        if ( it->GetSize() == size )
+        {
+            ++m_cacheHits;
+            // move to the front, as the most recently used
+            m_cache.splice(m_cache.begin(), m_cache, it);
+            return m_cache.front();
+        }
+    }
+
+    ++m_cacheMisses;
+
+    wxBitmapBundleSVGSharedCache& sharedCache = wxBitmapBundleSVGSharedCache::Get();
+    wxBitmap                      bitmap;
+
+    if ( m_sharedCacheBackend
+         && sharedCache.FindBitmap(m_sharedCacheHash, m_sharedCacheDataLength,
+                                   m_sharedCacheBackend, size, bitmap) )
+    {
+        AddToCache(bitmap);
+        return bitmap;
+    }
+
+    wxBitmapBundleSVGDiskCache& diskCache = wxBitmapBundleSVGDiskCache::Get();
+
+    if ( m_sharedCacheBackend
+         && diskCache.FindBitmap(m_sharedCacheHash, m_sharedCacheDataLength,
+                                 m_sharedCacheBackend, m_sharedCacheRendererVersion, size, bitmap) )
+    {
+        AddToCache(bitmap);
+        sharedCache.AddBitmap(m_sharedCacheHash, m_sharedCacheDataLength,
+                              m_sharedCacheBackend, bitmap);
+        return bitmap;
+    }
+
+    bitmap = DoRasterize(size);
+
+    if ( bitmap.IsOk() )
+    {
+        AddToCache(bitmap);
+
+        if ( m_sharedCacheBackend )
+        {
+            sharedCache.AddBitmap(m_sharedCacheHash, m_sharedCacheDataLength,
+                                  m_sharedCacheBackend, bitmap);
+            diskCache.AddBitmap(m_sharedCacheHash, m_sharedCacheDataLength,
+                                m_sharedCacheBackend, m_sharedCacheRendererVersion, bitmap);
+        }
+    }
+
+    return bitmap;
+}
+
+void wxBitmapBundleImplSVG::SetCacheLimits(size_t maxEntries, size_t maxBytes)
+{
+    m_cacheMaxEntries = maxEntries;
+    m_cacheMaxBytes   = maxBytes;
+    TrimCache();
+}
+
+// static
+void wxBitmapBundleImplSVG::SetDefaultCacheLimits(size_t maxEntries, size_t maxBytes)
+{
+    ms_defaultCacheMaxEntries = maxEntries;
+    ms_defaultCacheMaxBytes   = maxBytes;
+}
+
+void wxBitmapBundleImplSVG::SetSharedCacheKey(const char* backend, const char* rendererVersion,
+                                              const char* data)
+{
+    wxCHECK_RET(backend && rendererVersion && data, "null backend, renderer version, or data");
+
+    // the key is only needed by the caches, so that hashing the data is not
+    // measured as parsing when benchmarking with the caches disabled
+    if ( !wxBitmapBundleSVGSharedCache::Get().IsEnabled()
+         && !wxBitmapBundleSVGDiskCache::Get().IsEnabled() )
+        return;
+
+    m_sharedCacheBackend         = backend;
+    m_sharedCacheRendererVersion = rendererVersion;
+    m_sharedCacheHash            = wxBitmapBundleSVGSharedCache::HashData(data);
+    m_sharedCacheDataLength      = strlen(data);
+}
+
+// static
+wxBitmap wxBitmapBundleImplSVG::CreateBitmapFromRGBA(const unsigned char* buffer, size_t stride,
+                                                    const wxSize& size, bool premultiplied)
+{
+    wxCHECK_MSG(buffer && size.x > 0 && size.y > 0 && stride >= GetBitmapBytes(wxSize(size.x, 1)),
+                wxBitmap(), "invalid buffer");
+
+    wxBitmap bitmap(size, 32);
+
+    if ( !bitmap.IsOk() )
+        return wxBitmap();
+
+#ifdef __WXMSW__
+    bitmap.UseAlpha();
+#endif // #ifdef __WXMSW__
+
+    {
+        wxAlphaPixelData data(bitmap);
+
+        if ( !data )
+            return wxBitmap();
+
+        const size_t               pixelCount = static_cast<size_t>(size.x);
+        const unsigned char*       src = buffer;
+        wxAlphaPixelData::Iterator rowStart(data);
+
+        if ( BitmapPixelsRGBA || BitmapPixelsBGRA )
+        {
+            for ( int y = 0; y < size.y; ++y, src += stride )
+            {
+                ConvertRowRGBA(src, reinterpret_cast<unsigned char*>(rowStart.m_ptr), pixelCount, premultiplied);
+                rowStart.OffsetY(data, 1);
+            }
+        }
+        else
+        {
+            // any other layout, e.g., ARGB: fix the alpha in a temporary
+            // row and then set the pixels one by one
+            std::vector<unsigned char> row(pixelCount * 4);
+
+            for ( int y = 0; y < size.y; ++y, src += stride )
+            {
+                const unsigned char*       rowSrc = src;
+                wxAlphaPixelData::Iterator p = rowStart;
+
+                if ( premultiplied != BitmapPixelsPremultiplied )
+                {
+                    if ( BitmapPixelsPremultiplied )
+                        wxSVGPixelConverter::Premultiply(src, row.data(), pixelCount);
+                    else
+                        wxSVGPixelConverter::Unpremultiply(src, row.data(), pixelCount);
+                    rowSrc = row.data();
+                }
+
+                for ( size_t x = 0; x < pixelCount; ++x, ++p, rowSrc += 4 )
+                {
+                    p.Red()   = rowSrc[0];
+                    p.Green() = rowSrc[1];
+                    p.Blue()  = rowSrc[2];
+                    p.Alpha() = rowSrc[3];
+                }
+
+                rowStart.OffsetY(data, 1);
+            }
+        }
+    } // the raw access must end before the bitmap is used
+
+    return bitmap;
+}
+
+void wxBitmapBundleImplSVG::ClearCache()
+{
+    m_cache.clear();
+    m_cacheBytes = 0;
+}
+
+void wxBitmapBundleImplSVG::AddToCache(const wxBitmap& bitmap)
+{
+    const size_t bytes = GetBitmapBytes(bitmap.GetSize());
+
+    if ( m_cacheMaxEntries == 0 || bytes > m_cacheMaxBytes )
+        return;
+
+    m_cache.push_front(bitmap);
+    m_cacheBytes += bytes;
+    TrimCache();
+}
+
+void wxBitmapBundleImplSVG::TrimCache()
+{
+    while ( !m_cache.empty()
+            && (m_cache.size() > m_cacheMaxEntries || m_cacheBytes > m_cacheMaxBytes) )
+    {
+        m_cacheBytes -= GetBitmapBytes(m_cache.back().GetSize());
+        m_cache.pop_back();
+    }
+}
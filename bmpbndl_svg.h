@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg.h
+// Purpose:     Base class for wxBitmapBundleImpls rasterizing SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleImplSVG_PRIVATE_H
+#define wxBitmapBundleImplSVG_PRIVATE_H
+
+#include "wx/wx.h"
+#include "wx/bmpbndl.h"
+
+#include <list>
+
+#include "bmpbndl_svg_cache.h"
+#include "bmpbndl_svg_diskcache.h"
+
+// --- 8< ----------------------------------
+
+
+
+// ============================================================================
+// wxBitmapBundleImplSVG
+// ============================================================================
+
+class wxBitmapBundleImplSVG : public wxBitmapBundleImpl
+{
+public:
+    wxBitmapBundleImplSVG(const wxSize& sizeDef)
+        : m_sizeDef(sizeDef),
+          m_cacheMaxEntries(ms_defaultCacheMaxEntries),
+          m_cacheMaxBytes(ms_defaultCacheMaxBytes)
+    {
+    }
+
+    virtual wxSize GetDefaultSize() const wxOVERRIDE
+    {
+        return m_sizeDef;
+    };
+
+    virtual wxSize GetPreferredSizeAtScale(double scale) const wxOVERRIDE
+    {
+        return m_sizeDef*scale;
+    }
+
+    virtual wxBitmap GetBitmap(const wxSize& size) wxOVERRIDE;
+
+    // The rasterized bitmaps are cached, the least recently used one
+    // is removed when the cache would contain more than maxEntries bitmaps
+    // or their pixel data would take more than maxBytes. A bitmap larger
+    // than maxBytes is not cached at all. maxEntries = 0 disables the cache.
+    void SetCacheLimits(size_t maxEntries, size_t maxBytes);
+
+    // The limits used by the bundles created afterwards.
+    static void SetDefaultCacheLimits(size_t maxEntries, size_t maxBytes);
+    static size_t GetDefaultCacheMaxEntries() { return ms_defaultCacheMaxEntries; }
+    static size_t GetDefaultCacheMaxBytes() { return ms_defaultCacheMaxBytes; }
+
+    void ClearCache();
+
+    size_t GetCacheHitCount() const { return m_cacheHits; }
+    size_t GetCacheMissCount() const { return m_cacheMisses; }
+    size_t GetCacheEntryCount() const { return m_cache.size(); }
+    size_t GetCacheBytes() const { return m_cacheBytes; }
+
+    // memory taken by the pixel data of a bitmap of this size
+    static size_t GetBitmapBytes(const wxSize& size)
+    {
+        return static_cast<size_t>(size.x) * size.y * 4;
+    }
+
+    // Creates 32-bit wxBitmap with alpha from RGBA buffer with stride bytes
+    // per row, premultiplied or not. The pixels are converted to the layout
+    // of wxBitmap on this platform with wxSVGPixelConverter, a row at a time.
+    static wxBitmap CreateBitmapFromRGBA(const unsigned char* buffer, size_t stride,
+                                         const wxSize& size, bool premultiplied);
+
+    // Parses the data now, if the impl parses it lazily, i.e., only when
+    // a bitmap found in none of the caches must be rasterized, so that
+    // the parsing can be benchmarked separately. Returns false if the data
+    // could not be parsed. Does nothing for the impls parsing in the ctor.
+    bool Parse()
+    {
+        return DoParse();
+    }
+
+    // The rasterization is done in two phases: first the SVG is rendered
+    // onto a buffer specific for the implementation, then wxBitmap is created
+    // from the buffer. These functions allow performing the phases separately,
+    // so that they can be benchmarked. They bypass the cache.
+    bool RasterizeToBuffer(const wxSize& size)
+    {
+        return DoRasterizeToBuffer(size);
+    }
+
+    // Must be called only after successful RasterizeToBuffer() with the same size.
+    wxBitmap ConvertBufferToBitmap(const wxSize& size)
+    {
+        return DoConvertBufferToBitmap(size);
+    }
+
+protected:
+    virtual wxBitmap DoRasterize(const wxSize& size)
+    {
+        if ( !DoRasterizeToBuffer(size) )
+            return wxBitmap();
+
+        return DoConvertBufferToBitmap(size);
+    }
+
+    virtual bool DoParse()
+    {
+        return true;
+    }
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) = 0;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) = 0;
+
+    // Should be called from the derived class ctor, so that the bitmaps
+    // are shared with all the bundles created from the same data,
+    // see wxBitmapBundleSVGSharedCache, and can be stored in
+    // wxBitmapBundleSVGDiskCache. rendererVersion must be changed
+    // whenever the backend starts producing different bitmaps, so that
+    // the bitmaps stored on disk by the older version are not used.
+    // data must be 0 terminated. If both caches are disabled, no key is set
+    // and the bundle never uses them, even if they are enabled later.
+    void SetSharedCacheKey(const char* backend, const char* rendererVersion, const char* data);
+
+    const wxSize m_sizeDef;
+
+    // identify the bundle data in wxBitmapBundleSVGSharedCache,
+    // m_sharedCacheBackend is null if the shared cache is not used
+    const char* m_sharedCacheBackend{nullptr};
+    const char* m_sharedCacheRendererVersion{nullptr};
+    wxUint64    m_sharedCacheHash{0};
+    size_t      m_sharedCacheDataLength{0};
+
+    // Cache of the recently used bitmaps, the most recently used first.
+    //
+    // Note that the cache is bounded both by the number of bitmaps and
+    // the memory they take, so that an application using SVG for all of
+    // its icons does not end up with too many bitmap objects, while
+    // the bitmaps for several sizes used at the same time (e.g., for
+    // windows on monitors with different DPI) need not be rasterized
+    // again and again.
+    std::list<wxBitmap> m_cache;
+    size_t              m_cacheBytes{0};
+    size_t              m_cacheMaxEntries;
+    size_t              m_cacheMaxBytes;
+    size_t              m_cacheHits{0};
+    size_t              m_cacheMisses{0};
+
+    static size_t ms_defaultCacheMaxEntries;
+    static size_t ms_defaultCacheMaxBytes;
+
+    void AddToCache(const wxBitmap& bitmap);
+    void TrimCache();
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVG);
+};
+
+#endif // #ifndef wxBitmapBundleImplSVG_PRIVATE_H
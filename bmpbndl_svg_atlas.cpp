@@ -0,0 +1,386 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_atlas.cpp
+// Purpose:     Atlas of SVG icons rasterized with NanoSVG at fixed sizes
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_atlas.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#include "wx/ffile.h"
+#include "wx/filename.h"
+#include "wx/imagpng.h"
+#include "wx/stopwatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+
+#include "svgthreadpool.h"
+
+namespace
+{
+
+bool ReadSVGFile(const wxString& fileName, std::vector<char>& data)
+{
+    wxFFile file(fileName, "rb");
+
+    if ( !file.IsOpened() )
+        return false;
+
+    const wxFileOffset length = file.Length();
+
+    if ( length <= 0 )
+        return false;
+
+    data.resize(static_cast<size_t>(length));
+    return file.Read(data.data(), data.size()) == data.size();
+}
+
+// a row of icons in a page, as high as its first icon
+struct Shelf
+{
+    size_t page;
+    int    y;
+    int    height;
+    int    usedWidth;
+};
+
+} // anonymous namespace
+
+// ============================================================================
+// wxSVGIconAtlas implementation
+// ============================================================================
+
+bool wxSVGIconAtlas::Build(const wxString& dirName, const wxArrayString& fileNames,
+                           const std::vector<wxSize>& sizes, size_t threadCount,
+                           const wxSize& pageSize)
+{
+    wxCHECK(!fileNames.empty(), false);
+    wxCHECK(!sizes.empty(), false);
+    wxCHECK(pageSize.x > 0 && pageSize.y > 0, false);
+
+    m_fileNames = fileNames;
+    m_sizes     = sizes;
+    m_entries.clear();
+    m_pages.clear();
+    m_fileIndices.clear();
+    m_buildTimes = BuildTimes();
+
+    const size_t                   sizeCount = m_sizes.size();
+    std::vector<std::vector<char>> fileData(m_fileNames.size());
+    wxStopWatch                    stopWatch;
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        // not wxFileName(dirName, name), the name may include subfolders
+        wxFileName fileName(m_fileNames[f]);
+
+        fileName.MakeAbsolute(dirName);
+        if ( !ReadSVGFile(fileName.GetFullPath(), fileData[f]) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        m_fileIndices[m_fileNames[f]] = f;
+    }
+
+    m_buildTimes.read = stopWatch.TimeInMicro().ToLong();
+
+    m_entries.resize(m_fileNames.size() * sizeCount);
+    for ( size_t i = 0; i < m_entries.size(); ++i )
+    {
+        m_entries[i].fileIndex = i / sizeCount;
+        m_entries[i].rect.SetSize(m_sizes[i % sizeCount]);
+    }
+
+    wxTestSVGThreadPool pool(threadCount);
+    std::vector<std::unique_ptr<wxSVGNanoRasterizer>> rasterizers;
+    std::vector<std::vector<unsigned char>> buffers(m_entries.size());
+    std::atomic<size_t> failedEntry{m_entries.size()};
+
+    for ( size_t i = 0; i < pool.GetThreadCount(); ++i )
+        rasterizers.push_back(std::unique_ptr<wxSVGNanoRasterizer>(new wxSVGNanoRasterizer));
+
+    stopWatch.Start();
+    pool.ParallelFor(m_entries.size(), [&](size_t index, size_t workerIndex)
+        {
+            const std::vector<char>& data = fileData[m_entries[index].fileIndex];
+            const wxSize             size = m_entries[index].rect.GetSize();
+            wxSVGNanoRasterizer&     rasterizer = *rasterizers[workerIndex];
+
+            if ( !rasterizer.Rasterize(data.data(), data.size(), size) )
+            {
+                failedEntry = index;
+                return;
+            }
+
+            buffers[index].assign(rasterizer.GetBuffer(),
+                                  rasterizer.GetBuffer() + wxBitmapBundleImplSVG::GetBitmapBytes(size));
+        });
+    m_buildTimes.rasterize = stopWatch.TimeInMicro().ToLong();
+
+    if ( failedEntry != m_entries.size() )
+    {
+        const Entry& entry = m_entries[failedEntry];
+
+        wxLogError("Couldn't rasterize file '%s' at size %dx%d.", m_fileNames[entry.fileIndex],
+                   entry.rect.width, entry.rect.height);
+        m_entries.clear();
+        return false;
+    }
+
+    stopWatch.Start();
+    Pack(pageSize);
+    m_buildTimes.pack = stopWatch.TimeInMicro().ToLong();
+
+    stopWatch.Start();
+    for ( auto& page : m_pages )
+        page.buffer.assign(wxBitmapBundleImplSVG::GetBitmapBytes(page.size), 0);
+
+    // the icons do not overlap, so they can be copied in parallel
+    pool.ParallelFor(m_entries.size(), [&](size_t index, size_t WXUNUSED(workerIndex))
+        {
+            const Entry&         entry    = m_entries[index];
+            Page&                page     = m_pages[entry.page];
+            const size_t         rowBytes = static_cast<size_t>(entry.rect.width) * 4;
+            const unsigned char* src      = buffers[index].data();
+            unsigned char*       dst      = page.buffer.data()
+                                            + (static_cast<size_t>(entry.rect.y) * page.size.x + entry.rect.x) * 4;
+
+            for ( int y = 0; y < entry.rect.height; ++y, src += rowBytes, dst += page.size.x * 4 )
+                memcpy(dst, src, rowBytes);
+        });
+    m_buildTimes.copy = stopWatch.TimeInMicro().ToLong();
+
+    return true;
+}
+
+void wxSVGIconAtlas::Pack(const wxSize& pageSize)
+{
+    // an icon larger than the page gets a larger page
+    wxSize actualPageSize(pageSize);
+
+    for ( const auto& size : m_sizes )
+        actualPageSize.IncTo(size);
+
+    // the highest icons first, so that the icons on a shelf
+    // are not much lower than the shelf
+    std::vector<size_t> order(m_entries.size());
+
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+        {
+            const wxRect& ra = m_entries[a].rect;
+            const wxRect& rb = m_entries[b].rect;
+
+            return ra.height != rb.height ? ra.height > rb.height : ra.width > rb.width;
+        });
+
+    std::vector<Shelf> shelves;
+    std::vector<int>   pageHeights;
+
+    for ( const auto index : order )
+    {
+        Entry& entry = m_entries[index];
+        Shelf* shelf = nullptr;
+
+        for ( auto& s : shelves )
+        {
+            if ( s.height >= entry.rect.height && actualPageSize.x - s.usedWidth >= entry.rect.width )
+            {
+                shelf = &s;
+                break;
+            }
+        }
+
+        if ( !shelf )
+        {
+            if ( pageHeights.empty() || actualPageSize.y - pageHeights.back() < entry.rect.height )
+                pageHeights.push_back(0);
+
+            shelves.push_back({ pageHeights.size() - 1, pageHeights.back(), entry.rect.height, 0 });
+            pageHeights.back() += entry.rect.height;
+            shelf = &shelves.back();
+        }
+
+        entry.page = shelf->page;
+        entry.rect.SetPosition(wxPoint(shelf->usedWidth, shelf->y));
+        shelf->usedWidth += entry.rect.width;
+    }
+
+    // crop the pages to their shelves
+    m_pages.resize(pageHeights.size());
+    for ( size_t i = 0; i < m_pages.size(); ++i )
+        m_pages[i].size = wxSize(0, pageHeights[i]);
+
+    for ( const auto& s : shelves )
+        m_pages[s.page].size.x = wxMax(m_pages[s.page].size.x, s.usedWidth);
+}
+
+size_t wxSVGIconAtlas::GetBytes() const
+{
+    size_t bytes = 0;
+
+    for ( const auto& page : m_pages )
+        bytes += wxBitmapBundleImplSVG::GetBitmapBytes(page.size);
+
+    return bytes;
+}
+
+int wxSVGIconAtlas::FindFile(const wxString& fileName) const
+{
+    const auto it = m_fileIndices.find(fileName);
+
+    return it != m_fileIndices.end() ? static_cast<int>(it->second) : wxNOT_FOUND;
+}
+
+const wxSVGIconAtlas::Entry* wxSVGIconAtlas::Find(size_t fileIndex, const wxSize& size) const
+{
+    wxCHECK(fileIndex < m_fileNames.size(), nullptr);
+
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        if ( m_sizes[s] == size )
+            return &m_entries[fileIndex * m_sizes.size() + s];
+    }
+
+    return nullptr;
+}
+
+const wxSVGIconAtlas::Entry* wxSVGIconAtlas::Find(const wxString& fileName, const wxSize& size) const
+{
+    const int fileIndex = FindFile(fileName);
+
+    return fileIndex != wxNOT_FOUND ? Find(static_cast<size_t>(fileIndex), size) : nullptr;
+}
+
+wxBitmap wxSVGIconAtlas::GetPageBitmap(size_t page)
+{
+    wxCHECK(page < m_pages.size(), wxBitmap());
+
+    Page& p = m_pages[page];
+
+    if ( !p.bitmap.IsOk() )
+    {
+        p.bitmap = wxBitmapBundleImplSVG::CreateBitmapFromRGBA(p.buffer.data(),
+                       wxBitmapBundleImplSVG::GetBitmapBytes(wxSize(p.size.x, 1)), p.size, false);
+    }
+
+    return p.bitmap;
+}
+
+wxBitmap wxSVGIconAtlas::GetBitmap(const Entry& entry)
+{
+    const wxBitmap pageBitmap = GetPageBitmap(entry.page);
+
+    return pageBitmap.IsOk() ? pageBitmap.GetSubBitmap(entry.rect) : wxBitmap();
+}
+
+bool wxSVGIconAtlas::SaveIndex(const wxString& fileName) const
+{
+    wxString text("File\tWidth\tHeight\tPage\tX\tY\n");
+
+    for ( const auto& entry : m_entries )
+    {
+        text += wxString::Format("%s\t%d\t%d\t%zu\t%d\t%d\n", m_fileNames[entry.fileIndex],
+            entry.rect.width, entry.rect.height, entry.page, entry.rect.x, entry.rect.y);
+    }
+
+    wxFFile file(fileName, "w");
+
+    return file.IsOpened() && file.Write(text, wxConvUTF8);
+}
+
+bool wxSVGIconAtlas::SavePages(const wxString& fileNamePrefix) const
+{
+    if ( !wxImage::FindHandler(wxBITMAP_TYPE_PNG) )
+        wxImage::AddHandler(new wxPNGHandler);
+
+    for ( size_t i = 0; i < m_pages.size(); ++i )
+    {
+        const wxString fileName = wxString::Format("%s-%zu.png", fileNamePrefix, i);
+        const wxImage  image = wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(m_pages[i].buffer, m_pages[i].size);
+
+        if ( !image.SaveFile(fileName, wxBITMAP_TYPE_PNG) )
+        {
+            wxLogError("Couldn't save atlas page to '%s'.", fileName);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+wxBitmapBundle CreateFromSVGIconAtlas(const std::shared_ptr<wxSVGIconAtlas>& atlas,
+                                      const wxString& fileName)
+{
+    wxCHECK(atlas, wxBitmapBundle());
+
+    const int fileIndex = atlas->FindFile(fileName);
+
+    if ( fileIndex == wxNOT_FOUND )
+        return wxBitmapBundle();
+
+    return wxBitmapBundle::FromImpl(new wxBitmapBundleImplSVGAtlas(atlas, static_cast<size_t>(fileIndex)));
+}
+
+// ============================================================================
+// wxBitmapBundleImplSVGAtlas implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGAtlas::wxBitmapBundleImplSVGAtlas(const std::shared_ptr<wxSVGIconAtlas>& atlas,
+                                                       size_t fileIndex)
+    : m_atlas(atlas), m_fileIndex(fileIndex)
+{
+}
+
+wxSize wxBitmapBundleImplSVGAtlas::GetDefaultSize() const
+{
+    return GetAvailableSize(wxSize(1, 1));
+}
+
+wxSize wxBitmapBundleImplSVGAtlas::GetPreferredSizeAtScale(double scale) const
+{
+    return GetAvailableSize(GetDefaultSize()*scale);
+}
+
+wxBitmap wxBitmapBundleImplSVGAtlas::GetBitmap(const wxSize& size)
+{
+    const wxSize                 availableSize = GetAvailableSize(size);
+    const wxSVGIconAtlas::Entry* entry = m_atlas->Find(m_fileIndex, availableSize);
+
+    if ( !entry )
+        return wxBitmap();
+
+    wxBitmap bitmap = m_atlas->GetBitmap(*entry);
+
+    if ( bitmap.IsOk() && availableSize != size )
+        wxBitmap::Rescale(bitmap, size);
+
+    return bitmap;
+}
+
+wxSize wxBitmapBundleImplSVGAtlas::GetAvailableSize(const wxSize& size) const
+{
+    wxSize best, largest;
+
+    for ( const auto& s : m_atlas->GetSizes() )
+    {
+        if ( s.x >= size.x && s.y >= size.y && (best == wxSize() || s.x * s.y < best.x * best.y) )
+            best = s;
+        if ( s.x * s.y > largest.x * largest.y )
+            largest = s;
+    }
+
+    return best != wxSize() ? best : largest;
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
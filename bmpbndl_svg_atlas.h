@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_atlas.h
+// Purpose:     Atlas of SVG icons rasterized with NanoSVG at fixed sizes
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxSVGIconAtlas_PRIVATE_H
+#define wxSVGIconAtlas_PRIVATE_H
+
+#include "wx/wx.h"
+
+#include "bmpbndl_svg_nano.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// wxSVGIconAtlas declaration
+// ============================================================================
+
+/*
+    All the given SVG files rasterized at all the given sizes and packed
+    into a few large RGBA pages, instead of having a separate bitmap for
+    every icon and size.
+
+    The files are rasterized in parallel with wxSVGNanoRasterizer, one per
+    thread of wxTestSVGThreadPool. The rasterized icons are then sorted by
+    height and packed into shelves: rows as high as their first (i.e., highest)
+    icon, filled from left to right. An icon is put on the first shelf
+    with enough room left, a new shelf is started below the last one when
+    there is none, and a new page when the page is full. The pages are
+    then cropped to the shelves, so that they are not larger than needed.
+
+    The pages are kept as RGBA (not premultiplied) buffers, wxBitmaps
+    for them are created on demand, which must be done in the main thread.
+ */
+
+class wxSVGIconAtlas
+{
+public:
+    // position of an icon in the atlas
+    struct Entry
+    {
+        size_t fileIndex{0};
+        size_t page{0};
+        wxRect rect;
+    };
+
+    // times in microseconds of the last Build()
+    struct BuildTimes
+    {
+        long read{0};      // reading all the files
+        long rasterize{0}; // parsing and rasterizing all the icons in parallel
+        long pack{0};      // computing the icon positions
+        long copy{0};      // copying the icons to the pages in parallel
+    };
+
+    wxSVGIconAtlas() {}
+
+    // fileNames are relative to dirName and may include subfolders.
+    // threadCount = 0 means as many threads as there are CPU cores.
+    // The pages are pageSize large, or larger if an icon does not fit.
+    bool Build(const wxString& dirName, const wxArrayString& fileNames,
+               const std::vector<wxSize>& sizes, size_t threadCount = 0,
+               const wxSize& pageSize = wxSize(2048, 2048));
+
+    const BuildTimes& GetBuildTimes() const { return m_buildTimes; }
+
+    size_t GetFileCount() const { return m_fileNames.size(); }
+    const wxString& GetFileName(size_t fileIndex) const { return m_fileNames[fileIndex]; }
+    const std::vector<wxSize>& GetSizes() const { return m_sizes; }
+
+    // all the entries, sorted by file and then by size
+    const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+    size_t GetPageCount() const { return m_pages.size(); }
+    wxSize GetPageSize(size_t page) const { return m_pages[page].size; }
+
+    // bytes used by the pixels of all the pages
+    size_t GetBytes() const;
+
+    // returns wxNOT_FOUND if there is no such file in the atlas
+    int FindFile(const wxString& fileName) const;
+
+    // return nullptr if the icon is not in the atlas at this size
+    const Entry* Find(size_t fileIndex, const wxSize& size) const;
+    const Entry* Find(const wxString& fileName, const wxSize& size) const;
+
+    // must be called from the main thread only
+    wxBitmap GetPageBitmap(size_t page);
+    // returns a copy of the part of the page bitmap with the icon
+    wxBitmap GetBitmap(const Entry& entry);
+
+    // writes the entries as tab separated values: file, width,
+    // height, page, x, and y, one row per entry
+    bool SaveIndex(const wxString& fileName) const;
+    // writes the pages as fileNamePrefix-N.png, N starting at 0
+    bool SavePages(const wxString& fileNamePrefix) const;
+
+private:
+    struct Page
+    {
+        wxSize                     size;
+        std::vector<unsigned char> buffer; // RGBA, not premultiplied
+        wxBitmap                   bitmap; // created on demand
+    };
+
+    wxArrayString       m_fileNames;
+    std::vector<wxSize> m_sizes;
+    // m_entries[fileIndex * m_sizes.size() + sizeIndex]
+    std::vector<Entry>  m_entries;
+    std::vector<Page>   m_pages;
+    BuildTimes          m_buildTimes;
+
+    std::map<wxString, size_t> m_fileIndices;
+
+    // sets the page and position of all the entries and the page sizes
+    void Pack(const wxSize& pageSize);
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGIconAtlas);
+};
+
+// Creates wxBitmapBundle serving the bitmaps of the given file from the atlas,
+// returns an invalid bundle if the file is not in the atlas.
+wxBitmapBundle CreateFromSVGIconAtlas(const std::shared_ptr<wxSVGIconAtlas>& atlas,
+                                      const wxString& fileName);
+
+// ============================================================================
+// wxBitmapBundleImplSVGAtlas declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl returning the parts of the atlas pages with one
+    icon. The atlas has the icon only at the sizes it was built with,
+    the bitmaps at the other sizes are rescaled from the nearest larger
+    (or the largest) size available. The bitmaps are not cached, as that
+    would defeat the purpose of the atlas.
+ */
+
+class wxBitmapBundleImplSVGAtlas : public wxBitmapBundleImpl
+{
+public:
+    wxBitmapBundleImplSVGAtlas(const std::shared_ptr<wxSVGIconAtlas>& atlas, size_t fileIndex);
+
+    virtual wxSize GetDefaultSize() const wxOVERRIDE;
+    virtual wxSize GetPreferredSizeAtScale(double scale) const wxOVERRIDE;
+    virtual wxBitmap GetBitmap(const wxSize& size) wxOVERRIDE;
+
+private:
+    std::shared_ptr<wxSVGIconAtlas> m_atlas;
+    size_t                          m_fileIndex;
+
+    // returns the smallest size available not smaller than size,
+    // or the largest size available if there is none
+    wxSize GetAvailableSize(const wxSize& size) const;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGAtlas);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#endif // #ifndef wxSVGIconAtlas_PRIVATE_H
@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_cache.cpp
+// Purpose:     Process-wide cache of parsed SVGs and their bitmaps
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_cache.h"
+
+#include "wx/thread.h"
+
+// ============================================================================
+// wxBitmapBundleSVGSharedCache implementation
+// ============================================================================
+
+bool wxBitmapBundleSVGSharedCache::Key::operator<(const Key& other) const
+{
+    if ( hash != other.hash )
+        return hash < other.hash;
+    if ( dataLength != other.dataLength )
+        return dataLength < other.dataLength;
+    if ( backend != other.backend )
+        return backend < other.backend;
+    if ( size.x != other.size.x )
+        return size.x < other.size.x;
+    return size.y < other.size.y;
+}
+
+// static
+wxBitmapBundleSVGSharedCache& wxBitmapBundleSVGSharedCache::Get()
+{
+    static wxBitmapBundleSVGSharedCache s_cache;
+
+    return s_cache;
+}
+
+// static
+wxUint64 wxBitmapBundleSVGSharedCache::HashData(const char* data)
+{
+    // 64-bit FNV-1a
+    wxUint64 hash = wxULL(14695981039346656037);
+
+    for ( const unsigned char* p = reinterpret_cast<const unsigned char*>(data); *p; ++p )
+    {
+        hash ^= *p;
+        hash *= wxULL(1099511628211);
+    }
+
+    return hash;
+}
+
+void wxBitmapBundleSVGSharedCache::Enable(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_enabled = enable;
+}
+
+bool wxBitmapBundleSVGSharedCache::IsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_enabled;
+}
+
+void wxBitmapBundleSVGSharedCache::SetMaxBytes(size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_maxBytes = maxBytes;
+    DoTrim();
+}
+
+size_t wxBitmapBundleSVGSharedCache::GetMaxBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_maxBytes;
+}
+
+std::shared_ptr<void> wxBitmapBundleSVGSharedCache::FindDocument(wxUint64 hash, size_t dataLength,
+                                                                 const char* backend)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( !m_enabled )
+        return std::shared_ptr<void>();
+
+    const Entry* entry = DoFind({ hash, dataLength, backend, wxDefaultSize });
+
+    if ( !entry )
+    {
+        ++m_stats.documentMisses;
+        return std::shared_ptr<void>();
+    }
+
+    ++m_stats.documentHits;
+    return entry->document;
+}
+
+void wxBitmapBundleSVGSharedCache::AddDocument(wxUint64 hash, size_t dataLength, const char* backend,
+                                               const std::shared_ptr<void>& document, size_t bytes)
+{
+    wxCHECK_RET(document, "null document");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( !m_enabled )
+        return;
+
+    DoAdd({ { hash, dataLength, backend, wxDefaultSize }, document, wxBitmap(), bytes });
+}
+
+bool wxBitmapBundleSVGSharedCache::FindBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                                              const wxSize& size, wxBitmap& bitmap)
+{
+    wxASSERT_MSG(wxThread::IsMain(), "bitmaps can be shared only in the main thread");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( !m_enabled )
+        return false;
+
+    const Entry* entry = DoFind({ hash, dataLength, backend, size });
+
+    if ( !entry )
+    {
+        ++m_stats.bitmapMisses;
+        return false;
+    }
+
+    ++m_stats.bitmapHits;
+    bitmap = entry->bitmap;
+    return true;
+}
+
+void wxBitmapBundleSVGSharedCache::AddBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                                             const wxBitmap& bitmap)
+{
+    wxASSERT_MSG(wxThread::IsMain(), "bitmaps can be shared only in the main thread");
+    wxCHECK_RET(bitmap.IsOk(), "invalid bitmap");
+
+    const wxSize size  = bitmap.GetSize();
+    const size_t bytes = static_cast<size_t>(size.x) * size.y * 4;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( !m_enabled )
+        return;
+
+    DoAdd({ { hash, dataLength, backend, size }, std::shared_ptr<void>(), bitmap, bytes });
+}
+
+void wxBitmapBundleSVGSharedCache::Clear()
+{
+    wxASSERT_MSG(wxThread::IsMain(), "bitmaps can be released only in the main thread");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_entryMap.clear();
+    m_entries.clear();
+    m_stats.entryCount = 0;
+    m_stats.bytes = 0;
+}
+
+wxBitmapBundleSVGSharedCache::Statistics wxBitmapBundleSVGSharedCache::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_stats;
+}
+
+wxBitmapBundleSVGSharedCache::Entry* wxBitmapBundleSVGSharedCache::DoFind(const Key& key)
+{
+    const EntryMap::iterator it = m_entryMap.find(key);
+
+    if ( it == m_entryMap.end() )
+        return nullptr;
+
+    // move to the front, as the most recently used
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &m_entries.front();
+}
+
+void wxBitmapBundleSVGSharedCache::DoAdd(const Entry& entry)
+{
+    if ( entry.bytes > m_maxBytes )
+        return;
+
+    // another thread may have added the same entry in the meantime
+    const EntryMap::iterator it = m_entryMap.find(entry.key);
+
+    if ( it != m_entryMap.end() )
+    {
+        m_stats.bytes -= it->second->bytes;
+        m_entries.erase(it->second);
+        m_entryMap.erase(it);
+    }
+
+    m_entries.push_front(entry);
+    m_entryMap[entry.key] = m_entries.begin();
+    m_stats.bytes += entry.bytes;
+    m_stats.entryCount = m_entries.size();
+
+    DoTrim();
+}
+
+void wxBitmapBundleSVGSharedCache::DoTrim()
+{
+    // the bitmaps are released only in the main thread, see the class description
+    const bool          canReleaseBitmaps = wxThread::IsMain();
+    EntryList::iterator it = m_entries.end();
+
+    while ( m_stats.bytes > m_maxBytes && it != m_entries.begin() )
+    {
+        --it;
+
+        if ( it->key.size != wxDefaultSize && !canReleaseBitmaps )
+            continue;
+
+        m_stats.bytes -= it->bytes;
+        ++m_stats.evictions;
+        m_entryMap.erase(it->key);
+        it = m_entries.erase(it);
+    }
+
+    m_stats.entryCount = m_entries.size();
+}
@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_cache.h
+// Purpose:     Process-wide cache of parsed SVGs and their bitmaps
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleSVGSharedCache_PRIVATE_H
+#define wxBitmapBundleSVGSharedCache_PRIVATE_H
+
+#include "wx/wx.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// ============================================================================
+// wxBitmapBundleSVGSharedCache
+// ============================================================================
+
+/*
+    Cache shared by all wxBitmapBundleImplSVGs in the process, so that
+    the bundles created from the same SVG data (e.g., the same icon used
+    in several menus) share the parsed document and the rasterized bitmaps.
+    Only the impls of this application use it: the bundles created by
+    wxBitmapBundle::FromSVG() and FromSVGFile() of wxWidgets itself still
+    parse and rasterize each SVG on their own.
+
+    The entries are identified by the hash of the SVG data, its length,
+    the name of the backend, and, for bitmaps, the bitmap size.
+    The documents are stored as opaque pointers, only the backend
+    which created them knows their type.
+
+    The memory used by the cached documents and bitmaps is limited,
+    when exceeded, the least recently used entries are removed.
+    The documents and bitmaps removed from the cache stay alive
+    as long as there are bundles using them.
+
+    The documents can be found and added from any thread, they are held by
+    std::shared_ptr, whose reference count is atomic. The bitmaps can be
+    used only in the main thread: wxBitmap reference count is not atomic,
+    so a bitmap copied to or released in another thread while the main
+    thread copies it would be corrupted, no matter that the cache itself
+    is locked. FindBitmap(), AddBitmap(), and Clear() assert it and
+    the other threads evict only the documents when trimming the cache.
+ */
+
+class wxBitmapBundleSVGSharedCache
+{
+public:
+    struct Statistics
+    {
+        size_t documentHits{0};
+        size_t documentMisses{0};
+        size_t bitmapHits{0};
+        size_t bitmapMisses{0};
+        size_t evictions{0};
+        size_t entryCount{0};
+        size_t bytes{0};
+    };
+
+    static wxBitmapBundleSVGSharedCache& Get();
+
+    // data must be 0 terminated
+    static wxUint64 HashData(const char* data);
+
+    // the disabled cache does not find or store anything
+    void Enable(bool enable = true);
+    bool IsEnabled() const;
+
+    void   SetMaxBytes(size_t maxBytes);
+    size_t GetMaxBytes() const;
+
+    std::shared_ptr<void> FindDocument(wxUint64 hash, size_t dataLength, const char* backend);
+    // bytes is the (estimated) memory taken by the document
+    void AddDocument(wxUint64 hash, size_t dataLength, const char* backend,
+                     const std::shared_ptr<void>& document, size_t bytes);
+
+    // these can be called only in the main thread
+    bool FindBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                    const wxSize& size, wxBitmap& bitmap);
+    void AddBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                   const wxBitmap& bitmap);
+
+    void Clear();
+
+    Statistics GetStatistics() const;
+
+private:
+    wxBitmapBundleSVGSharedCache() {}
+
+    struct Key
+    {
+        wxUint64    hash;
+        size_t      dataLength;
+        std::string backend;
+        wxSize      size; // wxDefaultSize for documents
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Entry
+    {
+        Key                   key;
+        std::shared_ptr<void> document;
+        wxBitmap              bitmap;
+        size_t                bytes;
+    };
+
+    typedef std::list<Entry>                     EntryList;
+    typedef std::map<Key, EntryList::iterator>   EntryMap;
+
+    mutable std::mutex m_mutex;
+
+    bool       m_enabled{true};
+    size_t     m_maxBytes{32 * 1024 * 1024};
+    // the most recently used first
+    EntryList  m_entries;
+    EntryMap   m_entryMap;
+    Statistics m_stats;
+
+    // these must be called with m_mutex locked
+    Entry* DoFind(const Key& key);
+    void   DoAdd(const Entry& entry);
+    void   DoTrim();
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleSVGSharedCache);
+};
+
+// ============================================================================
+// wxBitmapBundleSVGSharedCacheDisabler
+// ============================================================================
+
+// Disables wxBitmapBundleSVGSharedCache in its scope, e.g., for benchmarking.
+class wxBitmapBundleSVGSharedCacheDisabler
+{
+public:
+    wxBitmapBundleSVGSharedCacheDisabler()
+        : m_wasEnabled(wxBitmapBundleSVGSharedCache::Get().IsEnabled())
+    {
+        wxBitmapBundleSVGSharedCache::Get().Enable(false);
+    }
+
+    ~wxBitmapBundleSVGSharedCacheDisabler()
+    {
+        wxBitmapBundleSVGSharedCache::Get().Enable(m_wasEnabled);
+    }
+
+private:
+    const bool m_wasEnabled;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleSVGSharedCacheDisabler);
+};
+
+#endif // #ifndef wxBitmapBundleSVGSharedCache_PRIVATE_H
@@ -0,0 +1,319 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_cairo.cpp
+// Purpose:     wxBitmapBundleImpl rendering SVG parsed by NanoSVG with cairo
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_cairo.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+
+#include "bmpbndl_svg_pixels.h"
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+namespace
+{
+
+// NanoSVG colours are 0xAABBGGRR, opacity is that of the whole shape
+void SetSourceColor(cairo_t* cr, unsigned int color, float opacity)
+{
+    cairo_set_source_rgba(cr,
+                          (color & 0xff) / 255.0,
+                          ((color >> 8) & 0xff) / 255.0,
+                          ((color >> 16) & 0xff) / 255.0,
+                          ((color >> 24) & 0xff) / 255.0 * opacity);
+}
+
+// Sets the gradient as the source, NanoSVG gives its transform from
+// the image coordinates to those where a linear gradient goes from (0, 0)
+// to (0, 1) and a radial one is the unit circle centered at (0, 0),
+// which is what the NanoSVG rasterizer uses
+void SetSourceGradient(cairo_t* cr, const NSVGgradient* gradient, bool isRadial, float opacity)
+{
+    cairo_pattern_t* pattern = isRadial ? cairo_pattern_create_radial(0, 0, 0, 0, 0, 1)
+                                        : cairo_pattern_create_linear(0, 0, 0, 1);
+    const float*     t = gradient->xform;
+    cairo_matrix_t   matrix;
+
+    // the pattern matrix maps the user space to the pattern space
+    cairo_matrix_init(&matrix, t[0], t[1], t[2], t[3], t[4], t[5]);
+    cairo_pattern_set_matrix(pattern, &matrix);
+
+    switch ( gradient->spread )
+    {
+        case NSVG_SPREAD_REFLECT:
+            cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REFLECT);
+            break;
+        case NSVG_SPREAD_REPEAT:
+            cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+            break;
+        default:
+            cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+    }
+
+    for ( int i = 0; i < gradient->nstops; ++i )
+    {
+        const unsigned int color = gradient->stops[i].color;
+
+        cairo_pattern_add_color_stop_rgba(pattern, gradient->stops[i].offset,
+                                          (color & 0xff) / 255.0,
+                                          ((color >> 8) & 0xff) / 255.0,
+                                          ((color >> 16) & 0xff) / 255.0,
+                                          ((color >> 24) & 0xff) / 255.0 * opacity);
+    }
+
+    cairo_set_source(cr, pattern);
+    // the context keeps its own reference
+    cairo_pattern_destroy(pattern);
+}
+
+// returns false for NSVG_PAINT_NONE
+bool SetSourcePaint(cairo_t* cr, const NSVGpaint& paint, float opacity)
+{
+    switch ( paint.type )
+    {
+        case NSVG_PAINT_COLOR:
+            SetSourceColor(cr, paint.color, opacity);
+            return true;
+        case NSVG_PAINT_LINEAR_GRADIENT:
+            SetSourceGradient(cr, paint.gradient, false, opacity);
+            return true;
+        case NSVG_PAINT_RADIAL_GRADIENT:
+            SetSourceGradient(cr, paint.gradient, true, opacity);
+            return true;
+    }
+
+    return false;
+}
+
+// NanoSVG converts all the path segments to cubic Bezier curves
+void AppendShapePath(cairo_t* cr, const NSVGshape* shape)
+{
+    cairo_new_path(cr);
+
+    for ( const NSVGpath* path = shape->paths; path; path = path->next )
+    {
+        const float* p = path->pts;
+
+        if ( path->npts < 1 )
+            continue;
+
+        cairo_move_to(cr, p[0], p[1]);
+        for ( int i = 0; i + 3 < path->npts; i += 3, p += 6 )
+            cairo_curve_to(cr, p[2], p[3], p[4], p[5], p[6], p[7]);
+        if ( path->closed )
+            cairo_close_path(cr);
+    }
+}
+
+void SetStrokeStyle(cairo_t* cr, const NSVGshape* shape)
+{
+    cairo_set_line_width(cr, shape->strokeWidth);
+    cairo_set_miter_limit(cr, shape->miterLimit);
+
+    switch ( shape->strokeLineJoin )
+    {
+        case NSVG_JOIN_ROUND:
+            cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+            break;
+        case NSVG_JOIN_BEVEL:
+            cairo_set_line_join(cr, CAIRO_LINE_JOIN_BEVEL);
+            break;
+        default:
+            cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+    }
+
+    switch ( shape->strokeLineCap )
+    {
+        case NSVG_CAP_ROUND:
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+            break;
+        case NSVG_CAP_SQUARE:
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
+            break;
+        default:
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
+    }
+
+    double dashes[8];
+    int    dashCount = 0;
+
+    for ( ; dashCount < shape->strokeDashCount && dashCount < 8; ++dashCount )
+        dashes[dashCount] = shape->strokeDashArray[dashCount];
+
+    // no dashes means a solid line
+    cairo_set_dash(cr, dashes, dashCount, shape->strokeDashOffset);
+}
+
+// Renders the image at scale, translated by (tx, ty), the same as nsvgRasterize()
+void RenderNSVGImage(cairo_t* cr, const NSVGimage* image, float tx, float ty, float scale)
+{
+    cairo_identity_matrix(cr);
+    cairo_translate(cr, tx, ty);
+    cairo_scale(cr, scale, scale);
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        if ( !(shape->flags & NSVG_FLAGS_VISIBLE) )
+            continue;
+
+        const bool hasStroke = shape->stroke.type != NSVG_PAINT_NONE && shape->strokeWidth > 0;
+
+        AppendShapePath(cr, shape);
+
+        if ( SetSourcePaint(cr, shape->fill, shape->opacity) )
+        {
+            cairo_set_fill_rule(cr, shape->fillRule == NSVG_FILLRULE_EVENODD
+                                    ? CAIRO_FILL_RULE_EVEN_ODD : CAIRO_FILL_RULE_WINDING);
+            if ( hasStroke )
+                cairo_fill_preserve(cr);
+            else
+                cairo_fill(cr);
+        }
+
+        if ( hasStroke )
+        {
+            SetSourcePaint(cr, shape->stroke, shape->opacity);
+            SetStrokeStyle(cr, shape);
+            cairo_stroke(cr);
+        }
+    }
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxBitmapBundleImplSVGCairo implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGCairo::wxBitmapBundleImplSVGCairo(const char* data, const wxSize& sizeDef)
+    : wxBitmapBundleImplSVG(sizeDef)
+{
+    wxCHECK_RET(data, "null data");
+
+    SetSharedCacheKey("Cairo", "1", data);
+
+    // the same parsed image as of wxBitmapBundleImplSVGNano
+    m_svgImage = GetSharedNSVGImage(m_sharedCacheHash, m_sharedCacheDataLength, data);
+}
+
+wxBitmapBundleImplSVGCairo::~wxBitmapBundleImplSVGCairo()
+{
+    DestroySurface();
+}
+
+bool wxBitmapBundleImplSVGCairo::IsOk() const
+{
+    return m_svgImage && m_svgImage->width > 0 && m_svgImage->height > 0;
+}
+
+void wxBitmapBundleImplSVGCairo::DestroySurface()
+{
+    if ( m_context )
+    {
+        cairo_destroy(m_context);
+        m_context = nullptr;
+    }
+
+    if ( m_surface )
+    {
+        cairo_surface_destroy(m_surface);
+        m_surface = nullptr;
+    }
+}
+
+bool wxBitmapBundleImplSVGCairo::DoRasterizeToBuffer(const wxSize& size)
+{
+    if ( !IsOk() )
+    {
+        wxLogDebug("invalid m_svgImage");
+        return false;
+    }
+
+    if ( size.x <= 0 || size.y <= 0 )
+    {
+        wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
+        return false;
+    }
+
+    if ( !m_surface
+         || cairo_image_surface_get_width(m_surface) != size.x
+         || cairo_image_surface_get_height(m_surface) != size.y )
+    {
+        DestroySurface();
+
+        m_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size.x, size.y);
+        m_context = cairo_create(m_surface);
+        if ( cairo_status(m_context) != CAIRO_STATUS_SUCCESS )
+        {
+            wxLogDebug("Failed to create cairo surface %dx%d", size.x, size.y);
+            DestroySurface();
+            return false;
+        }
+    }
+
+    // the surface is reused, clear what was rendered before
+    cairo_save(m_context);
+    cairo_set_operator(m_context, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(m_context);
+    cairo_restore(m_context);
+
+    // the same scaling and centering as RasterizeNSVGImage() in bmpbndl_svg_nano.cpp
+    const NSVGimage* image = m_svgImage.get();
+    const float      scale = wxMin(size.x / image->width, size.y / image->height);
+
+    RenderNSVGImage(m_context, image,
+                    (size.x - image->width * scale) / 2.0f,
+                    (size.y - image->height * scale) / 2.0f,
+                    scale);
+
+    return true;
+}
+
+wxBitmap wxBitmapBundleImplSVGCairo::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxCHECK_MSG(m_surface
+                && cairo_image_surface_get_width(m_surface) == size.x
+                && cairo_image_surface_get_height(m_surface) == size.y, wxBitmap(),
+                "buffer was not rasterized at this size");
+
+    cairo_surface_flush(m_surface);
+
+    unsigned char* data   = cairo_image_surface_get_data(m_surface);
+    const int      stride = cairo_image_surface_get_stride(m_surface);
+
+    // ARGB32 is a native endian 32-bit value, reorder its bytes to RGBA
+    for ( int y = 0; y < size.y; ++y )
+    {
+        unsigned char* row = data + static_cast<size_t>(y) * stride;
+
+#if wxBYTE_ORDER == wxLITTLE_ENDIAN
+        // BGRA
+        wxSVGPixelConverter::SwapRedBlue(row, row, size.x);
+#else
+        // ARGB
+        for ( unsigned char* p = row; p < row + size.x * 4; p += 4 )
+        {
+            const unsigned char alpha = p[0];
+
+            p[0] = p[1];
+            p[1] = p[2];
+            p[2] = p[3];
+            p[3] = alpha;
+        }
+#endif // #if wxBYTE_ORDER == wxLITTLE_ENDIAN
+    }
+
+    // the pixels were changed behind cairo's back
+    cairo_surface_mark_dirty(m_surface);
+
+    return CreateBitmapFromRGBA(data, stride, size, true);
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_cairo.h
+// Purpose:     wxBitmapBundleImpl rendering SVG parsed by NanoSVG with cairo
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleImplSVGCairo_PRIVATE_H
+#define wxBitmapBundleImplSVGCairo_PRIVATE_H
+
+#include "bmpbndl_svg_nano.h"
+
+// cairo is found with pkg-config by CMake, which then defines
+// wxTESTSVG_USE_CAIRO, see CMakeLists.txt
+#if defined(wxHAS_BMPBUNDLE_IMPL_SVG_NANO) && defined(wxTESTSVG_USE_CAIRO)
+    #define wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+#endif // #if defined(wxHAS_BMPBUNDLE_IMPL_SVG_NANO) && defined(wxTESTSVG_USE_CAIRO)
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+
+#include <memory>
+
+#include <cairo.h>
+
+#include "bmpbndl_svg.h"
+
+struct NSVGimage;
+
+// ============================================================================
+// wxBitmapBundleImplSVGCairo declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl which parses SVG with NanoSVG, sharing the parsed
+    image with wxBitmapBundleImplSVGNano, but renders its shapes with cairo
+    instead of the NanoSVG scanline rasterizer: the paths are filled and
+    stroked with cairo analytic antialiasing and the linear and radial
+    gradients become cairo patterns.
+
+    The image is scaled uniformly and centered at the requested size, the same
+    as wxBitmapBundleImplSVGD2D and wxBitmapBundleImplSVGNano do, into a cairo
+    image surface which is reused as long as the size does not change.
+    The surface is premultiplied ARGB in native byte order, which is
+    reordered to RGBA in place when converting it to wxBitmap.
+ */
+
+class wxBitmapBundleImplSVGCairo : public wxBitmapBundleImplSVG
+{
+public:
+    // data must be 0 terminated, wxBitmapBundleImplSVGCairo doesn't
+    // take its ownership and it can be deleted after the ctor
+    // was called.
+    wxBitmapBundleImplSVGCairo(const char* data, const wxSize& sizeDef);
+    ~wxBitmapBundleImplSVGCairo();
+
+    bool IsOk() const;
+
+private:
+    std::shared_ptr<NSVGimage> m_svgImage;
+
+    // the result of the last DoRasterizeToBuffer()
+    cairo_surface_t* m_surface{nullptr};
+    cairo_t*         m_context{nullptr};
+
+    void DestroySurface();
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGCairo);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+
+#endif // #ifndef wxBitmapBundleImplSVGCairo_PRIVATE_H
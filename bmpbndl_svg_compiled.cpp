@@ -0,0 +1,629 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_compiled.cpp
+// Purpose:     wxBitmapBundleImpl rasterizing memory-mapped compiled SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_compiled.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+
+#include "wx/ffile.h"
+#include "wx/filename.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+#include <nanosvgrast.h>
+
+namespace
+{
+
+// ============================================================================
+// the compiled file format
+// ============================================================================
+
+// increase when the format of the file changes
+const wxUint32 CompiledFileFormatVersion = 1;
+
+const char CompiledFileMagic[8] = { 'w', 'x', 'S', 'V', 'G', 'C', 'D', '\0' };
+
+// written in the native byte order, reads differently in any other
+const wxUint32 CompiledFileByteOrderMark = 0x01020304;
+
+// All the records consist of 4 byte fields, or bytes padded to 4,
+// so there is no padding added by the compiler and the arrays which
+// follow each other stay 4 byte aligned.
+
+struct CompiledFileHeader
+{
+    char     magic[8];
+    wxUint32 formatVersion;
+    wxUint32 byteOrderMark;
+    wxUint32 fileSize;
+    float    width;
+    float    height;
+    wxUint32 shapeCount;
+    wxUint32 pathCount;
+    wxUint32 gradientCount;
+    wxUint32 stopCount;
+    wxUint32 pointCount; // x, y pairs
+    // from the start of the file, 4 byte aligned
+    wxUint32 shapesOffset;
+    wxUint32 pathsOffset;
+    wxUint32 gradientsOffset;
+    wxUint32 stopsOffset;
+    wxUint32 pointsOffset;
+};
+
+struct CompiledPaint
+{
+    wxUint8  type; // NSVGpaintType
+    wxUint8  padding[3];
+    wxUint32 value; // 0xAABBGGRR colour or the index of the gradient
+};
+
+struct CompiledShape
+{
+    CompiledPaint fill;
+    CompiledPaint stroke;
+    float    opacity;
+    float    strokeWidth;
+    float    strokeDashOffset;
+    float    strokeDashArray[8];
+    float    miterLimit;
+    float    bounds[4];
+    wxUint32 firstPath;
+    wxUint32 pathCount;
+    wxUint8  strokeDashCount;
+    wxUint8  strokeLineJoin;
+    wxUint8  strokeLineCap;
+    wxUint8  fillRule;
+    wxUint8  flags;
+    wxUint8  padding[3];
+};
+
+// the points are the start point followed by 3 points of each cubic curve
+struct CompiledPath
+{
+    wxUint32 firstPoint;
+    wxUint32 pointCount;
+    float    bounds[4];
+    wxUint8  closed;
+    wxUint8  padding[3];
+};
+
+struct CompiledGradient
+{
+    float    xform[6];
+    float    fx;
+    float    fy;
+    wxUint32 firstStop;
+    wxUint32 stopCount;
+    wxUint8  spread;
+    wxUint8  padding[3];
+};
+
+struct CompiledStop
+{
+    wxUint32 color;
+    float    offset;
+};
+
+static_assert(sizeof(CompiledFileHeader) % 4 == 0 && sizeof(CompiledShape) % 4 == 0
+              && sizeof(CompiledPath) % 4 == 0 && sizeof(CompiledGradient) % 4 == 0
+              && sizeof(CompiledStop) % 4 == 0, "compiled records must be 4 byte aligned");
+
+bool IsGradientPaint(int type)
+{
+    return type == NSVG_PAINT_LINEAR_GRADIENT || type == NSVG_PAINT_RADIAL_GRADIENT;
+}
+
+// returns false if count records of recordSize at offset do not fit into fileSize
+bool IsArrayInFile(wxUint32 offset, wxUint32 count, size_t recordSize, size_t fileSize)
+{
+    return offset % 4 == 0
+           && offset >= sizeof(CompiledFileHeader) && offset <= fileSize
+           && count <= (fileSize - offset) / recordSize;
+}
+
+// returns false if first and count are not a range within 0 and total
+bool IsRange(wxUint32 first, wxUint32 count, wxUint32 total)
+{
+    return first <= total && count <= total - first;
+}
+
+// Rasterizes image to buffer with no gaps between rows, scaling it uniformly
+// and centering it at the given size, the same as RasterizeNSVGImage()
+// in bmpbndl_svg_nano.cpp, so that the bitmaps are identical
+void RasterizeCompiledImage(NSVGrasterizer* rasterizer, NSVGimage* image,
+                            const wxSize& size, unsigned char* buffer)
+{
+    const float scale = wxMin(size.x / image->width, size.y / image->height);
+    const float tx    = (size.x - image->width * scale) / 2.0f;
+    const float ty    = (size.y - image->height * scale) / 2.0f;
+
+    nsvgRasterize(rasterizer, image, tx, ty, scale, buffer, size.x, size.y, size.x * 4);
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxSVGCompiledImage implementation
+// ============================================================================
+
+wxString wxSVGCompiledImage::GetCompiledFileName(const wxString& svgFileName)
+{
+    wxFileName fileName(svgFileName);
+
+    fileName.SetExt(GetFileExtension());
+    return fileName.GetFullPath();
+}
+
+bool wxSVGCompiledImage::Compile(const NSVGimage* image, std::vector<unsigned char>& compiled)
+{
+    wxCHECK(image, false);
+
+    compiled.clear();
+
+    if ( !(image->width > 0 && image->height > 0) )
+        return false;
+
+    std::vector<CompiledShape>    shapes;
+    std::vector<CompiledPath>     paths;
+    std::vector<CompiledGradient> gradients;
+    std::vector<CompiledStop>     stops;
+    std::vector<float>            points;
+
+    // NanoSVG creates a gradient for each paint, so does the compiled image
+    const auto compilePaint = [&](const NSVGpaint& paint, CompiledPaint& compiledPaint)
+    {
+        memset(&compiledPaint, 0, sizeof(compiledPaint));
+
+        if ( paint.type == NSVG_PAINT_COLOR )
+        {
+            compiledPaint.type  = NSVG_PAINT_COLOR;
+            compiledPaint.value = paint.color;
+        }
+        else if ( IsGradientPaint(paint.type) && paint.gradient )
+        {
+            const NSVGgradient* gradient = paint.gradient;
+            CompiledGradient    compiledGradient;
+
+            memset(&compiledGradient, 0, sizeof(compiledGradient));
+            memcpy(compiledGradient.xform, gradient->xform, sizeof(compiledGradient.xform));
+            compiledGradient.fx        = gradient->fx;
+            compiledGradient.fy        = gradient->fy;
+            compiledGradient.spread    = static_cast<wxUint8>(gradient->spread);
+            compiledGradient.firstStop = static_cast<wxUint32>(stops.size());
+            compiledGradient.stopCount = static_cast<wxUint32>(gradient->nstops);
+
+            for ( int i = 0; i < gradient->nstops; ++i )
+            {
+                CompiledStop stop;
+
+                stop.color  = gradient->stops[i].color;
+                stop.offset = gradient->stops[i].offset;
+                stops.push_back(stop);
+            }
+
+            compiledPaint.type  = static_cast<wxUint8>(paint.type);
+            compiledPaint.value = static_cast<wxUint32>(gradients.size());
+            gradients.push_back(compiledGradient);
+        }
+        // anything else is not painted by the NanoSVG rasterizer either
+    };
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        // the rasterizer skips invisible shapes and those with nothing to paint
+        if ( !(shape->flags & NSVG_FLAGS_VISIBLE)
+             || (shape->fill.type == NSVG_PAINT_NONE && shape->stroke.type == NSVG_PAINT_NONE) )
+        {
+            continue;
+        }
+
+        CompiledShape compiledShape;
+
+        memset(&compiledShape, 0, sizeof(compiledShape));
+        compilePaint(shape->fill, compiledShape.fill);
+        compilePaint(shape->stroke, compiledShape.stroke);
+        compiledShape.opacity          = shape->opacity;
+        compiledShape.strokeWidth      = shape->strokeWidth;
+        compiledShape.strokeDashOffset = shape->strokeDashOffset;
+        memcpy(compiledShape.strokeDashArray, shape->strokeDashArray, sizeof(compiledShape.strokeDashArray));
+        compiledShape.miterLimit       = shape->miterLimit;
+        memcpy(compiledShape.bounds, shape->bounds, sizeof(compiledShape.bounds));
+        compiledShape.strokeDashCount  = static_cast<wxUint8>(shape->strokeDashCount);
+        compiledShape.strokeLineJoin   = static_cast<wxUint8>(shape->strokeLineJoin);
+        compiledShape.strokeLineCap    = static_cast<wxUint8>(shape->strokeLineCap);
+        compiledShape.fillRule         = static_cast<wxUint8>(shape->fillRule);
+        compiledShape.flags            = static_cast<wxUint8>(shape->flags);
+        compiledShape.firstPath        = static_cast<wxUint32>(paths.size());
+
+        for ( const NSVGpath* path = shape->paths; path; path = path->next )
+        {
+            // NanoSVG never creates other paths, Load() would reject them
+            if ( path->npts < 1 || (path->npts - 1) % 3 != 0 )
+                return false;
+
+            CompiledPath compiledPath;
+
+            memset(&compiledPath, 0, sizeof(compiledPath));
+            compiledPath.firstPoint = static_cast<wxUint32>(points.size() / 2);
+            compiledPath.pointCount = static_cast<wxUint32>(path->npts);
+            memcpy(compiledPath.bounds, path->bounds, sizeof(compiledPath.bounds));
+            compiledPath.closed     = path->closed ? 1 : 0;
+            points.insert(points.end(), path->pts, path->pts + path->npts * 2);
+            paths.push_back(compiledPath);
+        }
+
+        compiledShape.pathCount = static_cast<wxUint32>(paths.size()) - compiledShape.firstPath;
+        shapes.push_back(compiledShape);
+    }
+
+    const size_t shapesOffset    = sizeof(CompiledFileHeader);
+    const size_t pathsOffset     = shapesOffset + shapes.size() * sizeof(CompiledShape);
+    const size_t gradientsOffset = pathsOffset + paths.size() * sizeof(CompiledPath);
+    const size_t stopsOffset     = gradientsOffset + gradients.size() * sizeof(CompiledGradient);
+    const size_t pointsOffset    = stopsOffset + stops.size() * sizeof(CompiledStop);
+    const size_t fileSize        = pointsOffset + points.size() * sizeof(float);
+
+    // all the counts are smaller than the file size
+    if ( fileSize > 0xffffffff )
+        return false;
+
+    CompiledFileHeader header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CompiledFileMagic, sizeof(header.magic));
+    header.formatVersion   = CompiledFileFormatVersion;
+    header.byteOrderMark   = CompiledFileByteOrderMark;
+    header.fileSize        = static_cast<wxUint32>(fileSize);
+    header.width           = image->width;
+    header.height          = image->height;
+    header.shapeCount      = static_cast<wxUint32>(shapes.size());
+    header.pathCount       = static_cast<wxUint32>(paths.size());
+    header.gradientCount   = static_cast<wxUint32>(gradients.size());
+    header.stopCount       = static_cast<wxUint32>(stops.size());
+    header.pointCount      = static_cast<wxUint32>(points.size() / 2);
+    header.shapesOffset    = static_cast<wxUint32>(shapesOffset);
+    header.pathsOffset     = static_cast<wxUint32>(pathsOffset);
+    header.gradientsOffset = static_cast<wxUint32>(gradientsOffset);
+    header.stopsOffset     = static_cast<wxUint32>(stopsOffset);
+    header.pointsOffset    = static_cast<wxUint32>(pointsOffset);
+
+    compiled.resize(fileSize);
+
+    unsigned char* data = compiled.data();
+
+    memcpy(data, &header, sizeof(header));
+    if ( !shapes.empty() )
+        memcpy(data + shapesOffset, shapes.data(), shapes.size() * sizeof(CompiledShape));
+    if ( !paths.empty() )
+        memcpy(data + pathsOffset, paths.data(), paths.size() * sizeof(CompiledPath));
+    if ( !gradients.empty() )
+        memcpy(data + gradientsOffset, gradients.data(), gradients.size() * sizeof(CompiledGradient));
+    if ( !stops.empty() )
+        memcpy(data + stopsOffset, stops.data(), stops.size() * sizeof(CompiledStop));
+    if ( !points.empty() )
+        memcpy(data + pointsOffset, points.data(), points.size() * sizeof(float));
+
+    return true;
+}
+
+bool wxSVGCompiledImage::CompileFile(const wxString& svgFileName, const wxString& compiledFileName)
+{
+    wxFFile svgFile(svgFileName, "rb");
+
+    if ( !svgFile.IsOpened() )
+        return false;
+
+    const wxFileOffset length = svgFile.Length();
+
+    if ( length == wxInvalidOffset )
+        return false;
+
+    // 0 terminated, NanoSVG modifies it while parsing
+    wxCharBuffer data(static_cast<size_t>(length));
+
+    if ( svgFile.Read(data.data(), static_cast<size_t>(length)) != static_cast<size_t>(length) )
+        return false;
+
+    NSVGimage* image = nsvgParse(data.data(), "px", 96);
+
+    if ( !image )
+        return false;
+
+    std::vector<unsigned char> compiled;
+    const bool                 ok = Compile(image, compiled);
+
+    nsvgDelete(image);
+
+    if ( !ok )
+        return false;
+
+    wxFFile compiledFile(compiledFileName, "wb");
+
+    // a file left incomplete has a wrong size in its header and is not loaded
+    return compiledFile.IsOpened()
+           && compiledFile.Write(compiled.data(), compiled.size()) == compiled.size()
+           && compiledFile.Close();
+}
+
+bool wxSVGCompiledImage::Load(const void* data, size_t size)
+{
+    m_image = nullptr;
+    m_arena.reset();
+
+    wxCHECK(data, false);
+    wxCHECK_MSG(reinterpret_cast<uintptr_t>(data) % alignof(float) == 0, false, "misaligned data");
+
+    if ( size < sizeof(CompiledFileHeader) )
+        return false;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    CompiledFileHeader   header;
+
+    memcpy(&header, bytes, sizeof(header));
+
+    if ( memcmp(header.magic, CompiledFileMagic, sizeof(header.magic)) != 0
+         || header.formatVersion != CompiledFileFormatVersion
+         || header.byteOrderMark != CompiledFileByteOrderMark
+         || header.fileSize != size
+         || !(header.width > 0 && header.height > 0)
+         || !IsArrayInFile(header.shapesOffset, header.shapeCount, sizeof(CompiledShape), size)
+         || !IsArrayInFile(header.pathsOffset, header.pathCount, sizeof(CompiledPath), size)
+         || !IsArrayInFile(header.gradientsOffset, header.gradientCount, sizeof(CompiledGradient), size)
+         || !IsArrayInFile(header.stopsOffset, header.stopCount, sizeof(CompiledStop), size)
+         || !IsArrayInFile(header.pointsOffset, header.pointCount, 2 * sizeof(float), size) )
+    {
+        return false;
+    }
+
+    // the offsets are 4 byte aligned, and so is data
+    const CompiledShape*    shapes    = reinterpret_cast<const CompiledShape*>(bytes + header.shapesOffset);
+    const CompiledPath*     paths     = reinterpret_cast<const CompiledPath*>(bytes + header.pathsOffset);
+    const CompiledGradient* gradients = reinterpret_cast<const CompiledGradient*>(bytes + header.gradientsOffset);
+    const CompiledStop*     stops     = reinterpret_cast<const CompiledStop*>(bytes + header.stopsOffset);
+    const float*            points    = reinterpret_cast<const float*>(bytes + header.pointsOffset);
+
+    // validate everything first, so that the rasterizer never reads
+    // outside of the data
+    const auto isPaintValid = [&header](const CompiledPaint& paint)
+    {
+        return paint.type == NSVG_PAINT_NONE || paint.type == NSVG_PAINT_COLOR
+               || (IsGradientPaint(paint.type) && paint.value < header.gradientCount);
+    };
+
+    for ( wxUint32 i = 0; i < header.shapeCount; ++i )
+    {
+        const CompiledShape& shape = shapes[i];
+
+        if ( !isPaintValid(shape.fill) || !isPaintValid(shape.stroke)
+             || shape.strokeDashCount > WXSIZEOF(shape.strokeDashArray)
+             || !IsRange(shape.firstPath, shape.pathCount, header.pathCount) )
+        {
+            return false;
+        }
+    }
+
+    for ( wxUint32 i = 0; i < header.pathCount; ++i )
+    {
+        const CompiledPath& path = paths[i];
+
+        // a start point and whole cubic curves
+        if ( path.pointCount < 1 || (path.pointCount - 1) % 3 != 0 || path.pointCount > INT_MAX
+             || !IsRange(path.firstPoint, path.pointCount, header.pointCount) )
+        {
+            return false;
+        }
+    }
+
+    // the rasterizer uses the first and the last stop
+    size_t gradientBytes = 0;
+
+    for ( wxUint32 i = 0; i < header.gradientCount; ++i )
+    {
+        const CompiledGradient& gradient = gradients[i];
+
+        if ( gradient.stopCount < 1 || gradient.stopCount > INT_MAX
+             || !IsRange(gradient.firstStop, gradient.stopCount, header.stopCount) )
+        {
+            return false;
+        }
+
+        gradientBytes += sizeof(NSVGgradient) + (gradient.stopCount - 1) * sizeof(NSVGgradientStop)
+                         + alignof(NSVGgradient);
+    }
+
+    // a single block for all the NanoSVG structures
+    std::unique_ptr<wxSVGArena> arena(new wxSVGArena(sizeof(NSVGimage) + alignof(NSVGimage)
+        + header.shapeCount * sizeof(NSVGshape) + alignof(NSVGshape)
+        + header.pathCount * sizeof(NSVGpath) + alignof(NSVGpath)
+        + gradientBytes));
+
+    NSVGimage* image      = arena->AllocateArray<NSVGimage>(1);
+    NSVGshape* nsvgShapes = arena->AllocateArray<NSVGshape>(header.shapeCount);
+    NSVGpath*  nsvgPaths  = arena->AllocateArray<NSVGpath>(header.pathCount);
+
+    if ( !image || !nsvgShapes || !nsvgPaths )
+        return false;
+
+    // the gradient pointers are needed only while linking
+    std::vector<NSVGgradient*> gradientPointers(header.gradientCount);
+
+    for ( wxUint32 i = 0; i < header.gradientCount; ++i )
+    {
+        const CompiledGradient& gradient     = gradients[i];
+        NSVGgradient*           nsvgGradient = static_cast<NSVGgradient*>(arena->Allocate(
+            sizeof(NSVGgradient) + (gradient.stopCount - 1) * sizeof(NSVGgradientStop), alignof(NSVGgradient)));
+
+        if ( !nsvgGradient )
+            return false;
+
+        memcpy(nsvgGradient->xform, gradient.xform, sizeof(nsvgGradient->xform));
+        nsvgGradient->spread = static_cast<char>(gradient.spread);
+        nsvgGradient->fx     = gradient.fx;
+        nsvgGradient->fy     = gradient.fy;
+        nsvgGradient->nstops = static_cast<int>(gradient.stopCount);
+        for ( wxUint32 s = 0; s < gradient.stopCount; ++s )
+        {
+            nsvgGradient->stops[s].color  = stops[gradient.firstStop + s].color;
+            nsvgGradient->stops[s].offset = stops[gradient.firstStop + s].offset;
+        }
+
+        gradientPointers[i] = nsvgGradient;
+    }
+
+    const auto linkPaint = [&gradientPointers](const CompiledPaint& paint, NSVGpaint& nsvgPaint)
+    {
+        nsvgPaint.type = static_cast<signed char>(paint.type);
+        if ( paint.type == NSVG_PAINT_COLOR )
+            nsvgPaint.color = paint.value;
+        else if ( IsGradientPaint(paint.type) )
+            nsvgPaint.gradient = gradientPointers[paint.value];
+    };
+
+    for ( wxUint32 i = 0; i < header.pathCount; ++i )
+    {
+        const CompiledPath& path     = paths[i];
+        NSVGpath&           nsvgPath = nsvgPaths[i];
+
+        memset(&nsvgPath, 0, sizeof(nsvgPath));
+        // the rasterizer does not modify the points, but NSVGpath is not const
+        nsvgPath.pts    = const_cast<float*>(points + 2 * static_cast<size_t>(path.firstPoint));
+        nsvgPath.npts   = static_cast<int>(path.pointCount);
+        nsvgPath.closed = static_cast<char>(path.closed);
+        memcpy(nsvgPath.bounds, path.bounds, sizeof(nsvgPath.bounds));
+    }
+
+    for ( wxUint32 i = 0; i < header.shapeCount; ++i )
+    {
+        const CompiledShape& shape     = shapes[i];
+        NSVGshape&           nsvgShape = nsvgShapes[i];
+
+        memset(&nsvgShape, 0, sizeof(nsvgShape));
+        linkPaint(shape.fill, nsvgShape.fill);
+        linkPaint(shape.stroke, nsvgShape.stroke);
+        nsvgShape.opacity          = shape.opacity;
+        nsvgShape.strokeWidth      = shape.strokeWidth;
+        nsvgShape.strokeDashOffset = shape.strokeDashOffset;
+        memcpy(nsvgShape.strokeDashArray, shape.strokeDashArray, sizeof(nsvgShape.strokeDashArray));
+        nsvgShape.strokeDashCount  = static_cast<char>(shape.strokeDashCount);
+        nsvgShape.strokeLineJoin   = static_cast<char>(shape.strokeLineJoin);
+        nsvgShape.strokeLineCap    = static_cast<char>(shape.strokeLineCap);
+        nsvgShape.miterLimit       = shape.miterLimit;
+        nsvgShape.fillRule         = static_cast<char>(shape.fillRule);
+        nsvgShape.flags            = static_cast<unsigned char>(shape.flags);
+        memcpy(nsvgShape.bounds, shape.bounds, sizeof(nsvgShape.bounds));
+
+        // the paths of a shape are consecutive, so are the shapes
+        if ( shape.pathCount )
+        {
+            nsvgShape.paths = &nsvgPaths[shape.firstPath];
+            for ( wxUint32 p = 1; p < shape.pathCount; ++p )
+                nsvgPaths[shape.firstPath + p - 1].next = &nsvgPaths[shape.firstPath + p];
+            nsvgPaths[shape.firstPath + shape.pathCount - 1].next = nullptr;
+        }
+
+        nsvgShape.next = i + 1 < header.shapeCount ? &nsvgShapes[i + 1] : nullptr;
+    }
+
+    memset(image, 0, sizeof(*image));
+    image->width  = header.width;
+    image->height = header.height;
+    image->shapes = header.shapeCount ? nsvgShapes : nullptr;
+
+    m_arena.swap(arena);
+    m_image = image;
+    return true;
+}
+
+// Creates wxBitmapBundle using wxBitmapBundleImplSVGCompiled
+wxBitmapBundle CreateFromImplSVGCompiled(const wxString& fileName, const wxSize& size)
+{
+    wxBitmapBundleImplSVGCompiled* impl = new wxBitmapBundleImplSVGCompiled(fileName, size);
+
+    if ( impl->IsOk() )
+        return wxBitmapBundle::FromImpl(impl);
+
+    impl->DecRef();
+    return wxBitmapBundle();
+}
+
+// ============================================================================
+// wxBitmapBundleImplSVGCompiled implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGCompiled::wxBitmapBundleImplSVGCompiled(const wxString& fileName, const wxSize& sizeDef)
+    : wxBitmapBundleImplSVG(sizeDef),
+      m_file(fileName)
+{
+    if ( !m_file.IsOk() )
+    {
+        wxLogDebug("Couldn't map file '%s'", fileName);
+        return;
+    }
+
+    if ( !m_image.Load(m_file.GetData(), m_file.GetSize()) )
+        wxLogDebug("'%s' is not a valid compiled SVG", fileName);
+}
+
+wxBitmapBundleImplSVGCompiled::~wxBitmapBundleImplSVGCompiled()
+{
+    if ( m_rasterizer )
+        nsvgDeleteRasterizer(m_rasterizer);
+}
+
+bool wxBitmapBundleImplSVGCompiled::IsOk() const
+{
+    return m_image.IsOk();
+}
+
+bool wxBitmapBundleImplSVGCompiled::DoRasterizeToBuffer(const wxSize& size)
+{
+    if ( !IsOk() )
+    {
+        wxLogDebug("invalid m_image");
+        return false;
+    }
+
+    if ( size.x <= 0 || size.y <= 0 )
+    {
+        wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
+        return false;
+    }
+
+    if ( !m_rasterizer )
+    {
+        m_rasterizer = nsvgCreateRasterizer();
+        if ( !m_rasterizer )
+        {
+            wxLogDebug("Failed to create NanoSVG rasterizer");
+            return false;
+        }
+    }
+
+    m_buffer.resize(size.x * size.y * 4);
+    RasterizeCompiledImage(m_rasterizer, m_image.GetNSVGImage(), size, &m_buffer[0]);
+
+    return true;
+}
+
+wxBitmap wxBitmapBundleImplSVGCompiled::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxCHECK_MSG(m_buffer.size() == static_cast<size_t>(size.x * size.y * 4), wxBitmap(),
+                "buffer was not rasterized at this size");
+
+    return CreateBitmapFromRGBA(&m_buffer[0], GetBitmapBytes(wxSize(size.x, 1)), size, false);
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_compiled.h
+// Purpose:     wxBitmapBundleImpl rasterizing memory-mapped compiled SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleImplSVGCompiled_PRIVATE_H
+#define wxBitmapBundleImplSVGCompiled_PRIVATE_H
+
+#include "bmpbndl_svg_nano.h"
+
+// SVG is compiled from the image parsed by NanoSVG and rasterized
+// by the NanoSVG rasterizer
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    #define wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+
+#include <memory>
+#include <vector>
+
+#include "bmpbndl_svg.h"
+#include "bmpbndl_svg_diskcache.h"
+#include "bmpbndl_svg_flat.h"
+
+struct NSVGimage;
+struct NSVGrasterizer;
+
+// Creates wxBitmapBundle using wxBitmapBundleImplSVGCompiled
+wxBitmapBundle CreateFromImplSVGCompiled(const wxString& fileName, const wxSize& size);
+
+// ============================================================================
+// wxSVGCompiledImage
+// ============================================================================
+
+/*
+    SVG compiled into a binary display list, which is loaded without any
+    parsing. What is stored is the image as NanoSVG parsed it: the visible
+    shapes with their paths already transformed to the image coordinates and
+    converted to cubic Bezier curves, the resolved fill and stroke paints,
+    stroke styles, and the gradients with their stops and transforms. So
+    the compiled image is rasterized by the NanoSVG rasterizer exactly as
+    the SVG is by wxBitmapBundleImplSVGNano or wxBitmapBundle::FromSVG().
+
+    The format is native endian, a file compiled on a machine with another
+    byte order is rejected. It starts with a header with the image size,
+    the counts of all the records, and the offsets of their arrays: shapes,
+    paths, gradients, gradient stops, and points (x, y float pairs). All
+    the records are 4 byte aligned and a shape refers to its paths, a path
+    to its points, a paint to its gradient, and a gradient to its stops
+    by index and count, see bmpbndl_svg_compiled.cpp.
+
+    Load() validates all the offsets and indices and then only links
+    the NanoSVG structures together in a single arena: the points of
+    the paths are not copied, they point into the loaded data, which
+    therefore must stay valid and unchanged as long as the image is used.
+ */
+
+class wxSVGCompiledImage
+{
+public:
+    // the extension of the compiled files, without the dot
+    static const char* GetFileExtension() { return "svgc"; }
+
+    // the same path with the extension replaced with GetFileExtension()
+    static wxString GetCompiledFileName(const wxString& svgFileName);
+
+    // Replaces the content of compiled with the compiled image, returns
+    // false if the image has no size or too many records
+    static bool Compile(const NSVGimage* image, std::vector<unsigned char>& compiled);
+
+    // Parses the SVG file with NanoSVG the same way as wxBitmapBundle::FromSVG()
+    // does (in pixels at 96 DPI) and writes it compiled to compiledFileName.
+    // Returns false if the SVG cannot be read or parsed or the compiled
+    // file cannot be written.
+    static bool CompileFile(const wxString& svgFileName, const wxString& compiledFileName);
+
+    wxSVGCompiledImage() {}
+
+    // data must be aligned for float, e.g., mapped by wxSVGMappedFile, see
+    // the class description for its lifetime. Returns false if data is not
+    // a valid compiled image in the byte order of this machine.
+    bool Load(const void* data, size_t size);
+
+    bool IsOk() const { return m_image != nullptr; }
+
+    // Not to be deleted with nsvgDelete(), it is owned by this object.
+    // The NanoSVG rasterizer only reads the points, which are mapped
+    // read-only memory when loaded by wxBitmapBundleImplSVGCompiled.
+    NSVGimage* GetNSVGImage() const { return m_image; }
+
+private:
+    // holds the NanoSVG structures but not the points
+    std::unique_ptr<wxSVGArena> m_arena;
+    NSVGimage*                  m_image{nullptr};
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGCompiledImage);
+};
+
+// ============================================================================
+// wxBitmapBundleImplSVGCompiled declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl rasterizing a file compiled by wxSVGCompiledImage,
+    e.g., with the wxTestSVGCompile tool at build time, see CMakeLists.txt.
+
+    The file is memory mapped for the whole lifetime of the impl, so loading
+    it costs only mapping and linking the shapes and paths, no SVG is read
+    or parsed. Its pages are read only when the image is rasterized for
+    the first time and shared with other bundles and processes using
+    the same file. It is rasterized by NanoSVG, scaled uniformly and
+    centered at the requested size, the same as wxBitmapBundleImplSVGNano
+    does, so the bitmaps are identical.
+ */
+
+class wxBitmapBundleImplSVGCompiled : public wxBitmapBundleImplSVG
+{
+public:
+    wxBitmapBundleImplSVGCompiled(const wxString& fileName, const wxSize& sizeDef);
+    ~wxBitmapBundleImplSVGCompiled();
+
+    bool IsOk() const;
+
+private:
+    wxSVGMappedFile    m_file;
+    wxSVGCompiledImage m_image;
+    // created when rasterizing for the first time
+    NSVGrasterizer*    m_rasterizer{nullptr};
+
+    // RGBA (not premultiplied) result of the last DoRasterizeToBuffer()
+    wxVector<unsigned char> m_buffer;
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGCompiled);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+
+#endif // #ifndef wxBitmapBundleImplSVGCompiled_PRIVATE_H
@@ -15,7 +15,6 @@
 #include "wx/ffile.h"
 #include "wx/platinfo.h"
 #include "wx/msw/private/graphicsd2d.h"
-#include "wx/rawbmp.h"
 
 #include <combaseapi.h>
 
@@ -62,16 +61,52 @@ wxCOMPtr<ID2D1Factory> wxBitmapBundleImplSVGD2D::ms_D1Factory;
 wxCOMPtr<IWICBitmap> wxBitmapBundleImplSVGD2D::ms_bitmap;
 wxCOMPtr<ID2D1DeviceContext5> wxBitmapBundleImplSVGD2D::ms_context;
 
+// The document with its dimensions, stored in wxBitmapBundleSVGSharedCache
+struct wxBitmapBundleImplSVGD2DSharedDocument
+{
+    wxCOMPtr<ID2D1SvgDocument> document;
+    wxSize                     dimensions;
+};
+
 wxBitmapBundleImplSVGD2D::wxBitmapBundleImplSVGD2D(const char* data, const wxSize& sizeDef)
     : wxBitmapBundleImplSVG(sizeDef)
 {
     wxCHECK_RET(data, "null data");
     wxCHECK_RET(IsAvailable(), "wxBitmapBundleImplSVGD2D rasterization unavailable");
 
+    SetSharedCacheKey("D2D", "1", data);
+
+    wxBitmapBundleSVGSharedCache& sharedCache = wxBitmapBundleSVGSharedCache::Get();
+    std::shared_ptr<void>         sharedDocument;
+
+    if ( m_sharedCacheBackend )
+        sharedDocument = sharedCache.FindDocument(m_sharedCacheHash, m_sharedCacheDataLength, m_sharedCacheBackend);
+
+    if ( sharedDocument )
+    {
+        const wxBitmapBundleImplSVGD2DSharedDocument* doc
+            = static_cast<const wxBitmapBundleImplSVGD2DSharedDocument*>(sharedDocument.get());
+
+        m_SVGDocument = doc->document;
+        m_SVGDocumentDimensions = doc->dimensions;
+        return;
+    }
+
     wxCOMPtr<IStream> SVGStream;
 
-    if ( CreateIStreamFromPtr(data, SVGStream) )
-        CreateSVGDocument(SVGStream);
+    if ( CreateIStreamFromPtr(data, SVGStream) && CreateSVGDocument(SVGStream)
+         && m_sharedCacheBackend )
+    {
+        std::shared_ptr<wxBitmapBundleImplSVGD2DSharedDocument> doc
+            = std::make_shared<wxBitmapBundleImplSVGD2DSharedDocument>();
+
+        doc->document   = m_SVGDocument;
+        doc->dimensions = m_SVGDocumentDimensions;
+
+        // the real size of the document is unknown, use the size of the data as an estimate
+        sharedCache.AddDocument(m_sharedCacheHash, m_sharedCacheDataLength, m_sharedCacheBackend,
+                                doc, m_sharedCacheDataLength);
+    }
 }
 
 bool wxBitmapBundleImplSVGD2D::IsOk() const
@@ -149,14 +184,6 @@ bool wxBitmapBundleImplSVGD2D::GetSVGBitmapFromSharedBitmap(const wxSize& size,
         return false;
     }
 
-    wxBitmap bmpOut = wxBitmap(size, 32);
-
-    if ( !bmpOut.IsOk() )
-    {
-        wxLogDebug("Failed to created wxBitmap bmpOut");
-        return false;
-    }
-
     UINT  stride     = 0;
     UINT  bufferSize = 0;
     BYTE* buffer     = NULL;
@@ -181,50 +208,33 @@ bool wxBitmapBundleImplSVGD2D::GetSVGBitmapFromSharedBitmap(const wxSize& size,
         return false;
     }
 
-    const unsigned char* src = &buffer[0];
-    // if size.x < ms_maxBitmapSize.x, we need to skip the rest of the ms_bitmap row
-    const size_t         rowBytesToSkip = (ms_maxBitmapSize.x - size.x) * 4;
-
-    wxAlphaPixelData           bmpdata(bmpOut);
-    wxAlphaPixelData::Iterator dst(bmpdata);
+    // ms_bitmap is GUID_WICPixelFormat32bppPRGBA, i.e., already premultiplied;
+    // if size.x < ms_maxBitmapSize.x, the rest of each ms_bitmap row is skipped
+    const wxBitmap bmpOut = CreateBitmapFromRGBA(buffer, stride, size, true);
 
-    for ( int y = 0; y < size.y; ++y )
+    if ( !bmpOut.IsOk() )
     {
-        dst.MoveTo(bmpdata, 0, y);
-
-        // @TODO: Make sure the alpha are OK
-
-        for ( int x = 0; x < size.x; ++x )
-        {
-            const unsigned char a = src[3];
-
-            dst.Red()   = src[0] * a / 255;
-            dst.Green() = src[1] * a / 255;
-            dst.Blue()  = src[2] * a / 255;
-            dst.Alpha() = a;
-
-            ++dst;
-            src += 4;
-        }
-        src += rowBytesToSkip;
+        wxLogDebug("Failed to created wxBitmap bmpOut");
+        return false;
     }
 
     bmp = bmpOut;
     return true;
 }
 
-wxBitmap wxBitmapBundleImplSVGD2D::DoRasterize(const wxSize& size)
+// Renders the SVG onto ms_bitmap at (0, 0, size.x, size.y)
+bool wxBitmapBundleImplSVGD2D::DoRasterizeToBuffer(const wxSize& size)
 {
     if ( !IsOk() )
     {
         wxLogDebug("invalid m_SVGDocument");
-        return wxBitmap();
+        return false;
     }
 
     if ( !CanRasterizeAtSize(size) )
     {
         wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
-        return wxBitmap();
+        return false;
     }
 
     const float         scaleValue = wxMin((float)size.x / m_SVGDocumentDimensions.x, (float)size.y / m_SVGDocumentDimensions.y);
@@ -232,7 +242,6 @@ wxBitmap wxBitmapBundleImplSVGD2D::DoRasterize(const wxSize& size)
     const D2D1_SIZE_F   transl = D2D1::SizeF((size.x - m_SVGDocumentDimensions.x) / 2.0f, (size.y - m_SVGDocumentDimensions.y) / 2.0f);
 
     D2D1_MATRIX_3X2_F transform = D2D1::Matrix3x2F::Identity();
-    wxBitmap          bmp;
 
     // center
     transform = transform * D2D1::Matrix3x2F::Translation(transl);
@@ -245,6 +254,13 @@ wxBitmap wxBitmapBundleImplSVGD2D::DoRasterize(const wxSize& size)
     ms_context->DrawSvgDocument(m_SVGDocument);
     ms_context->EndDraw();
 
+    return true;
+}
+
+wxBitmap wxBitmapBundleImplSVGD2D::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxBitmap bmp;
+
     if ( GetSVGBitmapFromSharedBitmap(size, bmp) )
         return bmp;
 
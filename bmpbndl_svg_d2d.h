@@ -30,63 +30,11 @@
 #include "wx/bmpbndl.h"
 #include "wx/msw/private/comptr.h"
 
+#include "bmpbndl_svg.h"
+
 // Creates wxBitmapBundle using wxBitmapBundleImplSVGD2D
 wxBitmapBundle CreateFromImplSVGD2D(const wxString& fileName, const wxSize& size);
 
-// --- 8< ----------------------------------
-
-
-
-// ============================================================================
-// wxBitmapBundleImplSVG
-// ============================================================================
-
-class wxBitmapBundleImplSVG : public wxBitmapBundleImpl
-{
-public:
-    wxBitmapBundleImplSVG(const wxSize& sizeDef)
-        : m_sizeDef(sizeDef)
-    {
-    }
-
-    virtual wxSize GetDefaultSize() const wxOVERRIDE
-    {
-        return m_sizeDef;
-    };
-
-    virtual wxSize GetPreferredSizeAtScale(double scale) const wxOVERRIDE
-    {
-        return m_sizeDef*scale;
-    }
-
-    virtual wxBitmap GetBitmap(const wxSize& size) wxOVERRIDE
-    {
-        if ( !m_cachedBitmap.IsOk() || m_cachedBitmap.GetSize() != size )
-        {
-            m_cachedBitmap = DoRasterize(size);
-        }
-
-        return m_cachedBitmap;
-    }
-
-protected:
-    virtual wxBitmap DoRasterize(const wxSize& size) = 0;
-
-    const wxSize m_sizeDef;
-
-    // Cache the last used bitmap (may be invalid if not used yet).
-    //
-    // Note that we cache only the last bitmap and not all the bitmaps ever
-    // requested from GetBitmap() for the different sizes because there would
-    // be no way to clear such cache and its growth could be unbounded,
-    // resulting in too many bitmap objects being used in an application using
-    // SVG for all of its icons.
-    wxBitmap m_cachedBitmap;
-
-    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVG);
-};
-
-
 // ============================================================================
 // wxBitmapBundleImplSVGD2D declaration
 // ============================================================================
@@ -145,7 +93,8 @@ private:
     wxCOMPtr<ID2D1SvgDocument> m_SVGDocument;
     wxSize                     m_SVGDocumentDimensions;
 
-    virtual wxBitmap DoRasterize(const wxSize& size) wxOVERRIDE;
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
 
     bool CreateSVGDocument(const wxCOMPtr<IStream>& SVGStream);
 
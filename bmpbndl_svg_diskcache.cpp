@@ -0,0 +1,357 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_diskcache.cpp
+// Purpose:     Persistent cache of rasterized SVGs
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_diskcache.h"
+
+#include "wx/dir.h"
+#include "wx/ffile.h"
+#include "wx/filename.h"
+#include "wx/rawbmp.h"
+#include "wx/stdpaths.h"
+
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#ifdef __WINDOWS__
+    #include "wx/msw/wrapwin.h"
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif // #ifdef __WINDOWS__
+
+// ============================================================================
+// wxSVGMappedFile implementation
+// ============================================================================
+
+#ifdef __WINDOWS__
+
+wxSVGMappedFile::wxSVGMappedFile(const wxString& fileName)
+{
+    HANDLE file = ::CreateFileW(fileName.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if ( file == INVALID_HANDLE_VALUE )
+        return;
+
+    m_file = file;
+
+    LARGE_INTEGER size;
+
+    if ( !::GetFileSizeEx(file, &size) || size.QuadPart == 0 )
+        return;
+
+    m_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if ( !m_mapping )
+        return;
+
+    m_data = ::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if ( m_data )
+        m_size = static_cast<size_t>(size.QuadPart);
+}
+
+wxSVGMappedFile::~wxSVGMappedFile()
+{
+    if ( m_data )
+        ::UnmapViewOfFile(m_data);
+    if ( m_mapping )
+        ::CloseHandle(m_mapping);
+    if ( m_file )
+        ::CloseHandle(m_file);
+}
+
+#else // !__WINDOWS__
+
+wxSVGMappedFile::wxSVGMappedFile(const wxString& fileName)
+{
+    m_fd = open(fileName.fn_str(), O_RDONLY);
+    if ( m_fd == -1 )
+        return;
+
+    struct stat st;
+
+    if ( fstat(m_fd, &st) != 0 || st.st_size == 0 )
+        return;
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+
+    if ( data != MAP_FAILED )
+    {
+        m_data = data;
+        m_size = static_cast<size_t>(st.st_size);
+    }
+}
+
+wxSVGMappedFile::~wxSVGMappedFile()
+{
+    if ( m_data )
+        munmap(m_data, m_size);
+    if ( m_fd != -1 )
+        close(m_fd);
+}
+
+#endif // #ifdef __WINDOWS__
+
+namespace
+{
+
+// ============================================================================
+// the cache file format
+// ============================================================================
+
+// increase when the format of the file changes
+const wxUint32 CacheFileFormatVersion = 1;
+
+const char CacheFileMagic[8] = { 'w', 'x', 'S', 'V', 'G', 'R', 'C', '\0' };
+
+// followed by height rows of width * 4 bytes
+struct CacheFileHeader
+{
+    char     magic[8];
+    wxUint32 formatVersion;
+    wxUint32 wxVersion;
+    wxInt32  width;
+    wxInt32  height;
+    // offsets of the components in a pixel, see wxPixelFormat
+    wxUint8  red;
+    wxUint8  green;
+    wxUint8  blue;
+    wxUint8  alpha;
+};
+
+void InitCacheFileHeader(CacheFileHeader& header, const wxSize& size)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CacheFileMagic, sizeof(header.magic));
+    header.formatVersion = CacheFileFormatVersion;
+    header.wxVersion     = wxVERSION_NUMBER;
+    header.width         = size.x;
+    header.height        = size.y;
+    header.red           = wxAlphaPixelData::PixelFormat::RED;
+    header.green         = wxAlphaPixelData::PixelFormat::GREEN;
+    header.blue          = wxAlphaPixelData::PixelFormat::BLUE;
+    header.alpha         = wxAlphaPixelData::PixelFormat::ALPHA;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxBitmapBundleSVGDiskCache implementation
+// ============================================================================
+
+// static
+wxBitmapBundleSVGDiskCache& wxBitmapBundleSVGDiskCache::Get()
+{
+    static wxBitmapBundleSVGDiskCache s_cache;
+
+    return s_cache;
+}
+
+bool wxBitmapBundleSVGDiskCache::Enable(const wxString& dirName)
+{
+    const wxString name = dirName.empty() ? GetDefaultDirName() : dirName;
+
+    if ( !wxDir::Exists(name) && !wxFileName::Mkdir(name, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL) )
+    {
+        wxLogDebug("Couldn't create SVG disk cache folder '%s'.", name);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_dirName = name;
+    return true;
+}
+
+void wxBitmapBundleSVGDiskCache::Disable()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_dirName.clear();
+}
+
+bool wxBitmapBundleSVGDiskCache::IsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return !m_dirName.empty();
+}
+
+wxString wxBitmapBundleSVGDiskCache::GetDirName() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_dirName;
+}
+
+// static
+wxString wxBitmapBundleSVGDiskCache::GetDefaultDirName()
+{
+    wxFileName dirName(wxStandardPaths::Get().GetUserDir(wxStandardPaths::Dir_Cache), "");
+
+    dirName.AppendDir("wxTestSVG");
+    dirName.AppendDir("rasters");
+    return dirName.GetPath();
+}
+
+bool wxBitmapBundleSVGDiskCache::FindBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                                            const char* rendererVersion, const wxSize& size, wxBitmap& bitmap)
+{
+    const wxString fileName = GetFileName(hash, dataLength, backend, rendererVersion, size);
+
+    if ( fileName.empty() )
+        return false;
+
+    const size_t    rowBytes = static_cast<size_t>(size.x) * 4;
+    CacheFileHeader expectedHeader;
+    wxSVGMappedFile file(fileName);
+    bool            found = false;
+
+    InitCacheFileHeader(expectedHeader, size);
+
+    if ( file.IsOk()
+         && file.GetSize() == sizeof(expectedHeader) + rowBytes * size.y
+         && memcmp(file.GetData(), &expectedHeader, sizeof(expectedHeader)) == 0 )
+    {
+        wxBitmap result(size, 32);
+
+#ifdef __WXMSW__
+        result.UseAlpha();
+#endif // #ifdef __WXMSW__
+
+        {
+            wxAlphaPixelData data(result);
+
+            if ( data )
+            {
+                const unsigned char*       src = file.GetData() + sizeof(expectedHeader);
+                wxAlphaPixelData::Iterator rowStart(data);
+
+                for ( int y = 0; y < size.y; ++y, src += rowBytes )
+                {
+                    memcpy(rowStart.m_ptr, src, rowBytes);
+                    rowStart.OffsetY(data, 1);
+                }
+
+                found = true;
+            }
+        } // the raw access must end before the bitmap is used
+
+        if ( found )
+            bitmap = result;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( found )
+        ++m_stats.hits;
+    else
+        ++m_stats.misses;
+
+    return found;
+}
+
+void wxBitmapBundleSVGDiskCache::AddBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                                           const char* rendererVersion, const wxBitmap& bitmap)
+{
+    wxCHECK_RET(bitmap.IsOk(), "invalid bitmap");
+
+    const wxSize   size     = bitmap.GetSize();
+    const wxString fileName = GetFileName(hash, dataLength, backend, rendererVersion, size);
+
+    if ( fileName.empty() )
+        return;
+
+    // unique for the process and thread, so that the threads
+    // and processes writing the same entry do not clash
+    const wxString tempFileName = wxString::Format("%s.%lu.%zu.tmp", fileName,
+        wxGetProcessId(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    const size_t    rowBytes = static_cast<size_t>(size.x) * 4;
+    CacheFileHeader header;
+    bool            written = false;
+
+    InitCacheFileHeader(header, size);
+
+    {
+        wxBitmap         bitmapCopy(bitmap); // wxAlphaPixelData needs non-const bitmap
+        wxAlphaPixelData data(bitmapCopy);
+        wxFFile          file(tempFileName, "wb");
+
+        if ( data && file.IsOpened() && file.Write(&header, sizeof(header)) == sizeof(header) )
+        {
+            wxAlphaPixelData::Iterator rowStart(data);
+
+            written = true;
+            for ( int y = 0; y < size.y && written; ++y )
+            {
+                written = file.Write(rowStart.m_ptr, rowBytes) == rowBytes;
+                rowStart.OffsetY(data, 1);
+            }
+
+            written = file.Close() && written;
+        }
+    }
+
+    if ( written )
+        written = wxRenameFile(tempFileName, fileName, true);
+
+    if ( !written && wxFileExists(tempFileName) )
+        wxRemoveFile(tempFileName);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( written )
+        ++m_stats.writes;
+    else
+        ++m_stats.writeFailures;
+}
+
+void wxBitmapBundleSVGDiskCache::Clear()
+{
+    const wxString dirName = GetDirName();
+
+    if ( dirName.empty() || !wxDir::Exists(dirName) )
+        return;
+
+    wxArrayString fileNames;
+
+    wxDir::GetAllFiles(dirName, &fileNames, "*.raster", wxDIR_FILES);
+    for ( const auto& fileName : fileNames )
+        wxRemoveFile(fileName);
+}
+
+wxBitmapBundleSVGDiskCache::Statistics wxBitmapBundleSVGDiskCache::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_stats;
+}
+
+void wxBitmapBundleSVGDiskCache::ResetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_stats = Statistics();
+}
+
+wxString wxBitmapBundleSVGDiskCache::GetFileName(wxUint64 hash, size_t dataLength, const char* backend,
+                                                 const char* rendererVersion, const wxSize& size) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if ( m_dirName.empty() )
+        return wxString();
+
+    return wxFileName(m_dirName,
+                      wxString::Format("%016" wxLongLongFmtSpec "x-%zu-%s-%s-%dx%d.raster",
+                                       hash, dataLength, backend, rendererVersion, size.x, size.y)).GetFullPath();
+}
@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_diskcache.h
+// Purpose:     Persistent cache of rasterized SVGs
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleSVGDiskCache_PRIVATE_H
+#define wxBitmapBundleSVGDiskCache_PRIVATE_H
+
+#include "wx/wx.h"
+
+#include <mutex>
+
+// ============================================================================
+// wxSVGMappedFile
+// ============================================================================
+
+// Read-only memory mapping of the whole file, which starts at a page
+// boundary, so the data are aligned for any type. An empty file is not OK.
+class wxSVGMappedFile
+{
+public:
+    explicit wxSVGMappedFile(const wxString& fileName);
+    ~wxSVGMappedFile();
+
+    bool IsOk() const { return m_data != nullptr; }
+
+    const unsigned char* GetData() const { return static_cast<const unsigned char*>(m_data); }
+    size_t               GetSize() const { return m_size; }
+
+private:
+#ifdef __WINDOWS__
+    // not HANDLE, so that windows.h is not included here
+    WXHANDLE m_file{nullptr};
+    WXHANDLE m_mapping{nullptr};
+#else
+    int      m_fd{-1};
+#endif // #ifdef __WINDOWS__
+    void*    m_data{nullptr};
+    size_t   m_size{0};
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGMappedFile);
+};
+
+// ============================================================================
+// wxBitmapBundleSVGDiskCache
+// ============================================================================
+
+/*
+    Optional cache of the rasterized bitmaps stored on disk, so that the SVGs
+    do not have to be rasterized again when the application starts next time.
+
+    Each bitmap is stored in its own file, named after the hash and length
+    of the SVG data, the backend and its version, and the bitmap size.
+    The file contains a short header followed by the pixels exactly as they
+    are stored in the platform wxBitmap, as accessed with wxAlphaPixelData
+    (i.e., premultiplied on the platforms where the bitmaps are premultiplied,
+    such as MSW). The file is memory-mapped and the rows are copied straight
+    into the bitmap, without any conversion.
+
+    The cache is disabled by default. The files are written to a temporary
+    file first and then renamed, so that a crash or another process using
+    the cache at the same time never leaves an incomplete file behind.
+    Files with an unexpected header (e.g., written by a different version
+    or wxWidgets port) are ignored.
+
+    All the methods are thread-safe.
+ */
+
+class wxBitmapBundleSVGDiskCache
+{
+public:
+    struct Statistics
+    {
+        size_t hits{0};
+        size_t misses{0};
+        size_t writes{0};
+        size_t writeFailures{0};
+    };
+
+    static wxBitmapBundleSVGDiskCache& Get();
+
+    // If dirName is empty, GetDefaultDirName() is used.
+    // Returns false if the folder does not exist and cannot be created.
+    bool Enable(const wxString& dirName = wxString());
+    void Disable();
+    bool IsEnabled() const;
+
+    wxString GetDirName() const;
+
+    // the "wxTestSVG/rasters" subfolder of the user cache folder
+    static wxString GetDefaultDirName();
+
+    bool FindBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                    const char* rendererVersion, const wxSize& size, wxBitmap& bitmap);
+    void AddBitmap(wxUint64 hash, size_t dataLength, const char* backend,
+                   const char* rendererVersion, const wxBitmap& bitmap);
+
+    // deletes all the cached files
+    void Clear();
+
+    Statistics GetStatistics() const;
+    void       ResetStatistics();
+
+private:
+    wxBitmapBundleSVGDiskCache() {}
+
+    mutable std::mutex m_mutex;
+
+    // empty when the cache is disabled
+    wxString   m_dirName;
+    Statistics m_stats;
+
+    // returns an empty string if the cache is disabled
+    wxString GetFileName(wxUint64 hash, size_t dataLength, const char* backend,
+                         const char* rendererVersion, const wxSize& size) const;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleSVGDiskCache);
+};
+
+#endif // #ifndef wxBitmapBundleSVGDiskCache_PRIVATE_H
@@ -0,0 +1,2513 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_flat.cpp
+// Purpose:     Zero-copy SVG parser producing a flat path buffer
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_flat.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// ============================================================================
+// wxSVGArena implementation
+// ============================================================================
+
+wxSVGArena::wxSVGArena(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+wxSVGArena::~wxSVGArena()
+{
+    while ( m_blocks )
+    {
+        Block* next = m_blocks->next;
+
+        std::free(m_blocks);
+        m_blocks = next;
+    }
+}
+
+bool wxSVGArena::AddBlock(size_t minSize)
+{
+    const size_t size  = wxMax(m_blockSize, minSize);
+    Block*       block = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+
+    if ( !block )
+        return false;
+
+    block->next = m_blocks;
+    block->size = size;
+    m_blocks = block;
+    m_pos = reinterpret_cast<unsigned char*>(block + 1);
+    m_end = m_pos + size;
+    m_reservedBytes += size;
+    return true;
+}
+
+void* wxSVGArena::Allocate(size_t bytes, size_t alignment)
+{
+    wxCHECK_MSG(alignment && (alignment & (alignment - 1)) == 0, nullptr, "invalid alignment");
+
+    size_t padding = (alignment - (reinterpret_cast<uintptr_t>(m_pos) & (alignment - 1))) & (alignment - 1);
+
+    if ( !m_pos || padding + bytes > static_cast<size_t>(m_end - m_pos) )
+    {
+        // the rest of the current block is wasted
+        if ( !AddBlock(bytes + alignment) )
+            return nullptr;
+        padding = (alignment - (reinterpret_cast<uintptr_t>(m_pos) & (alignment - 1))) & (alignment - 1);
+    }
+
+    void* ptr = m_pos + padding;
+
+    m_pos       += padding + bytes;
+    m_usedBytes += padding + bytes;
+    return ptr;
+}
+
+bool wxSVGArena::Extend(void* ptr, size_t oldBytes, size_t newBytes)
+{
+    unsigned char* p = static_cast<unsigned char*>(ptr);
+
+    if ( !p || p + oldBytes != m_pos || newBytes < oldBytes
+         || newBytes - oldBytes > static_cast<size_t>(m_end - m_pos) )
+    {
+        return false;
+    }
+
+    m_pos       += newBytes - oldBytes;
+    m_usedBytes += newBytes - oldBytes;
+    return true;
+}
+
+void wxSVGArena::Reset()
+{
+    Block* largest = m_blocks;
+
+    for ( Block* block = m_blocks; block; block = block->next )
+    {
+        if ( block->size > largest->size )
+            largest = block;
+    }
+
+    while ( m_blocks )
+    {
+        Block* next = m_blocks->next;
+
+        if ( m_blocks != largest )
+            std::free(m_blocks);
+        m_blocks = next;
+    }
+
+    m_usedBytes     = 0;
+    m_reservedBytes = 0;
+    m_pos = m_end = nullptr;
+
+    if ( largest )
+    {
+        largest->next = nullptr;
+        m_blocks = largest;
+        m_pos = reinterpret_cast<unsigned char*>(largest + 1);
+        m_end = m_pos + largest->size;
+        m_reservedBytes = largest->size;
+    }
+}
+
+namespace
+{
+
+// ============================================================================
+// helpers
+// ============================================================================
+
+// Growable array of trivially copyable T allocated from wxSVGArena,
+// the memory left behind when it grows is freed only with the arena
+template <typename T>
+class ArenaVector
+{
+public:
+    explicit ArenaVector(wxSVGArena& arena) : m_arena(arena) {}
+
+    // returns pointer to count new uninitialized elements or nullptr if out of memory
+    T* Add(size_t count = 1)
+    {
+        if ( m_size + count > m_capacity && !Reserve(m_size + count) )
+            return nullptr;
+
+        T* items = m_data + m_size;
+
+        m_size += count;
+        return items;
+    }
+
+    bool Reserve(size_t capacity)
+    {
+        if ( capacity <= m_capacity )
+            return true;
+
+        capacity = wxMax(capacity, wxMax(m_capacity * 2, static_cast<size_t>(16)));
+
+        if ( m_arena.Extend(m_data, m_capacity * sizeof(T), capacity * sizeof(T)) )
+        {
+            m_capacity = capacity;
+            return true;
+        }
+
+        T* data = m_arena.AllocateArray<T>(capacity);
+
+        if ( !data )
+            return false;
+
+        if ( m_size )
+            std::memcpy(data, m_data, m_size * sizeof(T));
+        m_data     = data;
+        m_capacity = capacity;
+        return true;
+    }
+
+    size_t GetSize() const { return m_size; }
+    T* GetData() const { return m_data; }
+
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+
+    T& Last() { return m_data[m_size - 1]; }
+
+private:
+    wxSVGArena& m_arena;
+    T*          m_data{nullptr};
+    size_t      m_size{0};
+    size_t      m_capacity{0};
+};
+
+// range of the parsed data, not 0 terminated
+struct StringView
+{
+    const char* begin{nullptr};
+    const char* end{nullptr};
+
+    StringView() {}
+    StringView(const char* b, const char* e) : begin(b), end(e) {}
+
+    size_t Len() const { return end - begin; }
+    bool IsEmpty() const { return begin == end; }
+
+    bool Is(const char* s) const
+    {
+        const size_t len = std::strlen(s);
+
+        return Len() == len && std::memcmp(begin, s, len) == 0;
+    }
+
+    bool IsSameAs(const StringView& other) const
+    {
+        return Len() == other.Len() && std::memcmp(begin, other.begin, Len()) == 0;
+    }
+
+    bool StartsWith(const char* s) const
+    {
+        const size_t len = std::strlen(s);
+
+        return Len() >= len && std::memcmp(begin, s, len) == 0;
+    }
+
+    bool Contains(const char* s) const
+    {
+        for ( StringView rest(*this); !rest.IsEmpty(); ++rest.begin )
+        {
+            if ( rest.StartsWith(s) )
+                return true;
+        }
+        return false;
+    }
+};
+
+inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool IsAlpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline char ToLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline void SkipSpaces(const char*& p, const char* end)
+{
+    while ( p < end && IsSpace(*p) )
+        ++p;
+}
+
+// skips the spaces and at most one comma between numbers
+inline void SkipSeparators(const char*& p, const char* end)
+{
+    SkipSpaces(p, end);
+    if ( p < end && *p == ',' )
+    {
+        ++p;
+        SkipSpaces(p, end);
+    }
+}
+
+StringView Trim(StringView s)
+{
+    while ( s.begin < s.end && IsSpace(*s.begin) )
+        ++s.begin;
+    while ( s.end > s.begin && IsSpace(s.end[-1]) )
+        --s.end;
+    return s;
+}
+
+bool IsSameAsNoCase(const StringView& s, const char* other)
+{
+    const size_t len = std::strlen(other);
+
+    if ( s.Len() != len )
+        return false;
+
+    for ( size_t i = 0; i < len; ++i )
+    {
+        if ( ToLower(s.begin[i]) != other[i] )
+            return false;
+    }
+    return true;
+}
+
+// returns the position after pattern or end if it was not found
+const char* SkipPast(const char* p, const char* end, const char* pattern)
+{
+    const size_t len = std::strlen(pattern);
+
+    while ( static_cast<size_t>(end - p) >= len )
+    {
+        p = static_cast<const char*>(std::memchr(p, pattern[0], end - p - len + 1));
+        if ( !p )
+            return end;
+        if ( std::memcmp(p, pattern, len) == 0 )
+            return p + len;
+        ++p;
+    }
+
+    return end;
+}
+
+// Parses a number at p, skipping the separators before it, without
+// the locale dependency and 0 termination std::strtod() requires.
+// "1.5.5" are two numbers and "1e2" is one but "1em" is 1 followed by "em".
+bool ParseNumber(const char*& p, const char* end, float& value)
+{
+    // exactly representable powers of 10
+    static const double powersOf10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static const int maxPowerOf10 = WXSIZEOF(powersOf10) - 1;
+
+    const char* s = p;
+    bool        isNegative = false;
+    wxUint64    mantissa = 0;
+    int         digitCount = 0; // significant ones in mantissa
+    int         exponent = 0;
+    bool        hasDigits = false;
+
+    SkipSeparators(s, end);
+
+    if ( s < end && (*s == '+' || *s == '-') )
+    {
+        isNegative = *s == '-';
+        ++s;
+    }
+
+    for ( ; s < end && IsDigit(*s); ++s )
+    {
+        hasDigits = true;
+        if ( digitCount < 19 )
+        {
+            mantissa = mantissa * 10 + (*s - '0');
+            if ( mantissa )
+                ++digitCount;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+
+    if ( s < end && *s == '.' )
+    {
+        for ( ++s; s < end && IsDigit(*s); ++s )
+        {
+            hasDigits = true;
+            if ( digitCount < 19 )
+            {
+                mantissa = mantissa * 10 + (*s - '0');
+                if ( mantissa )
+                    ++digitCount;
+                --exponent;
+            }
+        }
+    }
+
+    if ( !hasDigits )
+        return false;
+
+    if ( s < end && (*s == 'e' || *s == 'E') )
+    {
+        const char* e = s + 1;
+        bool        isExpNegative = false;
+
+        if ( e < end && (*e == '+' || *e == '-') )
+        {
+            isExpNegative = *e == '-';
+            ++e;
+        }
+
+        if ( e < end && IsDigit(*e) )
+        {
+            int exp = 0;
+
+            for ( ; e < end && IsDigit(*e); ++e )
+            {
+                if ( exp < 10000 )
+                    exp = exp * 10 + (*e - '0');
+            }
+            exponent += isExpNegative ? -exp : exp;
+            s = e;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+
+    if ( exponent > maxPowerOf10 || exponent < -maxPowerOf10 )
+        result *= std::pow(10.0, exponent);
+    else if ( exponent > 0 )
+        result *= powersOf10[exponent];
+    else if ( exponent < 0 )
+        result /= powersOf10[-exponent];
+
+    value = static_cast<float>(isNegative ? -result : result);
+    p = s;
+    return true;
+}
+
+// arc flags may not be separated, e.g., "a1 1 0 00 1 1"
+bool ParseFlag(const char*& p, const char* end, bool& flag)
+{
+    SkipSeparators(p, end);
+    if ( p >= end || (*p != '0' && *p != '1') )
+        return false;
+
+    flag = *p++ == '1';
+    return true;
+}
+
+// parses at most maxCount numbers separated by spaces or commas
+size_t ParseNumbers(const char*& p, const char* end, float* numbers, size_t maxCount)
+{
+    size_t count = 0;
+
+    while ( count < maxCount && ParseNumber(p, end, numbers[count]) )
+        ++count;
+
+    return count;
+}
+
+// a number with an optional percent sign, clamped to 0..1
+float ParseOpacity(const StringView& s)
+{
+    const char* p = s.begin;
+    float       value = 1;
+
+    if ( !ParseNumber(p, s.end, value) )
+        return 1;
+
+    if ( p < s.end && *p == '%' )
+        value /= 100;
+    return wxMax(0.0f, wxMin(value, 1.0f));
+}
+
+inline wxUint32 MakeColor(unsigned r, unsigned g, unsigned b, unsigned a = 255)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+inline wxUint32 ApplyOpacity(wxUint32 color, float opacity)
+{
+    const unsigned alpha = static_cast<unsigned>((color >> 24) * opacity + 0.5f);
+
+    return (color & 0x00ffffff) | (wxMin(alpha, 255u) << 24);
+}
+
+inline int HexDigitValue(char c)
+{
+    if ( c >= '0' && c <= '9' )
+        return c - '0';
+    c = ToLower(c);
+    if ( c >= 'a' && c <= 'f' )
+        return c - 'a' + 10;
+    return -1;
+}
+
+// Parses #rgb, #rrggbb, rgb() and rgba() with numbers or percents, and
+// the basic named colours, returns false for anything else
+bool ParseColor(StringView s, wxUint32& color)
+{
+    struct NamedColor
+    {
+        const char* name;
+        wxUint32    color;
+    };
+    static const NamedColor namedColors[] =
+    {
+        { "black",       MakeColor(  0,   0,   0) },
+        { "white",       MakeColor(255, 255, 255) },
+        { "red",         MakeColor(255,   0,   0) },
+        { "green",       MakeColor(  0, 128,   0) },
+        { "blue",        MakeColor(  0,   0, 255) },
+        { "yellow",      MakeColor(255, 255,   0) },
+        { "gray",        MakeColor(128, 128, 128) },
+        { "grey",        MakeColor(128, 128, 128) },
+        { "silver",      MakeColor(192, 192, 192) },
+        { "maroon",      MakeColor(128,   0,   0) },
+        { "purple",      MakeColor(128,   0, 128) },
+        { "fuchsia",     MakeColor(255,   0, 255) },
+        { "magenta",     MakeColor(255,   0, 255) },
+        { "lime",        MakeColor(  0, 255,   0) },
+        { "olive",       MakeColor(128, 128,   0) },
+        { "navy",        MakeColor(  0,   0, 128) },
+        { "teal",        MakeColor(  0, 128, 128) },
+        { "aqua",        MakeColor(  0, 255, 255) },
+        { "cyan",        MakeColor(  0, 255, 255) },
+        { "orange",      MakeColor(255, 165,   0) },
+        { "transparent", MakeColor(  0,   0,   0, 0) },
+    };
+
+    s = Trim(s);
+    if ( s.IsEmpty() )
+        return false;
+
+    if ( *s.begin == '#' )
+    {
+        const size_t len = s.Len() - 1;
+        int          digits[6];
+
+        if ( len != 3 && len != 6 )
+            return false;
+
+        for ( size_t i = 0; i < len; ++i )
+        {
+            digits[i] = HexDigitValue(s.begin[i + 1]);
+            if ( digits[i] < 0 )
+                return false;
+        }
+
+        if ( len == 3 )
+            color = MakeColor(digits[0] * 17, digits[1] * 17, digits[2] * 17);
+        else
+            color = MakeColor(digits[0] * 16 + digits[1], digits[2] * 16 + digits[3], digits[4] * 16 + digits[5]);
+        return true;
+    }
+
+    if ( s.StartsWith("rgb") )
+    {
+        const char* p = static_cast<const char*>(std::memchr(s.begin, '(', s.Len()));
+        float       components[4] = { 0, 0, 0, 1 };
+
+        if ( !p )
+            return false;
+
+        ++p;
+        for ( size_t i = 0; i < 4; ++i )
+        {
+            if ( !ParseNumber(p, s.end, components[i]) )
+            {
+                if ( i < 3 )
+                    return false;
+                break;
+            }
+
+            // alpha without percent is 0..1
+            if ( p < s.end && *p == '%' )
+            {
+                components[i] = i < 3 ? components[i] * 255 / 100 : components[i] / 100;
+                ++p;
+            }
+
+            // CSS colour 4 allows spaces and a slash before alpha
+            SkipSpaces(p, s.end);
+            if ( p < s.end && *p == '/' )
+                ++p;
+        }
+
+        unsigned values[4];
+
+        for ( size_t i = 0; i < 3; ++i )
+            values[i] = static_cast<unsigned>(wxMax(0.0f, wxMin(components[i], 255.0f)) + 0.5f);
+        values[3] = static_cast<unsigned>(wxMax(0.0f, wxMin(components[3], 1.0f)) * 255 + 0.5f);
+
+        color = MakeColor(values[0], values[1], values[2], values[3]);
+        return true;
+    }
+
+    for ( const auto& c : namedColors )
+    {
+        if ( IsSameAsNoCase(s, c.name) )
+        {
+            color = c.color;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// out = outer * inner, i.e., inner is applied first
+void MultiplyXforms(const float* outer, const float* inner, float* out)
+{
+    float result[6];
+
+    result[0] = outer[0] * inner[0] + outer[2] * inner[1];
+    result[1] = outer[1] * inner[0] + outer[3] * inner[1];
+    result[2] = outer[0] * inner[2] + outer[2] * inner[3];
+    result[3] = outer[1] * inner[2] + outer[3] * inner[3];
+    result[4] = outer[0] * inner[4] + outer[2] * inner[5] + outer[4];
+    result[5] = outer[1] * inner[4] + outer[3] * inner[5] + outer[5];
+    std::memcpy(out, result, sizeof(result));
+}
+
+// returns false if t is not invertible
+bool InvertXform(const float* t, float* inverse)
+{
+    const double det = static_cast<double>(t[0]) * t[3] - static_cast<double>(t[2]) * t[1];
+
+    if ( std::fabs(det) < 1e-12 )
+        return false;
+
+    const double invDet = 1.0 / det;
+
+    inverse[0] = static_cast<float>(t[3] * invDet);
+    inverse[1] = static_cast<float>(-t[1] * invDet);
+    inverse[2] = static_cast<float>(-t[2] * invDet);
+    inverse[3] = static_cast<float>(t[0] * invDet);
+    inverse[4] = static_cast<float>((static_cast<double>(t[2]) * t[5] - static_cast<double>(t[3]) * t[4]) * invDet);
+    inverse[5] = static_cast<float>((static_cast<double>(t[1]) * t[4] - static_cast<double>(t[0]) * t[5]) * invDet);
+    return true;
+}
+
+void SetIdentityXform(float* t)
+{
+    t[0] = 1; t[1] = 0;
+    t[2] = 0; t[3] = 1;
+    t[4] = 0; t[5] = 0;
+}
+
+// Parses a transform list, e.g., "translate(10 20) rotate(45)",
+// into t, which is left unchanged if there is an error
+void ParseTransform(StringView s, float* t)
+{
+    const double pi = 3.14159265358979323846;
+    const char*  p = s.begin;
+    float        result[6];
+
+    SetIdentityXform(result);
+
+    for ( ;; )
+    {
+        SkipSeparators(p, s.end);
+        if ( p >= s.end )
+            break;
+
+        const char* nameBegin = p;
+
+        while ( p < s.end && IsAlpha(*p) )
+            ++p;
+
+        const StringView name(nameBegin, p);
+
+        SkipSpaces(p, s.end);
+        if ( name.IsEmpty() || p >= s.end || *p != '(' )
+            return;
+        ++p;
+
+        float        args[6];
+        const size_t argCount = ParseNumbers(p, s.end, args, WXSIZEOF(args));
+        float        m[6];
+
+        SkipSpaces(p, s.end);
+        if ( p >= s.end || *p != ')' )
+            return;
+        ++p;
+
+        SetIdentityXform(m);
+
+        if ( name.Is("matrix") && argCount == 6 )
+        {
+            std::memcpy(m, args, sizeof(m));
+        }
+        else if ( name.Is("translate") && argCount >= 1 )
+        {
+            m[4] = args[0];
+            m[5] = argCount > 1 ? args[1] : 0;
+        }
+        else if ( name.Is("scale") && argCount >= 1 )
+        {
+            m[0] = args[0];
+            m[3] = argCount > 1 ? args[1] : args[0];
+        }
+        else if ( name.Is("rotate") && argCount >= 1 )
+        {
+            const double angle = args[0] * pi / 180;
+            const float  cs = static_cast<float>(std::cos(angle));
+            const float  sn = static_cast<float>(std::sin(angle));
+
+            m[0] = cs; m[1] = sn;
+            m[2] = -sn; m[3] = cs;
+
+            if ( argCount >= 3 )
+            {
+                // translate(cx, cy) rotate(angle) translate(-cx, -cy)
+                m[4] = args[1] - cs * args[1] + sn * args[2];
+                m[5] = args[2] - sn * args[1] - cs * args[2];
+            }
+        }
+        else if ( name.Is("skewX") && argCount >= 1 )
+        {
+            m[2] = static_cast<float>(std::tan(args[0] * pi / 180));
+        }
+        else if ( name.Is("skewY") && argCount >= 1 )
+        {
+            m[1] = static_cast<float>(std::tan(args[0] * pi / 180));
+        }
+        else
+        {
+            return;
+        }
+
+        MultiplyXforms(result, m, result);
+    }
+
+    std::memcpy(t, result, sizeof(result));
+}
+
+inline void AddToBounds(float* bounds, float x, float y)
+{
+    bounds[0] = wxMin(bounds[0], x);
+    bounds[1] = wxMin(bounds[1], y);
+    bounds[2] = wxMax(bounds[2], x);
+    bounds[3] = wxMax(bounds[3], y);
+}
+
+inline void ResetBounds(float* bounds)
+{
+    bounds[0] = bounds[1] = 1e30f;
+    bounds[2] = bounds[3] = -1e30f;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxSVGFlatParser
+// ============================================================================
+
+/*
+    Does the actual parsing for wxSVGFlatDocument::Parse(), all its arrays
+    are allocated from the document arena.
+ */
+
+class wxSVGFlatParser
+{
+public:
+    wxSVGFlatParser(wxSVGFlatDocument& document, float dpi);
+
+    bool Parse(const char* data, size_t length);
+
+private:
+    typedef wxSVGFlatDocument Doc;
+
+    // deeper nesting is ignored with its content
+    static const size_t MaxDepth = 64;
+    // further attributes of an element are ignored
+    static const size_t MaxAttributes = 64;
+    // of the href chains of gradients
+    static const size_t MaxGradientReferences = 8;
+
+    struct Attribute
+    {
+        StringView name;
+        StringView value;
+    };
+
+    enum PaintSpecType
+    {
+        PaintSpec_None = 0,
+        PaintSpec_Color,
+        PaintSpec_CurrentColor,
+        PaintSpec_Url
+    };
+
+    struct PaintSpec
+    {
+        PaintSpecType type;
+        wxUint32      color;
+        StringView    url; // the id, without '#'
+    };
+
+    // the inherited properties
+    struct State
+    {
+        float         xform[6];
+        PaintSpec     fill;
+        PaintSpec     stroke;
+        wxUint32      color; // for currentColor
+        float         opacity;
+        float         fillOpacity;
+        float         strokeOpacity;
+        float         strokeWidth;
+        float         miterLimit;
+        unsigned char fillRule;
+        unsigned char lineJoin;
+        unsigned char lineCap;
+        bool          isVisible;
+    };
+
+    enum ElementKind
+    {
+        Element_Group,
+        Element_Defs,
+        Element_Gradient,
+        Element_Other
+    };
+
+    // a gradient coordinate
+    struct Coord
+    {
+        float value;
+        bool  isPercent;
+        bool  isSet;
+    };
+
+    struct Gradient
+    {
+        StringView    id;
+        StringView    href;
+        bool          isRadial;
+        bool          isUserSpace;
+        unsigned char spread;
+        float         xform[6]; // gradientTransform
+        Coord         x1, y1, x2, y2;
+        Coord         cx, cy, r;
+        wxUint32      firstStop;
+        wxUint32      stopCount;
+    };
+
+    // gradient paints are resolved after the whole document is parsed
+    struct PendingPaint
+    {
+        wxUint32   shapeIndex;
+        bool       isStroke;
+        StringView id;
+        float      opacity;     // fill or stroke opacity
+        float      xform[6];    // of the shape
+        float      bounds[4];   // of the shape in its user space
+    };
+
+    wxSVGFlatDocument& m_document;
+    const float        m_dpi;
+    bool               m_isOutOfMemory{false};
+
+    ArenaVector<Doc::Shape>        m_shapes;
+    ArenaVector<unsigned char>     m_commands;
+    ArenaVector<float>             m_points;
+    ArenaVector<Doc::Paint>        m_paints;
+    ArenaVector<Doc::GradientStop> m_stops;
+
+    ArenaVector<Gradient>          m_gradients;
+    ArenaVector<Doc::GradientStop> m_gradientStops;
+    ArenaVector<PendingPaint>      m_pendingPaints;
+
+    State       m_states[MaxDepth];
+    ElementKind m_kinds[MaxDepth];
+    size_t      m_depth{0};
+    size_t      m_skipDepth{0}; // of the skipped element and its children
+    size_t      m_defsDepth{0};
+    bool        m_hasRoot{false};
+    int         m_currentGradient{-1}; // its stops are being parsed
+
+    // the size of the root viewBox, for percentages
+    float m_viewWidth{0};
+    float m_viewHeight{0};
+
+    // the shape being parsed
+    wxUint32 m_shapeFirstCommand{0};
+    wxUint32 m_shapeFirstPoint{0};
+    float    m_shapeBounds[4];      // in document coordinates
+    float    m_shapeLocalBounds[4]; // in user coordinates
+    const State* m_shapeState{nullptr};
+
+    // XML
+    void StartElement(const StringView& name, const Attribute* attrs, size_t count);
+    void EndElement();
+
+    // attributes
+    void ParseRoot(const Attribute* attrs, size_t count, State& state);
+    void ApplyAttributes(const Attribute* attrs, size_t count, State& state);
+    void ApplyProperty(const StringView& name, const StringView& value, State& state);
+    void ApplyStyle(const StringView& style, State& state);
+    bool ParsePaint(const StringView& value, PaintSpec& paint) const;
+    // percentRef is what 100% is, units are converted to pixels
+    float ParseLength(const StringView& value, float percentRef) const;
+    float GetDiagonalRef() const;
+    static StringView FindAttribute(const Attribute* attrs, size_t count, const char* name);
+    float GetLengthAttribute(const Attribute* attrs, size_t count, const char* name,
+                             float percentRef, float defaultValue = 0) const;
+
+    // shapes
+    void ParseShape(const StringView& name, const Attribute* attrs, size_t count, const State& state);
+    void ParsePathData(const StringView& d);
+    void ParseRect(const Attribute* attrs, size_t count);
+    void AddEllipse(float cx, float cy, float rx, float ry);
+    void ParsePoints(const StringView& points, bool close);
+
+    bool BeginShape(const State& state);
+    void EndShape();
+    wxUint32 AddPaint(const PaintSpec& spec, float opacity, bool isStroke, const State& state);
+
+    void AddCommand(Doc::Command command, const float* userPoints, size_t pointCount);
+    void MoveTo(float x, float y);
+    void LineTo(float x, float y);
+    void QuadTo(float cx, float cy, float x, float y);
+    void CubicTo(float cx1, float cy1, float cx2, float cy2, float x, float y);
+    void ArcTo(float x1, float y1, float rx, float ry, float angle,
+               bool isLargeArc, bool isSweep, float x2, float y2);
+    void Close();
+
+    // gradients
+    void StartGradient(bool isRadial, const Attribute* attrs, size_t count);
+    void AddStop(const Attribute* attrs, size_t count, const State& state);
+    static void ParseStopColor(const StringView& value, const State& state, wxUint32& color);
+    Coord ParseCoord(const StringView& value) const;
+    const Gradient* FindGradient(const StringView& id) const;
+    // follows the href chain of g for the coordinate or stops
+    Coord ResolveCoord(const Gradient* g, Coord Gradient::* coord, float defaultValue, bool isPercent) const;
+    const Gradient* ResolveStops(const Gradient* g) const;
+    void ResolvePendingPaints();
+};
+
+wxSVGFlatParser::wxSVGFlatParser(wxSVGFlatDocument& document, float dpi)
+    : m_document(document), m_dpi(dpi),
+      m_shapes(document.m_arena), m_commands(document.m_arena), m_points(document.m_arena),
+      m_paints(document.m_arena), m_stops(document.m_arena),
+      m_gradients(document.m_arena), m_gradientStops(document.m_arena),
+      m_pendingPaints(document.m_arena)
+{
+    ResetBounds(m_shapeBounds);
+    ResetBounds(m_shapeLocalBounds);
+}
+
+bool wxSVGFlatParser::Parse(const char* data, size_t length)
+{
+    const char* p   = data;
+    const char* end = data + length;
+
+    // paint 0 is always none, so that it can be used for no paint
+    Doc::Paint* none = m_paints.Add();
+
+    if ( !none )
+        return false;
+    std::memset(none, 0, sizeof(*none));
+
+    // a rough estimate from the size of typical icon paths, to avoid
+    // growing the largest arrays many times
+    m_points.Reserve(length / 8);
+    m_commands.Reserve(length / 16);
+
+    while ( p < end && !m_isOutOfMemory )
+    {
+        p = static_cast<const char*>(std::memchr(p, '<', end - p));
+        if ( !p || ++p >= end )
+            break;
+
+        if ( *p == '!' )
+        {
+            if ( end - p >= 3 && std::memcmp(p, "!--", 3) == 0 )
+            {
+                p = SkipPast(p + 3, end, "-->");
+            }
+            else if ( end - p >= 8 && std::memcmp(p, "![CDATA[", 8) == 0 )
+            {
+                p = SkipPast(p + 8, end, "]]>");
+            }
+            else
+            {
+                // DOCTYPE, possibly with an internal subset in brackets
+                int brackets = 0;
+
+                for ( ; p < end; ++p )
+                {
+                    if ( *p == '[' )
+                        ++brackets;
+                    else if ( *p == ']' )
+                        --brackets;
+                    else if ( *p == '>' && brackets <= 0 )
+                        break;
+                }
+                if ( p < end )
+                    ++p;
+            }
+            continue;
+        }
+
+        if ( *p == '?' )
+        {
+            p = SkipPast(p + 1, end, "?>");
+            continue;
+        }
+
+        if ( *p == '/' )
+        {
+            p = static_cast<const char*>(std::memchr(p, '>', end - p));
+            if ( !p )
+                break;
+            ++p;
+            EndElement();
+            continue;
+        }
+
+        // start tag
+        const char* nameBegin = p;
+
+        while ( p < end && !IsSpace(*p) && *p != '>' && *p != '/' )
+            ++p;
+
+        StringView name(nameBegin, p);
+        // ignore the namespace prefix, e.g., "svg:path"
+        const char* colon = static_cast<const char*>(std::memchr(name.begin, ':', name.Len()));
+
+        if ( colon )
+            name.begin = colon + 1;
+
+        Attribute attrs[MaxAttributes];
+        size_t    attrCount = 0;
+        bool      isEmpty = false; // <element/>
+        bool      isClosed = false;
+
+        while ( p < end )
+        {
+            SkipSpaces(p, end);
+            if ( p >= end )
+                break;
+
+            if ( *p == '>' )
+            {
+                ++p;
+                isClosed = true;
+                break;
+            }
+
+            if ( *p == '/' )
+            {
+                isEmpty = true;
+                ++p;
+                continue;
+            }
+
+            const char* attrNameBegin = p;
+
+            while ( p < end && !IsSpace(*p) && *p != '=' && *p != '>' && *p != '/' )
+                ++p;
+
+            const StringView attrName(attrNameBegin, p);
+
+            SkipSpaces(p, end);
+            if ( p >= end || *p != '=' )
+            {
+                // an attribute without value is not valid XML, ignore it
+                if ( attrName.IsEmpty() && p < end && *p != '>' && *p != '/' )
+                    ++p;
+                continue;
+            }
+
+            ++p;
+            SkipSpaces(p, end);
+            if ( p >= end )
+                break;
+
+            StringView value;
+
+            if ( *p == '"' || *p == '\'' )
+            {
+                const char  quote = *p++;
+                const char* valueEnd = static_cast<const char*>(std::memchr(p, quote, end - p));
+
+                if ( !valueEnd )
+                    break;
+                value = StringView(p, valueEnd);
+                p = valueEnd + 1;
+            }
+            else
+            {
+                const char* valueBegin = p;
+
+                while ( p < end && !IsSpace(*p) && *p != '>' )
+                    ++p;
+                value = StringView(valueBegin, p);
+            }
+
+            if ( attrCount < MaxAttributes )
+            {
+                attrs[attrCount].name  = attrName;
+                attrs[attrCount].value = value;
+                ++attrCount;
+            }
+        }
+
+        if ( !isClosed )
+            break;
+
+        StartElement(name, attrs, attrCount);
+        if ( isEmpty )
+            EndElement();
+    }
+
+    if ( m_isOutOfMemory || !m_hasRoot )
+        return false;
+
+    ResolvePendingPaints();
+    if ( m_isOutOfMemory )
+        return false;
+
+    wxSVGFlatDocument& doc = m_document;
+
+    // without the size and viewBox, use the bounds of the content
+    if ( doc.m_width <= 0 || doc.m_height <= 0 )
+    {
+        for ( size_t i = 0; i < m_shapes.GetSize(); ++i )
+        {
+            doc.m_width  = wxMax(doc.m_width, m_shapes[i].bounds[2]);
+            doc.m_height = wxMax(doc.m_height, m_shapes[i].bounds[3]);
+        }
+    }
+
+    doc.m_shapes       = m_shapes.GetData();
+    doc.m_shapeCount   = m_shapes.GetSize();
+    doc.m_commands     = m_commands.GetData();
+    doc.m_commandCount = m_commands.GetSize();
+    doc.m_points       = m_points.GetData();
+    doc.m_pointCount   = m_points.GetSize() / 2;
+    doc.m_paints       = m_paints.GetData();
+    doc.m_paintCount   = m_paints.GetSize();
+    doc.m_stops        = m_stops.GetData();
+    doc.m_stopCount    = m_stops.GetSize();
+
+    return doc.IsOk();
+}
+
+void wxSVGFlatParser::StartElement(const StringView& name, const Attribute* attrs, size_t count)
+{
+    if ( m_skipDepth )
+    {
+        ++m_skipDepth;
+        return;
+    }
+
+    // content outside of the root svg and too deeply nested
+    // or not rendered elements is skipped
+    if ( m_depth == MaxDepth || (m_depth == 0 && (m_hasRoot || !name.Is("svg")))
+         || name.Is("clipPath") || name.Is("mask") || name.Is("marker")
+         || name.Is("pattern") || name.Is("symbol") || name.Is("style")
+         || name.Is("text") || name.Is("image") || name.Is("use")
+         || name.Is("title") || name.Is("desc") || name.Is("metadata") )
+    {
+        m_skipDepth = 1;
+        return;
+    }
+
+    State&      state = m_states[m_depth];
+    ElementKind kind  = Element_Group;
+
+    if ( m_depth > 0 )
+    {
+        state = m_states[m_depth - 1];
+    }
+    else
+    {
+        SetIdentityXform(state.xform);
+        state.fill.type      = PaintSpec_Color;
+        state.fill.color     = MakeColor(0, 0, 0);
+        state.stroke.type    = PaintSpec_None;
+        state.stroke.color   = 0;
+        state.color          = MakeColor(0, 0, 0);
+        state.opacity        = 1;
+        state.fillOpacity    = 1;
+        state.strokeOpacity  = 1;
+        state.strokeWidth    = 1;
+        state.miterLimit     = 4;
+        state.fillRule       = Doc::FillRule_NonZero;
+        state.lineJoin       = Doc::LineJoin_Miter;
+        state.lineCap        = Doc::LineCap_Butt;
+        state.isVisible      = true;
+    }
+
+    if ( name.Is("svg") )
+    {
+        if ( m_depth == 0 )
+        {
+            ParseRoot(attrs, count, state);
+            m_hasRoot = true;
+        }
+        ApplyAttributes(attrs, count, state);
+    }
+    else if ( name.Is("defs") )
+    {
+        kind = Element_Defs;
+        ++m_defsDepth;
+    }
+    else if ( name.Is("linearGradient") || name.Is("radialGradient") )
+    {
+        kind = Element_Gradient;
+        StartGradient(name.Is("radialGradient"), attrs, count);
+    }
+    else if ( name.Is("stop") )
+    {
+        kind = Element_Other;
+        if ( m_currentGradient >= 0 )
+            AddStop(attrs, count, state);
+    }
+    else if ( name.Is("path") || name.Is("rect") || name.Is("circle") || name.Is("ellipse")
+              || name.Is("line") || name.Is("polyline") || name.Is("polygon") )
+    {
+        kind = Element_Other;
+        ApplyAttributes(attrs, count, state);
+        if ( m_defsDepth == 0 && state.isVisible )
+            ParseShape(name, attrs, count, state);
+    }
+    else
+    {
+        // g and the unknown elements whose content is rendered, e.g., a or switch
+        ApplyAttributes(attrs, count, state);
+    }
+
+    m_kinds[m_depth++] = kind;
+}
+
+void wxSVGFlatParser::EndElement()
+{
+    if ( m_skipDepth )
+    {
+        --m_skipDepth;
+        return;
+    }
+
+    if ( m_depth == 0 )
+        return;
+
+    switch ( m_kinds[--m_depth] )
+    {
+        case Element_Defs:
+            --m_defsDepth;
+            break;
+        case Element_Gradient:
+            m_currentGradient = -1;
+            break;
+        default:
+            break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// attributes
+// ----------------------------------------------------------------------------
+
+// static
+StringView wxSVGFlatParser::FindAttribute(const Attribute* attrs, size_t count, const char* name)
+{
+    for ( size_t i = 0; i < count; ++i )
+    {
+        if ( attrs[i].name.Is(name) )
+            return attrs[i].value;
+    }
+
+    return StringView();
+}
+
+float wxSVGFlatParser::GetDiagonalRef() const
+{
+    return std::sqrt((m_viewWidth * m_viewWidth + m_viewHeight * m_viewHeight) / 2);
+}
+
+float wxSVGFlatParser::ParseLength(const StringView& value, float percentRef) const
+{
+    const char* p = value.begin;
+    float       length = 0;
+
+    if ( !ParseNumber(p, value.end, length) )
+        return 0;
+
+    const StringView unit = Trim(StringView(p, value.end));
+
+    if ( unit.IsEmpty() || unit.Is("px") )
+        return length;
+    if ( unit.Is("%") )
+        return length / 100 * percentRef;
+    if ( unit.Is("pt") )
+        return length * m_dpi / 72;
+    if ( unit.Is("pc") )
+        return length * m_dpi / 6;
+    if ( unit.Is("mm") )
+        return length * m_dpi / 25.4f;
+    if ( unit.Is("cm") )
+        return length * m_dpi / 2.54f;
+    if ( unit.Is("in") )
+        return length * m_dpi;
+    // the default font size
+    if ( unit.Is("em") )
+        return length * 16;
+    if ( unit.Is("ex") )
+        return length * 8;
+
+    return length;
+}
+
+float wxSVGFlatParser::GetLengthAttribute(const Attribute* attrs, size_t count, const char* name,
+                                          float percentRef, float defaultValue) const
+{
+    const StringView value = FindAttribute(attrs, count, name);
+
+    return value.IsEmpty() ? defaultValue : ParseLength(value, percentRef);
+}
+
+void wxSVGFlatParser::ParseRoot(const Attribute* attrs, size_t count, State& state)
+{
+    const StringView widthValue  = Trim(FindAttribute(attrs, count, "width"));
+    const StringView heightValue = Trim(FindAttribute(attrs, count, "height"));
+    const StringView viewBox     = FindAttribute(attrs, count, "viewBox");
+    float            width  = 0;
+    float            height = 0;
+    float            box[4] = { 0, 0, 0, 0 };
+    const char*      p = viewBox.begin;
+    const bool       hasViewBox = ParseNumbers(p, viewBox.end, box, 4) == 4 && box[2] > 0 && box[3] > 0;
+
+    // percentages of the unknown viewport are the same as no size
+    if ( !widthValue.IsEmpty() && widthValue.end[-1] != '%' )
+        width = ParseLength(widthValue, 0);
+    if ( !heightValue.IsEmpty() && heightValue.end[-1] != '%' )
+        height = ParseLength(heightValue, 0);
+
+    if ( !hasViewBox )
+    {
+        m_document.m_width  = width;
+        m_document.m_height = height;
+        m_viewWidth  = width;
+        m_viewHeight = height;
+        return;
+    }
+
+    if ( width <= 0 && height <= 0 )
+    {
+        width  = box[2];
+        height = box[3];
+    }
+    else if ( width <= 0 )
+    {
+        width = height * box[2] / box[3];
+    }
+    else if ( height <= 0 )
+    {
+        height = width * box[3] / box[2];
+    }
+
+    m_document.m_width  = width;
+    m_document.m_height = height;
+    m_viewWidth  = box[2];
+    m_viewHeight = box[3];
+
+    // preserveAspectRatio, xMidYMid meet by default
+    const StringView aspect = Trim(FindAttribute(attrs, count, "preserveAspectRatio"));
+    float            scaleX = width / box[2];
+    float            scaleY = height / box[3];
+    float            alignX = 0.5f;
+    float            alignY = 0.5f;
+
+    if ( !aspect.StartsWith("none") )
+    {
+        // e.g., "xMinYMax slice"
+        if ( aspect.Len() >= 8 && aspect.StartsWith("x") )
+        {
+            const StringView ax(aspect.begin + 1, aspect.begin + 4);
+            const StringView ay(aspect.begin + 5, aspect.begin + 8);
+
+            alignX = ax.Is("Min") ? 0.0f : ax.Is("Max") ? 1.0f : 0.5f;
+            alignY = ay.Is("Min") ? 0.0f : ay.Is("Max") ? 1.0f : 0.5f;
+        }
+
+        const float scale = aspect.Contains("slice") ? wxMax(scaleX, scaleY) : wxMin(scaleX, scaleY);
+
+        scaleX = scaleY = scale;
+    }
+    else
+    {
+        alignX = alignY = 0;
+    }
+
+    state.xform[0] = scaleX;
+    state.xform[1] = 0;
+    state.xform[2] = 0;
+    state.xform[3] = scaleY;
+    state.xform[4] = (width - box[2] * scaleX) * alignX - box[0] * scaleX;
+    state.xform[5] = (height - box[3] * scaleY) * alignY - box[1] * scaleY;
+}
+
+bool wxSVGFlatParser::ParsePaint(const StringView& value, PaintSpec& paint) const
+{
+    const StringView v = Trim(value);
+
+    if ( v.Is("none") )
+    {
+        paint.type = PaintSpec_None;
+        return true;
+    }
+
+    if ( v.Is("currentColor") )
+    {
+        paint.type = PaintSpec_CurrentColor;
+        return true;
+    }
+
+    if ( v.StartsWith("url(") )
+    {
+        const char* idBegin = v.begin + 4;
+        const char* idEnd = static_cast<const char*>(std::memchr(idBegin, ')', v.end - idBegin));
+
+        if ( !idEnd )
+            return false;
+
+        StringView id = Trim(StringView(idBegin, idEnd));
+
+        if ( !id.IsEmpty() && (*id.begin == '\'' || *id.begin == '"') && id.Len() >= 2 )
+            id = StringView(id.begin + 1, id.end - 1);
+        if ( id.IsEmpty() || *id.begin != '#' )
+            return false;
+
+        paint.type = PaintSpec_Url;
+        paint.url  = StringView(id.begin + 1, id.end);
+        return true;
+    }
+
+    if ( ParseColor(v, paint.color) )
+    {
+        paint.type = PaintSpec_Color;
+        return true;
+    }
+
+    // including "inherit"
+    return false;
+}
+
+void wxSVGFlatParser::ApplyProperty(const StringView& name, const StringView& value, State& state)
+{
+    if ( name.Is("fill") )
+    {
+        ParsePaint(value, state.fill);
+    }
+    else if ( name.Is("stroke") )
+    {
+        ParsePaint(value, state.stroke);
+    }
+    else if ( name.Is("stroke-width") )
+    {
+        state.strokeWidth = wxMax(0.0f, ParseLength(value, GetDiagonalRef()));
+    }
+    else if ( name.Is("opacity") )
+    {
+        // opacity is not inherited, unlike the other properties, but that of
+        // the parent applies to the children, approximated by multiplying them
+        state.opacity *= ParseOpacity(value);
+    }
+    else if ( name.Is("fill-opacity") )
+    {
+        state.fillOpacity = ParseOpacity(value);
+    }
+    else if ( name.Is("stroke-opacity") )
+    {
+        state.strokeOpacity = ParseOpacity(value);
+    }
+    else if ( name.Is("fill-rule") )
+    {
+        const StringView v = Trim(value);
+
+        if ( v.Is("evenodd") )
+            state.fillRule = Doc::FillRule_EvenOdd;
+        else if ( v.Is("nonzero") )
+            state.fillRule = Doc::FillRule_NonZero;
+    }
+    else if ( name.Is("stroke-linejoin") )
+    {
+        const StringView v = Trim(value);
+
+        if ( v.Is("round") )
+            state.lineJoin = Doc::LineJoin_Round;
+        else if ( v.Is("bevel") )
+            state.lineJoin = Doc::LineJoin_Bevel;
+        else if ( v.Is("miter") )
+            state.lineJoin = Doc::LineJoin_Miter;
+    }
+    else if ( name.Is("stroke-linecap") )
+    {
+        const StringView v = Trim(value);
+
+        if ( v.Is("round") )
+            state.lineCap = Doc::LineCap_Round;
+        else if ( v.Is("square") )
+            state.lineCap = Doc::LineCap_Square;
+        else if ( v.Is("butt") )
+            state.lineCap = Doc::LineCap_Butt;
+    }
+    else if ( name.Is("stroke-miterlimit") )
+    {
+        const char* p = value.begin;
+        float       limit = 4;
+
+        if ( ParseNumber(p, value.end, limit) )
+            state.miterLimit = wxMax(1.0f, limit);
+    }
+    else if ( name.Is("color") )
+    {
+        ParseColor(value, state.color);
+    }
+    else if ( name.Is("display") )
+    {
+        if ( Trim(value).Is("none") )
+            state.isVisible = false;
+    }
+    else if ( name.Is("visibility") )
+    {
+        const StringView v = Trim(value);
+
+        if ( v.Is("hidden") || v.Is("collapse") )
+            state.isVisible = false;
+        else if ( v.Is("visible") )
+            state.isVisible = true;
+    }
+}
+
+void wxSVGFlatParser::ApplyStyle(const StringView& style, State& state)
+{
+    const char* p = style.begin;
+
+    while ( p < style.end )
+    {
+        const char* declEnd = static_cast<const char*>(std::memchr(p, ';', style.end - p));
+
+        if ( !declEnd )
+            declEnd = style.end;
+
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', declEnd - p));
+
+        if ( colon )
+            ApplyProperty(Trim(StringView(p, colon)), Trim(StringView(colon + 1, declEnd)), state);
+
+        p = declEnd + 1;
+    }
+}
+
+void wxSVGFlatParser::ApplyAttributes(const Attribute* attrs, size_t count, State& state)
+{
+    StringView style;
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const Attribute& attr = attrs[i];
+
+        if ( attr.name.Is("style") )
+        {
+            style = attr.value;
+        }
+        else if ( attr.name.Is("transform") )
+        {
+            float t[6];
+
+            SetIdentityXform(t);
+            ParseTransform(attr.value, t);
+            MultiplyXforms(state.xform, t, state.xform);
+        }
+        else
+        {
+            ApplyProperty(attr.name, attr.value, state);
+        }
+    }
+
+    // the style attribute overrides the presentation attributes
+    if ( !style.IsEmpty() )
+        ApplyStyle(style, state);
+}
+
+// ----------------------------------------------------------------------------
+// shapes
+// ----------------------------------------------------------------------------
+
+void wxSVGFlatParser::ParseShape(const StringView& name, const Attribute* attrs, size_t count,
+                                 const State& state)
+{
+    if ( !BeginShape(state) )
+        return;
+
+    if ( name.Is("path") )
+    {
+        ParsePathData(FindAttribute(attrs, count, "d"));
+    }
+    else if ( name.Is("rect") )
+    {
+        ParseRect(attrs, count);
+    }
+    else if ( name.Is("circle") )
+    {
+        const float r = GetLengthAttribute(attrs, count, "r", GetDiagonalRef());
+
+        AddEllipse(GetLengthAttribute(attrs, count, "cx", m_viewWidth),
+                   GetLengthAttribute(attrs, count, "cy", m_viewHeight), r, r);
+    }
+    else if ( name.Is("ellipse") )
+    {
+        AddEllipse(GetLengthAttribute(attrs, count, "cx", m_viewWidth),
+                   GetLengthAttribute(attrs, count, "cy", m_viewHeight),
+                   GetLengthAttribute(attrs, count, "rx", m_viewWidth),
+                   GetLengthAttribute(attrs, count, "ry", m_viewHeight));
+    }
+    else if ( name.Is("line") )
+    {
+        MoveTo(GetLengthAttribute(attrs, count, "x1", m_viewWidth),
+               GetLengthAttribute(attrs, count, "y1", m_viewHeight));
+        LineTo(GetLengthAttribute(attrs, count, "x2", m_viewWidth),
+               GetLengthAttribute(attrs, count, "y2", m_viewHeight));
+    }
+    else if ( name.Is("polyline") || name.Is("polygon") )
+    {
+        ParsePoints(FindAttribute(attrs, count, "points"), name.Is("polygon"));
+    }
+
+    EndShape();
+}
+
+bool wxSVGFlatParser::BeginShape(const State& state)
+{
+    const bool hasFill   = state.fill.type != PaintSpec_None;
+    const bool hasStroke = state.stroke.type != PaintSpec_None && state.strokeWidth > 0;
+
+    // neither filled nor stroked shapes are not added at all
+    if ( !hasFill && !hasStroke )
+        return false;
+
+    m_shapeState = &state;
+    m_shapeFirstCommand = static_cast<wxUint32>(m_commands.GetSize());
+    m_shapeFirstPoint   = static_cast<wxUint32>(m_points.GetSize() / 2);
+    ResetBounds(m_shapeBounds);
+    ResetBounds(m_shapeLocalBounds);
+    return true;
+}
+
+void wxSVGFlatParser::EndShape()
+{
+    const State& state = *m_shapeState;
+    const size_t commandCount = m_commands.GetSize() - m_shapeFirstCommand;
+
+    m_shapeState = nullptr;
+
+    if ( commandCount == 0 || m_isOutOfMemory )
+        return;
+
+    Doc::Shape* shape = m_shapes.Add();
+
+    if ( !shape )
+    {
+        m_isOutOfMemory = true;
+        return;
+    }
+
+    const float* t = state.xform;
+
+    shape->firstCommand = m_shapeFirstCommand;
+    shape->commandCount = static_cast<wxUint32>(commandCount);
+    shape->firstPoint   = m_shapeFirstPoint;
+    shape->pointCount   = static_cast<wxUint32>(m_points.GetSize() / 2 - m_shapeFirstPoint);
+    shape->opacity      = state.opacity;
+    shape->strokeWidth  = state.strokeWidth * std::sqrt(std::fabs(t[0] * t[3] - t[1] * t[2]));
+    shape->miterLimit   = state.miterLimit;
+    shape->fillRule     = state.fillRule;
+    shape->lineJoin     = state.lineJoin;
+    shape->lineCap      = state.lineCap;
+    std::memcpy(shape->bounds, m_shapeBounds, sizeof(m_shapeBounds));
+    shape->fillPaint    = AddPaint(state.fill, state.fillOpacity, false, state);
+    shape->strokePaint  = state.strokeWidth > 0 ? AddPaint(state.stroke, state.strokeOpacity, true, state) : 0;
+}
+
+// returns the index of the paint or 0 for none or a gradient, which is resolved later
+wxUint32 wxSVGFlatParser::AddPaint(const PaintSpec& spec, float opacity, bool isStroke,
+                                   const State& state)
+{
+    wxUint32 color;
+
+    switch ( spec.type )
+    {
+        case PaintSpec_Color:
+            color = spec.color;
+            break;
+
+        case PaintSpec_CurrentColor:
+            color = state.color;
+            break;
+
+        case PaintSpec_Url:
+            {
+                PendingPaint* pending = m_pendingPaints.Add();
+
+                if ( !pending )
+                {
+                    m_isOutOfMemory = true;
+                    return 0;
+                }
+
+                pending->shapeIndex = static_cast<wxUint32>(m_shapes.GetSize() - 1);
+                pending->isStroke   = isStroke;
+                pending->id         = spec.url;
+                pending->opacity    = opacity;
+                std::memcpy(pending->xform, state.xform, sizeof(pending->xform));
+                std::memcpy(pending->bounds, m_shapeLocalBounds, sizeof(pending->bounds));
+            }
+            return 0;
+
+        default:
+            return 0;
+    }
+
+    color = ApplyOpacity(color, opacity);
+
+    // consecutive shapes often have the same colour
+    const Doc::Paint& last = m_paints.Last();
+
+    if ( last.type == Doc::Paint_Color && last.color == color )
+        return static_cast<wxUint32>(m_paints.GetSize() - 1);
+
+    Doc::Paint* paint = m_paints.Add();
+
+    if ( !paint )
+    {
+        m_isOutOfMemory = true;
+        return 0;
+    }
+
+    std::memset(paint, 0, sizeof(*paint));
+    paint->type  = Doc::Paint_Color;
+    paint->color = color;
+    return static_cast<wxUint32>(m_paints.GetSize() - 1);
+}
+
+void wxSVGFlatParser::AddCommand(Doc::Command command, const float* userPoints, size_t pointCount)
+{
+    unsigned char* c = m_commands.Add();
+    float*         pts = pointCount ? m_points.Add(pointCount * 2) : nullptr;
+
+    if ( !c || (pointCount && !pts) )
+    {
+        m_isOutOfMemory = true;
+        return;
+    }
+
+    *c = static_cast<unsigned char>(command);
+
+    const float* t = m_shapeState->xform;
+
+    for ( size_t i = 0; i < pointCount; ++i )
+    {
+        const float x = userPoints[i * 2];
+        const float y = userPoints[i * 2 + 1];
+
+        pts[i * 2]     = x * t[0] + y * t[2] + t[4];
+        pts[i * 2 + 1] = x * t[1] + y * t[3] + t[5];
+
+        AddToBounds(m_shapeLocalBounds, x, y);
+        AddToBounds(m_shapeBounds, pts[i * 2], pts[i * 2 + 1]);
+    }
+}
+
+void wxSVGFlatParser::MoveTo(float x, float y)
+{
+    const float pts[] = { x, y };
+
+    AddCommand(Doc::Command_MoveTo, pts, 1);
+}
+
+void wxSVGFlatParser::LineTo(float x, float y)
+{
+    const float pts[] = { x, y };
+
+    AddCommand(Doc::Command_LineTo, pts, 1);
+}
+
+void wxSVGFlatParser::QuadTo(float cx, float cy, float x, float y)
+{
+    const float pts[] = { cx, cy, x, y };
+
+    AddCommand(Doc::Command_QuadTo, pts, 2);
+}
+
+void wxSVGFlatParser::CubicTo(float cx1, float cy1, float cx2, float cy2, float x, float y)
+{
+    const float pts[] = { cx1, cy1, cx2, cy2, x, y };
+
+    AddCommand(Doc::Command_CubicTo, pts, 3);
+}
+
+void wxSVGFlatParser::Close()
+{
+    AddCommand(Doc::Command_Close, nullptr, 0);
+}
+
+// the endpoint to center parameterization conversion from the SVG
+// implementation notes, the arc is split into at most 90 degree cubic curves
+void wxSVGFlatParser::ArcTo(float x1, float y1, float rxIn, float ryIn, float angle,
+                            bool isLargeArc, bool isSweep, float x2, float y2)
+{
+    const double pi = 3.14159265358979323846;
+
+    if ( x1 == x2 && y1 == y2 )
+        return;
+
+    double rx = std::fabs(rxIn);
+    double ry = std::fabs(ryIn);
+
+    if ( rx < 1e-6 || ry < 1e-6 )
+    {
+        LineTo(x2, y2);
+        return;
+    }
+
+    const double phi = angle * pi / 180;
+    const double cosPhi = std::cos(phi);
+    const double sinPhi = std::sin(phi);
+    const double dx2 = (x1 - x2) / 2.0;
+    const double dy2 = (y1 - y2) / 2.0;
+    const double x1p = cosPhi * dx2 + sinPhi * dy2;
+    const double y1p = -sinPhi * dx2 + cosPhi * dy2;
+
+    // too small radii are scaled up
+    const double lambda = (x1p * x1p) / (rx * rx) + (y1p * y1p) / (ry * ry);
+
+    if ( lambda > 1 )
+    {
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
+    }
+
+    const double num = rx * rx * ry * ry - rx * rx * y1p * y1p - ry * ry * x1p * x1p;
+    const double den = rx * rx * y1p * y1p + ry * ry * x1p * x1p;
+    double       coef = den > 0 ? std::sqrt(wxMax(0.0, num / den)) : 0;
+
+    if ( isLargeArc == isSweep )
+        coef = -coef;
+
+    const double cxp = coef * rx * y1p / ry;
+    const double cyp = -coef * ry * x1p / rx;
+    const double cx = cosPhi * cxp - sinPhi * cyp + (x1 + x2) / 2.0;
+    const double cy = sinPhi * cxp + cosPhi * cyp + (y1 + y2) / 2.0;
+    const double ux = (x1p - cxp) / rx;
+    const double uy = (y1p - cyp) / ry;
+    const double vx = (-x1p - cxp) / rx;
+    const double vy = (-y1p - cyp) / ry;
+    const double theta1 = std::atan2(uy, ux);
+    double       deltaTheta = std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+
+    if ( !isSweep && deltaTheta > 0 )
+        deltaTheta -= 2 * pi;
+    else if ( isSweep && deltaTheta < 0 )
+        deltaTheta += 2 * pi;
+
+    const int    segmentCount = wxMax(1, static_cast<int>(std::ceil(std::fabs(deltaTheta) / (pi / 2) - 1e-6)));
+    const double delta = deltaTheta / segmentCount;
+    const double kappa = 4.0 / 3.0 * std::tan(delta / 4);
+
+    double a0 = theta1;
+    double cos0 = std::cos(a0);
+    double sin0 = std::sin(a0);
+
+    for ( int i = 0; i < segmentCount; ++i )
+    {
+        const double a1 = a0 + delta;
+        const double cos1 = std::cos(a1);
+        const double sin1 = std::sin(a1);
+
+        // on the unit circle
+        const double u[3] = { cos0 - kappa * sin0, cos1 + kappa * sin1, cos1 };
+        const double v[3] = { sin0 + kappa * cos0, sin1 - kappa * cos1, sin1 };
+        float        pts[6];
+
+        for ( int j = 0; j < 3; ++j )
+        {
+            pts[j * 2]     = static_cast<float>(cx + cosPhi * rx * u[j] - sinPhi * ry * v[j]);
+            pts[j * 2 + 1] = static_cast<float>(cy + sinPhi * rx * u[j] + cosPhi * ry * v[j]);
+        }
+
+        // avoid accumulating the errors at the end
+        if ( i == segmentCount - 1 )
+        {
+            pts[4] = x2;
+            pts[5] = y2;
+        }
+
+        CubicTo(pts[0], pts[1], pts[2], pts[3], pts[4], pts[5]);
+
+        a0 = a1;
+        cos0 = cos1;
+        sin0 = sin1;
+    }
+}
+
+void wxSVGFlatParser::ParsePathData(const StringView& d)
+{
+    const char* p   = d.begin;
+    const char* end = d.end;
+    char        command = 0;
+    char        lastCurve = 0; // 'C' or 'Q' if the previous segment was such
+    bool        needMoveTo = true;
+    float       x = 0, y = 0;              // current point
+    float       startX = 0, startY = 0;    // of the subpath
+    float       ctrlX = 0, ctrlY = 0;      // the last control point, for S and T
+
+    while ( !m_isOutOfMemory )
+    {
+        SkipSeparators(p, end);
+        if ( p >= end )
+            break;
+
+        if ( IsAlpha(*p) )
+        {
+            command = *p++;
+
+            if ( command == 'Z' || command == 'z' )
+            {
+                if ( !needMoveTo )
+                    Close();
+                x = startX;
+                y = startY;
+                lastCurve = 0;
+                // a drawing command without moveto continues from here
+                needMoveTo = true;
+                command = 0;
+                continue;
+            }
+        }
+        else if ( !command )
+        {
+            // numbers without a command
+            break;
+        }
+
+        const bool isRelative = command >= 'a' && command <= 'z';
+        const char upper = static_cast<char>(isRelative ? command - 'a' + 'A' : command);
+        const float ox = isRelative ? x : 0;
+        const float oy = isRelative ? y : 0;
+        float       args[6];
+
+        if ( upper == 'M' )
+        {
+            if ( ParseNumbers(p, end, args, 2) != 2 )
+                break;
+
+            x = startX = args[0] + ox;
+            y = startY = args[1] + oy;
+            MoveTo(x, y);
+            needMoveTo = false;
+            lastCurve = 0;
+            // subsequent pairs are lines
+            command = isRelative ? 'l' : 'L';
+            continue;
+        }
+
+        if ( needMoveTo )
+        {
+            MoveTo(x, y);
+            startX = x;
+            startY = y;
+            needMoveTo = false;
+        }
+
+        switch ( upper )
+        {
+            case 'L':
+                if ( ParseNumbers(p, end, args, 2) != 2 )
+                    return;
+                x = args[0] + ox;
+                y = args[1] + oy;
+                LineTo(x, y);
+                lastCurve = 0;
+                break;
+
+            case 'H':
+                if ( ParseNumbers(p, end, args, 1) != 1 )
+                    return;
+                x = args[0] + ox;
+                LineTo(x, y);
+                lastCurve = 0;
+                break;
+
+            case 'V':
+                if ( ParseNumbers(p, end, args, 1) != 1 )
+                    return;
+                y = args[0] + oy;
+                LineTo(x, y);
+                lastCurve = 0;
+                break;
+
+            case 'C':
+                if ( ParseNumbers(p, end, args, 6) != 6 )
+                    return;
+                CubicTo(args[0] + ox, args[1] + oy, args[2] + ox, args[3] + oy, args[4] + ox, args[5] + oy);
+                ctrlX = args[2] + ox;
+                ctrlY = args[3] + oy;
+                x = args[4] + ox;
+                y = args[5] + oy;
+                lastCurve = 'C';
+                break;
+
+            case 'S':
+                {
+                    if ( ParseNumbers(p, end, args, 4) != 4 )
+                        return;
+
+                    const float cx1 = lastCurve == 'C' ? 2 * x - ctrlX : x;
+                    const float cy1 = lastCurve == 'C' ? 2 * y - ctrlY : y;
+
+                    CubicTo(cx1, cy1, args[0] + ox, args[1] + oy, args[2] + ox, args[3] + oy);
+                    ctrlX = args[0] + ox;
+                    ctrlY = args[1] + oy;
+                    x = args[2] + ox;
+                    y = args[3] + oy;
+                    lastCurve = 'C';
+                }
+                break;
+
+            case 'Q':
+                if ( ParseNumbers(p, end, args, 4) != 4 )
+                    return;
+                QuadTo(args[0] + ox, args[1] + oy, args[2] + ox, args[3] + oy);
+                ctrlX = args[0] + ox;
+                ctrlY = args[1] + oy;
+                x = args[2] + ox;
+                y = args[3] + oy;
+                lastCurve = 'Q';
+                break;
+
+            case 'T':
+                if ( ParseNumbers(p, end, args, 2) != 2 )
+                    return;
+                ctrlX = lastCurve == 'Q' ? 2 * x - ctrlX : x;
+                ctrlY = lastCurve == 'Q' ? 2 * y - ctrlY : y;
+                x = args[0] + ox;
+                y = args[1] + oy;
+                QuadTo(ctrlX, ctrlY, x, y);
+                lastCurve = 'Q';
+                break;
+
+            case 'A':
+                {
+                    bool isLargeArc = false;
+                    bool isSweep = false;
+
+                    if ( ParseNumbers(p, end, args, 3) != 3
+                         || !ParseFlag(p, end, isLargeArc) || !ParseFlag(p, end, isSweep)
+                         || ParseNumbers(p, end, args + 3, 2) != 2 )
+                    {
+                        return;
+                    }
+
+                    ArcTo(x, y, args[0], args[1], args[2], isLargeArc, isSweep, args[3] + ox, args[4] + oy);
+                    x = args[3] + ox;
+                    y = args[4] + oy;
+                    lastCurve = 0;
+                }
+                break;
+
+            default:
+                // unknown command, the rest of the data is an error
+                return;
+        }
+    }
+}
+
+void wxSVGFlatParser::ParseRect(const Attribute* attrs, size_t count)
+{
+    const float x = GetLengthAttribute(attrs, count, "x", m_viewWidth);
+    const float y = GetLengthAttribute(attrs, count, "y", m_viewHeight);
+    const float w = GetLengthAttribute(attrs, count, "width", m_viewWidth);
+    const float h = GetLengthAttribute(attrs, count, "height", m_viewHeight);
+    float       rx = GetLengthAttribute(attrs, count, "rx", m_viewWidth, -1);
+    float       ry = GetLengthAttribute(attrs, count, "ry", m_viewHeight, -1);
+
+    if ( w <= 0 || h <= 0 )
+        return;
+
+    if ( rx < 0 && ry < 0 )
+        rx = ry = 0;
+    else if ( rx < 0 )
+        rx = ry;
+    else if ( ry < 0 )
+        ry = rx;
+
+    rx = wxMin(rx, w / 2);
+    ry = wxMin(ry, h / 2);
+
+    if ( rx < 1e-4f || ry < 1e-4f )
+    {
+        MoveTo(x, y);
+        LineTo(x + w, y);
+        LineTo(x + w, y + h);
+        LineTo(x, y + h);
+        Close();
+        return;
+    }
+
+    // the distance of the control points from the ends of a quarter circle
+    const float k = 0.5522847f;
+    const float kx = rx * k;
+    const float ky = ry * k;
+
+    MoveTo(x + rx, y);
+    LineTo(x + w - rx, y);
+    CubicTo(x + w - rx + kx, y, x + w, y + ry - ky, x + w, y + ry);
+    LineTo(x + w, y + h - ry);
+    CubicTo(x + w, y + h - ry + ky, x + w - rx + kx, y + h, x + w - rx, y + h);
+    LineTo(x + rx, y + h);
+    CubicTo(x + rx - kx, y + h, x, y + h - ry + ky, x, y + h - ry);
+    LineTo(x, y + ry);
+    CubicTo(x, y + ry - ky, x + rx - kx, y, x + rx, y);
+    Close();
+}
+
+void wxSVGFlatParser::AddEllipse(float cx, float cy, float rx, float ry)
+{
+    if ( rx <= 0 || ry <= 0 )
+        return;
+
+    const float k = 0.5522847f;
+    const float kx = rx * k;
+    const float ky = ry * k;
+
+    MoveTo(cx + rx, cy);
+    CubicTo(cx + rx, cy + ky, cx + kx, cy + ry, cx, cy + ry);
+    CubicTo(cx - kx, cy + ry, cx - rx, cy + ky, cx - rx, cy);
+    CubicTo(cx - rx, cy - ky, cx - kx, cy - ry, cx, cy - ry);
+    CubicTo(cx + kx, cy - ry, cx + rx, cy - ky, cx + rx, cy);
+    Close();
+}
+
+void wxSVGFlatParser::ParsePoints(const StringView& points, bool close)
+{
+    const char* p = points.begin;
+    float       xy[2];
+    bool        isFirst = true;
+
+    while ( ParseNumbers(p, points.end, xy, 2) == 2 )
+    {
+        if ( isFirst )
+            MoveTo(xy[0], xy[1]);
+        else
+            LineTo(xy[0], xy[1]);
+        isFirst = false;
+    }
+
+    if ( close && !isFirst )
+        Close();
+}
+
+// ----------------------------------------------------------------------------
+// gradients
+// ----------------------------------------------------------------------------
+
+wxSVGFlatParser::Coord wxSVGFlatParser::ParseCoord(const StringView& value) const
+{
+    Coord       coord = { 0, false, false };
+    const char* p = value.begin;
+
+    if ( !ParseNumber(p, value.end, coord.value) )
+        return coord;
+
+    coord.isSet = true;
+    SkipSpaces(p, value.end);
+    if ( p < value.end && *p == '%' )
+        coord.isPercent = true;
+    else
+        coord.value = ParseLength(value, 0);
+    return coord;
+}
+
+void wxSVGFlatParser::StartGradient(bool isRadial, const Attribute* attrs, size_t count)
+{
+    Gradient* g = m_gradients.Add();
+
+    if ( !g )
+    {
+        m_isOutOfMemory = true;
+        return;
+    }
+
+    *g = Gradient();
+    g->isRadial  = isRadial;
+    g->firstStop = static_cast<wxUint32>(m_gradientStops.GetSize());
+    SetIdentityXform(g->xform);
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const StringView& name  = attrs[i].name;
+        const StringView& value = attrs[i].value;
+
+        if ( name.Is("id") )
+        {
+            g->id = value;
+        }
+        else if ( name.Is("href") || name.Is("xlink:href") )
+        {
+            const StringView href = Trim(value);
+
+            if ( !href.IsEmpty() && *href.begin == '#' )
+                g->href = StringView(href.begin + 1, href.end);
+        }
+        else if ( name.Is("gradientUnits") )
+        {
+            g->isUserSpace = Trim(value).Is("userSpaceOnUse");
+        }
+        else if ( name.Is("gradientTransform") )
+        {
+            ParseTransform(value, g->xform);
+        }
+        else if ( name.Is("spreadMethod") )
+        {
+            const StringView v = Trim(value);
+
+            if ( v.Is("reflect") )
+                g->spread = Doc::Spread_Reflect;
+            else if ( v.Is("repeat") )
+                g->spread = Doc::Spread_Repeat;
+        }
+        else if ( name.Is("x1") )
+            g->x1 = ParseCoord(value);
+        else if ( name.Is("y1") )
+            g->y1 = ParseCoord(value);
+        else if ( name.Is("x2") )
+            g->x2 = ParseCoord(value);
+        else if ( name.Is("y2") )
+            g->y2 = ParseCoord(value);
+        else if ( name.Is("cx") )
+            g->cx = ParseCoord(value);
+        else if ( name.Is("cy") )
+            g->cy = ParseCoord(value);
+        else if ( name.Is("r") )
+            g->r = ParseCoord(value);
+    }
+
+    m_currentGradient = static_cast<int>(m_gradients.GetSize() - 1);
+}
+
+// static
+void wxSVGFlatParser::ParseStopColor(const StringView& value, const State& state, wxUint32& color)
+{
+    if ( Trim(value).Is("currentColor") )
+        color = state.color;
+    else
+        ParseColor(value, color);
+}
+
+void wxSVGFlatParser::AddStop(const Attribute* attrs, size_t count, const State& state)
+{
+    float      offset = 0;
+    wxUint32   color = MakeColor(0, 0, 0);
+    float      opacity = 1;
+    StringView style;
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const StringView& name  = attrs[i].name;
+        const StringView& value = attrs[i].value;
+
+        if ( name.Is("offset") )
+            offset = ParseOpacity(value);
+        else if ( name.Is("stop-color") )
+            ParseStopColor(value, state, color);
+        else if ( name.Is("stop-opacity") )
+            opacity = ParseOpacity(value);
+        else if ( name.Is("style") )
+            style = value;
+    }
+
+    // the same as ApplyStyle() but for the stop properties
+    for ( const char* p = style.begin; p < style.end; )
+    {
+        const char* declEnd = static_cast<const char*>(std::memchr(p, ';', style.end - p));
+
+        if ( !declEnd )
+            declEnd = style.end;
+
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', declEnd - p));
+
+        if ( colon )
+        {
+            const StringView name  = Trim(StringView(p, colon));
+            const StringView value = Trim(StringView(colon + 1, declEnd));
+
+            if ( name.Is("stop-color") )
+                ParseStopColor(value, state, color);
+            else if ( name.Is("stop-opacity") )
+                opacity = ParseOpacity(value);
+        }
+
+        p = declEnd + 1;
+    }
+
+    Doc::GradientStop* stop = m_gradientStops.Add();
+
+    if ( !stop )
+    {
+        m_isOutOfMemory = true;
+        return;
+    }
+
+    Gradient& g = m_gradients[m_currentGradient];
+
+    // the offsets must not decrease
+    if ( g.stopCount > 0 )
+        offset = wxMax(offset, m_gradientStops[g.firstStop + g.stopCount - 1].offset);
+
+    stop->offset = offset;
+    stop->color  = ApplyOpacity(color, opacity);
+    ++g.stopCount;
+}
+
+const wxSVGFlatParser::Gradient* wxSVGFlatParser::FindGradient(const StringView& id) const
+{
+    for ( size_t i = 0; i < m_gradients.GetSize(); ++i )
+    {
+        if ( m_gradients[i].id.IsSameAs(id) )
+            return &m_gradients[i];
+    }
+
+    return nullptr;
+}
+
+wxSVGFlatParser::Coord wxSVGFlatParser::ResolveCoord(const Gradient* g, Coord Gradient::* coord,
+                                                     float defaultValue, bool isPercent) const
+{
+    for ( size_t i = 0; g && i < MaxGradientReferences; ++i )
+    {
+        if ( (g->*coord).isSet )
+            return g->*coord;
+        g = g->href.IsEmpty() ? nullptr : FindGradient(g->href);
+    }
+
+    const Coord c = { defaultValue, isPercent, true };
+
+    return c;
+}
+
+const wxSVGFlatParser::Gradient* wxSVGFlatParser::ResolveStops(const Gradient* g) const
+{
+    for ( size_t i = 0; g && i < MaxGradientReferences; ++i )
+    {
+        if ( g->stopCount > 0 )
+            return g;
+        g = g->href.IsEmpty() ? nullptr : FindGradient(g->href);
+    }
+
+    return nullptr;
+}
+
+void wxSVGFlatParser::ResolvePendingPaints()
+{
+    for ( size_t i = 0; i < m_pendingPaints.GetSize(); ++i )
+    {
+        const PendingPaint& pending = m_pendingPaints[i];
+        const Gradient*     g = FindGradient(pending.id);
+        const Gradient*     stops = ResolveStops(g);
+        Doc::Paint          paint;
+
+        // unknown references and gradients without stops paint nothing
+        if ( !stops )
+            continue;
+
+        std::memset(&paint, 0, sizeof(paint));
+
+        if ( stops->stopCount == 1 )
+        {
+            paint.type  = Doc::Paint_Color;
+            paint.color = ApplyOpacity(m_gradientStops[stops->firstStop].color, pending.opacity);
+        }
+        else
+        {
+            // the gradient coordinates are fractions of the bounding box
+            // or in the user space of the shape, with percentages
+            // relative to the viewport
+            const float width  = pending.bounds[2] - pending.bounds[0];
+            const float height = pending.bounds[3] - pending.bounds[1];
+            const bool  isUser = g->isUserSpace;
+            float       unitToGradient[6];
+            float       total[6];
+
+            if ( !isUser && (width <= 0 || height <= 0) )
+                continue;
+
+            // converts the coordinate to the gradient units
+            struct Converter
+            {
+                bool  isUser;
+                float ref;
+
+                float operator()(const Coord& c) const
+                {
+                    if ( c.isPercent )
+                        return isUser ? c.value / 100 * ref : c.value / 100;
+                    return c.value;
+                }
+            };
+            const Converter convertX = { isUser, m_viewWidth };
+            const Converter convertY = { isUser, m_viewHeight };
+            const Converter convertR = { isUser, GetDiagonalRef() };
+
+            if ( g->isRadial )
+            {
+                const float cx = convertX(ResolveCoord(g, &Gradient::cx, 50, true));
+                const float cy = convertY(ResolveCoord(g, &Gradient::cy, 50, true));
+                const float r  = convertR(ResolveCoord(g, &Gradient::r, 50, true));
+
+                paint.type = Doc::Paint_RadialGradient;
+                unitToGradient[0] = r;  unitToGradient[1] = 0;
+                unitToGradient[2] = 0;  unitToGradient[3] = r;
+                unitToGradient[4] = cx; unitToGradient[5] = cy;
+            }
+            else
+            {
+                const float x1 = convertX(ResolveCoord(g, &Gradient::x1, 0, true));
+                const float y1 = convertY(ResolveCoord(g, &Gradient::y1, 0, true));
+                const float x2 = convertX(ResolveCoord(g, &Gradient::x2, 100, true));
+                const float y2 = convertY(ResolveCoord(g, &Gradient::y2, 0, true));
+                const float dx = x2 - x1;
+                const float dy = y2 - y1;
+
+                // maps (0, 0) to (x1, y1) and (0, 1) to (x2, y2)
+                paint.type = Doc::Paint_LinearGradient;
+                unitToGradient[0] = dy; unitToGradient[1] = -dx;
+                unitToGradient[2] = dx; unitToGradient[3] = dy;
+                unitToGradient[4] = x1; unitToGradient[5] = y1;
+            }
+
+            // unit space -> gradient units -> bounding box -> user space -> document
+            MultiplyXforms(g->xform, unitToGradient, total);
+            if ( !isUser )
+            {
+                const float bbox[6] = { width, 0, 0, height, pending.bounds[0], pending.bounds[1] };
+
+                MultiplyXforms(bbox, total, total);
+            }
+            MultiplyXforms(pending.xform, total, total);
+
+            if ( !InvertXform(total, paint.xform) )
+            {
+                // degenerate, SVG paints it with the last stop colour
+                paint.type  = Doc::Paint_Color;
+                paint.color = ApplyOpacity(m_gradientStops[stops->firstStop + stops->stopCount - 1].color,
+                                           pending.opacity);
+            }
+            else
+            {
+                Doc::GradientStop* copied = m_stops.Add(stops->stopCount);
+
+                if ( !copied )
+                {
+                    m_isOutOfMemory = true;
+                    return;
+                }
+
+                paint.spread    = g->spread;
+                paint.firstStop = static_cast<wxUint32>(m_stops.GetSize() - stops->stopCount);
+                paint.stopCount = stops->stopCount;
+                for ( wxUint32 s = 0; s < stops->stopCount; ++s )
+                {
+                    copied[s] = m_gradientStops[stops->firstStop + s];
+                    copied[s].color = ApplyOpacity(copied[s].color, pending.opacity);
+                }
+            }
+        }
+
+        Doc::Paint* added = m_paints.Add();
+
+        if ( !added )
+        {
+            m_isOutOfMemory = true;
+            return;
+        }
+
+        *added = paint;
+
+        Doc::Shape&    shape = m_shapes[pending.shapeIndex];
+        const wxUint32 index = static_cast<wxUint32>(m_paints.GetSize() - 1);
+
+        if ( pending.isStroke )
+            shape.strokePaint = index;
+        else
+            shape.fillPaint = index;
+    }
+}
+
+// ============================================================================
+// wxSVGFlatDocument implementation
+// ============================================================================
+
+wxSVGFlatDocument::wxSVGFlatDocument(size_t arenaBlockSize)
+    : m_arena(arenaBlockSize)
+{
+}
+
+void wxSVGFlatDocument::Clear()
+{
+    m_arena.Reset();
+
+    m_width = m_height = 0;
+    m_shapes   = nullptr;
+    m_commands = nullptr;
+    m_points   = nullptr;
+    m_paints   = nullptr;
+    m_stops    = nullptr;
+    m_shapeCount = m_commandCount = m_pointCount = m_paintCount = m_stopCount = 0;
+}
+
+bool wxSVGFlatDocument::Parse(const char* data, size_t length, float dpi)
+{
+    Clear();
+
+    wxCHECK(data, false);
+
+    wxSVGFlatParser parser(*this, dpi);
+
+    if ( !parser.Parse(data, length) )
+    {
+        Clear();
+        return false;
+    }
+
+    return true;
+}
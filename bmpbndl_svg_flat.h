@@ -0,0 +1,236 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_flat.h
+// Purpose:     Zero-copy SVG parser producing a flat path buffer
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxSVGFlatDocument_PRIVATE_H
+#define wxSVGFlatDocument_PRIVATE_H
+
+#include "wx/wx.h"
+
+// ============================================================================
+// wxSVGArena
+// ============================================================================
+
+/*
+    Bump allocator for the data of one document: allocating is just moving
+    a pointer within the current block and everything is freed at once by
+    Reset() or the dtor. Reset() keeps the largest block, so an arena reused
+    for documents of similar size stops requesting memory from the system.
+ */
+
+class wxSVGArena
+{
+public:
+    static const size_t DefaultBlockSize = 64 * 1024;
+
+    explicit wxSVGArena(size_t blockSize = DefaultBlockSize);
+    ~wxSVGArena();
+
+    // alignment must be a power of 2, returns nullptr if out of memory
+    void* Allocate(size_t bytes, size_t alignment);
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Grows the last allocation in place if it is at ptr, has oldBytes,
+    // and the current block has room for newBytes, returns false otherwise
+    bool Extend(void* ptr, size_t oldBytes, size_t newBytes);
+
+    void Reset();
+
+    // allocated since the last Reset()
+    size_t GetUsedBytes() const { return m_usedBytes; }
+    // all the blocks, including the unused space
+    size_t GetReservedBytes() const { return m_reservedBytes; }
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size; // of the data following the header
+    };
+
+    const size_t   m_blockSize;
+    Block*         m_blocks{nullptr}; // the current one first
+    unsigned char* m_pos{nullptr};
+    unsigned char* m_end{nullptr};
+    size_t         m_usedBytes{0};
+    size_t         m_reservedBytes{0};
+
+    bool AddBlock(size_t minSize);
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGArena);
+};
+
+// ============================================================================
+// wxSVGFlatDocument
+// ============================================================================
+
+/*
+    SVG document parsed into flat arrays, an alternative to NanoSVG's parser.
+
+    NanoSVG copies the whole input, as it modifies it while tokenizing,
+    allocates every shape, path, and gradient separately, and links them
+    into lists, converting all the segments to cubic Bezier curves.
+    Parse() instead walks the input in place without modifying or copying
+    it and allocates everything from the document arena, producing
+    a structure of arrays a rasterizer can consume directly:
+
+    - the commands of all the shapes in a single array of bytes,
+    - their points, already transformed to the document coordinates,
+      in a single array of floats (x, y pairs) in the command order,
+    - the shapes referring to ranges of both arrays and to the paint table,
+    - the paint table with the solid colours and gradients, whose stops are
+      in another array.
+
+    Lines and quadratic curves are kept as such instead of being converted
+    to cubic ones, arcs become cubic curves. The supported subset is what
+    icons use: the path, rect, circle, ellipse, line, polyline, and polygon
+    elements within nested groups with transforms, fill and stroke with
+    their opacities and styles, inherited from the groups and given either
+    as attributes or in the style attribute, and linear and radial gradients.
+    Like NanoSVG, there is no text, images, use, clipping, masks, patterns,
+    markers, filters, style sheets, or dashes; the content of clipPath, mask,
+    marker, pattern, and symbol is skipped, that of any other unknown
+    element is parsed. Only the basic named colours are recognized.
+
+    The document can be reused for parsing many documents, its arena then
+    keeps the memory allocated for the previous ones.
+ */
+
+class wxSVGFlatDocument
+{
+public:
+    enum Command
+    {
+        Command_MoveTo = 0, // 1 point
+        Command_LineTo,     // 1 point
+        Command_QuadTo,     // 2 points: control and end
+        Command_CubicTo,    // 3 points: 2 controls and end
+        Command_Close       // no points
+    };
+
+    enum PaintType
+    {
+        Paint_None = 0,
+        Paint_Color,
+        Paint_LinearGradient,
+        Paint_RadialGradient
+    };
+
+    enum FillRule
+    {
+        FillRule_NonZero = 0,
+        FillRule_EvenOdd
+    };
+
+    // the same values as NanoSVG uses
+    enum LineJoin { LineJoin_Miter = 0, LineJoin_Round, LineJoin_Bevel };
+    enum LineCap { LineCap_Butt = 0, LineCap_Round, LineCap_Square };
+    enum Spread { Spread_Pad = 0, Spread_Reflect, Spread_Repeat };
+
+    struct GradientStop
+    {
+        float    offset;
+        wxUint32 color; // 0xAABBGGRR
+    };
+
+    struct Paint
+    {
+        unsigned char type;   // PaintType
+        unsigned char spread; // Spread, only for gradients
+        wxUint32      color;  // 0xAABBGGRR, including the fill or stroke opacity
+        // the stops of a gradient, the fill or stroke opacity is applied to them
+        wxUint32      firstStop;
+        wxUint32      stopCount;
+        // Transforms the document coordinates to those of the gradient,
+        // where a linear one goes from (0, 0) to (0, 1) and a radial one is
+        // the unit circle centered at (0, 0), the same as NSVGgradient::xform:
+        // x' = x * xform[0] + y * xform[2] + xform[4],
+        // y' = x * xform[1] + y * xform[3] + xform[5]
+        float         xform[6];
+    };
+
+    struct Shape
+    {
+        wxUint32      firstCommand;
+        wxUint32      commandCount;
+        wxUint32      firstPoint; // in points, i.e., x is at GetPoints()[2 * firstPoint]
+        wxUint32      pointCount;
+        wxUint32      fillPaint;  // index into GetPaints(), 0 is always Paint_None
+        wxUint32      strokePaint;
+        float         opacity;
+        float         strokeWidth; // in the document coordinates
+        float         miterLimit;
+        unsigned char fillRule;    // FillRule
+        unsigned char lineJoin;    // LineJoin
+        unsigned char lineCap;     // LineCap
+        // minX, minY, maxX, maxY of all the points, including the control
+        // ones, so they may be larger than the exact bounds of the curves
+        float         bounds[4];
+    };
+
+    explicit wxSVGFlatDocument(size_t arenaBlockSize = wxSVGArena::DefaultBlockSize);
+
+    // data need not be 0 terminated and is not modified, the document
+    // does not refer to it after Parse() returns. dpi is used for units
+    // like mm or pt. Returns false if data is not an SVG with positive
+    // size or if out of memory.
+    bool Parse(const char* data, size_t length, float dpi = 96);
+
+    bool IsOk() const { return m_width > 0 && m_height > 0; }
+
+    void Clear();
+
+    float GetWidth() const { return m_width; }
+    float GetHeight() const { return m_height; }
+
+    size_t GetShapeCount() const { return m_shapeCount; }
+    const Shape* GetShapes() const { return m_shapes; }
+
+    size_t GetCommandCount() const { return m_commandCount; }
+    const unsigned char* GetCommands() const { return m_commands; }
+
+    size_t GetPointCount() const { return m_pointCount; }
+    const float* GetPoints() const { return m_points; }
+
+    size_t GetPaintCount() const { return m_paintCount; }
+    const Paint* GetPaints() const { return m_paints; }
+
+    size_t GetStopCount() const { return m_stopCount; }
+    const GradientStop* GetStops() const { return m_stops; }
+
+    // memory used by the document, including the temporary parser data
+    size_t GetUsedBytes() const { return m_arena.GetUsedBytes(); }
+
+private:
+    wxSVGArena m_arena;
+
+    float m_width{0};
+    float m_height{0};
+
+    const Shape*         m_shapes{nullptr};
+    size_t               m_shapeCount{0};
+    const unsigned char* m_commands{nullptr};
+    size_t               m_commandCount{0};
+    const float*         m_points{nullptr};
+    size_t               m_pointCount{0};
+    const Paint*         m_paints{nullptr};
+    size_t               m_paintCount{0};
+    const GradientStop*  m_stops{nullptr};
+    size_t               m_stopCount{0};
+
+    friend class wxSVGFlatParser;
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGFlatDocument);
+};
+
+#endif // #ifndef wxSVGFlatDocument_PRIVATE_H
@@ -0,0 +1,682 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_nano.cpp
+// Purpose:     wxBitmapBundleImpl using NanoSVG to rasterize SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_nano.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#include "wx/ffile.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+    #include <gdk-pixbuf/gdk-pixbuf.h>
+    #ifdef __WXGTK3__
+        #include <cairo.h>
+    #endif // #ifdef __WXGTK3__
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+// Use the same options wxWidgets uses for NanoSVG.
+// NB: if wxWidgets is linked statically, it must have been built
+// with wxUSE_NANOSVG_EXTERNAL, otherwise NanoSVG symbols clash.
+#define NANOSVG_IMPLEMENTATION
+#define NANOSVGRAST_IMPLEMENTATION
+#define NANOSVG_ALL_COLOR_KEYWORDS
+
+#ifdef __VISUALC__
+    #pragma warning(push)
+    #pragma warning(disable:4456) // declaration hides previous local declaration
+    #pragma warning(disable:4702) // unreachable code
+#endif // #ifdef __VISUALC__
+
+#include <nanosvg.h>
+#include <nanosvgrast.h>
+
+#ifdef __VISUALC__
+    #pragma warning(pop)
+#endif // #ifdef __VISUALC__
+
+namespace
+{
+
+// Rasterizes image to buffer with rows stride bytes apart,
+// scaling it uniformly and centering it at the given size,
+// the same as wxBitmapBundleImplSVGD2D does
+void RasterizeNSVGImage(NSVGrasterizer* rasterizer, NSVGimage* image,
+                        const wxSize& size, unsigned char* buffer, int stride)
+{
+    const float scale = wxMin(size.x / image->width, size.y / image->height);
+    const float tx    = (size.x - image->width * scale) / 2.0f;
+    const float ty    = (size.y - image->height * scale) / 2.0f;
+
+    nsvgRasterize(rasterizer, image, tx, ty, scale, buffer, size.x, size.y, stride);
+}
+
+// Rasterizes the part rect of the image RasterizeNSVGImage() rasterizes at
+// size to buffer of the rect size, with rows stride bytes apart. NanoSVG
+// flattens every shape it is given, even one outside the buffer, so only
+// the shapes whose bounds (grown by their stroke) intersect rect are passed
+// to it, linked in copies, as the image may be shared with other threads.
+void RasterizeNSVGImageRect(NSVGrasterizer* rasterizer, const NSVGimage* image,
+                            const wxSize& size, const wxRect& rect,
+                            unsigned char* buffer, int stride)
+{
+    const float scale = wxMin(size.x / image->width, size.y / image->height);
+    const float tx    = (size.x - image->width * scale) / 2.0f;
+    const float ty    = (size.y - image->height * scale) / 2.0f;
+
+    // rect in the image coordinates, one pixel larger for the antialiasing
+    const float left   = (rect.x - 1 - tx) / scale;
+    const float top    = (rect.y - 1 - ty) / scale;
+    const float right  = (rect.x + rect.width + 1 - tx) / scale;
+    const float bottom = (rect.y + rect.height + 1 - ty) / scale;
+
+    std::vector<NSVGshape> shapes;
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        // miter joins and square caps may stick out more than half the width
+        const float margin = shape->stroke.type != NSVG_PAINT_NONE
+                             ? shape->strokeWidth / 2 * wxMax(shape->miterLimit, 1.5f) : 0;
+
+        if ( shape->bounds[0] - margin > right || shape->bounds[2] + margin < left
+             || shape->bounds[1] - margin > bottom || shape->bounds[3] + margin < top )
+        {
+            continue;
+        }
+
+        shapes.push_back(*shape);
+    }
+
+    for ( size_t i = 0; i < shapes.size(); ++i )
+        shapes[i].next = i + 1 < shapes.size() ? &shapes[i + 1] : nullptr;
+
+    NSVGimage clipped = *image;
+
+    clipped.shapes = shapes.empty() ? nullptr : &shapes[0];
+
+    nsvgRasterize(rasterizer, &clipped, tx - rect.x, ty - rect.y, scale,
+                  buffer, rect.width, rect.height, stride);
+}
+
+// Creates wxImage from RGBA buffer with no gaps between rows
+wxImage CreateImageFromRGBA(const unsigned char* buffer, const wxSize& size)
+{
+    wxImage image(size, false);
+
+    image.SetAlpha();
+
+    const unsigned char* src   = buffer;
+    unsigned char*       rgb   = image.GetData();
+    unsigned char*       alpha = image.GetAlpha();
+    const size_t         pixelCount = static_cast<size_t>(size.x) * size.y;
+
+    for ( size_t i = 0; i < pixelCount; ++i )
+    {
+        rgb[0] = src[0];
+        rgb[1] = src[1];
+        rgb[2] = src[2];
+        *alpha = src[3];
+
+        rgb   += 3;
+        alpha += 1;
+        src   += 4;
+    }
+
+    return image;
+}
+
+// Returns estimated memory used by the parsed image
+size_t GetNSVGImageBytes(const NSVGimage* image)
+{
+    size_t bytes = sizeof(NSVGimage);
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        bytes += sizeof(NSVGshape);
+
+        for ( const NSVGpath* path = shape->paths; path; path = path->next )
+            bytes += sizeof(NSVGpath) + path->npts * 2 * sizeof(float);
+
+        if ( shape->fill.type == NSVG_PAINT_LINEAR_GRADIENT || shape->fill.type == NSVG_PAINT_RADIAL_GRADIENT )
+            bytes += sizeof(NSVGgradient) + shape->fill.gradient->nstops * sizeof(NSVGgradientStop);
+        if ( shape->stroke.type == NSVG_PAINT_LINEAR_GRADIENT || shape->stroke.type == NSVG_PAINT_RADIAL_GRADIENT )
+            bytes += sizeof(NSVGgradient) + shape->stroke.gradient->nstops * sizeof(NSVGgradientStop);
+    }
+
+    return bytes;
+}
+
+// NanoSVG rasterizer of the calling thread, created on the first use
+NSVGrasterizer* GetThreadNSVGRasterizer()
+{
+    struct RasterizerHolder
+    {
+        NSVGrasterizer* rasterizer{nsvgCreateRasterizer()};
+
+        ~RasterizerHolder()
+        {
+            if ( rasterizer )
+                nsvgDeleteRasterizer(rasterizer);
+        }
+    };
+
+    static thread_local RasterizerHolder s_holder;
+
+    return s_holder.rasterizer;
+}
+
+// Reads the whole file, buf is 0 terminated
+bool ReadSVGFile(const wxString& fileName, wxCharBuffer& buf)
+{
+    wxFFile file(fileName, "rb");
+
+    if ( file.IsOpened() )
+    {
+        const wxFileOffset lenAsOfs = file.Length();
+        if ( lenAsOfs != wxInvalidOffset )
+        {
+            const size_t len = static_cast<size_t>(lenAsOfs);
+
+            buf = wxCharBuffer(len);
+            return file.Read(buf.data(), len) == len;
+        }
+    }
+
+    return false;
+}
+
+// see GetNSVGParseCount()
+std::atomic<size_t> s_NSVGParseCount{0};
+
+} // anonymous namespace
+
+// Returns the image parsed from data, shared with the other bundles
+std::shared_ptr<NSVGimage> GetSharedNSVGImage(wxUint64 hash, size_t dataLength, const char* data)
+{
+    wxBitmapBundleSVGSharedCache& sharedCache = wxBitmapBundleSVGSharedCache::Get();
+    std::shared_ptr<NSVGimage>    svgImage;
+
+    if ( dataLength )
+        svgImage = std::static_pointer_cast<NSVGimage>(sharedCache.FindDocument(hash, dataLength, "Nano"));
+
+    if ( !svgImage )
+    {
+        // NanoSVG modifies the data while parsing it, so we need a copy
+        wxCharBuffer dataCopy(data);
+        NSVGimage*   image = nsvgParse(dataCopy.data(), "px", 96);
+
+        ++s_NSVGParseCount;
+
+        if ( !image )
+        {
+            wxLogDebug("Failed to parse SVG");
+            return svgImage;
+        }
+
+        svgImage.reset(image, nsvgDelete);
+        if ( dataLength )
+            sharedCache.AddDocument(hash, dataLength, "Nano", svgImage, GetNSVGImageBytes(image));
+    }
+
+    return svgImage;
+}
+
+size_t GetNSVGParseCount()
+{
+    return s_NSVGParseCount;
+}
+
+// Creates wxBitmapBundle using wxBitmapBundleImplSVGNano
+wxBitmapBundle CreateFromImplSVGNano(const wxString& fileName, const wxSize& size)
+{
+    wxCharBuffer buf;
+
+    if ( ReadSVGFile(fileName, buf) )
+    {
+        wxBitmapBundleImplSVGNano* impl = new wxBitmapBundleImplSVGNano(buf.data(), size);
+
+        // parse now, so that an invalid file is reported here
+        if ( impl->Parse() )
+            return wxBitmapBundle::FromImpl(impl);
+
+        impl->DecRef();
+    }
+
+    return wxBitmapBundle();
+}
+
+// Creates wxBitmapBundleImplSVGNanoMT
+wxBitmapBundleImplSVGNanoMT* CreateImplSVGNanoMT(const wxString& fileName, const wxSize& size)
+{
+    wxCharBuffer buf;
+
+    if ( ReadSVGFile(fileName, buf) )
+    {
+        wxBitmapBundleImplSVGNanoMT* impl = new wxBitmapBundleImplSVGNanoMT(buf.data(), size);
+
+        if ( impl->IsOk() )
+            return impl;
+
+        impl->DecRef();
+    }
+
+    return nullptr;
+}
+
+// ============================================================================
+// wxBitmapBundleImplSVGNano implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGNano::wxBitmapBundleImplSVGNano(const char* data, const wxSize& sizeDef)
+    : wxBitmapBundleImplSVG(sizeDef)
+{
+    wxCHECK_RET(data, "null data");
+
+    SetSharedCacheKey("Nano", "1", data);
+
+    // parsed in DoParse(), only when a bitmap not found in the caches is needed
+    m_data = wxCharBuffer(data);
+}
+
+wxBitmapBundleImplSVGNano::~wxBitmapBundleImplSVGNano()
+{
+    if ( m_rasterizer )
+        nsvgDeleteRasterizer(m_rasterizer);
+}
+
+bool wxBitmapBundleImplSVGNano::IsOk() const
+{
+    if ( !m_isParsed )
+        return m_data.length() > 0;
+
+    return m_svgImage && m_rasterizer
+           && m_svgImage->width > 0 && m_svgImage->height > 0;
+}
+
+bool wxBitmapBundleImplSVGNano::DoParse()
+{
+    if ( !m_isParsed )
+    {
+        m_isParsed = true;
+        m_svgImage = GetSharedNSVGImage(m_sharedCacheHash, m_sharedCacheDataLength, m_data.data());
+        m_data = wxCharBuffer();
+
+        if ( m_svgImage )
+            m_rasterizer = nsvgCreateRasterizer();
+    }
+
+    return IsOk();
+}
+
+bool wxBitmapBundleImplSVGNano::DoRasterizeToBuffer(const wxSize& size)
+{
+    if ( !DoParse() )
+    {
+        wxLogDebug("invalid m_svgImage");
+        return false;
+    }
+
+    if ( size.x <= 0 || size.y <= 0 )
+    {
+        wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
+        return false;
+    }
+
+    m_buffer.resize(size.x * size.y * 4);
+    RasterizeNSVGImage(m_rasterizer, m_svgImage.get(), size, &m_buffer[0], size.x * 4);
+
+    return true;
+}
+
+wxBitmap wxBitmapBundleImplSVGNano::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxCHECK_MSG(m_buffer.size() == static_cast<size_t>(size.x * size.y * 4), wxBitmap(),
+                "buffer was not rasterized at this size");
+
+    return CreateBitmapFromRGBA(&m_buffer[0], GetBitmapBytes(wxSize(size.x, 1)), size, false);
+}
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+// ============================================================================
+// wxBitmapBundleImplSVGNanoPixbuf implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGNanoPixbuf::wxBitmapBundleImplSVGNanoPixbuf(const char* data, const wxSize& sizeDef)
+    : wxBitmapBundleImplSVG(sizeDef)
+{
+    wxCHECK_RET(data, "null data");
+
+    // the bitmaps are the same as those of wxBitmapBundleImplSVGNano
+    SetSharedCacheKey("Nano", "1", data);
+
+    m_svgImage = GetSharedNSVGImage(m_sharedCacheHash, m_sharedCacheDataLength, data);
+    if ( !m_svgImage )
+        return;
+
+    m_rasterizer = nsvgCreateRasterizer();
+}
+
+wxBitmapBundleImplSVGNanoPixbuf::~wxBitmapBundleImplSVGNanoPixbuf()
+{
+    if ( m_pixbuf )
+        g_object_unref(m_pixbuf);
+    if ( m_rasterizer )
+        nsvgDeleteRasterizer(m_rasterizer);
+}
+
+bool wxBitmapBundleImplSVGNanoPixbuf::IsOk() const
+{
+    return m_svgImage && m_rasterizer
+           && m_svgImage->width > 0 && m_svgImage->height > 0;
+}
+
+bool wxBitmapBundleImplSVGNanoPixbuf::DoRasterizeToBuffer(const wxSize& size)
+{
+    if ( !IsOk() )
+    {
+        wxLogDebug("invalid m_svgImage");
+        return false;
+    }
+
+    if ( size.x <= 0 || size.y <= 0 )
+    {
+        wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
+        return false;
+    }
+
+    if ( m_pixbuf )
+    {
+        g_object_unref(m_pixbuf);
+        m_pixbuf = nullptr;
+    }
+
+    // the pixels are not initialized, NanoSVG clears them before rasterizing
+    m_pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, size.x, size.y);
+    if ( !m_pixbuf )
+    {
+        wxLogDebug("Failed to create GdkPixbuf %dx%d", size.x, size.y);
+        return false;
+    }
+
+    RasterizeNSVGImage(m_rasterizer, m_svgImage.get(), size,
+                       gdk_pixbuf_get_pixels(m_pixbuf), gdk_pixbuf_get_rowstride(m_pixbuf));
+
+    return true;
+}
+
+wxBitmap wxBitmapBundleImplSVGNanoPixbuf::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxCHECK_MSG(m_pixbuf
+                && gdk_pixbuf_get_width(m_pixbuf) == size.x
+                && gdk_pixbuf_get_height(m_pixbuf) == size.y, wxBitmap(),
+                "buffer was not rasterized at this size");
+
+    GdkPixbuf* pixbuf = m_pixbuf;
+
+    m_pixbuf = nullptr;
+    // wxBitmap takes the ownership of pixbuf, its pixels are not copied
+    wxBitmap bitmap(pixbuf);
+
+#ifdef __WXGTK3__
+    // wxGTK3 draws the bitmap using a premultiplied cairo surface, which it
+    // creates from the pixbuf and keeps when the bitmap is drawn for the first
+    // time. Draw it once now, so that the pixels are converted here, as in
+    // wxBitmapBundleImplSVGNano, and not when the bitmap is first painted.
+    // Drawing needs no display, unlike wxMemoryDC, and the 1x1 target surface
+    // makes the drawing itself negligible.
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+    cairo_t*         cr      = cairo_create(surface);
+
+    bitmap.Draw(cr, 0, 0);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+#endif // #ifdef __WXGTK3__
+
+    return bitmap;
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+// ============================================================================
+// wxSVGNanoRasterizer implementation
+// ============================================================================
+
+wxSVGNanoRasterizer::wxSVGNanoRasterizer()
+    : m_rasterizer(nsvgCreateRasterizer())
+{
+}
+
+wxSVGNanoRasterizer::~wxSVGNanoRasterizer()
+{
+    if ( m_rasterizer )
+        nsvgDeleteRasterizer(m_rasterizer);
+}
+
+bool wxSVGNanoRasterizer::Rasterize(const char* data, size_t dataLength, const wxSize& size)
+{
+    if ( !m_rasterizer || !data || size.x <= 0 || size.y <= 0 )
+        return false;
+
+    // NanoSVG modifies the data while parsing, it also needs them 0 terminated
+    m_data.assign(data, data + dataLength);
+    m_data.push_back('\0');
+
+    NSVGimage* image = nsvgParse(m_data.data(), "px", 96);
+
+    if ( !image )
+        return false;
+
+    const bool ok = image->width > 0 && image->height > 0;
+
+    if ( ok )
+    {
+        m_buffer.resize(size.x * size.y * 4);
+        RasterizeNSVGImage(m_rasterizer, image, size, m_buffer.data(), size.x * 4);
+    }
+
+    nsvgDelete(image);
+    return ok;
+}
+
+// ============================================================================
+// wxBitmapBundleImplSVGNanoMT implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGNanoMT::wxBitmapBundleImplSVGNanoMT(const char* data, const wxSize& sizeDef)
+    : m_sizeDef(sizeDef),
+      m_cacheMaxEntries(wxBitmapBundleImplSVG::GetDefaultCacheMaxEntries()),
+      m_cacheMaxBytes(wxBitmapBundleImplSVG::GetDefaultCacheMaxBytes())
+{
+    wxCHECK_RET(data, "null data");
+
+    m_svgImage = GetSharedNSVGImage(wxBitmapBundleSVGSharedCache::HashData(data), strlen(data), data);
+}
+
+bool wxBitmapBundleImplSVGNanoMT::IsOk() const
+{
+    return m_svgImage && m_svgImage->width > 0 && m_svgImage->height > 0;
+}
+
+wxBitmap wxBitmapBundleImplSVGNanoMT::GetBitmap(const wxSize& size)
+{
+    const BufferPtr buffer = GetBuffer(size);
+
+    if ( !buffer )
+        return wxBitmap();
+
+    return wxBitmapBundleImplSVG::CreateBitmapFromRGBA(buffer->data(),
+               wxBitmapBundleImplSVG::GetBitmapBytes(wxSize(size.x, 1)), size, false);
+}
+
+wxImage wxBitmapBundleImplSVGNanoMT::GetImage(const wxSize& size)
+{
+    const BufferPtr buffer = GetBuffer(size);
+
+    return buffer ? CreateImageFromRGBA(buffer->data(), size) : wxImage();
+}
+
+wxBitmapBundleImplSVGNanoMT::BufferPtr wxBitmapBundleImplSVGNanoMT::GetBuffer(const wxSize& size)
+{
+    if ( !IsOk() || size.x <= 0 || size.y <= 0 )
+        return BufferPtr();
+
+    std::promise<BufferPtr>       promise;
+    std::shared_future<BufferPtr> buffer;
+    bool                          isCached = false;
+    wxUint64                      generation = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        for ( std::list<CacheEntry>::iterator it = m_cache.begin(); it != m_cache.end(); ++it )
+        {
+            if ( it->size == size )
+            {
+                ++m_cacheHits;
+                // move to the front, as the most recently used
+                m_cache.splice(m_cache.begin(), m_cache, it);
+                buffer = m_cache.front().buffer;
+                isCached = true;
+                break;
+            }
+        }
+
+        if ( !isCached )
+        {
+            ++m_cacheMisses;
+            buffer = promise.get_future().share();
+            generation = ++m_cacheGeneration;
+
+            // the entry is added before the buffer is rasterized,
+            // so that the other threads wait for it instead of
+            // rasterizing the same size too
+            const size_t bytes = wxBitmapBundleImplSVG::GetBitmapBytes(size);
+
+            if ( m_cacheMaxEntries > 0 && bytes <= m_cacheMaxBytes )
+            {
+                m_cache.push_front({ size, buffer, generation });
+                m_cacheBytes += bytes;
+                DoTrimCache();
+            }
+        }
+    }
+
+    if ( !isCached )
+    {
+        BufferPtr rasterized;
+
+        try
+        {
+            rasterized = DoRasterize(size);
+        }
+        catch ( ... )
+        {
+            // e.g., std::bad_alloc for a large size: the waiting threads
+            // get the same exception instead of a broken promise and
+            // the next call for this size tries again
+            promise.set_exception(std::current_exception());
+            RemoveCacheEntry(generation);
+            throw;
+        }
+
+        promise.set_value(rasterized);
+
+        // do not keep the failure in the cache, the next call may succeed
+        if ( !rasterized )
+            RemoveCacheEntry(generation);
+
+        return rasterized;
+    }
+
+    return buffer.get();
+}
+
+void wxBitmapBundleImplSVGNanoMT::RemoveCacheEntry(wxUint64 generation)
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+    for ( std::list<CacheEntry>::iterator it = m_cache.begin(); it != m_cache.end(); ++it )
+    {
+        if ( it->generation == generation )
+        {
+            m_cacheBytes -= wxBitmapBundleImplSVG::GetBitmapBytes(it->size);
+            m_cache.erase(it);
+            break;
+        }
+    }
+}
+
+// static
+wxImage wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(const Buffer& buffer, const wxSize& size)
+{
+    wxCHECK_MSG(buffer.size() == wxBitmapBundleImplSVG::GetBitmapBytes(size), wxImage(),
+                "buffer was not rasterized at this size");
+
+    return CreateImageFromRGBA(buffer.data(), size);
+}
+
+wxBitmapBundleImplSVGNanoMT::BufferPtr wxBitmapBundleImplSVGNanoMT::GetRectBuffer(const wxSize& size,
+                                                                                const wxRect& rect) const
+{
+    if ( !IsOk() || rect.IsEmpty() || !wxRect(size).Contains(rect) )
+        return BufferPtr();
+
+    NSVGrasterizer* rasterizer = GetThreadNSVGRasterizer();
+
+    if ( !rasterizer )
+        return BufferPtr();
+
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>(wxBitmapBundleImplSVG::GetBitmapBytes(rect.GetSize()));
+
+    RasterizeNSVGImageRect(rasterizer, m_svgImage.get(), size, rect, buffer->data(), rect.width * 4);
+    return buffer;
+}
+
+void wxBitmapBundleImplSVGNanoMT::SetCacheLimits(size_t maxEntries, size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+    m_cacheMaxEntries = maxEntries;
+    m_cacheMaxBytes   = maxBytes;
+    DoTrimCache();
+}
+
+void wxBitmapBundleImplSVGNanoMT::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+    m_cache.clear();
+    m_cacheBytes = 0;
+}
+
+wxBitmapBundleImplSVGNanoMT::BufferPtr wxBitmapBundleImplSVGNanoMT::DoRasterize(const wxSize& size) const
+{
+    NSVGrasterizer* rasterizer = GetThreadNSVGRasterizer();
+
+    if ( !rasterizer )
+        return BufferPtr();
+
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>(wxBitmapBundleImplSVG::GetBitmapBytes(size));
+
+    RasterizeNSVGImage(rasterizer, m_svgImage.get(), size, buffer->data(), size.x * 4);
+    return buffer;
+}
+
+void wxBitmapBundleImplSVGNanoMT::DoTrimCache()
+{
+    while ( !m_cache.empty()
+            && (m_cache.size() > m_cacheMaxEntries || m_cacheBytes > m_cacheMaxBytes) )
+    {
+        m_cacheBytes -= wxBitmapBundleImplSVG::GetBitmapBytes(m_cache.back().size);
+        m_cache.pop_back();
+    }
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
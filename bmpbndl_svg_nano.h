@@ -0,0 +1,306 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_nano.h
+// Purpose:     wxBitmapBundleImpl using NanoSVG to rasterize SVG
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleImplSVGNano_PRIVATE_H
+#define wxBitmapBundleImplSVGNano_PRIVATE_H
+
+#include "wx/wx.h"
+
+// NanoSVG headers are not installed with wxWidgets, they are available
+// only when the path to them (e.g. wxWidgets/3rdparty/nanosvg/src)
+// was given to CMake as NANOSVG_INCLUDE_DIR
+#ifdef __has_include
+    #if __has_include(<nanosvg.h>) && __has_include(<nanosvgrast.h>)
+        #define wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    #endif // #if __has_include(<nanosvg.h>) && __has_include(<nanosvgrast.h>)
+#endif // #ifdef __has_include
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// see wxBitmapBundleImplSVGNanoPixbuf
+#ifdef __WXGTK__
+    #define wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+#endif // #ifdef __WXGTK__
+
+#include "wx/vector.h"
+
+#include <atomic>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bmpbndl_svg.h"
+
+struct NSVGimage;
+struct NSVGrasterizer;
+
+// Creates wxBitmapBundle using wxBitmapBundleImplSVGNano
+wxBitmapBundle CreateFromImplSVGNano(const wxString& fileName, const wxSize& size);
+
+class wxBitmapBundleImplSVGNanoMT;
+
+// Returns the image parsed from data, shared with the other bundles
+// created from the same data, see wxBitmapBundleSVGSharedCache, or null
+// if data could not be parsed. hash is wxBitmapBundleSVGSharedCache::HashData(data),
+// dataLength 0 means that the bundle has no shared cache key and the image
+// is not shared.
+std::shared_ptr<NSVGimage> GetSharedNSVGImage(wxUint64 hash, size_t dataLength, const char* data);
+
+// Returns how many times GetSharedNSVGImage() has parsed the data
+// with nsvgParse(), i.e., did not find the image in the shared cache
+size_t GetNSVGParseCount();
+
+// Creates wxBitmapBundleImplSVGNanoMT, returns null on failure.
+// The caller owns the returned impl, e.g., can pass it to wxBitmapBundle::FromImpl().
+wxBitmapBundleImplSVGNanoMT* CreateImplSVGNanoMT(const wxString& fileName, const wxSize& size);
+
+// ============================================================================
+// wxBitmapBundleImplSVGNano declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl using NanoSVG to rasterize an SVG to wxBitmap
+    at given size. It does the same as wxBitmapBundle::FromSVG(),
+    but unlike the wxWidgets implementation it allows to measure
+    the rasterization and wxBitmap creation separately, see
+    wxBitmapBundleImplSVG::RasterizeToBuffer().
+
+    The data is parsed only when a bitmap found neither in the shared
+    nor in the disk cache must be rasterized, so that an application
+    starting with the bitmaps in the disk cache does not parse at all.
+    Until then, IsOk() only checks that the data is not empty.
+ */
+
+class wxBitmapBundleImplSVGNano : public wxBitmapBundleImplSVG
+{
+public:
+    // data must be 0 terminated, wxBitmapBundleImplSVGNano doesn't
+    // take its ownership and it can be deleted after the ctor
+    // was called.
+    wxBitmapBundleImplSVGNano(const char* data, const wxSize& sizeDef);
+    ~wxBitmapBundleImplSVGNano();
+
+    bool IsOk() const;
+
+private:
+    // copy of the data until it is parsed
+    wxCharBuffer m_data;
+    bool         m_isParsed{false};
+
+    // the parsed image may be shared with other bundles created
+    // from the same data, see wxBitmapBundleSVGSharedCache
+    std::shared_ptr<NSVGimage> m_svgImage;
+    NSVGrasterizer*            m_rasterizer{nullptr};
+
+    // RGBA (not premultiplied) result of the last DoRasterizeToBuffer()
+    wxVector<unsigned char> m_buffer;
+
+    virtual bool DoParse() wxOVERRIDE;
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGNano);
+};
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+// ============================================================================
+// wxBitmapBundleImplSVGNanoPixbuf declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl using NanoSVG, available only in wxGTK, which
+    rasterizes directly into the pixels of the returned wxBitmap.
+
+    wxBitmapBundleImplSVGNano rasterizes into its own buffer, which is
+    then copied into wxBitmap. wxGTK wxBitmap keeps its pixels in GdkPixbuf,
+    whose layout (RGBA, not premultiplied) is the same as that of NanoSVG
+    output. So here NanoSVG rasterizes into the memory of a new GdkPixbuf,
+    using its row stride, and the pixbuf is then passed to wxBitmap without
+    copying anything. This saves only the copy, not the conversion: wxGTK3
+    draws the bitmap using a (premultiplied) cairo surface created from
+    the pixbuf, converting every pixel just like wxBitmapBundleImplSVGNano
+    does. As wxGTK3 creates the surface only when the bitmap is drawn for
+    the first time, DoConvertBufferToBitmap() draws it once, so that
+    the conversion is measured in the Convert phase of the benchmark.
+ */
+
+class wxBitmapBundleImplSVGNanoPixbuf : public wxBitmapBundleImplSVG
+{
+public:
+    // data must be 0 terminated, wxBitmapBundleImplSVGNanoPixbuf doesn't
+    // take its ownership and it can be deleted after the ctor
+    // was called.
+    wxBitmapBundleImplSVGNanoPixbuf(const char* data, const wxSize& sizeDef);
+    ~wxBitmapBundleImplSVGNanoPixbuf();
+
+    bool IsOk() const;
+
+private:
+    std::shared_ptr<NSVGimage> m_svgImage;
+    NSVGrasterizer*            m_rasterizer{nullptr};
+
+    // result of the last DoRasterizeToBuffer(), owned until
+    // DoConvertBufferToBitmap() passes it to wxBitmap
+    GdkPixbuf* m_pixbuf{nullptr};
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGNanoPixbuf);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+// ============================================================================
+// wxSVGNanoRasterizer declaration
+// ============================================================================
+
+/*
+    Parses and rasterizes SVG with NanoSVG without creating any wxWidgets
+    objects, so it can be used in worker threads. Each thread must use its
+    own instance, as the buffers for the data being parsed and for
+    the rasterized image as well as the NanoSVG rasterizer are reused
+    between the calls.
+ */
+
+class wxSVGNanoRasterizer
+{
+public:
+    wxSVGNanoRasterizer();
+    ~wxSVGNanoRasterizer();
+
+    // data need not be 0 terminated, it is copied before parsing
+    bool Rasterize(const char* data, size_t dataLength, const wxSize& size);
+
+    // RGBA (not premultiplied) result of the last successful Rasterize()
+    const unsigned char* GetBuffer() const { return m_buffer.data(); }
+
+private:
+    std::vector<char>          m_data;
+    std::vector<unsigned char> m_buffer;
+    NSVGrasterizer*            m_rasterizer{nullptr};
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGNanoRasterizer);
+};
+
+// ============================================================================
+// wxBitmapBundleImplSVGNanoMT declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl using NanoSVG whose GetBitmap(), GetImage(), and
+    GetBuffer() can be called from several threads at once, e.g., to
+    rasterize icons in worker threads while the UI thread keeps running.
+
+    The parsed image is not modified after the ctor returns, so it is shared
+    by all the threads, while each thread rasterizes with its own NanoSVG
+    rasterizer. The cache holds immutable RGBA buffers instead of bitmaps:
+    reference counting of wxBitmap and wxImage is not thread-safe, so every
+    call returns a new object not shared with any other thread. The cache
+    lock is held only while looking up or inserting an entry, never while
+    rasterizing. When several threads ask for the same size not cached yet,
+    only the first one rasterizes it and the others wait for its result.
+
+    Note that not all ports (e.g., wxGTK) support creating wxBitmap outside
+    the main thread, the worker threads there should call GetImage()
+    and convert the image to wxBitmap in the main thread.
+ */
+
+class wxBitmapBundleImplSVGNanoMT : public wxBitmapBundleImpl
+{
+public:
+    // RGBA, not premultiplied, with no gaps between rows
+    typedef std::vector<unsigned char>    Buffer;
+    typedef std::shared_ptr<const Buffer> BufferPtr;
+
+    // data must be 0 terminated, wxBitmapBundleImplSVGNanoMT doesn't
+    // take its ownership and it can be deleted after the ctor
+    // was called.
+    wxBitmapBundleImplSVGNanoMT(const char* data, const wxSize& sizeDef);
+
+    bool IsOk() const;
+
+    virtual wxSize GetDefaultSize() const wxOVERRIDE
+    {
+        return m_sizeDef;
+    }
+
+    virtual wxSize GetPreferredSizeAtScale(double scale) const wxOVERRIDE
+    {
+        return m_sizeDef*scale;
+    }
+
+    virtual wxBitmap GetBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxImage GetImage(const wxSize& size);
+
+    // returns null if the image could not be rasterized at this size
+    BufferPtr GetBuffer(const wxSize& size);
+
+    // Rasterizes only the part rect of the image GetBuffer(size) returns,
+    // e.g., the visible part of a bitmap too large to be rasterized whole.
+    // The buffer has the size of rect and is not cached. Returns null if
+    // rect is empty or not inside size.
+    BufferPtr GetRectBuffer(const wxSize& size, const wxRect& rect) const;
+
+    // creates wxImage from the buffer returned by GetBuffer(size) (or
+    // GetRectBuffer() with rect of this size), e.g., when the buffer was
+    // obtained in a worker thread and the image is needed in the main thread
+    static wxImage CreateImageFromBuffer(const Buffer& buffer, const wxSize& size);
+
+    // the same as wxBitmapBundleImplSVG::SetCacheLimits(),
+    // the defaults are wxBitmapBundleImplSVG default limits
+    void SetCacheLimits(size_t maxEntries, size_t maxBytes);
+
+    void ClearCache();
+
+    size_t GetCacheHitCount() const { return m_cacheHits; }
+    size_t GetCacheMissCount() const { return m_cacheMisses; }
+
+private:
+    struct CacheEntry
+    {
+        wxSize                        size;
+        std::shared_future<BufferPtr> buffer;
+        // identifies the GetBuffer() call which added the entry
+        wxUint64                      generation;
+    };
+
+    const wxSize               m_sizeDef;
+    std::shared_ptr<NSVGimage> m_svgImage;
+
+    // the most recently used first
+    std::mutex            m_cacheMutex;
+    std::list<CacheEntry> m_cache;
+    size_t                m_cacheBytes{0};
+    size_t                m_cacheMaxEntries;
+    size_t                m_cacheMaxBytes;
+    wxUint64              m_cacheGeneration{0};
+    std::atomic<size_t>   m_cacheHits{0};
+    std::atomic<size_t>   m_cacheMisses{0};
+
+    BufferPtr DoRasterize(const wxSize& size) const;
+
+    // must be called with m_cacheMutex locked
+    void DoTrimCache();
+
+    // removes the entry added by the GetBuffer() call with this generation
+    // if it is still cached: it may have been already evicted and replaced
+    // by another call for the same size, which must be kept
+    void RemoveCacheEntry(wxUint64 generation);
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGNanoMT);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#endif // #ifndef wxBitmapBundleImplSVGNano_PRIVATE_H
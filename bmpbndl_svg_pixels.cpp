@@ -0,0 +1,526 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_pixels.cpp
+// Purpose:     Conversions of rasterized SVG pixels
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_pixels.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define wxSVG_PIXELS_X86_64
+
+    #include <immintrin.h>
+
+    #ifdef __VISUALC__
+        #include <intrin.h>
+        // MSVC allows using the intrinsics in any function
+        #define wxSVG_TARGET_AVX2
+    #else
+        #define wxSVG_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif // #ifdef __VISUALC__
+#endif // #if defined(__x86_64__) || defined(_M_X64)
+
+namespace
+{
+
+typedef void (*KernelFn)(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+
+struct Kernels
+{
+    KernelFn swapRedBlue;
+    KernelFn premultiply;
+    KernelFn premultiplySwapRedBlue;
+    KernelFn unpremultiply;
+    KernelFn unpremultiplySwapRedBlue;
+};
+
+// ----------------------------------------------------------------------------
+// scalar kernels, also used for the pixels left over by the SIMD ones
+// ----------------------------------------------------------------------------
+
+void SwapRedBlueScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    for ( size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4 )
+    {
+        const unsigned char r = src[0];
+        const unsigned char b = src[2];
+
+        dst[0] = b;
+        dst[1] = src[1];
+        dst[2] = r;
+        dst[3] = src[3];
+    }
+}
+
+template <bool swapRedBlue>
+void PremultiplyScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    for ( size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4 )
+    {
+        const unsigned      a = src[3];
+        const unsigned char r = static_cast<unsigned char>(src[0] * a / 255);
+        const unsigned char g = static_cast<unsigned char>(src[1] * a / 255);
+        const unsigned char b = static_cast<unsigned char>(src[2] * a / 255);
+
+        dst[0] = swapRedBlue ? b : r;
+        dst[1] = g;
+        dst[2] = swapRedBlue ? r : b;
+        dst[3] = static_cast<unsigned char>(a);
+    }
+}
+
+// a must not be 0; computed in float exactly as the SIMD kernels do
+inline unsigned char UnpremultiplyChannel(unsigned c, unsigned a)
+{
+    const float value = c * 255.f / a + 0.5f;
+
+    return static_cast<unsigned char>(value < 255.f ? value : 255.f);
+}
+
+template <bool swapRedBlue>
+void UnpremultiplyScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    for ( size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4 )
+    {
+        const unsigned a = src[3];
+
+        if ( a == 0 )
+        {
+            dst[0] = dst[1] = dst[2] = dst[3] = 0;
+            continue;
+        }
+
+        const unsigned char r = UnpremultiplyChannel(src[0], a);
+        const unsigned char g = UnpremultiplyChannel(src[1], a);
+        const unsigned char b = UnpremultiplyChannel(src[2], a);
+
+        dst[0] = swapRedBlue ? b : r;
+        dst[1] = g;
+        dst[2] = swapRedBlue ? r : b;
+        dst[3] = static_cast<unsigned char>(a);
+    }
+}
+
+const Kernels ScalarKernels =
+{
+    SwapRedBlueScalar,
+    PremultiplyScalar<false>,
+    PremultiplyScalar<true>,
+    UnpremultiplyScalar<false>,
+    UnpremultiplyScalar<true>
+};
+
+#ifdef wxSVG_PIXELS_X86_64
+
+// ----------------------------------------------------------------------------
+// SSE2 kernels, processing 4 pixels at once
+// ----------------------------------------------------------------------------
+
+void SwapRedBlueSSE2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m128i maskRedBlue = _mm_set1_epi32(0x00ff00ff);
+    size_t        i = 0;
+
+    for ( ; i + 4 <= pixelCount; i += 4 )
+    {
+        const __m128i pixels    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        const __m128i redBlue   = _mm_and_si128(pixels, maskRedBlue);
+        const __m128i greenAlpha = _mm_andnot_si128(maskRedBlue, pixels);
+        // red moves to the third byte and blue falls off the pixel and vice versa
+        const __m128i blueRed   = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(blueRed, greenAlpha));
+    }
+
+    SwapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// premultiplies 2 pixels with 16-bit channels
+template <bool swapRedBlue>
+inline __m128i PremultiplyPixelsSSE2(__m128i pixels)
+{
+    const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i one = _mm_set1_epi16(1);
+
+    // alpha in all the lanes but 255 in the alpha lane, so that alpha is kept
+    __m128i alpha = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_or_si128(alpha, alphaLanes);
+
+    // t / 255 rounded down is (t + 1 + (t >> 8)) >> 8 for t <= 255 * 255
+    const __m128i t = _mm_mullo_epi16(pixels, alpha);
+    __m128i result = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, one), _mm_srli_epi16(t, 8)), 8);
+
+    if ( swapRedBlue )
+    {
+        result = _mm_shufflelo_epi16(result, _MM_SHUFFLE(3, 0, 1, 2));
+        result = _mm_shufflehi_epi16(result, _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    return result;
+}
+
+template <bool swapRedBlue>
+void PremultiplySSE2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i = 0;
+
+    for ( ; i + 4 <= pixelCount; i += 4 )
+    {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        const __m128i lo = PremultiplyPixelsSSE2<swapRedBlue>(_mm_unpacklo_epi8(pixels, zero));
+        const __m128i hi = PremultiplyPixelsSSE2<swapRedBlue>(_mm_unpackhi_epi8(pixels, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(lo, hi));
+    }
+
+    PremultiplyScalar<swapRedBlue>(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// unpremultiplies 1 pixel with 32-bit channels
+template <bool swapRedBlue>
+inline __m128i UnpremultiplyPixelSSE2(__m128i pixel)
+{
+    const __m128  max       = _mm_set1_ps(255.f);
+    const __m128  half      = _mm_set1_ps(0.5f);
+    const __m128  alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    const __m128 channels = _mm_cvtepi32_ps(pixel);
+    const __m128 alpha    = _mm_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128 result = _mm_add_ps(_mm_div_ps(_mm_mul_ps(channels, max), alpha), half);
+
+    result = _mm_min_ps(result, max);
+    result = _mm_or_ps(_mm_andnot_ps(alphaLane, result), _mm_and_ps(alphaLane, channels));
+    // zero alpha gives zero pixel, this also gets rid of the division by zero
+    result = _mm_and_ps(result, _mm_cmpneq_ps(alpha, _mm_setzero_ps()));
+
+    if ( swapRedBlue )
+        result = _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 1, 2));
+
+    return _mm_cvttps_epi32(result);
+}
+
+template <bool swapRedBlue>
+void UnpremultiplySSE2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i = 0;
+
+    for ( ; i + 4 <= pixelCount; i += 4 )
+    {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        const __m128i lo     = _mm_unpacklo_epi8(pixels, zero);
+        const __m128i hi     = _mm_unpackhi_epi8(pixels, zero);
+
+        const __m128i p0 = UnpremultiplyPixelSSE2<swapRedBlue>(_mm_unpacklo_epi16(lo, zero));
+        const __m128i p1 = UnpremultiplyPixelSSE2<swapRedBlue>(_mm_unpackhi_epi16(lo, zero));
+        const __m128i p2 = UnpremultiplyPixelSSE2<swapRedBlue>(_mm_unpacklo_epi16(hi, zero));
+        const __m128i p3 = UnpremultiplyPixelSSE2<swapRedBlue>(_mm_unpackhi_epi16(hi, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                         _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+    }
+
+    UnpremultiplyScalar<swapRedBlue>(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+const Kernels SSE2Kernels =
+{
+    SwapRedBlueSSE2,
+    PremultiplySSE2<false>,
+    PremultiplySSE2<true>,
+    UnpremultiplySSE2<false>,
+    UnpremultiplySSE2<true>
+};
+
+// ----------------------------------------------------------------------------
+// AVX2 kernels, processing 8 pixels at once
+// ----------------------------------------------------------------------------
+
+wxSVG_TARGET_AVX2
+void SwapRedBlueAVX2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t        i = 0;
+
+    for ( ; i + 8 <= pixelCount; i += 8 )
+    {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+    }
+
+    SwapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// premultiplies 4 pixels with 16-bit channels, see PremultiplyPixelsSSE2()
+template <bool swapRedBlue>
+wxSVG_TARGET_AVX2
+inline __m256i PremultiplyPixelsAVX2(__m256i pixels)
+{
+    const __m256i alphaLanes = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i one = _mm256_set1_epi16(1);
+
+    __m256i alpha = _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+
+    alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm256_or_si256(alpha, alphaLanes);
+
+    const __m256i t = _mm256_mullo_epi16(pixels, alpha);
+    __m256i result = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, one), _mm256_srli_epi16(t, 8)), 8);
+
+    if ( swapRedBlue )
+    {
+        result = _mm256_shufflelo_epi16(result, _MM_SHUFFLE(3, 0, 1, 2));
+        result = _mm256_shufflehi_epi16(result, _MM_SHUFFLE(3, 0, 1, 2));
+    }
+
+    return result;
+}
+
+// unpacking and packing work within 128-bit lanes, so the pixels stay in order
+template <bool swapRedBlue>
+wxSVG_TARGET_AVX2
+void PremultiplyAVX2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t        i = 0;
+
+    for ( ; i + 8 <= pixelCount; i += 8 )
+    {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        const __m256i lo = PremultiplyPixelsAVX2<swapRedBlue>(_mm256_unpacklo_epi8(pixels, zero));
+        const __m256i hi = PremultiplyPixelsAVX2<swapRedBlue>(_mm256_unpackhi_epi8(pixels, zero));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+
+    PremultiplyScalar<swapRedBlue>(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// unpremultiplies 2 pixels with 32-bit channels, see UnpremultiplyPixelSSE2()
+template <bool swapRedBlue>
+wxSVG_TARGET_AVX2
+inline __m256i UnpremultiplyPixelsAVX2(__m256i pixels)
+{
+    const __m256  max       = _mm256_set1_ps(255.f);
+    const __m256  half      = _mm256_set1_ps(0.5f);
+    const __m256  alphaLane = _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+
+    const __m256 channels = _mm256_cvtepi32_ps(pixels);
+    const __m256 alpha    = _mm256_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m256 result = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(channels, max), alpha), half);
+
+    result = _mm256_min_ps(result, max);
+    result = _mm256_or_ps(_mm256_andnot_ps(alphaLane, result), _mm256_and_ps(alphaLane, channels));
+    result = _mm256_and_ps(result, _mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_NEQ_UQ));
+
+    if ( swapRedBlue )
+        result = _mm256_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 1, 2));
+
+    return _mm256_cvttps_epi32(result);
+}
+
+template <bool swapRedBlue>
+wxSVG_TARGET_AVX2
+void UnpremultiplyAVX2(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t        i = 0;
+
+    for ( ; i + 8 <= pixelCount; i += 8 )
+    {
+        const unsigned char* s = src + i * 4;
+
+        // pk has pixel 2k in the low and pixel 2k + 1 in the high lane
+        const __m256i p0 = UnpremultiplyPixelsAVX2<swapRedBlue>(
+                              _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s))));
+        const __m256i p1 = UnpremultiplyPixelsAVX2<swapRedBlue>(
+                              _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + 8))));
+        const __m256i p2 = UnpremultiplyPixelsAVX2<swapRedBlue>(
+                              _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + 16))));
+        const __m256i p3 = UnpremultiplyPixelsAVX2<swapRedBlue>(
+                              _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + 24))));
+
+        // the pixels end up in order 0, 2, 4, 6, 1, 3, 5, 7
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_permutevar8x32_epi32(packed, order));
+    }
+
+    UnpremultiplyScalar<swapRedBlue>(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+const Kernels AVX2Kernels =
+{
+    SwapRedBlueAVX2,
+    PremultiplyAVX2<false>,
+    PremultiplyAVX2<true>,
+    UnpremultiplyAVX2<false>,
+    UnpremultiplyAVX2<true>
+};
+
+bool CPUHasAVX2()
+{
+#ifdef __VISUALC__
+    int info[4];
+
+    __cpuid(info, 0);
+    if ( info[0] < 7 )
+        return false;
+
+    // the OS must save the AVX registers too
+    __cpuid(info, 1);
+    if ( !(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6 )
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif // #ifdef __VISUALC__
+}
+
+#endif // #ifdef wxSVG_PIXELS_X86_64
+
+const Kernels* GetKernelsFor(wxSVGPixelConverter::InstructionSet instructionSet)
+{
+    switch ( instructionSet )
+    {
+#ifdef wxSVG_PIXELS_X86_64
+        case wxSVGPixelConverter::InstructionSet_SSE2:
+            return &SSE2Kernels;
+        case wxSVGPixelConverter::InstructionSet_AVX2:
+            return &AVX2Kernels;
+#endif // #ifdef wxSVG_PIXELS_X86_64
+        default:
+            return &ScalarKernels;
+    }
+}
+
+wxSVGPixelConverter::InstructionSet GetBestInstructionSet()
+{
+    for ( int i = wxSVGPixelConverter::InstructionSet_Max - 1; i > 0; --i )
+    {
+        const wxSVGPixelConverter::InstructionSet instructionSet
+            = static_cast<wxSVGPixelConverter::InstructionSet>(i);
+
+        if ( wxSVGPixelConverter::IsInstructionSetSupported(instructionSet) )
+            return instructionSet;
+    }
+
+    return wxSVGPixelConverter::InstructionSet_Scalar;
+}
+
+std::atomic<int>& GetCurrentInstructionSet()
+{
+    static std::atomic<int> s_instructionSet(GetBestInstructionSet());
+
+    return s_instructionSet;
+}
+
+inline const Kernels& GetKernels()
+{
+    return *GetKernelsFor(static_cast<wxSVGPixelConverter::InstructionSet>(GetCurrentInstructionSet().load()));
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxSVGPixelConverter implementation
+// ============================================================================
+
+// static
+void wxSVGPixelConverter::SwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    GetKernels().swapRedBlue(src, dst, pixelCount);
+}
+
+// static
+void wxSVGPixelConverter::Premultiply(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    GetKernels().premultiply(src, dst, pixelCount);
+}
+
+// static
+void wxSVGPixelConverter::PremultiplySwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    GetKernels().premultiplySwapRedBlue(src, dst, pixelCount);
+}
+
+// static
+void wxSVGPixelConverter::Unpremultiply(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    GetKernels().unpremultiply(src, dst, pixelCount);
+}
+
+// static
+void wxSVGPixelConverter::UnpremultiplySwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+{
+    GetKernels().unpremultiplySwapRedBlue(src, dst, pixelCount);
+}
+
+// static
+bool wxSVGPixelConverter::IsInstructionSetSupported(InstructionSet instructionSet)
+{
+    switch ( instructionSet )
+    {
+        case InstructionSet_Scalar:
+            return true;
+#ifdef wxSVG_PIXELS_X86_64
+        case InstructionSet_SSE2:
+            return true; // always available on x86-64
+        case InstructionSet_AVX2:
+        {
+            static const bool s_hasAVX2 = CPUHasAVX2();
+
+            return s_hasAVX2;
+        }
+#endif // #ifdef wxSVG_PIXELS_X86_64
+        default:
+            return false;
+    }
+}
+
+// static
+wxSVGPixelConverter::InstructionSet wxSVGPixelConverter::GetInstructionSet()
+{
+    return static_cast<InstructionSet>(GetCurrentInstructionSet().load());
+}
+
+// static
+bool wxSVGPixelConverter::SetInstructionSet(InstructionSet instructionSet)
+{
+    if ( !IsInstructionSetSupported(instructionSet) )
+        return false;
+
+    GetCurrentInstructionSet() = instructionSet;
+    return true;
+}
+
+// static
+const char* wxSVGPixelConverter::GetInstructionSetName(InstructionSet instructionSet)
+{
+    switch ( instructionSet )
+    {
+        case InstructionSet_Scalar:
+            return "Scalar";
+        case InstructionSet_SSE2:
+            return "SSE2";
+        case InstructionSet_AVX2:
+            return "AVX2";
+        default:
+            return "Unknown";
+    }
+}
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_pixels.h
+// Purpose:     Conversions of rasterized SVG pixels
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxSVGPixelConverter_PRIVATE_H
+#define wxSVGPixelConverter_PRIVATE_H
+
+#include "wx/wx.h"
+
+// ============================================================================
+// wxSVGPixelConverter
+// ============================================================================
+
+/*
+    Kernels converting 32-bit pixels between the layouts used by
+    the rasterizers and wxBitmap: swapping red and blue (i.e., RGBA to BGRA
+    and back) and premultiplying the colour by alpha or undoing that.
+
+    Every kernel has a scalar implementation and on x86-64 also SSE2 and
+    AVX2 ones. The fastest one the CPU supports is chosen at runtime when
+    the converter is first used. All the implementations give exactly
+    the same results: premultiplying computes c * a / 255 rounded down,
+    unpremultiplying c * 255 / a rounded to nearest, limited to 255,
+    and a pixel with zero alpha becomes all zeros.
+
+    src and dst may be the same buffer but must not overlap otherwise.
+    The kernels are thread-safe, SetInstructionSet() is not and should be
+    called only when no conversion is running, e.g., when benchmarking.
+ */
+
+class wxSVGPixelConverter
+{
+public:
+    enum InstructionSet
+    {
+        InstructionSet_Scalar = 0,
+        InstructionSet_SSE2,
+        InstructionSet_AVX2,
+
+        InstructionSet_Max
+    };
+
+    // swaps the first and third byte of every pixel
+    static void SwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+
+    static void Premultiply(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+    static void PremultiplySwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+
+    static void Unpremultiply(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+    static void UnpremultiplySwapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+
+    static bool IsInstructionSetSupported(InstructionSet instructionSet);
+    static InstructionSet GetInstructionSet();
+    // returns false if the CPU does not support the instruction set
+    static bool SetInstructionSet(InstructionSet instructionSet);
+
+    static const char* GetInstructionSetName(InstructionSet instructionSet);
+};
+
+#endif // #ifndef wxSVGPixelConverter_PRIVATE_H
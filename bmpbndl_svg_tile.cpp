@@ -0,0 +1,1573 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_tile.cpp
+// Purpose:     wxBitmapBundleImpl rasterizing SVG parsed by NanoSVG in tiles
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+
+#include "bmpbndl_svg_tile.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "bmpbndl_svg_pixels.h"
+#include "svgthreadpool.h"
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define wxSVG_TILE_X86_64
+
+    #include <immintrin.h>
+
+    #ifdef __VISUALC__
+        // MSVC allows using the intrinsics in any function
+        #define wxSVG_TARGET_AVX2
+    #else
+        #define wxSVG_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif // #ifdef __VISUALC__
+#endif // #if defined(__x86_64__) || defined(_M_X64)
+
+namespace
+{
+
+const int TileSize = wxSVGTileRasterizer::TileSize;
+
+// the maximum distance of the lines from the curves they replace,
+// in pixels, the same as the NanoSVG rasterizer uses
+const float FlatteningTolerance = 0.25f;
+
+const float Pi = 3.14159265f;
+
+// a stroke with more dashes than this is stroked solid, the dashes would be
+// too small to see and, with large coordinates, too small to advance along
+// the path in float precision
+const float MaxDashCount = 100000;
+
+// The lines ending exactly at the right edge of the image write up to two
+// cells right of it, which may be past the last tile. These cells are
+// never read, they would change only the pixels right of the image.
+const size_t CellPadding = 4;
+
+// Kernels working with the accumulated cells and the premultiplied RGBA
+// pixels, all the implementations give exactly the same results
+struct Kernels
+{
+    // Sums TileSize cells from carry, stores the 8-bit coverage of each
+    // of them, clears them for the next shape, and returns the last sum
+    float (*accumulate)(float* cells, float carry, bool evenOdd, unsigned char* coverage);
+    // composites count pixels of src with coverage over dst
+    void (*blend)(unsigned char* dst, const unsigned char* src, const unsigned char* coverage, int count);
+    // the same with a single colour
+    void (*blendColor)(unsigned char* dst, const unsigned char* color, const unsigned char* coverage, int count);
+};
+
+// ----------------------------------------------------------------------------
+// scalar kernels, also used for the pixels left over by the SIMD ones
+// ----------------------------------------------------------------------------
+
+// t / 255 rounded down for t <= 255 * 255, see wxSVGPixelConverter
+inline unsigned Div255(unsigned t)
+{
+    return (t + 1 + (t >> 8)) >> 8;
+}
+
+// the coverage of a pixel whose accumulated winding number is sum,
+// computed exactly as the SIMD kernels do
+inline float CoverageFromSum(float sum, bool evenOdd)
+{
+    float a = std::fabs(sum);
+
+    if ( evenOdd )
+    {
+        // the distance to the nearest even number
+        a = a - static_cast<float>(static_cast<int>(a * 0.5f)) * 2.0f;
+
+        const float b = 2.0f - a;
+
+        return a < b ? a : b;
+    }
+
+    return a < 1.0f ? a : 1.0f;
+}
+
+inline unsigned char CoverageToByte(float coverage)
+{
+    return static_cast<unsigned char>(static_cast<int>(coverage * 255.0f + 0.5f));
+}
+
+float AccumulateScalar(float* cells, float carry, bool evenOdd, unsigned char* coverage)
+{
+    for ( int i = 0; i < TileSize; i += 4 )
+    {
+        float* c = cells + i;
+
+        // the same order of additions as the SIMD prefix sum
+        const float sums[4] =
+        {
+            c[0] + carry,
+            (c[1] + c[0]) + carry,
+            ((c[2] + c[1]) + c[0]) + carry,
+            ((c[3] + c[2]) + (c[1] + c[0])) + carry
+        };
+
+        for ( int j = 0; j < 4; ++j )
+        {
+            coverage[i + j] = CoverageToByte(CoverageFromSum(sums[j], evenOdd));
+            c[j] = 0;
+        }
+
+        carry = sums[3];
+    }
+
+    return carry;
+}
+
+inline void BlendPixel(unsigned char* dst, const unsigned char* src, unsigned coverage)
+{
+    const unsigned alpha   = Div255(src[3] * coverage);
+    const unsigned inverse = 255 - alpha;
+
+    dst[0] = static_cast<unsigned char>(Div255(src[0] * coverage) + Div255(dst[0] * inverse));
+    dst[1] = static_cast<unsigned char>(Div255(src[1] * coverage) + Div255(dst[1] * inverse));
+    dst[2] = static_cast<unsigned char>(Div255(src[2] * coverage) + Div255(dst[2] * inverse));
+    dst[3] = static_cast<unsigned char>(alpha + Div255(dst[3] * inverse));
+}
+
+void BlendScalar(unsigned char* dst, const unsigned char* src, const unsigned char* coverage, int count)
+{
+    for ( int i = 0; i < count; ++i, dst += 4, src += 4 )
+        BlendPixel(dst, src, coverage[i]);
+}
+
+void BlendColorScalar(unsigned char* dst, const unsigned char* color, const unsigned char* coverage, int count)
+{
+    for ( int i = 0; i < count; ++i, dst += 4 )
+        BlendPixel(dst, color, coverage[i]);
+}
+
+const Kernels ScalarKernels =
+{
+    AccumulateScalar,
+    BlendScalar,
+    BlendColorScalar
+};
+
+#ifdef wxSVG_TILE_X86_64
+
+// ----------------------------------------------------------------------------
+// SSE2 kernels, processing 4 cells or pixels at once
+// ----------------------------------------------------------------------------
+
+float AccumulateSSE2(float* cells, float carry, bool evenOdd, unsigned char* coverage)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 half     = _mm_set1_ps(0.5f);
+    const __m128 one      = _mm_set1_ps(1.0f);
+    const __m128 two      = _mm_set1_ps(2.0f);
+    const __m128 max      = _mm_set1_ps(255.0f);
+
+    __m128  sum = _mm_set1_ps(carry);
+    __m128i bytes[TileSize / 4];
+
+    for ( int i = 0; i < TileSize / 4; ++i )
+    {
+        float* c = cells + i * 4;
+        __m128 x = _mm_loadu_ps(c);
+
+        // prefix sum in two steps: x[i] + x[i - 1], then + x[i - 2]
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, sum);
+        sum = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+
+        _mm_storeu_ps(c, _mm_setzero_ps());
+
+        __m128 a = _mm_andnot_ps(signMask, x);
+
+        if ( evenOdd )
+        {
+            // the conversion truncates, a is not negative
+            const __m128 pairs = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(a, half)));
+
+            a = _mm_sub_ps(a, _mm_mul_ps(pairs, two));
+            a = _mm_min_ps(a, _mm_sub_ps(two, a));
+        }
+        else
+        {
+            a = _mm_min_ps(a, one);
+        }
+
+        bytes[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, max), half));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(coverage),
+                     _mm_packus_epi16(_mm_packs_epi32(bytes[0], bytes[1]),
+                                      _mm_packs_epi32(bytes[2], bytes[3])));
+
+    return _mm_cvtss_f32(sum);
+}
+
+// the coverage of 4 pixels repeated in all the bytes of each pixel
+inline __m128i LoadCoverageSSE2(const unsigned char* coverage)
+{
+    int value;
+
+    memcpy(&value, coverage, sizeof(value));
+
+    const __m128i c = _mm_cvtsi32_si128(value);
+    const __m128i pairs = _mm_unpacklo_epi8(c, c);
+
+    return _mm_unpacklo_epi16(pairs, pairs);
+}
+
+// composites 2 pixels with 16-bit channels, see BlendPixel()
+inline __m128i BlendPixelsSSE2(__m128i dst, __m128i src, __m128i coverage)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i max = _mm_set1_epi16(255);
+
+    __m128i t = _mm_mullo_epi16(src, coverage);
+    const __m128i s = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, one), _mm_srli_epi16(t, 8)), 8);
+
+    __m128i alpha = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+    t = _mm_mullo_epi16(dst, _mm_sub_epi16(max, alpha));
+
+    const __m128i d = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, one), _mm_srli_epi16(t, 8)), 8);
+
+    return _mm_add_epi16(s, d);
+}
+
+inline void Blend4SSE2(unsigned char* dst, __m128i src, const unsigned char* coverage)
+{
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+    const __m128i cover  = LoadCoverageSSE2(coverage);
+
+    const __m128i lo = BlendPixelsSSE2(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(src, zero),
+                                       _mm_unpacklo_epi8(cover, zero));
+    const __m128i hi = BlendPixelsSSE2(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(src, zero),
+                                       _mm_unpackhi_epi8(cover, zero));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+}
+
+void BlendSSE2(unsigned char* dst, const unsigned char* src, const unsigned char* coverage, int count)
+{
+    int i = 0;
+
+    for ( ; i + 4 <= count; i += 4 )
+        Blend4SSE2(dst + i * 4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)), coverage + i);
+
+    BlendScalar(dst + i * 4, src + i * 4, coverage + i, count - i);
+}
+
+void BlendColorSSE2(unsigned char* dst, const unsigned char* color, const unsigned char* coverage, int count)
+{
+    int value;
+
+    memcpy(&value, color, sizeof(value));
+
+    const __m128i src = _mm_set1_epi32(value);
+    int           i = 0;
+
+    for ( ; i + 4 <= count; i += 4 )
+        Blend4SSE2(dst + i * 4, src, coverage + i);
+
+    BlendColorScalar(dst + i * 4, color, coverage + i, count - i);
+}
+
+const Kernels SSE2Kernels =
+{
+    AccumulateSSE2,
+    BlendSSE2,
+    BlendColorSSE2
+};
+
+// ----------------------------------------------------------------------------
+// AVX2 kernels, compositing 8 pixels at once
+// ----------------------------------------------------------------------------
+
+// the coverage of 8 pixels repeated in all the bytes of each pixel
+wxSVG_TARGET_AVX2
+inline __m256i LoadCoverageAVX2(const unsigned char* coverage)
+{
+    const __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage)));
+
+    return _mm256_mullo_epi32(c, _mm256_set1_epi32(0x01010101));
+}
+
+// composites 4 pixels with 16-bit channels, see BlendPixelsSSE2()
+wxSVG_TARGET_AVX2
+inline __m256i BlendPixelsAVX2(__m256i dst, __m256i src, __m256i coverage)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i max = _mm256_set1_epi16(255);
+
+    __m256i t = _mm256_mullo_epi16(src, coverage);
+    const __m256i s = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, one), _mm256_srli_epi16(t, 8)), 8);
+
+    __m256i alpha = _mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+
+    alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+    t = _mm256_mullo_epi16(dst, _mm256_sub_epi16(max, alpha));
+
+    const __m256i d = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, one), _mm256_srli_epi16(t, 8)), 8);
+
+    return _mm256_add_epi16(s, d);
+}
+
+// unpacking and packing work within 128-bit lanes, so the pixels stay in order
+wxSVG_TARGET_AVX2
+inline void Blend8AVX2(unsigned char* dst, __m256i src, const unsigned char* coverage)
+{
+    const __m256i zero   = _mm256_setzero_si256();
+    const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+    const __m256i cover  = LoadCoverageAVX2(coverage);
+
+    const __m256i lo = BlendPixelsAVX2(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpacklo_epi8(src, zero),
+                                       _mm256_unpacklo_epi8(cover, zero));
+    const __m256i hi = BlendPixelsAVX2(_mm256_unpackhi_epi8(pixels, zero), _mm256_unpackhi_epi8(src, zero),
+                                       _mm256_unpackhi_epi8(cover, zero));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_packus_epi16(lo, hi));
+}
+
+wxSVG_TARGET_AVX2
+void BlendAVX2(unsigned char* dst, const unsigned char* src, const unsigned char* coverage, int count)
+{
+    int i = 0;
+
+    for ( ; i + 8 <= count; i += 8 )
+        Blend8AVX2(dst + i * 4, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4)), coverage + i);
+
+    BlendScalar(dst + i * 4, src + i * 4, coverage + i, count - i);
+}
+
+wxSVG_TARGET_AVX2
+void BlendColorAVX2(unsigned char* dst, const unsigned char* color, const unsigned char* coverage, int count)
+{
+    int value;
+
+    memcpy(&value, color, sizeof(value));
+
+    const __m256i src = _mm256_set1_epi32(value);
+    int           i = 0;
+
+    for ( ; i + 8 <= count; i += 8 )
+        Blend8AVX2(dst + i * 4, src, coverage + i);
+
+    BlendColorScalar(dst + i * 4, color, coverage + i, count - i);
+}
+
+// The prefix sum is a chain of dependent additions, which wider vectors
+// would not shorten, and it must add in the same order everywhere
+// to give the same coverage, so only compositing uses AVX2.
+const Kernels AVX2Kernels =
+{
+    AccumulateSSE2,
+    BlendAVX2,
+    BlendColorAVX2
+};
+
+#endif // #ifdef wxSVG_TILE_X86_64
+
+inline const Kernels& GetKernels()
+{
+    switch ( wxSVGPixelConverter::GetInstructionSet() )
+    {
+#ifdef wxSVG_TILE_X86_64
+        case wxSVGPixelConverter::InstructionSet_SSE2:
+            return SSE2Kernels;
+        case wxSVGPixelConverter::InstructionSet_AVX2:
+            return AVX2Kernels;
+#endif // #ifdef wxSVG_TILE_X86_64
+        default:
+            return ScalarKernels;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// paints
+// ----------------------------------------------------------------------------
+
+// NanoSVG colours are 0xAABBGGRR, opacity is that of the whole shape
+void GetPremultipliedColor(unsigned int color, float opacity, unsigned char* rgba)
+{
+    const unsigned alpha = static_cast<unsigned>(((color >> 24) & 0xff) * opacity + 0.5f);
+
+    rgba[0] = static_cast<unsigned char>(((color & 0xff) * alpha + 127) / 255);
+    rgba[1] = static_cast<unsigned char>((((color >> 8) & 0xff) * alpha + 127) / 255);
+    rgba[2] = static_cast<unsigned char>((((color >> 16) & 0xff) * alpha + 127) / 255);
+    rgba[3] = static_cast<unsigned char>(alpha);
+}
+
+// the colour between c0 and c1 at u from 0 to 1, not premultiplied
+unsigned int LerpColor(unsigned int c0, unsigned int c1, float u)
+{
+    unsigned int color = 0;
+
+    for ( int shift = 0; shift < 32; shift += 8 )
+    {
+        const float v0 = static_cast<float>((c0 >> shift) & 0xff);
+        const float v1 = static_cast<float>((c1 >> shift) & 0xff);
+
+        color |= static_cast<unsigned int>(v0 + (v1 - v0) * u + 0.5f) << shift;
+    }
+
+    return color;
+}
+
+// The paint of the shape being composited: a premultiplied colour or
+// a gradient, whose 256 premultiplied colours are built the same way
+// as by the NanoSVG rasterizer
+class PaintSource
+{
+public:
+    // returns false if there is nothing to paint
+    bool Init(const NSVGpaint& paint, float opacity, float tx, float ty, float scale)
+    {
+        opacity = wxMax(0.0f, wxMin(opacity, 1.0f));
+
+        switch ( paint.type )
+        {
+            case NSVG_PAINT_COLOR:
+                m_isGradient = false;
+                GetPremultipliedColor(paint.color, opacity, m_color);
+                return m_color[3] != 0;
+
+            case NSVG_PAINT_LINEAR_GRADIENT:
+            case NSVG_PAINT_RADIAL_GRADIENT:
+                m_isGradient = true;
+                m_isRadial   = paint.type == NSVG_PAINT_RADIAL_GRADIENT;
+                InitGradient(*paint.gradient, opacity, tx, ty, scale);
+                return true;
+        }
+
+        return false;
+    }
+
+    bool IsGradient() const { return m_isGradient; }
+    bool IsOpaqueColor() const { return !m_isGradient && m_color[3] == 255; }
+    const unsigned char* GetColor() const { return m_color; }
+
+    // stores the premultiplied colours of count pixels from (x, y)
+    void GetGradientColors(int x, int y, int count, unsigned char* rgba) const
+    {
+        // at the pixel centres
+        const float px = x + 0.5f;
+        const float py = y + 0.5f;
+
+        float gx = px * m_xform[0] + py * m_xform[2] + m_xform[4];
+        float gy = px * m_xform[1] + py * m_xform[3] + m_xform[5];
+
+        for ( int i = 0; i < count; ++i, rgba += 4 )
+        {
+            const float t = m_isRadial ? std::sqrt(gx * gx + gy * gy) : gy;
+
+            memcpy(rgba, &m_colors[GetColorIndex(t) * 4], 4);
+
+            gx += m_xform[0];
+            gy += m_xform[1];
+        }
+    }
+
+private:
+    bool          m_isGradient{false};
+    bool          m_isRadial{false};
+    int           m_spread{NSVG_SPREAD_PAD};
+    unsigned char m_color[4] = { 0, 0, 0, 0 };
+    // from the pixel coordinates to the gradient ones, where a linear
+    // gradient goes from (0, 0) to (0, 1) and a radial one is the unit
+    // circle centered at (0, 0)
+    float         m_xform[6];
+    unsigned char m_colors[256 * 4];
+
+    void InitGradient(const NSVGgradient& gradient, float opacity, float tx, float ty, float scale)
+    {
+        const float* t = gradient.xform;
+
+        // the pixel coordinates are the image ones scaled and translated
+        m_xform[0] = t[0] / scale;
+        m_xform[1] = t[1] / scale;
+        m_xform[2] = t[2] / scale;
+        m_xform[3] = t[3] / scale;
+        m_xform[4] = t[4] - (tx * t[0] + ty * t[2]) / scale;
+        m_xform[5] = t[5] - (tx * t[1] + ty * t[3]) / scale;
+
+        m_spread = gradient.spread;
+
+        unsigned int colors[256];
+
+        if ( gradient.nstops == 0 )
+        {
+            std::fill_n(colors, 256, 0u);
+        }
+        else if ( gradient.nstops == 1 )
+        {
+            std::fill_n(colors, 256, gradient.stops[0].color);
+        }
+        else
+        {
+            const NSVGgradientStop* stops = gradient.stops;
+            const int               last  = gradient.nstops - 1;
+
+            // before the first stop and after the last one
+            const int first = static_cast<int>(wxMax(0.0f, wxMin(stops[0].offset, 1.0f)) * 255.0f);
+            const int end   = static_cast<int>(wxMax(0.0f, wxMin(stops[last].offset, 1.0f)) * 255.0f);
+
+            std::fill_n(colors, first, stops[0].color);
+            std::fill(colors + wxMax(first, end), colors + 256, stops[last].color);
+
+            for ( int i = 0; i < last; ++i )
+            {
+                const int i0 = static_cast<int>(wxMax(0.0f, wxMin(stops[i].offset, 1.0f)) * 255.0f);
+                const int i1 = static_cast<int>(wxMax(0.0f, wxMin(stops[i + 1].offset, 1.0f)) * 255.0f);
+
+                for ( int j = i0; j < i1; ++j )
+                    colors[j] = LerpColor(stops[i].color, stops[i + 1].color, static_cast<float>(j - i0) / (i1 - i0));
+            }
+        }
+
+        for ( int i = 0; i < 256; ++i )
+            GetPremultipliedColor(colors[i], opacity, &m_colors[i * 4]);
+    }
+
+    int GetColorIndex(float t) const
+    {
+        switch ( m_spread )
+        {
+            case NSVG_SPREAD_REFLECT:
+                t = std::fabs(t);
+                t -= 2.0f * std::floor(t * 0.5f);
+                if ( t > 1.0f )
+                    t = 2.0f - t;
+                break;
+
+            case NSVG_SPREAD_REPEAT:
+                t -= std::floor(t);
+                break;
+        }
+
+        // also for NaN
+        if ( !(t > 0.0f) )
+            return 0;
+        if ( t >= 1.0f )
+            return 255;
+
+        return static_cast<int>(t * 255.0f + 0.5f);
+    }
+};
+
+// ----------------------------------------------------------------------------
+// geometry helpers
+// ----------------------------------------------------------------------------
+
+inline void AddPoint(std::vector<float>& points, float x, float y)
+{
+    const size_t size = points.size();
+
+    // a zero length segment has no direction for the stroke
+    if ( size >= 2 && points[size - 2] == x && points[size - 1] == y )
+        return;
+
+    points.push_back(x);
+    points.push_back(y);
+}
+
+// Adds the points of the cubic Bezier curve from (x0, y0) to (x3, y3),
+// except the first one, with FlatteningTolerance
+void FlattenCubic(std::vector<float>& points,
+                  float x0, float y0, float x1, float y1,
+                  float x2, float y2, float x3, float y3)
+{
+    // the flattening error with n uniform steps is at most 3/4 of
+    // the largest second difference of the control points divided by n^2
+    const float ddx = wxMax(std::fabs(x0 - 2 * x1 + x2), std::fabs(x1 - 2 * x2 + x3));
+    const float ddy = wxMax(std::fabs(y0 - 2 * y1 + y2), std::fabs(y1 - 2 * y2 + y3));
+    const float dd  = std::sqrt(ddx * ddx + ddy * ddy);
+
+    const float n = std::ceil(std::sqrt(0.75f * dd / FlatteningTolerance));
+    // also for NaN
+    const int   steps = n < 100 ? wxMax(1, static_cast<int>(n)) : 100;
+
+    for ( int i = 1; i < steps; ++i )
+    {
+        const float t  = static_cast<float>(i) / steps;
+        const float u  = 1 - t;
+        const float b0 = u * u * u;
+        const float b1 = 3 * u * u * t;
+        const float b2 = 3 * u * t * t;
+        const float b3 = t * t * t;
+
+        AddPoint(points, b0 * x0 + b1 * x1 + b2 * x2 + b3 * x3,
+                         b0 * y0 + b1 * y1 + b2 * y2 + b3 * y3);
+    }
+
+    AddPoint(points, x3, y3);
+}
+
+// Stores the regular polygon approximating the circle with
+// FlatteningTolerance in points, which must have room for 256 points,
+// returns their count
+int GetCirclePoints(float cx, float cy, float r, float* points)
+{
+    int count = 8;
+
+    if ( r > FlatteningTolerance )
+    {
+        const float step = 2.0f * std::acos(1.0f - FlatteningTolerance / r);
+
+        count = wxMax(8, wxMin(static_cast<int>(std::ceil(2.0f * Pi / step)), 256));
+    }
+
+    for ( int i = 0; i < count; ++i )
+    {
+        const float angle = 2.0f * Pi * i / count;
+
+        points[i * 2]     = cx + r * std::cos(angle);
+        points[i * 2 + 1] = cy + r * std::sin(angle);
+    }
+
+    return count;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxSVGTileRasterizer implementation
+// ============================================================================
+
+wxSVGTileRasterizer::wxSVGTileRasterizer()
+{
+}
+
+bool wxSVGTileRasterizer::Rasterize(const NSVGimage* image, float tx, float ty, float scale,
+                                    unsigned char* dst, int width, int height, int stride)
+{
+    wxCHECK_MSG(image && dst, false, "null image or buffer");
+
+    if ( width <= 0 || height <= 0 || !(scale > 0) )
+        return false;
+
+    SetSize(width, height);
+
+    m_band.top    = 0;
+    m_band.bottom = height;
+    ResetTiles(m_band);
+
+    for ( int y = 0; y < height; ++y )
+        memset(dst + static_cast<size_t>(y) * stride, 0, static_cast<size_t>(width) * 4);
+
+    // each paint is composited as soon as its lines are accumulated
+    m_lines.clear();
+    AddPaints(image, tx, ty, scale,
+        [&](const NSVGshape& shape, const NSVGpaint& paint, bool evenOdd)
+        {
+            for ( size_t i = 0; i < m_lines.size(); i += 4 )
+                AccumulateLine(m_band, &m_lines[i]);
+
+            FillPaint(m_band, paint, shape.opacity, evenOdd, tx, ty, scale, dst, stride);
+            m_lines.clear();
+        });
+
+    return true;
+}
+
+bool wxSVGTileRasterizer::RasterizeBands(const NSVGimage* image, float tx, float ty, float scale,
+                                         unsigned char* dst, int width, int height, int stride,
+                                         wxTestSVGThreadPool& pool, int bandHeight)
+{
+    wxCHECK_MSG(image && dst, false, "null image or buffer");
+
+    if ( width <= 0 || height <= 0 || !(scale > 0) )
+        return false;
+
+    SetSize(width, height);
+
+    if ( bandHeight <= 0 )
+        bandHeight = height / static_cast<int>(pool.GetThreadCount() * BandsPerThread);
+
+    // whole tile rows, so that the bands do not share any tile
+    bandHeight = wxMax(1, (bandHeight + TileSize - 1) / TileSize) * TileSize;
+
+    const size_t bandCount = static_cast<size_t>((height + bandHeight - 1) / bandHeight);
+
+    m_bands.resize(bandCount);
+    for ( size_t b = 0; b < bandCount; ++b )
+    {
+        Band& band = m_bands[b];
+
+        band.top    = static_cast<int>(b) * bandHeight;
+        band.bottom = wxMin(band.top + bandHeight, height);
+        band.lines.clear();
+        band.paintEnds.clear();
+        ResetTiles(band);
+    }
+
+    // the lines of all the paints are flattened, stroked, and clipped once
+    m_lines.clear();
+    m_paints.clear();
+    AddPaints(image, tx, ty, scale,
+        [&](const NSVGshape& shape, const NSVGpaint& paint, bool evenOdd)
+        {
+            const Paint p = { &paint, shape.opacity, evenOdd, m_lines.size() / 4 };
+
+            m_paints.push_back(p);
+        });
+
+    // and sorted into the bands of the rows AccumulateLine() changes
+    size_t line = 0;
+
+    for ( const auto& p : m_paints )
+    {
+        for ( ; line < p.lineEnd; ++line )
+        {
+            const float* l      = &m_lines[line * 4];
+            const float  yStart = wxMax(wxMin(l[1], l[3]), 0.0f);
+            const float  yEnd   = wxMin(wxMax(l[1], l[3]), static_cast<float>(height));
+
+            if ( !(yStart < yEnd) )
+                continue;
+
+            const int first = static_cast<int>(yStart) / bandHeight;
+            const int last  = (static_cast<int>(std::ceil(yEnd)) - 1) / bandHeight;
+
+            for ( int b = first; b <= last; ++b )
+                m_bands[b].lines.push_back(static_cast<unsigned>(line));
+        }
+
+        for ( auto& band : m_bands )
+            band.paintEnds.push_back(band.lines.size());
+    }
+
+    pool.ParallelFor(bandCount, [&](size_t index, size_t)
+        {
+            Band& band = m_bands[index];
+
+            for ( int y = band.top; y < band.bottom; ++y )
+                memset(dst + static_cast<size_t>(y) * stride, 0, static_cast<size_t>(width) * 4);
+
+            size_t begin = 0;
+
+            for ( size_t p = 0; p < m_paints.size(); ++p )
+            {
+                const size_t end = band.paintEnds[p];
+
+                if ( begin == end )
+                    continue;
+
+                for ( size_t i = begin; i < end; ++i )
+                    AccumulateLine(band, &m_lines[band.lines[i] * static_cast<size_t>(4)]);
+
+                FillPaint(band, *m_paints[p].paint, m_paints[p].opacity, m_paints[p].evenOdd,
+                          tx, ty, scale, dst, stride);
+                begin = end;
+            }
+        });
+
+    return true;
+}
+
+void wxSVGTileRasterizer::SetSize(int width, int height)
+{
+    if ( width == m_width && height == m_height )
+        return;
+
+    m_width      = width;
+    m_height     = height;
+    m_tilesX     = (width + TileSize - 1) / TileSize;
+    m_tilesY     = (height + TileSize - 1) / TileSize;
+    m_cellStride = static_cast<size_t>(m_tilesX) * TileSize + CellPadding;
+
+    m_tiles.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0);
+    m_cells.assign(m_cellStride * height, 0.0f);
+}
+
+// static
+void wxSVGTileRasterizer::ResetTiles(Band& band)
+{
+    band.minTileX = band.minTileY = INT_MAX;
+    band.maxTileX = band.maxTileY = -1;
+}
+
+void wxSVGTileRasterizer::AddPaints(const NSVGimage* image, float tx, float ty, float scale,
+                                    const AddPaintFn& addPaint)
+{
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        if ( !(shape->flags & NSVG_FLAGS_VISIBLE) )
+            continue;
+
+        const float strokeWidth = shape->strokeWidth * scale;
+        const bool  hasFill     = shape->fill.type != NSVG_PAINT_NONE;
+        const bool  hasStroke   = shape->stroke.type != NSVG_PAINT_NONE && strokeWidth > 0;
+
+        if ( !hasFill && !hasStroke )
+            continue;
+
+        FlattenShape(shape, tx, ty, scale);
+
+        if ( hasFill )
+        {
+            AddFillLines();
+            addPaint(*shape, shape->fill, shape->fillRule == NSVG_FILLRULE_EVENODD);
+        }
+
+        if ( hasStroke )
+        {
+            if ( shape->strokeDashCount > 0 )
+            {
+                DashPolylines(shape, scale);
+                AddStrokeLines(m_dashPoints, m_dashPolylines, strokeWidth,
+                               shape->strokeLineJoin, shape->strokeLineCap, shape->miterLimit);
+            }
+            else
+            {
+                AddStrokeLines(m_points, m_polylines, strokeWidth,
+                               shape->strokeLineJoin, shape->strokeLineCap, shape->miterLimit);
+            }
+
+            // the overlapping parts of the stroke are always non-zero
+            addPaint(*shape, shape->stroke, false);
+        }
+    }
+}
+
+void wxSVGTileRasterizer::FlattenShape(const NSVGshape* shape, float tx, float ty, float scale)
+{
+    m_points.clear();
+    m_polylines.clear();
+
+    // NanoSVG converts all the path segments to cubic Bezier curves
+    for ( const NSVGpath* path = shape->paths; path; path = path->next )
+    {
+        if ( path->npts < 1 )
+            continue;
+
+        const float* p     = path->pts;
+        const int    first = static_cast<int>(m_points.size() / 2);
+
+        m_points.push_back(p[0] * scale + tx);
+        m_points.push_back(p[1] * scale + ty);
+
+        for ( int i = 0; i + 3 < path->npts; i += 3, p += 6 )
+        {
+            FlattenCubic(m_points,
+                         m_points[m_points.size() - 2], m_points[m_points.size() - 1],
+                         p[2] * scale + tx, p[3] * scale + ty,
+                         p[4] * scale + tx, p[5] * scale + ty,
+                         p[6] * scale + tx, p[7] * scale + ty);
+        }
+
+        const int count = static_cast<int>(m_points.size() / 2) - first;
+
+        m_polylines.push_back(first);
+        m_polylines.push_back(path->closed ? -count : count);
+    }
+}
+
+void wxSVGTileRasterizer::DashPolylines(const NSVGshape* shape, float scale)
+{
+    m_dashPoints.clear();
+    m_dashPolylines.clear();
+
+    const int dashCount = wxMin(static_cast<int>(shape->strokeDashCount), 8);
+    float     dashes[8];
+    float     patternLength = 0;
+
+    for ( int i = 0; i < dashCount; ++i )
+    {
+        dashes[i] = wxMax(0.0f, shape->strokeDashArray[i]) * scale;
+        patternLength += dashes[i];
+    }
+
+    // an odd count of dashes is repeated to get the gaps too
+    if ( dashCount & 1 )
+        patternLength *= 2;
+
+    float pathLength = 0;
+
+    for ( size_t p = 0; p < m_polylines.size(); p += 2 )
+    {
+        const float* points = &m_points[m_polylines[p] * 2];
+        const int    count  = std::abs(m_polylines[p + 1]);
+        const int    segmentCount = m_polylines[p + 1] < 0 ? count : count - 1;
+
+        for ( int s = 0; s < segmentCount; ++s )
+        {
+            const float* a = points + s * 2;
+            const float* b = points + ((s + 1) % count) * 2;
+
+            pathLength += std::sqrt((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]));
+        }
+    }
+
+    if ( !(patternLength > 0) || !(pathLength / patternLength * dashCount < MaxDashCount) )
+    {
+        m_dashPoints = m_points;
+        m_dashPolylines = m_polylines;
+        return;
+    }
+
+    for ( size_t p = 0; p < m_polylines.size(); p += 2 )
+    {
+        const float* points = &m_points[m_polylines[p] * 2];
+        const int    count  = std::abs(m_polylines[p + 1]);
+        const bool   closed = m_polylines[p + 1] < 0;
+
+        // every path starts with the dash offset, the same as in NanoSVG
+        float offset = std::fmod(shape->strokeDashOffset * scale, patternLength);
+
+        if ( offset < 0 )
+            offset += patternLength;
+
+        // the dashes and gaps alternate, an odd count of them is
+        // repeated with the dashes becoming gaps and vice versa
+        int  dash = 0;
+        bool isOn = true;
+
+        while ( offset > dashes[dash] )
+        {
+            offset -= dashes[dash];
+            dash = (dash + 1) % dashCount;
+            isOn = !isOn;
+        }
+
+        float remaining = dashes[dash] - offset;
+        int   first = -1;
+
+        auto startDash = [&](float x, float y)
+        {
+            first = static_cast<int>(m_dashPoints.size() / 2);
+            m_dashPoints.push_back(x);
+            m_dashPoints.push_back(y);
+        };
+
+        auto endDash = [&]()
+        {
+            const int dashPointCount = static_cast<int>(m_dashPoints.size() / 2) - first;
+
+            if ( dashPointCount > 1 )
+            {
+                m_dashPolylines.push_back(first);
+                m_dashPolylines.push_back(dashPointCount);
+            }
+            else
+            {
+                m_dashPoints.resize(first * 2);
+            }
+
+            first = -1;
+        };
+
+        if ( isOn )
+            startDash(points[0], points[1]);
+
+        const int segmentCount = closed ? count : count - 1;
+
+        for ( int s = 0; s < segmentCount; ++s )
+        {
+            const float* a = points + s * 2;
+            const float* b = points + ((s + 1) % count) * 2;
+            const float  dx = b[0] - a[0];
+            const float  dy = b[1] - a[1];
+            const float  length = std::sqrt(dx * dx + dy * dy);
+            float        pos = 0;
+
+            while ( length - pos > remaining )
+            {
+                pos += remaining;
+
+                const float x = a[0] + dx * pos / length;
+                const float y = a[1] + dy * pos / length;
+
+                if ( isOn )
+                {
+                    AddPoint(m_dashPoints, x, y);
+                    endDash();
+                }
+                else
+                {
+                    startDash(x, y);
+                }
+
+                isOn      = !isOn;
+                dash      = (dash + 1) % dashCount;
+                remaining = dashes[dash];
+            }
+
+            remaining -= length - pos;
+
+            if ( isOn )
+                AddPoint(m_dashPoints, b[0], b[1]);
+        }
+
+        if ( isOn )
+            endDash();
+    }
+}
+
+void wxSVGTileRasterizer::AddFillLines()
+{
+    for ( size_t p = 0; p < m_polylines.size(); p += 2 )
+    {
+        const float* points = &m_points[m_polylines[p] * 2];
+        const int    count  = std::abs(m_polylines[p + 1]);
+
+        // filling always closes the path, the direction of the lines
+        // gives the winding number
+        for ( int i = 0, j = count - 1; i < count; j = i++ )
+            AddLine(points[j * 2], points[j * 2 + 1], points[i * 2], points[i * 2 + 1]);
+    }
+}
+
+void wxSVGTileRasterizer::AddStrokeLines(const std::vector<float>& points,
+                                         const std::vector<int>& polylines,
+                                         float width, int lineJoin, int lineCap,
+                                         float miterLimit)
+{
+    // The stroke is the union of the quads of the segments, the joins at
+    // the vertices, and the caps at the ends of the open polylines, all of
+    // them with positive winding numbers, which the non-zero rule unites.
+    // Round joins and caps are just circles at the vertices and ends.
+    const float halfWidth = width / 2;
+    float       polygon[256 * 2];
+
+    for ( size_t p = 0; p < polylines.size(); p += 2 )
+    {
+        const float* pts    = &points[polylines[p] * 2];
+        int          count  = std::abs(polylines[p + 1]);
+        const bool   closed = polylines[p + 1] < 0;
+
+        // a closed path usually ends where it starts
+        while ( closed && count > 1
+                && pts[(count - 1) * 2] == pts[0] && pts[(count - 1) * 2 + 1] == pts[1] )
+        {
+            --count;
+        }
+
+        if ( count == 1 )
+        {
+            // a dot, which only round and square caps paint
+            if ( lineCap == NSVG_CAP_ROUND )
+            {
+                AddPolygon(polygon, GetCirclePoints(pts[0], pts[1], halfWidth, polygon));
+            }
+            else if ( lineCap == NSVG_CAP_SQUARE )
+            {
+                const float square[] =
+                {
+                    pts[0] - halfWidth, pts[1] - halfWidth,
+                    pts[0] + halfWidth, pts[1] - halfWidth,
+                    pts[0] + halfWidth, pts[1] + halfWidth,
+                    pts[0] - halfWidth, pts[1] + halfWidth
+                };
+
+                AddPolygon(square, 4);
+            }
+
+            continue;
+        }
+
+        const int segmentCount = closed ? count : count - 1;
+
+        for ( int s = 0; s < segmentCount; ++s )
+        {
+            const float* a  = pts + s * 2;
+            const float* b  = pts + ((s + 1) % count) * 2;
+            const float  dx = b[0] - a[0];
+            const float  dy = b[1] - a[1];
+            const float  length = std::sqrt(dx * dx + dy * dy);
+
+            if ( !(length > 0) )
+                continue;
+
+            // the normal of the segment scaled to the half width
+            const float nx = -dy / length * halfWidth;
+            const float ny = dx / length * halfWidth;
+            const float quad[] =
+            {
+                a[0] + nx, a[1] + ny,
+                b[0] + nx, b[1] + ny,
+                b[0] - nx, b[1] - ny,
+                a[0] - nx, a[1] - ny
+            };
+
+            AddPolygon(quad, 4);
+        }
+
+        // the joins at all the vertices of a closed polyline
+        // but only at the inner ones of an open one
+        const int firstJoin = closed ? 0 : 1;
+        const int endJoin   = closed ? count : count - 1;
+
+        for ( int v = firstJoin; v < endJoin; ++v )
+        {
+            const float* prev = pts + ((v + count - 1) % count) * 2;
+            const float* curr = pts + v * 2;
+            const float* next = pts + ((v + 1) % count) * 2;
+
+            if ( lineJoin == NSVG_JOIN_ROUND )
+            {
+                AddPolygon(polygon, GetCirclePoints(curr[0], curr[1], halfWidth, polygon));
+                continue;
+            }
+
+            float dx0 = curr[0] - prev[0];
+            float dy0 = curr[1] - prev[1];
+            float dx1 = next[0] - curr[0];
+            float dy1 = next[1] - curr[1];
+
+            const float length0 = std::sqrt(dx0 * dx0 + dy0 * dy0);
+            const float length1 = std::sqrt(dx1 * dx1 + dy1 * dy1);
+
+            if ( !(length0 > 0 && length1 > 0) )
+                continue;
+
+            dx0 /= length0;
+            dy0 /= length0;
+            dx1 /= length1;
+            dy1 /= length1;
+
+            const float cross = dx0 * dy1 - dy0 * dx1;
+
+            // straight on, the quads meet exactly
+            if ( std::fabs(cross) < 1e-6f && dx0 * dx1 + dy0 * dy1 > 0 )
+                continue;
+
+            // the outer side is the one the polyline turns away from
+            const float side = cross > 0 ? -1.0f : 1.0f;
+            const float nx0  = -dy0 * side;
+            const float ny0  = dx0 * side;
+            const float nx1  = -dy1 * side;
+            const float ny1  = dx1 * side;
+
+            // the miter length relative to the half width is 1 / cos of
+            // half the angle between the normals
+            float       mx = nx0 + nx1;
+            float       my = ny0 + ny1;
+            const float m  = std::sqrt(mx * mx + my * my);
+
+            if ( lineJoin == NSVG_JOIN_MITER && m > 0 )
+            {
+                mx /= m;
+                my /= m;
+
+                const float cosHalf = mx * nx0 + my * ny0;
+
+                if ( cosHalf > 0 && 1.0f / cosHalf <= miterLimit )
+                {
+                    const float miterLength = halfWidth / cosHalf;
+                    const float miter[] =
+                    {
+                        curr[0], curr[1],
+                        curr[0] + nx0 * halfWidth, curr[1] + ny0 * halfWidth,
+                        curr[0] + mx * miterLength, curr[1] + my * miterLength,
+                        curr[0] + nx1 * halfWidth, curr[1] + ny1 * halfWidth
+                    };
+
+                    AddPolygon(miter, 4);
+                    continue;
+                }
+            }
+
+            // bevel, also for the miters over the limit
+            const float bevel[] =
+            {
+                curr[0], curr[1],
+                curr[0] + nx0 * halfWidth, curr[1] + ny0 * halfWidth,
+                curr[0] + nx1 * halfWidth, curr[1] + ny1 * halfWidth
+            };
+
+            AddPolygon(bevel, 3);
+        }
+
+        if ( closed || lineCap == NSVG_CAP_BUTT )
+            continue;
+
+        // the caps at both ends, d is the unit direction out of the polyline
+        for ( int end = 0; end < 2; ++end )
+        {
+            const float* e     = end ? pts + (count - 1) * 2 : pts;
+            const float* inner = end ? pts + (count - 2) * 2 : pts + 2;
+
+            if ( lineCap == NSVG_CAP_ROUND )
+            {
+                AddPolygon(polygon, GetCirclePoints(e[0], e[1], halfWidth, polygon));
+                continue;
+            }
+
+            const float dx = e[0] - inner[0];
+            const float dy = e[1] - inner[1];
+            const float length = std::sqrt(dx * dx + dy * dy);
+
+            if ( !(length > 0) )
+                continue;
+
+            const float ex = dx / length * halfWidth;
+            const float ey = dy / length * halfWidth;
+            const float square[] =
+            {
+                e[0] - ey, e[1] + ex,
+                e[0] - ey + ex, e[1] + ex + ey,
+                e[0] + ey + ex, e[1] - ex + ey,
+                e[0] + ey, e[1] - ex
+            };
+
+            AddPolygon(square, 4);
+        }
+    }
+}
+
+void wxSVGTileRasterizer::AddPolygon(const float* points, int count)
+{
+    if ( count < 3 )
+        return;
+
+    // twice the signed area
+    float area = 0;
+
+    for ( int i = 0, j = count - 1; i < count; j = i++ )
+        area += points[j * 2] * points[i * 2 + 1] - points[i * 2] * points[j * 2 + 1];
+
+    for ( int i = 0, j = count - 1; i < count; j = i++ )
+    {
+        if ( area >= 0 )
+            AddLine(points[j * 2], points[j * 2 + 1], points[i * 2], points[i * 2 + 1]);
+        else
+            AddLine(points[i * 2], points[i * 2 + 1], points[j * 2], points[j * 2 + 1]);
+    }
+}
+
+void wxSVGTileRasterizer::AddLine(float x0, float y0, float x1, float y1)
+{
+    if ( y0 == y1 || !(std::isfinite(x0) && std::isfinite(y0) && std::isfinite(x1) && std::isfinite(y1)) )
+        return;
+
+    const float bottom = static_cast<float>(m_height);
+    const float right  = static_cast<float>(m_width);
+
+    if ( (y0 <= 0 && y1 <= 0) || (y0 >= bottom && y1 >= bottom) )
+        return;
+
+    // the parts right of the image would change only the cells right of it
+    if ( x0 >= right && x1 >= right )
+        return;
+
+    if ( x0 > right || x1 > right )
+    {
+        const float y = y0 + (y1 - y0) * (right - x0) / (x1 - x0);
+
+        if ( x0 > right )
+        {
+            x0 = right;
+            y0 = y;
+        }
+        else
+        {
+            x1 = right;
+            y1 = y;
+        }
+    }
+
+    const auto addLine = [this](float xa, float ya, float xb, float yb)
+    {
+        m_lines.push_back(xa);
+        m_lines.push_back(ya);
+        m_lines.push_back(xb);
+        m_lines.push_back(yb);
+    };
+
+    // the parts left of the image still change the winding number of
+    // the whole row, they are moved onto its left edge
+    if ( x0 <= 0 && x1 <= 0 )
+    {
+        addLine(0, y0, 0, y1);
+        return;
+    }
+
+    if ( x0 < 0 || x1 < 0 )
+    {
+        const float y = y0 + (y1 - y0) * (0 - x0) / (x1 - x0);
+
+        if ( x0 < 0 )
+        {
+            addLine(0, y0, 0, y);
+            x0 = 0;
+            y0 = y;
+        }
+        else
+        {
+            addLine(0, y, 0, y1);
+            x1 = 0;
+            y1 = y;
+        }
+    }
+
+    addLine(x0, y0, x1, y1);
+}
+
+// Adds the area the line covers in each cell, signed by its direction, and
+// marks the touched tiles. The line is within 0 <= x <= m_width, a pixel's
+// coverage is then the sum of its cell and all the cells left of it.
+void wxSVGTileRasterizer::AccumulateLine(Band& band, const float* line)
+{
+    float x0 = line[0];
+    float y0 = line[1];
+    float x1 = line[2];
+    float y1 = line[3];
+
+    if ( y0 == y1 )
+        return;
+
+    float direction = 1.0f;
+
+    if ( y0 > y1 )
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        direction = -1.0f;
+    }
+
+    const float right  = static_cast<float>(m_width);
+    const float dxdy   = (x1 - x0) / (y1 - y0);
+    const float yStart = wxMax(y0, 0.0f);
+    const float yEnd   = wxMin(y1, static_cast<float>(m_height));
+
+    if ( !(yStart < yEnd) )
+        return;
+
+    // The x at the top and bottom of each row is computed from the line
+    // alone, not by stepping from the previous row, so that the rows
+    // of a band are the same whichever row the band starts at
+    const int yFirst = wxMax(static_cast<int>(yStart), band.top);
+    const int yLast  = wxMin(static_cast<int>(std::ceil(yEnd)) - 1, band.bottom - 1);
+
+    for ( int y = yFirst; y <= yLast; ++y )
+    {
+        const float ya = wxMax(static_cast<float>(y), yStart);
+        const float yb = wxMin(y + 1.0f, yEnd);
+        const float dy = yb - ya;
+        // rounding must not move the line out of the image
+        const float x     = wxMax(0.0f, wxMin(x0 + (ya - y0) * dxdy, right));
+        const float xNext = wxMax(0.0f, wxMin(x0 + (yb - y0) * dxdy, right));
+        const float d     = dy * direction;
+
+        const float xa = wxMin(x, xNext);
+        const float xb = wxMax(x, xNext);
+        const float xaFloor = std::floor(xa);
+        const int   xai = static_cast<int>(xaFloor);
+        const int   xbi = static_cast<int>(std::ceil(xb));
+        int         xLast;
+
+        float* cells = &m_cells[y * m_cellStride];
+
+        if ( xbi <= xai + 1 )
+        {
+            // within a single pixel: its cell gets the area right of the line
+            // and the next one the rest of the winding number change
+            const float xmf = 0.5f * (x + xNext) - xaFloor;
+
+            cells[xai] += d - d * xmf;
+            cells[xai + 1] += d * xmf;
+            xLast = xai + 1;
+        }
+        else
+        {
+            const float s   = 1.0f / (xb - xa);
+            const float xaf = xa - xaFloor;
+            const float a0  = 0.5f * s * (1 - xaf) * (1 - xaf);
+            const float xbf = xb - xbi + 1.0f;
+            const float am  = 0.5f * s * xbf * xbf;
+
+            cells[xai] += d * a0;
+
+            if ( xbi == xai + 2 )
+            {
+                cells[xai + 1] += d * (1 - a0 - am);
+            }
+            else
+            {
+                const float a1 = s * (1.5f - xaf);
+
+                cells[xai + 1] += d * (a1 - a0);
+                for ( int xi = xai + 2; xi < xbi - 1; ++xi )
+                    cells[xi] += d * s;
+
+                const float a2 = a1 + (xbi - xai - 3) * s;
+
+                cells[xbi - 1] += d * (1 - a2 - am);
+            }
+
+            cells[xbi] += d * am;
+            xLast = xbi;
+        }
+
+        // the cells past the last tile are never read
+        const int tileY     = y / TileSize;
+        const int tileFirst = xai / TileSize;
+        const int tileLast  = wxMin(xLast / TileSize, m_tilesX - 1);
+
+        if ( tileFirst <= tileLast )
+        {
+            memset(&m_tiles[tileY * m_tilesX + tileFirst], 1, tileLast - tileFirst + 1);
+
+            band.minTileX = wxMin(band.minTileX, tileFirst);
+            band.maxTileX = wxMax(band.maxTileX, tileLast);
+            band.minTileY = wxMin(band.minTileY, tileY);
+            band.maxTileY = wxMax(band.maxTileY, tileY);
+        }
+    }
+}
+
+void wxSVGTileRasterizer::FillPaint(Band& band, const NSVGpaint& paint, float opacity, bool evenOdd,
+                                    float tx, float ty, float scale,
+                                    unsigned char* dst, int stride)
+{
+    // nothing was accumulated
+    if ( band.maxTileX < band.minTileX )
+        return;
+
+    const Kernels& kernels = GetKernels();
+    PaintSource    source;
+    const bool     hasPaint = source.Init(paint, opacity, tx, ty, scale);
+
+    unsigned char coverage[TileSize];
+    unsigned char colors[TileSize * 4];
+    wxUint32      opaqueColor;
+
+    memcpy(&opaqueColor, source.GetColor(), sizeof(opaqueColor));
+
+    for ( int tileY = band.minTileY; tileY <= band.maxTileY; ++tileY )
+    {
+        const unsigned char* tiles = &m_tiles[tileY * m_tilesX];
+        const int            yEnd  = wxMin((tileY + 1) * TileSize, m_height);
+
+        for ( int y = tileY * TileSize; y < yEnd; ++y )
+        {
+            float*         cells = &m_cells[y * m_cellStride];
+            unsigned char* row   = dst + static_cast<size_t>(y) * stride;
+            float          carry = 0;
+
+            // Nothing was accumulated left of the first touched tile, so
+            // the sum starts from zero there. The row continues to the right
+            // edge, as the lines right of the image were dropped and
+            // the shape may cover the rest of the row.
+            for ( int tileX = band.minTileX; tileX < m_tilesX; ++tileX )
+            {
+                const int x     = tileX * TileSize;
+                const int count = wxMin(TileSize, m_width - x);
+
+                if ( tiles[tileX] )
+                {
+                    // the cells must be cleared even if there is no paint
+                    carry = kernels.accumulate(cells + x, carry, evenOdd, coverage);
+                    if ( !hasPaint )
+                        continue;
+                }
+                else
+                {
+                    // no line crosses the tile, so the coverage of its row is
+                    // the same as that of the last pixel left of it
+                    const unsigned char c = CoverageToByte(CoverageFromSum(carry, evenOdd));
+
+                    if ( c == 0 || !hasPaint )
+                        continue;
+
+                    if ( c == 255 && source.IsOpaqueColor() )
+                    {
+                        wxUint32* pixels = reinterpret_cast<wxUint32*>(row + x * 4);
+
+                        std::fill_n(pixels, count, opaqueColor);
+                        continue;
+                    }
+
+                    memset(coverage, c, TileSize);
+                }
+
+                if ( source.IsGradient() )
+                {
+                    source.GetGradientColors(x, y, count, colors);
+                    kernels.blend(row + x * 4, colors, coverage, count);
+                }
+                else
+                {
+                    kernels.blendColor(row + x * 4, source.GetColor(), coverage, count);
+                }
+            }
+        }
+
+        memset(&m_tiles[tileY * m_tilesX + band.minTileX], 0, band.maxTileX - band.minTileX + 1);
+    }
+
+    ResetTiles(band);
+}
+
+// ============================================================================
+// wxBitmapBundleImplSVGTile implementation
+// ============================================================================
+
+wxBitmapBundleImplSVGTile::wxBitmapBundleImplSVGTile(const char* data, const wxSize& sizeDef)
+    : wxBitmapBundleImplSVG(sizeDef)
+{
+    wxCHECK_RET(data, "null data");
+
+    SetSharedCacheKey("Tile", "1", data);
+
+    // the same parsed image as of wxBitmapBundleImplSVGNano
+    m_svgImage = GetSharedNSVGImage(m_sharedCacheHash, m_sharedCacheDataLength, data);
+}
+
+bool wxBitmapBundleImplSVGTile::IsOk() const
+{
+    return m_svgImage && m_svgImage->width > 0 && m_svgImage->height > 0;
+}
+
+bool wxBitmapBundleImplSVGTile::DoRasterizeToBuffer(const wxSize& size)
+{
+    if ( !IsOk() )
+    {
+        wxLogDebug("invalid m_svgImage");
+        return false;
+    }
+
+    if ( size.x <= 0 || size.y <= 0 )
+    {
+        wxLogDebug("invalid rasterization size %dx%d", size.x, size.y);
+        return false;
+    }
+
+    m_buffer.resize(GetBitmapBytes(size));
+
+    // the same scaling and centering as RasterizeNSVGImage() in bmpbndl_svg_nano.cpp
+    const NSVGimage* image = m_svgImage.get();
+    const float      scale = wxMin(size.x / image->width, size.y / image->height);
+
+    return m_rasterizer.Rasterize(image,
+                                  (size.x - image->width * scale) / 2.0f,
+                                  (size.y - image->height * scale) / 2.0f,
+                                  scale, &m_buffer[0], size.x, size.y, size.x * 4);
+}
+
+wxBitmap wxBitmapBundleImplSVGTile::DoConvertBufferToBitmap(const wxSize& size)
+{
+    wxCHECK_MSG(m_buffer.size() == GetBitmapBytes(size), wxBitmap(),
+                "buffer was not rasterized at this size");
+
+    return CreateBitmapFromRGBA(&m_buffer[0], GetBitmapBytes(wxSize(size.x, 1)), size, true);
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
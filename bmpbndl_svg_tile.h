@@ -0,0 +1,228 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        bmpbndl_svg_tile.h
+// Purpose:     wxBitmapBundleImpl rasterizing SVG parsed by NanoSVG in tiles
+// Author:      PB
+// Created:     2022-01-18
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef wxBitmapBundleImplSVGTile_PRIVATE_H
+#define wxBitmapBundleImplSVGTile_PRIVATE_H
+
+#include "bmpbndl_svg_nano.h"
+
+// the shapes are parsed by NanoSVG, only the rasterizer is different
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    #define wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+
+#include <climits>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "bmpbndl_svg.h"
+
+struct NSVGimage;
+struct NSVGshape;
+struct NSVGpaint;
+
+class wxTestSVGThreadPool;
+
+// ============================================================================
+// wxSVGTileRasterizer
+// ============================================================================
+
+/*
+    Rasterizer of the shapes parsed by NanoSVG, an alternative to
+    the NanoSVG scanline rasterizer, which samples each scanline 5 times
+    vertically into a coverage buffer and then composites the spans
+    a pixel at a time.
+
+    Here the paths are flattened to lines and each line adds the exact area
+    it covers in each pixel it crosses (and the change of the winding number
+    right of it) into an accumulation buffer of floats, the same technique
+    font-rs uses. A running sum along each row then gives the coverage of
+    every pixel, analytically, with no supersampling. The image is divided
+    into tiles of TileSize x TileSize pixels and the lines mark the tiles
+    they touch: only those are summed, the coverage of all the other ones is
+    constant along each of their rows, so a tile outside the shape is
+    skipped and one inside it is filled without computing any coverage.
+
+    The prefix sums, the conversion of the coverage to 8 bits, and
+    compositing are done by SSE2 or AVX2 kernels on x86-64. The instruction
+    set is that of wxSVGPixelConverter, so it can be changed with
+    wxSVGPixelConverter::SetInstructionSet() for benchmarking, and all
+    the instruction sets give exactly the same pixels.
+
+    Strokes are expanded into the segment quads, joins, and caps, which
+    overlap and are filled with the non-zero rule, dashes are supported.
+    Gradients are sampled at the pixel centres from 256 colour tables,
+    including their spread method; like NanoSVG, the focal point of radial
+    gradients is ignored.
+
+    RasterizeBands() splits the image into horizontal bands of whole tile
+    rows, sorts the lines into the bands they cross, and rasterizes
+    the bands in parallel into their rows of the same buffer. A line adds
+    to each row only what is computed from the line and the row alone,
+    so the pixels are bit-identical to those of Rasterize().
+
+    Each thread must use its own instance, as the buffers are reused
+    between the calls.
+ */
+
+class wxSVGTileRasterizer
+{
+public:
+    static const int TileSize = 16;
+
+    wxSVGTileRasterizer();
+
+    // Rasterizes image scaled by scale and translated by (tx, ty), the same
+    // as nsvgRasterize(), into dst with rows stride bytes apart. The result
+    // is premultiplied RGBA, unlike that of NanoSVG. Returns false if
+    // the size or scale is invalid. A part of the image is rasterized by
+    // subtracting its origin from (tx, ty) and passing its size, the lines
+    // are clipped to it.
+    bool Rasterize(const NSVGimage* image, float tx, float ty, float scale,
+                   unsigned char* dst, int width, int height, int stride);
+
+    // Rasterizes the same as Rasterize() but in bands of bandHeight rows,
+    // rounded up to whole tiles, on the threads of pool. bandHeight = 0
+    // gives each thread BandsPerThread bands. Only this function may use
+    // pool until it returns.
+    bool RasterizeBands(const NSVGimage* image, float tx, float ty, float scale,
+                        unsigned char* dst, int width, int height, int stride,
+                        wxTestSVGThreadPool& pool, int bandHeight = 0);
+
+    // more bands than threads, so that the threads which finish their
+    // simpler bands early take over the rest
+    static const int BandsPerThread = 4;
+
+private:
+    // rows [top, bottom) of the image and the tiles the current paint
+    // touched in them
+    struct Band
+    {
+        int top{0};
+        int bottom{0};
+        int minTileX{INT_MAX}, minTileY{INT_MAX};
+        int maxTileX{-1}, maxTileY{-1};
+
+        // only for RasterizeBands(): the indices of the lines in m_lines
+        // crossing the band, in the order of m_paints, and the end of
+        // the indices of each paint
+        std::vector<unsigned> lines;
+        std::vector<size_t>   paintEnds;
+    };
+
+    // only for RasterizeBands(): a fill or a stroke of a shape,
+    // its lines in m_lines end at lineEnd
+    struct Paint
+    {
+        const NSVGpaint* paint;
+        float            opacity;
+        bool             evenOdd;
+        size_t           lineEnd;
+    };
+
+    typedef std::function<void(const NSVGshape& shape, const NSVGpaint& paint, bool evenOdd)>
+        AddPaintFn;
+
+    // one entry per tile, non-zero if the lines of the current shape touch it
+    std::vector<unsigned char> m_tiles;
+    // (width rounded up to TileSize + padding) * height cells
+    std::vector<float>         m_cells;
+    // flattened polylines of the current shape, x and y pairs
+    std::vector<float>         m_points;
+    // the polylines in m_points: the index of the first point and
+    // the number of the points, closed ones have negative count
+    std::vector<int>           m_polylines;
+    // dashes of the current stroke, in the same format as m_points
+    std::vector<float>         m_dashPoints;
+    std::vector<int>           m_dashPolylines;
+    // the lines clipped to the image, x0, y0, x1, and y1 of each, of
+    // the current paint or, in RasterizeBands(), of all of them
+    std::vector<float>         m_lines;
+    std::vector<Paint>         m_paints;
+    // the whole image for Rasterize()
+    Band                       m_band;
+    std::vector<Band>          m_bands;
+
+    int    m_width{0};
+    int    m_height{0};
+    size_t m_cellStride{0};
+    int    m_tilesX{0};
+    int    m_tilesY{0};
+
+    void SetSize(int width, int height);
+    static void ResetTiles(Band& band);
+
+    // Adds the lines of each fill and stroke of the visible shapes
+    // of image to m_lines and then calls addPaint with it
+    void AddPaints(const NSVGimage* image, float tx, float ty, float scale,
+                   const AddPaintFn& addPaint);
+
+    void FlattenShape(const NSVGshape* shape, float tx, float ty, float scale);
+    void DashPolylines(const NSVGshape* shape, float scale);
+
+    void AddFillLines();
+    void AddStrokeLines(const std::vector<float>& points, const std::vector<int>& polylines,
+                        float width, int lineJoin, int lineCap, float miterLimit);
+
+    // adds the closed polygon oriented so that its winding number is positive
+    void AddPolygon(const float* points, int count);
+    // clips the line to the image and adds it to m_lines
+    void AddLine(float x0, float y0, float x1, float y1);
+    // accumulates the rows of the line within the band
+    void AccumulateLine(Band& band, const float* line);
+
+    // composites the paint with the coverage accumulated in the band and
+    // clears its touched tiles for the next paint
+    void FillPaint(Band& band, const NSVGpaint& paint, float opacity, bool evenOdd,
+                   float tx, float ty, float scale,
+                   unsigned char* dst, int stride);
+
+    wxDECLARE_NO_COPY_CLASS(wxSVGTileRasterizer);
+};
+
+// ============================================================================
+// wxBitmapBundleImplSVGTile declaration
+// ============================================================================
+
+/*
+    wxBitmapBundleImpl which parses SVG with NanoSVG, sharing the parsed
+    image with wxBitmapBundleImplSVGNano, but rasterizes it with
+    wxSVGTileRasterizer, scaled uniformly and centered at the requested
+    size, the same as wxBitmapBundleImplSVGNano does.
+ */
+
+class wxBitmapBundleImplSVGTile : public wxBitmapBundleImplSVG
+{
+public:
+    // data must be 0 terminated, wxBitmapBundleImplSVGTile doesn't
+    // take its ownership and it can be deleted after the ctor
+    // was called.
+    wxBitmapBundleImplSVGTile(const char* data, const wxSize& sizeDef);
+
+    bool IsOk() const;
+
+private:
+    std::shared_ptr<NSVGimage> m_svgImage;
+    wxSVGTileRasterizer        m_rasterizer;
+
+    // premultiplied RGBA result of the last DoRasterizeToBuffer()
+    wxVector<unsigned char> m_buffer;
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE;
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& size) wxOVERRIDE;
+
+    wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplSVGTile);
+};
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+
+#endif // #ifndef wxBitmapBundleImplSVGTile_PRIVATE_H
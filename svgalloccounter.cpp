@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgalloccounter.cpp
+// Purpose:     Counting heap allocations of the calling thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+
+#include "svgalloccounter.h"
+
+namespace
+{
+
+// a trivial type, so that accessing it does not call any initialization
+// function, which could allocate
+struct ThreadCounts
+{
+    bool      isCounting;
+    size_t    allocCount;
+    size_t    allocBytes;
+    long long liveBytes;
+    long long peakBytes;
+};
+
+thread_local ThreadCounts gs_counts;
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGAllocCounter
+// ============================================================================
+
+// static
+bool wxTestSVGAllocCounter::IsAvailable()
+{
+    // called through volatile pointers, as the compiler knows that
+    // the standard malloc() and free() cannot change the counts
+    void* (*volatile mallocFn)(size_t) = malloc;
+    void  (*volatile freeFn)(void*)    = free;
+    Values values;
+
+    Start();
+    freeFn(mallocFn(16));
+    Stop(values);
+
+    return values.allocCount > 0;
+}
+
+// static
+void wxTestSVGAllocCounter::Start()
+{
+    wxASSERT_MSG(!gs_counts.isCounting, "already counting");
+
+    gs_counts.allocCount = 0;
+    gs_counts.allocBytes = 0;
+    gs_counts.liveBytes  = 0;
+    gs_counts.peakBytes  = 0;
+    gs_counts.isCounting = true;
+}
+
+// static
+void wxTestSVGAllocCounter::Stop(Values& values)
+{
+    gs_counts.isCounting = false;
+
+    values.allocCount = gs_counts.allocCount;
+    values.allocBytes = gs_counts.allocBytes;
+    values.peakBytes  = static_cast<size_t>(gs_counts.peakBytes);
+    values.liveBytes  = gs_counts.liveBytes;
+}
+
+// static
+void wxTestSVGAllocCounter::OnAlloc(size_t requestedSize, size_t usableSize)
+{
+    ThreadCounts& counts = gs_counts;
+
+    if ( !counts.isCounting )
+        return;
+
+    ++counts.allocCount;
+    counts.allocBytes += requestedSize;
+    counts.liveBytes  += static_cast<long long>(usableSize);
+    if ( counts.liveBytes > counts.peakBytes )
+        counts.peakBytes = counts.liveBytes;
+}
+
+// static
+void wxTestSVGAllocCounter::OnFree(size_t usableSize)
+{
+    ThreadCounts& counts = gs_counts;
+
+    if ( counts.isCounting )
+        counts.liveBytes -= static_cast<long long>(usableSize);
+}
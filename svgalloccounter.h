@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgalloccounter.h
+// Purpose:     Counting heap allocations of the calling thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_ALLOC_COUNTER_H_DEFINED
+#define TEST_SVG_ALLOC_COUNTER_H_DEFINED
+
+#include <cstddef>
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGAllocCounter
+// ============================================================================
+
+/*
+    Counts heap allocations (malloc(), calloc(), realloc(), and aligned
+    allocations, including those made by operator new) of the calling
+    thread between Start() and Stop().
+
+    The allocations are seen only when the allocator functions are
+    interposed, which is done by svgallochooks.cpp for glibc. It is linked
+    only to wxTestSVGBench, elsewhere IsAvailable() returns false and all
+    the values are 0. The hooks add a thread local check to each allocation
+    when not counting.
+
+    Live bytes are the usable sizes of the blocks (malloc_usable_size()),
+    so they are slightly larger than the bytes requested. The blocks freed
+    during counting but allocated before it are subtracted too, therefore
+    liveBytes can be negative.
+ */
+
+class wxTestSVGAllocCounter
+{
+public:
+    struct Values
+    {
+        size_t    allocCount{0}; // allocations and reallocations
+        size_t    allocBytes{0}; // requested
+        size_t    peakBytes{0};  // maximum of live bytes above those at Start()
+        long long liveBytes{0};  // live bytes at Stop() minus those at Start()
+    };
+
+    // returns true if the allocator functions are interposed
+    static bool IsAvailable();
+
+    // counting cannot be nested
+    static void Start();
+    static void Stop(Values& values);
+
+    // called by the hooks for each allocation and deallocation of any thread,
+    // they must not allocate
+    static void OnAlloc(size_t requestedSize, size_t usableSize);
+    static void OnFree(size_t usableSize);
+};
+
+#endif // #ifndef TEST_SVG_ALLOC_COUNTER_H_DEFINED
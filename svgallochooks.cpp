@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgallochooks.cpp
+// Purpose:     Interposing the glibc allocator for wxTestSVGAllocCounter
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+    The functions defined in the executable take precedence over those
+    of the shared libraries, so these replace malloc() and friends for
+    the whole process, including NanoSVG, wxWidgets, and operator new.
+    They forward to the glibc implementation, reporting the sizes to
+    wxTestSVGAllocCounter.
+
+    Only the benchmark application links this file, to keep the GUI
+    application allocating as usual.
+ */
+
+#include <cerrno>
+#include <cstdlib>
+
+#include "svgalloccounter.h"
+
+#ifdef __GLIBC__
+
+#include <malloc.h>
+
+extern "C"
+{
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+    void* ptr = __libc_malloc(size);
+
+    if ( ptr )
+        wxTestSVGAllocCounter::OnAlloc(size, malloc_usable_size(ptr));
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size)
+{
+    void* ptr = __libc_calloc(count, size);
+
+    if ( ptr )
+        wxTestSVGAllocCounter::OnAlloc(count * size, malloc_usable_size(ptr));
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    const size_t oldUsableSize = ptr ? malloc_usable_size(ptr) : 0;
+    void*        newPtr        = __libc_realloc(ptr, size);
+
+    // realloc(ptr, 0) frees ptr, a failed realloc() keeps it
+    if ( newPtr || size == 0 )
+    {
+        if ( ptr )
+            wxTestSVGAllocCounter::OnFree(oldUsableSize);
+        if ( newPtr )
+            wxTestSVGAllocCounter::OnAlloc(size, malloc_usable_size(newPtr));
+    }
+    return newPtr;
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    void* ptr = __libc_memalign(alignment, size);
+
+    if ( ptr )
+        wxTestSVGAllocCounter::OnAlloc(size, malloc_usable_size(ptr));
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    if ( alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 )
+        return EINVAL;
+
+    void* newPtr = memalign(alignment, size);
+
+    if ( !newPtr )
+        return ENOMEM;
+
+    *ptr = newPtr;
+    return 0;
+}
+
+void free(void* ptr)
+{
+    if ( !ptr )
+        return;
+
+    wxTestSVGAllocCounter::OnFree(malloc_usable_size(ptr));
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#endif // #ifdef __GLIBC__
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbackendregistry.cpp
+// Purpose:     Registry of the SVG rasterizers benchmarked side by side
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "bmpbndl_svg.h"
+#include "bmpbndl_svg_cairo.h"
+#include "bmpbndl_svg_d2d.h"
+#include "bmpbndl_svg_nano.h"
+#include "bmpbndl_svg_tile.h"
+
+#include "svgbackendregistry.h"
+
+namespace
+{
+
+#ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxBitmapBundleImplSVGWx
+// ============================================================================
+
+/*
+    Used for benchmarking NanoSVG when its headers are not available and
+    wxBitmapBundleImplSVGNano thus cannot be used. It just wraps the bundle
+    created with wxBitmapBundle::FromSVG(), so the rasterization and
+    conversion phases cannot be separated: the time of the whole
+    wxBitmapBundle::GetBitmap() is reported as the rasterization time.
+ */
+
+class wxBitmapBundleImplSVGWx : public wxBitmapBundleImplSVG
+{
+public:
+    wxBitmapBundleImplSVGWx(const char* data, const wxSize& sizeDef)
+        : wxBitmapBundleImplSVG(sizeDef),
+          m_bundle(wxBitmapBundle::FromSVG(data, sizeDef))
+    {
+        SetSharedCacheKey("Wx", "1", data);
+    }
+
+    bool IsOk() const { return m_bundle.IsOk(); }
+
+private:
+    wxBitmapBundle m_bundle;
+    wxBitmap       m_bitmap;
+
+    virtual bool DoRasterizeToBuffer(const wxSize& size) wxOVERRIDE
+    {
+        m_bitmap = m_bundle.GetBitmap(size);
+        return m_bitmap.IsOk();
+    }
+
+    virtual wxBitmap DoConvertBufferToBitmap(const wxSize& WXUNUSED(size)) wxOVERRIDE
+    {
+        return m_bitmap;
+    }
+};
+
+#endif // #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// Creates T, which must have IsOk(), returns nullptr if it is not
+template <typename T>
+wxBitmapBundleImplSVG* CreateBitmapBundleImpl(const char* data)
+{
+    T* impl = new T(data, wxSize(2, 2));
+
+    if ( impl->IsOk() )
+        return impl;
+
+    impl->DecRef();
+    return nullptr;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGBackendRegistry
+// ============================================================================
+
+// static
+bool wxTestSVGBackendRegistry::Register(const wxTestSVGBackend& backend)
+{
+    wxCHECK(!backend.name.empty() && backend.createImpl, false);
+
+    if ( Find(backend.name) )
+    {
+        wxLogError("Backend '%s' is already registered.", backend.name);
+        return false;
+    }
+
+    VectorBackends& backends = DoGetAll();
+
+    if ( backend.HasFlag(wxTestSVGBackend::Flag_Baseline) && !backends.empty() )
+    {
+        wxLogError("Backend '%s' cannot be the baseline, '%s' already is.", backend.name, backends[0].name);
+        return false;
+    }
+
+    backends.push_back(backend);
+    return true;
+}
+
+// static
+const wxTestSVGBackendRegistry::VectorBackends& wxTestSVGBackendRegistry::GetAll()
+{
+    return DoGetAll();
+}
+
+// static
+const wxTestSVGBackend* wxTestSVGBackendRegistry::Find(const wxString& name)
+{
+    const VectorBackends& backends = DoGetAll();
+    const auto it = std::find_if(backends.begin(), backends.end(),
+                                 [&name](const wxTestSVGBackend& b) { return b.name.IsSameAs(name, false); });
+
+    return it != backends.end() ? &*it : nullptr;
+}
+
+// static
+const wxTestSVGBackend& wxTestSVGBackendRegistry::GetBaseline()
+{
+    // always registered first
+    return DoGetAll()[0];
+}
+
+// static
+wxArrayString wxTestSVGBackendRegistry::GetAvailableNames()
+{
+    wxArrayString names;
+
+    for ( const auto& b : DoGetAll() )
+    {
+        if ( b.IsAvailable() )
+            names.push_back(b.name);
+    }
+
+    return names;
+}
+
+// static
+wxTestSVGBackendRegistry::VectorBackends& wxTestSVGBackendRegistry::DoGetAll()
+{
+    static VectorBackends backends;
+
+    // the backends built into this application, in this order: NanoSVG,
+    // Direct2D on MSW, NanoSVG rasterizing into GdkPixbuf on GTK, cairo
+    // rendering the shapes parsed by NanoSVG when cairo is found, and
+    // wxSVGTileRasterizer rasterizing them
+    if ( backends.empty() )
+    {
+        wxTestSVGBackend backend;
+
+        backend.name  = "Nano";
+        backend.flags = wxTestSVGBackend::Flag_Baseline;
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+        backend.createImpl = CreateBitmapBundleImpl<wxBitmapBundleImplSVGNano>;
+#else
+        backend.description = "Without NanoSVG headers, Nano is wxBitmapBundle::FromSVG(), "
+                              "its Rasterize includes the conversion to wxBitmap.";
+        backend.createImpl  = CreateBitmapBundleImpl<wxBitmapBundleImplSVGWx>;
+        backend.flags      |= wxTestSVGBackend::Flag_NoConvertPhase;
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+        backends.push_back(backend);
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
+        backend = wxTestSVGBackend();
+        backend.name        = "D2D";
+        backend.isAvailable = wxBitmapBundleImplSVGD2D::IsAvailable;
+        backend.createImpl  = CreateBitmapBundleImpl<wxBitmapBundleImplSVGD2D>;
+        backends.push_back(backend);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+        backend = wxTestSVGBackend();
+        backend.name        = "Pixbuf";
+        backend.description = "Pixbuf is NanoSVG rasterizing directly into GdkPixbuf used by wxBitmap, "
+                              "its Convert passes the pixbuf to wxBitmap without copying the pixels. "
+                              "The pixbuf is RGBA, not premultiplied, so on wxGTK3 Convert also draws "
+                              "the bitmap once, creating the premultiplied cairo surface wxGTK3 would "
+                              "otherwise create when the bitmap is drawn for the first time.";
+        backend.createImpl  = CreateBitmapBundleImpl<wxBitmapBundleImplSVGNanoPixbuf>;
+        backends.push_back(backend);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO_PIXBUF
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+        backend = wxTestSVGBackend();
+        backend.name        = "Cairo";
+        backend.description = "Cairo renders the shapes parsed by NanoSVG with cairo, "
+                              "so its Parse is the same as Nano and only Rasterize and Convert differ.";
+        backend.createImpl  = CreateBitmapBundleImpl<wxBitmapBundleImplSVGCairo>;
+        backends.push_back(backend);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_CAIRO
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+        backend = wxTestSVGBackend();
+        backend.name        = "Tile";
+        backend.description = "Tile rasterizes the shapes parsed by NanoSVG with analytic coverage "
+                              "and SIMD compositing, skipping the tiles no edge crosses, "
+                              "so its Parse is the same as Nano and only Rasterize and Convert differ.";
+        backend.createImpl  = CreateBitmapBundleImpl<wxBitmapBundleImplSVGTile>;
+        backends.push_back(backend);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_TILE
+    }
+
+    return backends;
+}
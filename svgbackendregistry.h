@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbackendregistry.h
+// Purpose:     Registry of the SVG rasterizers benchmarked side by side
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_BACKEND_REGISTRY_H_DEFINED
+#define TEST_SVG_BACKEND_REGISTRY_H_DEFINED
+
+#include <vector>
+
+#include <wx/wx.h>
+
+class wxBitmapBundleImplSVG;
+
+// ============================================================================
+// wxTestSVGBackend
+// ============================================================================
+
+/*
+    An SVG rasterizer benchmarked by wxTestSVGRasterizationBenchmark::Run(),
+    wrapped in wxBitmapBundleImplSVG so that its parsing, rasterization,
+    and conversion to wxBitmap can be timed separately.
+ */
+
+struct wxTestSVGBackend
+{
+    enum Flags
+    {
+        Flag_None = 0,
+        // the reference all the other backends are reported against,
+        // always benchmarked and always first, there is only one
+        Flag_Baseline = 0x0001,
+        // rasterization and conversion cannot be timed separately,
+        // the Rasterize time includes both and Convert is not reported
+        Flag_NoConvertPhase = 0x0002,
+    };
+
+    // returns false if the backend cannot be used on this system
+    typedef bool (*IsAvailableFn)();
+    // data is 0 terminated, returns nullptr if it could not be parsed;
+    // the impls parsing lazily, e.g., NanoSVG, return nullptr only for empty
+    // data, the invalid one is reported by wxBitmapBundleImplSVG::Parse()
+    typedef wxBitmapBundleImplSVG* (*CreateImplFn)(const char* data);
+
+    // shown in the reports and the results and used to select the backend,
+    // case-insensitively, on the command line, e.g., "Nano"
+    wxString      name;
+    // a sentence for the summary report, may be empty
+    wxString      description;
+    // null means always available
+    IsAvailableFn isAvailable{nullptr};
+    CreateImplFn  createImpl{nullptr};
+    int           flags{Flag_None};
+
+    bool IsAvailable() const { return !isAvailable || isAvailable(); }
+    bool HasFlag(int flag) const { return (flags & flag) != 0; }
+};
+
+// ============================================================================
+// wxTestSVGBackendRegistry
+// ============================================================================
+
+/*
+    The backends the benchmark can use. Those built into this application
+    are always registered first, NanoSVG being the baseline, see DoGetAll().
+    Other rasterizers, e.g., another library or NanoSVG compiled with
+    different options in its own translation unit, are added with
+    Register() before benchmarking. The registry is not thread-safe,
+    it is to be used only from the main thread.
+ */
+
+class wxTestSVGBackendRegistry
+{
+public:
+    typedef std::vector<wxTestSVGBackend> VectorBackends;
+
+    // Returns false if the backend has no name or createImpl function, if
+    // a backend with the same name is already registered, or if it is
+    // a second baseline.
+    static bool Register(const wxTestSVGBackend& backend);
+
+    // all the registered backends, available or not, in the order
+    // of registration
+    static const VectorBackends& GetAll();
+
+    // returns nullptr if no backend of this name is registered
+    static const wxTestSVGBackend* Find(const wxString& name);
+
+    static const wxTestSVGBackend& GetBaseline();
+
+    // names of the backends IsAvailable() on this system
+    static wxArrayString GetAvailableNames();
+
+private:
+    static VectorBackends& DoGetAll();
+};
+
+#endif // #ifndef TEST_SVG_BACKEND_REGISTRY_H_DEFINED
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////////////
 // Name:        svgbench.cpp
-// Purpose:     Benchmark SVG rasterization with NanoSVG and Direct2D
+// Purpose:     Benchmark SVG rasterization with the registered backends
 // Author:      PB
 // Created:     2022-01-20
 // Copyright:   (c) 2022 PB
@@ -9,18 +9,24 @@
 
 #include <algorithm>
 #include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <numeric>
+#include <random>
 
-#include <wx/dirdlg.h>
 #include <wx/ffile.h>
 #include <wx/filename.h>
 #include <wx/stopwatch.h>
-#include <wx/textfile.h>
-#include <wx/webview.h>
 
-#include "bmpbndl_svg_d2d.h"
+#include "bmpbndl_svg.h"
+#include "bmpbndl_svg_cache.h"
 
+#include "svgbackendregistry.h"
 #include "svgbench.h"
+#include "svgbenchresults.h"
+#include "svgreportwriter.h"
 
 // ============================================================================
 // wxTestSVGRasterizationBenchmark
@@ -30,7 +36,7 @@ wxTestSVGRasterizationBenchmark::wxTestSVGRasterizationBenchmark()
 {
 }
 
-void wxTestSVGRasterizationBenchmark::Setup(const wxString& dirName, 
+void wxTestSVGRasterizationBenchmark::Setup(const wxString& dirName,
                                             const wxArrayString& fileNames,
                                             const std::vector<wxSize>& sizes)
 {
@@ -39,121 +45,539 @@ void wxTestSVGRasterizationBenchmark::Setup(const wxString& dirName,
     m_sizes     = sizes;
 }
 
-wxBitmapBundle CreateBitmapBundleNano(const wxString& fileName)
+wxString wxTestSVGRasterizationBenchmark::GetFilePath(size_t fileIndex) const
 {
-    return wxBitmapBundle::FromSVGFile(fileName, wxSize(2, 2));
+    // not wxFileName(m_dirName, name), the name may include subfolders
+    wxFileName fileName(m_fileNames[fileIndex]);
+
+    fileName.MakeAbsolute(m_dirName);
+    return fileName.GetFullPath();
 }
 
-#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
-wxBitmapBundle CreateBitmapBundleD2D(const wxString& fileName)
+wxString wxTestSVGRasterizationBenchmark::GetDisplayName(size_t fileIndex) const
 {
-    return CreateFromImplSVGD2D(fileName, wxSize(2, 2));
+    wxFileName fileName(m_fileNames[fileIndex]);
+
+    fileName.ClearExt();
+    return fileName.GetFullPath(wxPATH_UNIX);
 }
-#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
 
-bool wxTestSVGRasterizationBenchmark::Run(bool hasD2DSVG, size_t runCount, 
-                                          wxString& report, wxString& detailedReport)
+bool wxTestSVGRasterizationBenchmark::Run(const wxArrayString& backendNames, size_t runCount, wxString& report,
+                                          wxTestSVGReportWriter* detailedReport,
+                                          wxTestSVGReportWriter* results,
+                                          wxTestSVGBenchmarkResults* samples)
 {
     wxCHECK(!m_fileNames.empty(), false);
     wxCHECK(!m_sizes.empty(), false);
     wxCHECK(runCount, false);
 
-    MatrixLong3 timesNano(m_fileNames.size());
-    MatrixLong3 timesD2D(m_fileNames.size());
+    // otherwise all but the first runs would just get the parsed documents from the cache
+    wxBitmapBundleSVGSharedCacheDisabler sharedCacheDisabler;
+
+    std::vector<CreateBitmapBundleImplFn> createImplFns;
+    VectorBackendResults                  backends;
+
+    const auto addBackend = [&](const wxTestSVGBackend& backend)
+    {
+        backends.push_back(BackendResults());
+        backends.back().name        = backend.name;
+        backends.back().description = backend.description;
+        backends.back().flags       = backend.flags;
+        InitPhaseTimes(backends.back().times, backends.back().stats);
+        if ( m_perfCounters.IsOpened() )
+        {
+            backends.back().parseCounters.assign(m_fileNames.size(), VectorCounterSums(1));
+            backends.back().bitmapCounters.assign(m_fileNames.size(), VectorCounterSums(m_sizes.size()));
+        }
+        if ( m_isAllocCounterEnabled )
+        {
+            backends.back().parseAllocs.assign(m_fileNames.size(), VectorAllocSums(1));
+            backends.back().bitmapAllocs.assign(m_fileNames.size(), VectorAllocSums(m_sizes.size()));
+        }
+        createImplFns.push_back(backend.createImpl);
+    };
+
+    addBackend(wxTestSVGBackendRegistry::GetBaseline());
+    for ( const auto& name : backendNames )
+    {
+        const wxTestSVGBackend* backend = wxTestSVGBackendRegistry::Find(name);
+
+        wxCHECK_MSG(backend && backend->IsAvailable(), false,
+                    wxString::Format("backend '%s' not available", name));
+
+        if ( !backend->HasFlag(wxTestSVGBackend::Flag_Baseline) )
+            addBackend(*backend);
+    }
+
+    if ( results )
+        BeginResultsTable(*results);
+    if ( detailedReport )
+        BeginDetailedTable(*detailedReport);
+    if ( samples )
+        BeginSamples(runCount, *samples);
+
+    VectorMetrics metrics(m_fileNames.size());
 
     for ( size_t f = 0; f < m_fileNames.size(); ++f )
     {
-        if ( !BenchmarkFile(CreateBitmapBundleNano, m_fileNames[f], runCount, timesNano[f]) )
-            return false;
-#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
-        if ( hasD2DSVG )
+        for ( size_t b = 0; b < backends.size(); ++b )
         {
-            if ( !BenchmarkFile(CreateBitmapBundleD2D, m_fileNames[f], runCount, timesD2D[f]) )
+            if ( !BenchmarkFile(createImplFns[b], f, runCount, backends[b]) )
                 return false;
+
+            CalcFileStats(f, backends[b].times, backends[b].stats);
         }
-#endif
+
+        if ( results )
+            WriteResultsRows(backends, f, *results);
+        if ( detailedReport )
+            WriteDetailedRows(backends, f, *detailedReport);
+        if ( samples )
+            AddFileSamples(backends, f, *samples);
+
+        // only the statistics are needed for the report, so that
+        // the memory does not grow with the number of files and runs
+        for ( auto& backend : backends )
+            FreeFileTimes(f, backend.times);
+
+        // the file has already been benchmarked
+        CalcMetrics(f, metrics[f]);
+    }
+
+    if ( results )
+    {
+        results->EndTable();
+        results->EndDocument();
     }
 
-    MatrixStats statsNano;
-    MatrixStats statsD2D;
+    if ( detailedReport )
+    {
+        detailedReport->EndTable();
+        detailedReport->EndDocument();
+    }
+
+    CreateReport(backends, metrics, runCount, report);
+
+    return true;
+}
+
+bool wxTestSVGRasterizationBenchmark::CreateReportFromResults(const wxTestSVGBenchmarkResults& samples,
+                                                              wxString& report,
+                                                              wxTestSVGReportWriter* detailedReport,
+                                                              wxTestSVGReportWriter* results)
+{
+    const wxTestSVGBenchmarkResults::Samples& cells = samples.GetSamples();
+
+    wxCHECK(!cells.empty(), false);
 
-    statsNano.resize(m_fileNames.size());
-    for ( auto& s : statsNano )
-        s.resize(m_sizes.size());
+    wxArrayString       fileNames;
+    std::vector<wxSize> sizes;
+    wxArrayString       backendNames;
+    size_t              runCount = 0;
 
-    if ( hasD2DSVG )
+    for ( const auto& c : cells )
     {
-        statsD2D.resize(m_fileNames.size());
-        for ( auto& s : statsD2D )
-            s.resize(m_sizes.size());
+        const wxTestSVGBenchmarkResults::Key& key = c.first;
+
+        if ( std::find(fileNames.begin(), fileNames.end(), key.fileName) == fileNames.end() )
+            fileNames.push_back(key.fileName);
+        // the phases done once per file have no size
+        if ( key.size.x > 0 && std::find(sizes.begin(), sizes.end(), key.size) == sizes.end() )
+            sizes.push_back(key.size);
+        if ( std::find(backendNames.begin(), backendNames.end(), key.backend) == backendNames.end() )
+            backendNames.push_back(key.backend);
+
+        runCount = wxMax(runCount, c.second.size());
     }
 
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    if ( sizes.empty() )
     {
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        wxLogError("The benchmark results have no bitmap sizes.");
+        return false;
+    }
+
+    fileNames.Sort(wxNaturalStringSortAscending);
+    std::sort(sizes.begin(), sizes.end(), [](const wxSize& s1, const wxSize& s2)
         {
-            statsNano[f][s] = CalcStatsForVectorLong(timesNano[f][s]);
-            if ( hasD2DSVG )
-                statsD2D[f][s] = CalcStatsForVectorLong(timesD2D[f][s]);
+            return s1.x * s1.y != s2.x * s2.y ? s1.x * s1.y < s2.x * s2.y : s1.x < s2.x;
+        });
+    // the baseline always first, the others are reported against it
+    const wxString baselineName = wxTestSVGBackendRegistry::GetBaseline().name;
+
+    std::stable_partition(backendNames.begin(), backendNames.end(),
+                          [&baselineName](const wxString& name) { return name == baselineName; });
+
+    if ( m_dirName.empty() )
+        m_dirName = samples.GetMetadata("Folder");
+    m_fileNames = fileNames;
+    m_sizes     = sizes;
+
+    unsigned long warmupRunCount = 0;
+
+    if ( samples.GetMetadata("WarmupRuns").ToULong(&warmupRunCount) )
+        m_samplingOptions.warmupRunCount = warmupRunCount;
+    m_samplingOptions.adaptive = false;
+
+    VectorBackendResults backends(backendNames.size());
+
+    for ( size_t b = 0; b < backends.size(); ++b )
+    {
+        BackendResults& backend = backends[b];
+
+        const wxTestSVGBackend* registered = wxTestSVGBackendRegistry::Find(backendNames[b]);
+
+        backend.name = backendNames[b];
+        if ( registered )
+        {
+            backend.description = registered->description;
+            backend.flags       = registered->flags;
         }
+        InitPhaseTimes(backend.times, backend.stats);
+
+        for ( size_t p = 0; p < Phase_Max; ++p )
+        {
+            for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            {
+                for ( size_t s = 0; s < backend.times[p][f].size(); ++s )
+                {
+                    wxTestSVGBenchmarkResults::Key key;
+
+                    key.fileName = m_fileNames[f];
+                    key.size     = IsPerFilePhase(p) ? wxSize(0, 0) : m_sizes[s];
+                    key.backend  = backend.name;
+                    key.phase    = GetPhaseName(p);
+
+                    const auto it = cells.find(key);
+
+                    if ( it == cells.end() || it->second.empty() )
+                    {
+                        wxLogError("The benchmark results have no %s times of file '%s' at size %dx%d with %s.",
+                                   key.phase, key.fileName, m_sizes[s].x, m_sizes[s].y, key.backend);
+                        return false;
+                    }
+
+                    backend.times[p][f][s] = it->second;
+                }
+            }
+        }
+
+        // all the times are already in memory, loaded from the file
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            CalcFileStats(f, backend.times, backend.stats);
     }
 
-    CreateReport(statsNano, hasD2DSVG ? &statsD2D : nullptr, runCount, report);
+    VectorMetrics metrics(m_fileNames.size());
+
+    if ( wxDirExists(m_dirName) )
+    {
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            CalcMetrics(f, metrics[f]);
+    }
 
-    CreateDetailedReport(timesNano, statsNano,
-                         hasD2DSVG ? &timesD2D : nullptr, hasD2DSVG ? &statsD2D : nullptr,
-                         true, detailedReport);
+    if ( results )
+    {
+        BeginResultsTable(*results);
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            WriteResultsRows(backends, f, *results);
+        results->EndTable();
+        results->EndDocument();
+    }
+
+    if ( detailedReport )
+    {
+        BeginDetailedTable(*detailedReport);
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            WriteDetailedRows(backends, f, *detailedReport);
+        detailedReport->EndTable();
+        detailedReport->EndDocument();
+    }
+
+    CreateReport(backends, metrics, runCount, report);
 
     return true;
 }
 
-bool wxTestSVGRasterizationBenchmark::BenchmarkFile(CreateBitmapBundleFn fn,
-                                                    const wxString& fileName,
-                                                    size_t runCount, MatrixLong2& times)
+bool wxTestSVGRasterizationBenchmark::BenchmarkFile(CreateBitmapBundleImplFn fn,
+                                                    size_t fileIndex, size_t runCount,
+                                                    BackendResults& results)
 {
-    wxStopWatch stopWatch;
-
-    times.resize(m_sizes.size());
-    for ( auto& t : times )
-        t.resize(runCount);
+    const wxString&        fileName = m_fileNames[fileIndex];
+    const wxString         fullPath = GetFilePath(fileIndex);
+    const SamplingOptions& options  = m_samplingOptions;
+    PhaseTimes&            times    = results.times;
+
+    wxStopWatch       stopWatch;
+    wxStopWatch       budgetStopWatch;
+    std::vector<bool> isSizeDone(m_sizes.size(), false);
+    size_t            measuredRunCount = 0;
+    size_t            nextCheckRunCount = runCount;
+
+    // there may be more than runCount times in the adaptive mode
+    for ( auto& phaseTimes : times )
+    {
+        for ( auto& t : phaseTimes[fileIndex] )
+            t.reserve(runCount);
+    }
 
-    for ( size_t run = 0; run < runCount; ++run )
+    for ( size_t run = 0; ; ++run )
     {
-        const wxBitmapBundle bundle = fn(wxFileName(m_dirName, fileName).GetFullPath());
+        const bool isWarmup = run < options.warmupRunCount;
+
+        if ( !isWarmup && measuredRunCount >= runCount )
+        {
+            if ( !options.adaptive
+                 || measuredRunCount >= options.maxRunCount
+                 || budgetStopWatch.Time() > options.timeBudget )
+                break;
+
+            // the bootstrap is not cheap, so the cells are not checked after every run
+            if ( measuredRunCount >= nextCheckRunCount )
+            {
+                bool isDone = true;
+
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    if ( !isSizeDone[s] )
+                        isSizeDone[s] = IsCIWidthReached(times[Phase_Bitmap][fileIndex][s]);
+                    isDone = isDone && isSizeDone[s];
+                }
+
+                if ( isDone )
+                    break;
 
-        wxBitmap   bitmap;
-        wxLongLong time;
+                nextCheckRunCount = measuredRunCount + wxMax(size_t(5), measuredRunCount / 10);
+            }
+        }
+
+        wxCharBuffer data;
+        long         ioTime = 0, parseTime = 0;
+
+        stopWatch.Start();
+        if ( !ReadFile(fullPath, data) )
+        {
+            wxLogError("Couldn't read file '%s'.", fileName);
+            return false;
+        }
+        ioTime = stopWatch.TimeInMicro().ToLong();
+
+        // the counters are started before and stopped after the stop watch,
+        // so that their overhead is not included in the times
+        StartAllocCounter();
+        StartPerfCounters();
+        stopWatch.Start();
+        wxBitmapBundleImplSVG* impl = fn(data.data());
+        // the impls parsing lazily would parse in the first RasterizeToBuffer()
+        if ( impl && !impl->Parse() )
+        {
+            impl->DecRef();
+            impl = nullptr;
+        }
+        parseTime = stopWatch.TimeInMicro().ToLong();
+        if ( m_perfCounters.IsOpened() )
+            StopPerfCounters(!isWarmup, results.parseCounters[fileIndex][0]);
+        if ( m_isAllocCounterEnabled )
+            StopAllocCounter(!isWarmup && impl, results.parseAllocs[fileIndex][0]);
+
+        if ( !isWarmup )
+        {
+            times[Phase_IO][fileIndex][0].push_back(ioTime);
+            times[Phase_Parse][fileIndex][0].push_back(parseTime);
+        }
+
+        if ( !impl )
+        {
+            wxLogError("Couldn't parse file '%s'.", fileName);
+            return false;
+        }
+
+        // takes the ownership of impl
+        const wxBitmapBundle bundle = wxBitmapBundle::FromImpl(impl);
+
+        wxBitmap bitmap;
+        long     rasterizeTime = 0, convertTime = 0;
 
         for ( size_t s = 0; s < m_sizes.size(); ++s )
         {
+            if ( isSizeDone[s] )
+                continue;
+
             const wxSize& bitmapSize = m_sizes[s];
 
+            // so that its deallocation is neither measured nor counted
+            bitmap = wxNullBitmap;
+
+            StartAllocCounter();
+            StartPerfCounters();
             stopWatch.Start();
-            bitmap = bundle.GetBitmap(bitmapSize);
-            time = stopWatch.TimeInMicro();
-            times[s][run] = time.ToLong();
+            const bool rasterized = impl->RasterizeToBuffer(bitmapSize);
+            rasterizeTime = stopWatch.TimeInMicro().ToLong();
+
+            if ( rasterized )
+            {
+                stopWatch.Start();
+                bitmap = impl->ConvertBufferToBitmap(bitmapSize);
+                convertTime = stopWatch.TimeInMicro().ToLong();
+            }
+            if ( m_perfCounters.IsOpened() )
+                StopPerfCounters(!isWarmup && rasterized, results.bitmapCounters[fileIndex][s]);
+            if ( m_isAllocCounterEnabled )
+                StopAllocCounter(!isWarmup && rasterized, results.bitmapAllocs[fileIndex][s]);
 
-            if ( !bitmap.IsOk() )
-             {
+            if ( !rasterized || !bitmap.IsOk() )
+            {
                 wxLogError("Couldn't rasterize file '%s' at size %dx%d.", fileName, bitmapSize.x, bitmapSize.y);
                 return false;
             }
+
+            if ( !isWarmup )
+            {
+                times[Phase_Rasterize][fileIndex][s].push_back(rasterizeTime);
+                times[Phase_Convert][fileIndex][s].push_back(convertTime);
+                times[Phase_Bitmap][fileIndex][s].push_back(rasterizeTime + convertTime);
+            }
         }
+
+        if ( !isWarmup )
+            ++measuredRunCount;
     }
 
     return true;
 }
 
-void wxTestSVGRasterizationBenchmark::CreateReport(const MatrixStats& statsNano, const MatrixStats* statsD2D,
+void wxTestSVGRasterizationBenchmark::StartPerfCounters()
+{
+    if ( m_perfCounters.IsOpened() )
+        m_perfCounters.Start();
+}
+
+void wxTestSVGRasterizationBenchmark::StopPerfCounters(bool isMeasured, CounterSums& sums)
+{
+    wxTestSVGPerfCounters::Values values;
+
+    if ( !m_perfCounters.Stop(values) || !isMeasured )
+        return;
+
+    ++sums.runCount;
+    for ( size_t c = 0; c < wxTestSVGPerfCounters::Counter_Max; ++c )
+        sums.values[c] += values[c];
+}
+
+void wxTestSVGRasterizationBenchmark::StartAllocCounter()
+{
+    if ( m_isAllocCounterEnabled )
+        wxTestSVGAllocCounter::Start();
+}
+
+void wxTestSVGRasterizationBenchmark::StopAllocCounter(bool isMeasured, AllocSums& sums)
+{
+    wxTestSVGAllocCounter::Values values;
+
+    wxTestSVGAllocCounter::Stop(values);
+    if ( !isMeasured )
+        return;
+
+    ++sums.runCount;
+    sums.allocCount += values.allocCount;
+    sums.allocBytes += values.allocBytes;
+    sums.liveBytes  += values.liveBytes;
+    sums.peakBytes   = wxMax(sums.peakBytes, values.peakBytes);
+}
+
+bool wxTestSVGRasterizationBenchmark::EnableAllocCounter(bool enable)
+{
+    m_isAllocCounterEnabled = enable && wxTestSVGAllocCounter::IsAvailable();
+    return m_isAllocCounterEnabled == enable;
+}
+
+bool wxTestSVGRasterizationBenchmark::EnablePerfCounters(bool enable)
+{
+    if ( !enable )
+    {
+        m_perfCounters.Close();
+        return true;
+    }
+
+    return m_perfCounters.IsOpened() || m_perfCounters.Open();
+}
+
+void wxTestSVGRasterizationBenchmark::CalcMetrics(size_t fileIndex, wxTestSVGDocumentMetrics& metrics) const
+{
+    if ( !wxTestSVGDocumentMetrics::IsAvailable() )
+        return;
+
+    wxCharBuffer data;
+
+    if ( !ReadFile(GetFilePath(fileIndex), data) || !metrics.Calculate(data.data(), m_sizes) )
+        wxLogWarning("Couldn't calculate the complexity of file '%s'.", m_fileNames[fileIndex]);
+}
+
+bool wxTestSVGRasterizationBenchmark::IsCIWidthReached(const VectorLong& data) const
+{
+    VectorLong dataSorted(data);
+    long       low = 0, high = 0;
+
+    std::sort(dataSorted.begin(), dataSorted.end());
+    CalcMedianCI(dataSorted, low, high);
+
+    const long median = GetMedian(dataSorted);
+
+    if ( median <= 0 )
+        return high == low;
+
+    return static_cast<double>(high - low) / median <= m_samplingOptions.targetCIWidth;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateReport(const VectorBackendResults& backends,
+                                                   const VectorMetrics& metrics,
                                                    size_t runCount, wxString& reportText)
 {
-    wxArrayString       result;    
-    wxString            rowStr;
-    std::vector<double> sumsNano(m_sizes.size());
-    VectorLong          minsNano(m_sizes.size(), LONG_MAX), maxesNano(m_sizes.size(), LONG_MIN);
-    std::vector<double> sumsD2D(m_sizes.size());
-    VectorLong          minsD2D(m_sizes.size(), LONG_MAX), maxesD2D(m_sizes.size(), LONG_MIN);
-        
+    struct Column
+    {
+        const PhaseStats* stats;
+        size_t            phase;
+        size_t            size;
+    };
+
+    std::vector<Column>        columns;
+    std::vector<wxArrayString> columnLabels;
+    wxArrayString              result;
+    wxString                   rowStr;
+
+    const auto addColumns = [&](const wxString& group, size_t phase, size_t size)
+    {
+        wxArrayString labels;
+
+        labels.push_back(group);
+        labels.push_back(GetPhaseName(phase));
+        labels.push_back(wxString());
+
+        for ( const auto& backend : backends )
+        {
+            if ( phase == Phase_Convert && (backend.flags & wxTestSVGBackend::Flag_NoConvertPhase) )
+                continue;
+
+            labels.back() = backend.name;
+            columns.push_back({ &backend.stats, phase, size });
+            columnLabels.push_back(labels);
+        }
+    };
+
+    addColumns("Loading", Phase_IO, 0);
+    addColumns("Loading", Phase_Parse, 0);
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        const wxString sizeStr = wxString::Format("%dx%d", m_sizes[s].x, m_sizes[s].y);
+
+        addColumns(sizeStr, Phase_Rasterize, s);
+        addColumns(sizeStr, Phase_Convert, s);
+        addColumns(sizeStr, Phase_Bitmap, s);
+    }
+
+    std::vector<double> sums(columns.size());
+    std::vector<double> maxCIWidths(columns.size());
+    VectorLong          mins(columns.size(), LONG_MAX), maxes(columns.size(), LONG_MIN);
+    size_t              minRunCount = SIZE_MAX, maxRunCount = 0;
+
     rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Report">)";
     rowStr += "<style>";
     rowStr += "table, th, td, tfoot {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} tfoot {color: red;} ";
@@ -161,358 +585,1006 @@ void wxTestSVGRasterizationBenchmark::CreateReport(const MatrixStats& statsNano,
     rowStr += "</style></head><body>\n";
     result.push_back(rowStr);
 
-    result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu runs)</h1>", 
-        m_fileNames.size(), m_dirName, runCount));
-    result.push_back("<p>Unless indicated otherwise, the times are in microseconds</p>");
+    for ( const auto& c : columns )
+    {
+        for ( const auto& fileStats : (*c.stats)[c.phase] )
+        {
+            minRunCount = wxMin(minRunCount, fileStats[c.size].count);
+            maxRunCount = wxMax(maxRunCount, fileStats[c.size].count);
+        }
+    }
 
-    // create headers    
-    rowStr = R"(<table>)";    
-    rowStr += R"(<thead><tr>)";
-    rowStr += R"(<th rowspan="2">File</th>)";
-    for ( const auto& s : m_sizes )
+    if ( minRunCount == maxRunCount )
     {
-        rowStr += wxString::Format(R"(<th colspan="2">%dx%d</th>)", s.x, s.y);
+        result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu runs)</h1>",
+            m_fileNames.size(), m_dirName, runCount));
+    }
+    else
+    {
+        result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu to %zu runs)</h1>",
+            m_fileNames.size(), m_dirName, minRunCount, maxRunCount));
+    }
+    result.push_back("<p>Unless indicated otherwise, the times are in microseconds (median of all runs). "
+                     "Total is the time of wxBitmapBundle::GetBitmap(), i.e., Rasterize + Convert.</p>");
+    result.push_back(wxString::Format("<p>Each file was benchmarked with %zu warm-up runs not included in the results. "
+                                      "Max CI is the largest width of the bootstrap 95%% confidence interval "
+                                      "of the median relative to the median, in percent.",
+                                      m_samplingOptions.warmupRunCount));
+    if ( m_samplingOptions.adaptive )
+    {
+        result.back() += wxString::Format(" Sampling was adaptive: each file and size was measured "
+                                          "until the total time Max CI fell below %.1f %%, "
+                                          "at most %zu times and for at most %ld ms per file and backend.",
+                                          m_samplingOptions.targetCIWidth * 100, m_samplingOptions.maxRunCount,
+                                          m_samplingOptions.timeBudget);
+    }
+    result.back() += "</p>";
+    for ( const auto& backend : backends )
+    {
+        if ( !backend.description.empty() )
+            result.push_back(wxString::Format("<p>%s</p>", backend.description));
     }
-    rowStr += R"(</tr>)";
-    rowStr += "\n";
-    result.push_back(rowStr);
 
-    rowStr = R"(<tr>)";
-    for ( size_t i = 0; i < m_sizes.size(); ++i )
-        rowStr += "<th>Nano</th><th>D2D</th>";
-    rowStr += R"(</tr>)";
-    rowStr += R"(</thead>)";
-    rowStr += "\n";
-    result.push_back(rowStr);
+    // create headers
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
 
     result.push_back("<tbody>\n");
     for ( size_t f = 0; f < m_fileNames.size(); ++f )
     {
-        rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(m_fileNames[f]).GetName());
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        rowStr = wxString::Format("<tr><td>%s</td>", GetDisplayName(f));
+        for ( size_t c = 0; c < columns.size(); ++c )
         {
-            rowStr += wxString::Format("<td>%ld</td><td>%s</td>",
-                statsNano[f][s].mdn, statsD2D ? wxString::Format("%ld", (*statsD2D)[f][s].mdn) : "");
+            const Stats& stats = (*columns[c].stats)[columns[c].phase][f][columns[c].size];
+            const long   value = stats.mdn;
 
-            sumsNano[s] += statsNano[f][s].mdn;
-            if ( statsNano[f][s].mdn < minsNano[s] )
-                minsNano[s] = statsNano[f][s].mdn;
-            if ( statsNano[f][s].mdn > maxesNano[s] )
-                maxesNano[s] = statsNano[f][s].mdn;
+            rowStr += wxString::Format("<td>%ld</td>", value);
 
-            
-            if ( statsD2D )
-            {
-                sumsD2D[s] += (*statsD2D)[f][s].mdn;
-                if ( (*statsD2D)[f][s].mdn < minsD2D[s] )
-                    minsD2D[s] = (*statsD2D)[f][s].mdn;
-                if ( (*statsD2D)[f][s].mdn > maxesD2D[s] )
-                    maxesD2D[s] = (*statsD2D)[f][s].mdn;
+            if ( value > 0 )
+                maxCIWidths[c] = wxMax(maxCIWidths[c], 100. * (stats.mdnCIHigh - stats.mdnCILow) / value);
 
-            }
+            sums[c] += value;
+            if ( value < mins[c] )
+                mins[c] = value;
+            if ( value > maxes[c] )
+                maxes[c] = value;
         }
         rowStr += "</tr>\n";
         result.push_back(rowStr);
     }
     result.push_back("</tbody>\n");
 
-    wxString sumsStr, minsStr, maxesStr;
+    wxString sumsStr, minsStr, maxesStr, maxCIWidthsStr;
 
     sumsStr = "<tfoot><tr><td>Sum (milliseconds)</td>";
     minsStr = "<tr><td>Min</td>";
     maxesStr = "<tr><td>Max</td>";
-    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    maxCIWidthsStr = "<tr><td>Max CI (%)</td>";
+    for ( size_t c = 0; c < columns.size(); ++c )
     {
-        sumsStr += wxString::Format("<td>%.2f</td><td>%s</td>",
-            sumsNano[s] / 1000., statsD2D ? wxString::Format("%.2f", sumsD2D[s] / 1000. ) : "");
-        minsStr += wxString::Format("<td>%ld</td><td>%s</td>",
-            minsNano[s], statsD2D ? wxString::Format("%ld", minsD2D[s]) : "");
-        maxesStr += wxString::Format("<td>%ld</td><td>%s</td>",
-            maxesNano[s], statsD2D ? wxString::Format("%ld", maxesD2D[s]) : "");
+        sumsStr += wxString::Format("<td>%.2f</td>", sums[c] / 1000.);
+        minsStr += wxString::Format("<td>%ld</td>", mins[c]);
+        maxesStr += wxString::Format("<td>%ld</td>", maxes[c]);
+        maxCIWidthsStr += wxString::Format("<td>%.1f</td>", maxCIWidths[c]);
     }
     result.push_back(sumsStr + "</tr>\n");
     result.push_back(minsStr + "</tr>\n");
     result.push_back(maxesStr + "</tr>\n");
-    result.push_back("<tfoot>");
+    result.push_back(maxCIWidthsStr + "</tr>\n");
+    result.push_back("</tfoot>");
     result.push_back("</table>\n");
+
+    if ( std::any_of(metrics.begin(), metrics.end(),
+                     [](const wxTestSVGDocumentMetrics& m) { return !m.edgeCounts.empty(); }) )
+    {
+        AppendComplexityTables(backends, metrics, result);
+    }
+
+    if ( !backends.front().bitmapCounters.empty() )
+        AppendPerfCountersTable(backends, result);
+
+    if ( !backends.front().bitmapAllocs.empty() )
+        AppendAllocTable(backends, result);
+
     result.push_back("</body></html>");
 
     for ( const auto& r : result )
         reportText += r + "\n";
 }
 
-// if !asHTML, the result is plaintext with the values separated by tabs
-void wxTestSVGRasterizationBenchmark::CreateDetailedReport(const MatrixLong3& timesNano, const MatrixStats& statsNano,
-                                                           const MatrixLong3* timesD2D,  const MatrixStats* statsD2D,
-                                                           bool asHTML, wxString& reportText)
+void wxTestSVGRasterizationBenchmark::AppendComplexityTables(const VectorBackendResults& backends,
+                                                             const VectorMetrics& metrics,
+                                                             wxArrayString& result)
 {
-    const size_t runCount = timesNano[0][0].size();
+    std::vector<wxArrayString> columnLabels;
+    wxString                   rowStr;
+
+    const auto hasMetrics = [&](size_t fileIndex)
+    {
+        return metrics[fileIndex].edgeCounts.size() == m_sizes.size();
+    };
+    const auto getSizeStr = [&](size_t sizeIndex)
+    {
+        return wxString::Format("%dx%d", m_sizes[sizeIndex].x, m_sizes[sizeIndex].y);
+    };
+    const auto addColumn = [&](const wxString& group, const wxString& label)
+    {
+        columnLabels.push_back(wxArrayString());
+        if ( !group.empty() )
+            columnLabels.back().push_back(group);
+        columnLabels.back().push_back(label);
+    };
+    const auto getMedian = [](std::vector<double> data) -> double
+    {
+        if ( data.empty() )
+            return 0;
+
+        std::sort(data.begin(), data.end());
+        if ( data.size() % 2 == 0 )
+            return (data[data.size() / 2 - 1] + data[data.size() / 2]) / 2;
+        return data[data.size() / 2];
+    };
+
+    // structural metrics of each file
+    for ( const auto& label : { "Shapes", "Paths", "Cubics", "Gradients", "Stroke %", "Coverage" } )
+        addColumn("Document", label);
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+        addColumn("Flattened Edges", getSizeStr(s));
+
+    result.push_back("<h3>Complexity</h3>");
+    result.push_back("<p>The structure of each document as parsed by NanoSVG: visible shapes, their paths, "
+                     "cubic Bezier segments, and gradient paints, the share of strokes among the fills "
+                     "and strokes painted, and the sum of the shape bounding boxes relative to "
+                     "the document area (Coverage, roughly how many times each pixel is painted). "
+                     "Flattened edges are those the NanoSVG rasterizer processes at each size, "
+                     "with strokes estimated as twice their centerline.</p>");
 
-    wxArrayString result;
-    wxString      rowStr;
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
 
-    if ( asHTML )
+    result.push_back("<tbody>\n");
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
     {
-        rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Benchmark Detailed Report">)";
-        rowStr += "<style>";
-        rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse} td {text-align: right}";
-        rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif}";
-        rowStr += "</style></head><body>\n";
+        const wxTestSVGDocumentMetrics& m = metrics[f];
+
+        rowStr = wxString::Format("<tr><td>%s</td>", GetDisplayName(f));
+        if ( hasMetrics(f) )
+        {
+            rowStr += wxString::Format("<td>%zu</td><td>%zu</td><td>%zu</td><td>%zu</td><td>%.0f</td><td>%.2f</td>",
+                                       m.shapeCount, m.pathCount, m.cubicCount, m.gradientCount,
+                                       m.GetStrokeShare() * 100, m.bboxCoverage);
+            for ( const auto& edgeCount : m.edgeCounts )
+                rowStr += wxString::Format("<td>%zu</td>", edgeCount);
+        }
+        else
+        {
+            for ( size_t c = 0; c < columnLabels.size(); ++c )
+                rowStr += "<td>-</td>";
+        }
+        rowStr += "</tr>\n";
         result.push_back(rowStr);
     }
+    result.push_back("</tbody></table>\n");
 
-    // create headers
-    if ( asHTML )
+    // model of the bitmap time of each backend and its outliers
+    struct Outlier
+    {
+        size_t file;
+        size_t size;
+        size_t backend;
+        double time;
+        double predicted;
+        double robustZ;
+    };
+
+    std::vector<wxTestSVGTimeModel> models(backends.size());
+    std::vector<Outlier>            outliers;
+
+    for ( size_t b = 0; b < backends.size(); ++b )
     {
-        result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s'</h1>", m_fileNames.size(), m_dirName));
-        result.push_back("<p>All times are in microseconds</p>");
-        rowStr = R"(<table style="width:100%">)";
-        rowStr += R"(<thead><tr>)";
-        rowStr += R"(<th rowspan="3">Run</th>)";
-        for ( const auto& f : m_fileNames )
+        const MatrixStats&                     stats = backends[b].stats[Phase_Bitmap];
+        wxTestSVGTimeModel::VectorSamples      samples;
+        std::vector<std::pair<size_t, size_t>> sampleCells; // file and size of each sample
+
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
         {
-            rowStr += wxString::Format(R"(<th colspan="%zu">%s</th>)",
-                m_sizes.size() * 2, wxFileName(f).GetName());
+            if ( !hasMetrics(f) )
+                continue;
+
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+            {
+                wxTestSVGTimeModel::Sample sample;
+
+                sample.edges  = static_cast<double>(metrics[f].edgeCounts[s]);
+                sample.pixels = static_cast<double>(m_sizes[s].x) * m_sizes[s].y;
+                sample.time   = static_cast<double>(stats[f][s].mdn);
+                samples.push_back(sample);
+                sampleCells.push_back(std::make_pair(f, s));
+            }
+        }
+
+        if ( !models[b].Fit(samples) )
+            continue;
+
+        std::vector<double> residuals, deviations;
+
+        for ( const auto& sample : samples )
+            residuals.push_back(sample.time - models[b].Predict(sample.edges, sample.pixels));
+
+        const double median = getMedian(residuals);
+
+        for ( const auto& r : residuals )
+            deviations.push_back(std::fabs(r - median));
+
+        const double mad = getMedian(deviations);
+
+        // all the residuals being the same, there are no outliers
+        if ( mad <= 0 )
+            continue;
+
+        for ( size_t i = 0; i < samples.size(); ++i )
+        {
+            // 0.6745 makes it comparable to the z-score for normally distributed data
+            const double robustZ = 0.6745 * (residuals[i] - median) / mad;
+
+            if ( robustZ > OutlierMinRobustZ )
+            {
+                outliers.push_back({ sampleCells[i].first, sampleCells[i].second, b,
+                                     samples[i].time, samples[i].time - residuals[i], robustZ });
+            }
         }
-        rowStr += R"(</tr>)";
     }
-    else
+
+    result.push_back("<h3>Time Model</h3>");
+    result.push_back("<p>The median bitmap time (Total) of all the files and sizes fitted by least squares "
+                     "as a + b &times; edges + c &times; pixels, where edges are the flattened edges "
+                     "and pixels the bitmap area. R&sup2; is the share of the time variance "
+                     "the model explains.</p>");
+
+    columnLabels.clear();
+    for ( const auto& label : { "a (&micro;s)", "b (ns/edge)", "c (ns/pixel)", "R&sup2;", "Samples" } )
+        addColumn(wxString(), label);
+
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("Backend", columnLabels, result);
+    result.push_back("</thead>\n");
+
+    result.push_back("<tbody>\n");
+    for ( size_t b = 0; b < backends.size(); ++b )
     {
-        rowStr = "Run\t";
-        for ( const auto& f : m_fileNames )
+        const wxTestSVGTimeModel& model = models[b];
+
+        rowStr = wxString::Format("<tr><td>%s</td>", backends[b].name);
+        if ( model.GetSampleCount() > 0 )
         {
-            rowStr += wxFileName(f).GetName();
-            rowStr += wxString('\t', m_sizes.size() * 2);
+            rowStr += wxString::Format("<td>%.1f</td><td>%.2f</td><td>%.3f</td><td>%.3f</td><td>%zu</td>",
+                                       model.GetIntercept(), model.GetPerEdge() * 1000,
+                                       model.GetPerPixel() * 1000, model.GetRSquared(),
+                                       model.GetSampleCount());
         }
+        else
+        {
+            rowStr += "<td>-</td><td>-</td><td>-</td><td>-</td><td>0</td>";
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
     }
-    rowStr += "\n";
-    result.push_back(rowStr);
+    result.push_back("</tbody></table>\n");
+
+    // the most time above the prediction first
+    std::sort(outliers.begin(), outliers.end(), [](const Outlier& o1, const Outlier& o2)
+        {
+            return o1.time - o1.predicted > o2.time - o2.predicted;
+        });
+
+    const double minRobustZ = OutlierMinRobustZ;
 
-    if ( asHTML )
+    result.push_back("<h3>Outliers</h3>");
+    result.push_back(wxString::Format("<p>The files and sizes much slower than the time model predicts, "
+                                      "i.e., with the robust z-score of the difference from the prediction "
+                                      "(based on the median absolute deviation) above %.1f, "
+                                      "ordered by the time above the prediction. "
+                                      "These are where optimizing the rasterization pays off most.</p>",
+                                      minRobustZ));
+
+    if ( outliers.empty() )
     {
-        rowStr = R"(<tr>)";
-        for ( const auto& f : m_fileNames )
+        result.push_back("<p>There are no outliers.</p>");
+        return;
+    }
+
+    if ( outliers.size() > OutlierMaxCount )
+    {
+        result.back() = result.back().BeforeLast('<');
+        result.back() += wxString::Format(" Only the first %zu of %zu are shown.</p>",
+                                          static_cast<size_t>(OutlierMaxCount), outliers.size());
+        outliers.resize(OutlierMaxCount);
+    }
+
+    columnLabels.clear();
+    for ( const auto& label : { "Size", "Backend", "Total", "Predicted", "Ratio", "Robust z", "Edges", "Shapes" } )
+        addColumn(wxString(), label);
+
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
+
+    result.push_back("<tbody>\n");
+    for ( const auto& o : outliers )
+    {
+        rowStr = wxString::Format("<tr><td>%s</td><td>%s</td><td>%s</td>",
+                                  GetDisplayName(o.file), getSizeStr(o.size),
+                                  backends[o.backend].name);
+        rowStr += wxString::Format("<td>%.0f</td><td>%.0f</td>", o.time, o.predicted);
+        if ( o.predicted > 0 )
+            rowStr += wxString::Format("<td>%.1f</td>", o.time / o.predicted);
+        else
+            rowStr += "<td>-</td>";
+        rowStr += wxString::Format("<td>%.1f</td><td>%zu</td><td>%zu</td></tr>\n",
+                                   o.robustZ, metrics[o.file].edgeCounts[o.size], metrics[o.file].shapeCount);
+        result.push_back(rowStr);
+    }
+    result.push_back("</tbody></table>\n");
+}
+
+void wxTestSVGRasterizationBenchmark::AppendPerfCountersTable(const VectorBackendResults& backends,
+                                                              wxArrayString& result)
+{
+    typedef wxTestSVGPerfCounters Counters;
+
+    enum Value
+    {
+        Value_IPC = 0,
+        Value_KiloInstructions,
+        Value_CyclesPerPixel,
+        Value_L1DMissesPerPixel,
+        Value_LLCMissesPerPixel,
+        Value_LLCMPKI,
+        Value_BranchMissesPerPixel,
+        Value_PageFaults,
+    };
+
+    struct Column
+    {
+        const MatrixCounterSums* sums;
+        size_t                   size;
+        Value                    value;
+        Counters::Counter        counter; // the one required besides instructions
+    };
+
+    const auto GetRequiredCounter = [](Value value) -> Counters::Counter
+    {
+        switch ( value )
         {
-            wxUnusedVar(f);
-            for ( const auto& s : m_sizes )
-                rowStr += wxString::Format(R"(<th colspan="2">%dx%d</th>)", s.x, s.y);
+            case Value_IPC:
+            case Value_CyclesPerPixel:       return Counters::Counter_Cycles;
+            case Value_KiloInstructions:     return Counters::Counter_Instructions;
+            case Value_L1DMissesPerPixel:    return Counters::Counter_L1DMisses;
+            case Value_LLCMissesPerPixel:
+            case Value_LLCMPKI:              return Counters::Counter_LLCMisses;
+            case Value_BranchMissesPerPixel: return Counters::Counter_BranchMisses;
+            case Value_PageFaults:           break;
         }
-        rowStr += R"(</tr>)";
-    }
-    else
+        return Counters::Counter_PageFaults;
+    };
+
+    std::vector<Column>        columns;
+    std::vector<wxArrayString> columnLabels;
+    wxString                   rowStr;
+    wxString                   unavailable;
+
+    const auto addColumns = [&](const wxString& group, bool isParse, size_t size,
+                                const std::vector<std::pair<Value, wxString>>& values)
     {
-        rowStr = "\t"; // Run column
-        for ( const auto& f : m_fileNames )
+        for ( const auto& backend : backends )
         {
-            wxUnusedVar(f);
-            for ( const auto& s : m_sizes )
-                rowStr += wxString::Format("%dx%d\t\t", s.x, s.y);
+            for ( const auto& value : values )
+            {
+                wxArrayString labels;
+
+                labels.push_back(group);
+                labels.push_back(backend.name);
+                labels.push_back(value.second);
+                columns.push_back({ isParse ? &backend.parseCounters : &backend.bitmapCounters,
+                                    size, value.first, GetRequiredCounter(value.first) });
+                columnLabels.push_back(labels);
+            }
         }
-        rowStr.RemoveLast(2); // extra tabs at the end of the row
+    };
+
+    addColumns("Parse", true, 0,
+               { { Value_IPC, "IPC" }, { Value_KiloInstructions, "kInstr" },
+                 { Value_LLCMPKI, "LLC MPKI" }, { Value_PageFaults, "PF" } });
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        addColumns(wxString::Format("%dx%d", m_sizes[s].x, m_sizes[s].y), false, s,
+                   { { Value_IPC, "IPC" }, { Value_CyclesPerPixel, "Cyc/px" },
+                     { Value_L1DMissesPerPixel, "L1D/px" }, { Value_LLCMissesPerPixel, "LLC/px" },
+                     { Value_LLCMPKI, "LLC MPKI" }, { Value_BranchMissesPerPixel, "BrM/px" },
+                     { Value_PageFaults, "PF" } });
     }
-    rowStr += "\n";
-    result.push_back(rowStr);
 
-    if ( asHTML )
+    for ( size_t c = 0; c < Counters::Counter_Max; ++c )
     {
-        rowStr = R"(<tr>)";
-        for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
-            rowStr += "<th>Nano</th><th>D2D</th>";
-        rowStr += R"(</tr>)";
-        rowStr += R"(</thead>)";
+        if ( !m_perfCounters.IsAvailable(static_cast<Counters::Counter>(c)) )
+        {
+            if ( !unavailable.empty() )
+                unavailable += ", ";
+            unavailable += Counters::GetCounterName(static_cast<Counters::Counter>(c));
+        }
     }
-    else
+
+    result.push_back("<h3>Hardware Performance Counters</h3>");
+    result.push_back("<p>The means per run in the user space. IPC is instructions per cycle, "
+                     "/px per output pixel, MPKI misses per 1000 instructions, and PF page faults. "
+                     "A low IPC with many cache misses suggests a memory-bound file, "
+                     "a high IPC a compute-bound one.");
+    if ( !unavailable.empty() )
+        result.back() += wxString::Format(" Counters not available: %s.", unavailable);
+    result.back() += "</p>";
+
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
+
+    result.push_back("<tbody>\n");
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
     {
-        rowStr.clear();
-        for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
-            rowStr += "\tNano\tD2D";
+        rowStr = wxString::Format("<tr><td>%s</td>", GetDisplayName(f));
+
+        for ( const auto& c : columns )
+        {
+            const CounterSums&      sums   = (*c.sums)[f][c.size];
+            const Counters::Values& values = sums.values;
+            const double            pixels = static_cast<double>(m_sizes[c.size].x) * m_sizes[c.size].y;
+
+            if ( sums.runCount == 0 || !m_perfCounters.IsAvailable(c.counter)
+                 || ((c.value == Value_IPC || c.value == Value_LLCMPKI)
+                     && !m_perfCounters.IsAvailable(Counters::Counter_Instructions)) )
+            {
+                rowStr += "<td>-</td>";
+                continue;
+            }
+
+            const double instructions = values[Counters::Counter_Instructions];
+            double       value = 0;
+
+            switch ( c.value )
+            {
+                case Value_IPC:
+                    value = values[Counters::Counter_Cycles] > 0 ? instructions / values[Counters::Counter_Cycles] : 0;
+                    break;
+                case Value_KiloInstructions:
+                    value = instructions / sums.runCount / 1000;
+                    break;
+                case Value_CyclesPerPixel:
+                    value = values[Counters::Counter_Cycles] / sums.runCount / pixels;
+                    break;
+                case Value_L1DMissesPerPixel:
+                    value = values[Counters::Counter_L1DMisses] / sums.runCount / pixels;
+                    break;
+                case Value_LLCMissesPerPixel:
+                    value = values[Counters::Counter_LLCMisses] / sums.runCount / pixels;
+                    break;
+                case Value_LLCMPKI:
+                    value = instructions > 0 ? values[Counters::Counter_LLCMisses] * 1000 / instructions : 0;
+                    break;
+                case Value_BranchMissesPerPixel:
+                    value = values[Counters::Counter_BranchMisses] / sums.runCount / pixels;
+                    break;
+                case Value_PageFaults:
+                    value = values[Counters::Counter_PageFaults] / sums.runCount;
+                    break;
+            }
+
+            rowStr += wxString::Format(c.value == Value_CyclesPerPixel || c.value == Value_KiloInstructions
+                                       ? "<td>%.1f</td>" : "<td>%.3f</td>", value);
+        }
+
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
     }
-    rowStr += "\n";
-    result.push_back(rowStr);
+    result.push_back("</tbody></table>\n");
+}
 
-    const wxChar* valueFormatHTML = wxS("<td>%ld</td><td>%s</td>");
-    const wxChar* valueFormatTSV = wxS("%ld\t%s\t");
+void wxTestSVGRasterizationBenchmark::AppendAllocTable(const VectorBackendResults& backends,
+                                                       wxArrayString& result)
+{
+    enum Value
+    {
+        Value_AllocCount = 0,
+        Value_AllocBytes,
+        Value_PeakBytes,
+        Value_LiveBytes,
+    };
 
-    if ( asHTML )
-        result.push_back("<tbody>\n");
-    for ( size_t run = 0; run < runCount; ++run )
+    struct Column
     {
-        if ( asHTML )
-            rowStr.Printf(R"(<tr><td>%zu</td>)", run + 1);
-        else
-            rowStr.Printf("%zu\t", run + 1);
+        const MatrixAllocSums* sums;
+        size_t                 size;
+        Value                  value;
+    };
 
-        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    std::vector<Column>        columns;
+    std::vector<wxArrayString> columnLabels;
+    wxString                   rowStr;
+
+    const auto addColumns = [&](const wxString& group, bool isParse, size_t size)
+    {
+        for ( const auto& backend : backends )
         {
-            for ( size_t s = 0; s < m_sizes.size(); ++s )
+            for ( size_t v = Value_AllocCount; v <= Value_LiveBytes; ++v )
             {
-                rowStr += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                    timesNano[f][s][run],
-                    timesD2D ? wxString::Format("%ld", (*timesD2D)[f][s][run]) : "");
+                static const char* const valueLabels[] = { "Allocs", "kB", "Peak kB", "Doc kB" };
+                wxArrayString labels;
+
+                // the bytes retained after getting a bitmap are just its buffer
+                if ( v == Value_LiveBytes && !isParse )
+                    break;
+
+                labels.push_back(group);
+                labels.push_back(backend.name);
+                labels.push_back(valueLabels[v]);
+                columns.push_back({ isParse ? &backend.parseAllocs : &backend.bitmapAllocs,
+                                    size, static_cast<Value>(v) });
+                columnLabels.push_back(labels);
             }
+        }
+    };
+
+    addColumns("Parse", true, 0);
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+        addColumns(wxString::Format("%dx%d", m_sizes[s].x, m_sizes[s].y), false, s);
+
+    result.push_back("<h3>Heap Allocations</h3>");
+    result.push_back("<p>The means per run of allocations and kilobytes allocated, "
+                     "the maximum of the peak live kilobytes, and for parsing the kilobytes "
+                     "still allocated afterwards, i.e., the size of the parsed document. "
+                     "Live kilobytes are usable sizes of the blocks, slightly larger than requested.</p>");
+
+    result.push_back(R"(<table><thead>)");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
 
+    result.push_back("<tbody>\n");
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        rowStr = wxString::Format("<tr><td>%s</td>", GetDisplayName(f));
+
+        for ( const auto& c : columns )
+        {
+            const AllocSums& sums = (*c.sums)[f][c.size];
+
+            if ( sums.runCount == 0 )
+            {
+                rowStr += "<td>-</td>";
+                continue;
+            }
+
+            switch ( c.value )
+            {
+                case Value_AllocCount:
+                    rowStr += wxString::Format("<td>%.0f</td>", sums.allocCount / sums.runCount);
+                    break;
+                case Value_AllocBytes:
+                    rowStr += wxString::Format("<td>%.1f</td>", sums.allocBytes / sums.runCount / 1024);
+                    break;
+                case Value_PeakBytes:
+                    rowStr += wxString::Format("<td>%.1f</td>", sums.peakBytes / 1024.);
+                    break;
+                case Value_LiveBytes:
+                    rowStr += wxString::Format("<td>%.1f</td>", sums.liveBytes / sums.runCount / 1024);
+                    break;
+            }
         }
-        if ( asHTML )
-            rowStr += R"(</tr>)";
-        else
-            rowStr.RemoveLast(); // extra tab
 
-        rowStr += "\n";
+        rowStr += "</tr>\n";
         result.push_back(rowStr);
     }
+    result.push_back("</tbody></table>\n");
+}
+
+void wxTestSVGRasterizationBenchmark::BeginDetailedTable(wxTestSVGReportWriter& writer) const
+{
+    static const char* const labels[] =
+    {
+        "File", "Width", "Height", "Phase", "Backend", "Median", "Median CI Low", "Median CI High",
+        "Mean", "StdDev", "MAD", "P90", "P99", "Min", "Max", "Runs", "Times"
+    };
+    wxTestSVGReportWriter::VectorColumns columns;
+
+    for ( const auto& label : labels )
+    {
+        columns.push_back(wxTestSVGReportWriter::Column());
+        columns.back().labels.push_back(label);
+    }
 
-    if ( asHTML )
-        result.push_back("</tbody>\n");
+    // the file, the phase, the backend, and the times
+    // of all the runs separated by spaces
+    columns[0].isNumeric = false;
+    columns[3].isNumeric = false;
+    columns[4].isNumeric = false;
+    columns.back().isNumeric = false;
 
-    wxString mdnRow("Median");
-    wxString avgRow("Mean");
-    wxString minRow("Min ");
-    wxString maxRow("Max");
+    writer.BeginDocument(wxString::Format("Benchmarked %zu files from folder '%s'", m_fileNames.size(), m_dirName));
+    writer.AddParagraph("All times are in microseconds");
+    writer.BeginTable("Statistics", columns);
+}
+
+void wxTestSVGRasterizationBenchmark::WriteDetailedRows(const VectorBackendResults& backends, size_t fileIndex,
+                                                        wxTestSVGReportWriter& writer)
+{
+    const size_t  f = fileIndex;
+    wxArrayString values;
 
-    if ( asHTML )
+    const auto addRows = [&](size_t phase, size_t size)
     {
-        result.push_back("<tfoot>");
-        mdnRow.Printf("<tr><td>%s</td>", mdnRow);
-        avgRow.Printf("<tr><td>%s</td>", avgRow);
-        minRow.Printf("<tr><td>%s</td>", minRow);
-        maxRow.Printf("<tr><td>%s</td>", maxRow);
+        for ( const auto& backend : backends )
+        {
+            const VectorLong& times = backend.times[phase][f][size];
+            const Stats&      stats = backend.stats[phase][f][size];
+            wxString          timesStr;
+
+            for ( const auto time : times )
+                timesStr += wxString::Format(timesStr.empty() ? "%ld" : " %ld", time);
+
+            values.clear();
+            values.push_back(m_fileNames[f]);
+            // the phases done once per file have no size
+            values.push_back(IsPerFilePhase(phase) ? wxString() : wxString::Format("%d", m_sizes[size].x));
+            values.push_back(IsPerFilePhase(phase) ? wxString() : wxString::Format("%d", m_sizes[size].y));
+            values.push_back(GetPhaseName(phase));
+            values.push_back(backend.name);
+            values.push_back(wxString::Format("%ld", stats.mdn));
+            values.push_back(wxString::Format("%ld", stats.mdnCILow));
+            values.push_back(wxString::Format("%ld", stats.mdnCIHigh));
+            values.push_back(wxString::Format("%.1f", stats.avg));
+            values.push_back(wxString::Format("%.1f", stats.stdDev));
+            values.push_back(wxString::Format("%ld", stats.mad));
+            values.push_back(wxString::Format("%ld", stats.p90));
+            values.push_back(wxString::Format("%ld", stats.p99));
+            values.push_back(wxString::Format("%ld", stats.min));
+            values.push_back(wxString::Format("%ld", stats.max));
+            values.push_back(wxString::Format("%zu", stats.count));
+            values.push_back(timesStr);
+            writer.AddRow(values);
+        }
+    };
+
+    // Phase_Bitmap is not listed, it is just Phase_Rasterize + Phase_Convert
+    addRows(Phase_IO, 0);
+    addRows(Phase_Parse, 0);
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        addRows(Phase_Rasterize, s);
+        addRows(Phase_Convert, s);
+    }
+}
+
+// static
+void wxTestSVGRasterizationBenchmark::BeginResultsTable(wxTestSVGReportWriter& writer)
+{
+    static const char* const labels[] =
+    {
+        "File", "Width", "Height", "Backend", "Run", "IO", "Parse", "Rasterize", "Convert", "Bitmap"
+    };
+    wxTestSVGReportWriter::VectorColumns columns;
+
+    for ( const auto& label : labels )
+    {
+        columns.push_back(wxTestSVGReportWriter::Column());
+        columns.back().labels.push_back(label);
+        columns.back().isNumeric = columns.size() != 1 && columns.size() != 4;
+    }
+
+    writer.BeginDocument("wxTestSVG Benchmark Results");
+    writer.BeginTable("Times in microseconds", columns);
+}
+
+void wxTestSVGRasterizationBenchmark::WriteResultsRows(const VectorBackendResults& backends, size_t fileIndex,
+                                                       wxTestSVGReportWriter& writer)
+{
+    const size_t  f = fileIndex;
+    wxArrayString values;
+
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        for ( const auto& backend : backends )
+        {
+            const PhaseTimes& times = backend.times;
+
+            // in the adaptive mode, a size may have fewer runs than its file was loaded,
+            // only the runs in which the size was rasterized are listed; the I/O and
+            // parse times are per file and run, i.e., the same for all sizes
+            for ( size_t run = 0; run < times[Phase_Bitmap][f][s].size(); ++run )
+            {
+                values.clear();
+                values.push_back(m_fileNames[f]);
+                values.push_back(wxString::Format("%d", m_sizes[s].x));
+                values.push_back(wxString::Format("%d", m_sizes[s].y));
+                values.push_back(backend.name);
+                values.push_back(wxString::Format("%zu", run + 1));
+                values.push_back(wxString::Format("%ld", times[Phase_IO][f][0][run]));
+                values.push_back(wxString::Format("%ld", times[Phase_Parse][f][0][run]));
+                values.push_back(wxString::Format("%ld", times[Phase_Rasterize][f][s][run]));
+                values.push_back(wxString::Format("%ld", times[Phase_Convert][f][s][run]));
+                values.push_back(wxString::Format("%ld", times[Phase_Bitmap][f][s][run]));
+                writer.AddRow(values);
+            }
+        }
+    }
+}
+
+void wxTestSVGRasterizationBenchmark::BeginSamples(size_t runCount, wxTestSVGBenchmarkResults& samples) const
+{
+    wxString sizesStr;
+
+    for ( const auto& size : m_sizes )
+        sizesStr += wxString::Format("%s%dx%d", sizesStr.empty() ? "" : ",", size.x, size.y);
+
+    samples.Clear();
+    samples.SetSystemMetadata();
+    samples.SetMetadata("Folder", m_dirName);
+    samples.SetMetadata("Files", wxString::Format("%zu", m_fileNames.size()));
+    samples.SetMetadata("Sizes", sizesStr);
+    samples.SetMetadata("Runs", wxString::Format("%zu", runCount));
+    samples.SetMetadata("WarmupRuns", wxString::Format("%zu", m_samplingOptions.warmupRunCount));
+    if ( m_samplingOptions.adaptive )
+    {
+        samples.SetMetadata("Adaptive", wxString::Format("target CI %g %%, at most %zu runs and %ld ms",
+                                                         m_samplingOptions.targetCIWidth * 100,
+                                                         m_samplingOptions.maxRunCount,
+                                                         m_samplingOptions.timeBudget));
     }
     else
     {
-        mdnRow.Printf("%s\t", mdnRow);
-        avgRow.Printf("%s\t", avgRow);
-        minRow.Printf("%s\t", minRow);
-        maxRow.Printf("%s\t", maxRow);
+        samples.SetMetadata("Adaptive", "No");
     }
+}
 
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+void wxTestSVGRasterizationBenchmark::AddFileSamples(const VectorBackendResults& backends, size_t fileIndex,
+                                                     wxTestSVGBenchmarkResults& samples) const
+{
+    const size_t f = fileIndex;
+
+    for ( const auto& backend : backends )
     {
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        for ( size_t p = 0; p < Phase_Max; ++p )
         {
-            mdnRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].mdn, statsD2D ? wxString::Format("%ld", (*statsD2D)[f][s].mdn) : "");
-            avgRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].avg, statsD2D ? wxString::Format("%ld", (*statsD2D)[f][s].avg) : "");
-            minRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].min, statsD2D ? wxString::Format("%ld", (*statsD2D)[f][s].min) : "");
-            maxRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].max, statsD2D ? wxString::Format("%ld", (*statsD2D)[f][s].max) : "");
+            for ( size_t s = 0; s < backend.times[p][f].size(); ++s )
+            {
+                samples.AddSamples(m_fileNames[f], IsPerFilePhase(p) ? wxSize(0, 0) : m_sizes[s],
+                                   backend.name, GetPhaseName(p), backend.times[p][f][s]);
+            }
         }
     }
-    if ( asHTML )
+}
+
+void wxTestSVGRasterizationBenchmark::InitPhaseTimes(PhaseTimes& times, PhaseStats& stats) const
+{
+    for ( size_t p = 0; p < Phase_Max; ++p )
     {
-        mdnRow += "</tr>";
-        avgRow += "</tr>";
-        minRow += "</tr>";
-        maxRow += "</tr>";
+        const size_t sizeCount = IsPerFilePhase(p) ? 1 : m_sizes.size();
+
+        times[p].assign(m_fileNames.size(), MatrixLong2(sizeCount));
+        stats[p].assign(m_fileNames.size(), VectorStats(sizeCount));
     }
-    else // extra tabs
+}
+
+void wxTestSVGRasterizationBenchmark::CalcFileStats(size_t fileIndex, const PhaseTimes& times,
+                                                    PhaseStats& stats) const
+{
+    for ( size_t p = 0; p < Phase_Max; ++p )
     {
-        mdnRow.RemoveLast();
-        avgRow.RemoveLast();
-        minRow.RemoveLast();
-        maxRow.RemoveLast();
+        for ( size_t s = 0; s < times[p][fileIndex].size(); ++s )
+            stats[p][fileIndex][s] = CalcStatsForVectorLong(times[p][fileIndex][s]);
     }
+}
 
-    result.push_back(mdnRow);
-    result.push_back(avgRow);
-    result.push_back(minRow);
-    result.push_back(maxRow);
+// static
+void wxTestSVGRasterizationBenchmark::FreeFileTimes(size_t fileIndex, PhaseTimes& times)
+{
+    for ( auto& phaseTimes : times )
+    {
+        for ( auto& t : phaseTimes[fileIndex] )
+            VectorLong().swap(t);
+    }
+}
 
-    if ( asHTML )
+// static
+wxString wxTestSVGRasterizationBenchmark::GetPhaseName(size_t phase)
+{
+    switch ( phase )
     {
-        result.push_back("</tfoot></table>\n");
-        result.push_back("</body></html>");
+        case Phase_IO:        return "I/O";
+        case Phase_Parse:     return "Parse";
+        case Phase_Rasterize: return "Rasterize";
+        case Phase_Convert:   return "Convert";
+        case Phase_Bitmap:    return "Total";
     }
 
-    for ( const auto& r : result )
-        reportText += r + "\n";
+    wxFAIL_MSG("invalid phase");
+    return wxString();
 }
 
-wxTestSVGRasterizationBenchmark::Stats wxTestSVGRasterizationBenchmark::CalcStatsForVectorLong(const VectorLong& data)
+// static
+void wxTestSVGRasterizationBenchmark::AppendHeaderRows(const wxString& firstColumnLabel,
+                                                       const std::vector<wxArrayString>& columnLabels,
+                                                       wxArrayString& result)
 {
-    VectorLong dataSorted(data);
-    Stats      stats;
-    wxLongLong sum = 0;
+    wxCHECK_RET(!columnLabels.empty(), "no columns");
 
-    std::sort(dataSorted.begin(), dataSorted.end());
+    const size_t levelCount = columnLabels[0].size();
+    wxString     rowStr;
 
-    stats.min = dataSorted[0];
-    stats.max = dataSorted[dataSorted.size() - 1];
+    for ( size_t level = 0; level < levelCount; ++level )
+    {
+        rowStr = R"(<tr>)";
+        if ( level == 0 )
+            rowStr += wxString::Format(R"(<th rowspan="%zu">%s</th>)", levelCount, firstColumnLabel);
 
-    stats.mdn = dataSorted[dataSorted.size() / 2];
-    if ( !(data.size() % 2) ) // even number
-        stats.mdn = (stats.mdn + dataSorted[(dataSorted.size() / 2) - 1]) / 2;
+        for ( size_t c = 0; c < columnLabels.size(); )
+        {
+            size_t span = 1;
 
-    sum = std::accumulate(dataSorted.begin(), dataSorted.end(), sum);
-    stats.avg = ( sum / dataSorted.size() ).ToLong();
+            // merge columns with the same labels at this and all the upper levels
+            for ( ; c + span < columnLabels.size(); ++span )
+            {
+                bool same = true;
 
-    return stats;
+                for ( size_t l = 0; l <= level && same; ++l )
+                    same = columnLabels[c][l] == columnLabels[c + span][l];
+
+                if ( !same )
+                    break;
+            }
+
+            if ( span > 1 )
+                rowStr += wxString::Format(R"(<th colspan="%zu">%s</th>)", span, columnLabels[c][level]);
+            else
+                rowStr += wxString::Format(R"(<th>%s</th>)", columnLabels[c][level]);
+
+            c += span;
+        }
+
+        rowStr += R"(</tr>)";
+        rowStr += "\n";
+        result.push_back(rowStr);
+    }
 }
 
-// ============================================================================
-// wxTestSVGBenchmarkReportFrame
-// ============================================================================
+// static
+bool wxTestSVGRasterizationBenchmark::ReadFile(const wxString& fileName, wxCharBuffer& data)
+{
+    wxFFile file(fileName, "rb");
+
+    if ( !file.IsOpened() )
+        return false;
 
-wxTestSVGBenchmarkReportFrame::wxTestSVGBenchmarkReportFrame(wxWindow* parent,
-                    const wxString& dirName,
-                    const wxString& report, 
-                    const wxString& detailedReport) 
-    : wxFrame(parent, wxID_ANY, "Benchmark Report"),
-      m_dirName(dirName), m_report(report), m_detailedReport(detailedReport)
+    const wxFileOffset lenAsOfs = file.Length();
+
+    if ( lenAsOfs == wxInvalidOffset )
+        return false;
+
+    const size_t len = static_cast<size_t>(lenAsOfs);
+
+    // wxCharBuffer is 0 terminated, as the bundle implementations require
+    data = wxCharBuffer(len);
+
+    return file.Read(data.data(), len) == len;
+}
+
+bool wxTestSVGRasterizationBenchmark::AreImagesIdentical(const wxImage& image1, const wxImage& image2)
 {
-    m_defaultName = "wxTestSVG Benchmark - " + dirName.AfterLast(wxFileName::GetPathSeparator());
+    if ( !image1.IsOk() || !image2.IsOk()
+         || image1.GetSize() != image2.GetSize() || image1.HasAlpha() != image2.HasAlpha() )
+    {
+        return false;
+    }
 
-    wxMenu* menuFile = new wxMenu;        
-    
-    menuFile->Append(wxID_SAVEAS);
-    menuFile->Append(ID_SAVE_DETAILED, "Save &Detailed Report...");
+    const size_t pixelCount = static_cast<size_t>(image1.GetWidth()) * image1.GetHeight();
 
-    Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveReport, this, wxID_SAVEAS);
-    Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveDetailedReport, this, ID_SAVE_DETAILED);
-    
-    wxMenuBar* menuBar = new wxMenuBar();
-    
-    menuBar->Append(menuFile, "&Report");
-    SetMenuBar(menuBar);      
+    return memcmp(image1.GetData(), image2.GetData(), pixelCount * 3) == 0
+           && (!image1.HasAlpha() || memcmp(image1.GetAlpha(), image2.GetAlpha(), pixelCount) == 0);
+}
+
+wxTestSVGRasterizationBenchmark::Stats wxTestSVGRasterizationBenchmark::CalcStatsForVectorLong(const VectorLong& data)
+{
+    Stats stats;
 
-    wxWebView* webView = wxWebView::New(this, wxID_ANY);
-    webView->SetPage(report, wxWebViewDefaultURLStr);        
-        
-    SetMinClientSize(FromDIP(wxSize(800, 600)));
-    Show();
+    if ( data.empty() )
+        return stats;
+
+    VectorLong dataSorted(data);
+    VectorLong deviations;
+    double     sum = 0, sumSquares = 0;
+
+    std::sort(dataSorted.begin(), dataSorted.end());
+
+    stats.count = dataSorted.size();
+    stats.min   = dataSorted.front();
+    stats.max   = dataSorted.back();
+    stats.mdn   = GetMedian(dataSorted);
+    stats.p90   = GetPercentile(dataSorted, 0.90);
+    stats.p99   = GetPercentile(dataSorted, 0.99);
+
+    sum = std::accumulate(dataSorted.begin(), dataSorted.end(), sum);
+    stats.avg = sum / stats.count;
+
+    for ( const auto& d : dataSorted )
+    {
+        sumSquares += (d - stats.avg) * (d - stats.avg);
+        deviations.push_back(std::abs(d - stats.mdn));
+    }
+
+    if ( stats.count > 1 )
+        stats.stdDev = sqrt(sumSquares / (stats.count - 1));
+
+    std::sort(deviations.begin(), deviations.end());
+    stats.mad = GetMedian(deviations);
+
+    CalcMedianCI(dataSorted, stats.mdnCILow, stats.mdnCIHigh);
+
+    return stats;
 }
 
-void wxTestSVGBenchmarkReportFrame::OnSaveReport(wxCommandEvent&)
+// static
+long wxTestSVGRasterizationBenchmark::GetPercentile(const VectorLong& dataSorted, double percentile)
 {
-    const wxString fileName = wxFileSelector("Select file name",
-        m_dirName, m_defaultName, "html", "HTML files (*.html)|*.html",
-        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    wxCHECK(!dataSorted.empty(), 0);
 
-    if ( fileName.empty() )
-        return;
+    // nearest rank, so that the result is one of the measured values
+    const size_t rank = static_cast<size_t>(ceil(percentile * dataSorted.size()));
 
-    WriteHTMLReport(fileName, m_report);
+    return dataSorted[wxMin(wxMax(rank, size_t(1)), dataSorted.size()) - 1];
 }
-    
-void wxTestSVGBenchmarkReportFrame::OnSaveDetailedReport(wxCommandEvent&)
+
+// static
+long wxTestSVGRasterizationBenchmark::GetMedian(const VectorLong& dataSorted)
 {
-    const wxString fileName = wxFileSelector("Select file name",
-        m_dirName, m_defaultName + "_details", "html", "HTML files (*.html)|*.html",
-        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    wxCHECK(!dataSorted.empty(), 0);
 
-    if ( fileName.empty() )
-        return;
+    const size_t middle = dataSorted.size() / 2;
 
-    WriteHTMLReport(fileName, m_detailedReport);
+    if ( dataSorted.size() % 2 )
+        return dataSorted[middle];
+
+    return (dataSorted[middle - 1] + dataSorted[middle]) / 2;
 }
 
-bool wxTestSVGBenchmarkReportFrame::WriteHTMLReport(const wxString& fileName, const wxString& reportText)
+// static
+void wxTestSVGRasterizationBenchmark::CalcMedianCI(const VectorLong& data, long& low, long& high)
 {
-    wxFFile reportFile(fileName, "w");
+    low = high = 0;
+    wxCHECK_RET(!data.empty(), "no data");
 
-    if ( !reportFile.IsOpened() )
-        return false;
+    std::mt19937                          generator(20220120);
+    std::uniform_int_distribution<size_t> distribution(0, data.size() - 1);
+    VectorLong                            resample(data.size());
+    VectorLong                            medians;
+
+    medians.reserve(BootstrapResampleCount);
+    for ( size_t r = 0; r < BootstrapResampleCount; ++r )
+    {
+        for ( auto& value : resample )
+            value = data[distribution(generator)];
+
+        // the same as GetMedian() but without sorting the whole resample
+        const size_t middle = resample.size() / 2;
+
+        std::nth_element(resample.begin(), resample.begin() + middle, resample.end());
+
+        long median = resample[middle];
+
+        if ( !(resample.size() % 2) )
+            median = (*std::max_element(resample.begin(), resample.begin() + middle) + median) / 2;
+
+        medians.push_back(median);
+    }
 
-    return reportFile.Write(reportText, wxConvUTF8);
+    std::sort(medians.begin(), medians.end());
+    low  = GetPercentile(medians, 0.025);
+    high = GetPercentile(medians, 0.975);
 }
@@ -10,10 +10,23 @@
 #ifndef TEST_SVG_BENCH_H_DEFINED
 #define TEST_SVG_BENCH_H_DEFINED
 
+#include <array>
+#include <memory>
 #include <vector>
 
 #include <wx/wx.h>
 
+#include "bmpbndl_svg_nano.h"
+#include "svgalloccounter.h"
+#include "svgmetrics.h"
+#include "svgperfcounters.h"
+
+class wxBitmapBundleImplSVG;
+class wxSVGIconAtlas;
+class wxTestSVGBenchmarkResults;
+class wxTestSVGReportWriter;
+class wxTestSVGThreadPool;
+
 // ============================================================================
 // wxTestSVGRasterizationBenchmark
 // ============================================================================
@@ -21,74 +34,498 @@
 class wxTestSVGRasterizationBenchmark
 {
 public:
+    // how Run() samples the times of each file and bitmap size
+    struct SamplingOptions
+    {
+        // runs done first for each file and backend and not measured,
+        // so that the first cold run (page faults, cold caches)
+        // does not skew the results
+        size_t warmupRunCount{1};
+
+        // If adaptive, each (file, size) cell is measured at least runCount
+        // times given to Run() and then until the 95% confidence interval
+        // of the median of its total time (see Phase_Bitmap) is narrower than
+        // targetCIWidth (relative to the median), the cell has been measured
+        // maxRunCount times, or the file has been benchmarked with
+        // the backend for longer than timeBudget milliseconds.
+        bool   adaptive{false};
+        double targetCIWidth{0.02};
+        size_t maxRunCount{1000};
+        long   timeBudget{10000};
+    };
+
     wxTestSVGRasterizationBenchmark();
 
+    // fileNames are relative to dirName and may include subfolders,
+    // see wxTestSVGCorpus
     void Setup(const wxString& dirName, const wxArrayString& fileNames,
                const std::vector<wxSize>& sizes);
 
-    bool Run(bool hasD2DSVG, size_t runCount, wxString& report, wxString& detailedReport);
+    void SetSamplingOptions(const SamplingOptions& options) { m_samplingOptions = options; }
+    const SamplingOptions& GetSamplingOptions() const { return m_samplingOptions; }
+
+    // If enabled, Run() collects hardware performance counters around
+    // parsing and getting each bitmap, see wxTestSVGPerfCounters, and
+    // the report shows IPC and misses per output pixel. Returns false
+    // if no counter is available, e.g., not on Linux or not allowed by
+    // the kernel, the counters are then not collected.
+    bool EnablePerfCounters(bool enable);
+    bool ArePerfCountersEnabled() const { return m_perfCounters.IsOpened(); }
+    // errno of the failure to open the counters
+    int GetPerfCountersError() const { return m_perfCounters.GetError(); }
+
+    // If enabled, Run() also counts heap allocations, bytes allocated, and
+    // peak live bytes of parsing and getting each bitmap, and the size of
+    // each parsed document, see wxTestSVGAllocCounter. Returns false if
+    // the allocator is not interposed, i.e., outside wxTestSVGBench on glibc.
+    bool EnableAllocCounter(bool enable);
+    bool IsAllocCounterEnabled() const { return m_isAllocCounterEnabled; }
+
+    // Benchmarks the backends of wxTestSVGBackendRegistry with the given
+    // names, which must be available. The baseline backend (NanoSVG) is
+    // always benchmarked and reported first, whether it is in backendNames
+    // or not, the others in the order of backendNames.
+    // If NanoSVG headers are available, the report also shows the structural
+    // complexity of each file (see wxTestSVGDocumentMetrics), a model of
+    // the bitmap time fitted to it for each backend (see wxTestSVGTimeModel),
+    // and the files much slower than the model predicts.
+    // If detailedReport is not null, it receives the statistics and the times
+    // of all the runs, one row per file, size, phase, and backend. If results
+    // is not null, it receives the raw times in "long" format, i.e., one row
+    // per file, size, backend and run. Both are written as soon as each file
+    // has been benchmarked and the caller closes them.
+    // If samples is not null, it receives the raw times with the metadata
+    // of this build and machine, e.g., to be saved as a baseline. Otherwise
+    // only the statistics of the files already benchmarked are kept, so that
+    // the memory used does not grow with the number of runs.
+    bool Run(const wxArrayString& backendNames, size_t runCount, wxString& report,
+             wxTestSVGReportWriter* detailedReport = nullptr,
+             wxTestSVGReportWriter* results = nullptr,
+             wxTestSVGBenchmarkResults* samples = nullptr);
+
+    // Creates the same report, detailed report, and results as Run() from
+    // the times in samples instead of benchmarking, e.g., from the results
+    // of several shards of a corpus merged with
+    // wxTestSVGBenchmarkResults::Merge(). The files, sizes (ordered by area),
+    // and backends are those in samples. The folder given to Setup(), or
+    // the one in samples metadata, is used only for the complexity metrics,
+    // which are omitted if it does not exist. Hardware counters and
+    // allocations are not saved, so they are not reported. Returns false
+    // and logs the error if the times of any file, size, and backend are
+    // missing.
+    bool CreateReportFromResults(const wxTestSVGBenchmarkResults& samples, wxString& report,
+                                 wxTestSVGReportWriter* detailedReport = nullptr,
+                                 wxTestSVGReportWriter* results = nullptr);
+
+    // Measures the application startup with wxBitmapBundleSVGDiskCache:
+    // all the files are loaded and their bitmaps at all the sizes obtained
+    // first with the cache empty (cold) and then with all the bitmaps
+    // in the cache (warm). A temporary cache folder is used and
+    // the in-memory shared cache is disabled, as in a new process.
+    bool RunStartup(size_t runCount, wxString& report, wxString* results = nullptr);
+
+    // The modes below exercise NanoSVG directly and are available only
+    // with its headers, each is implemented in its own svgbench*.cpp.
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+    // Measures the throughput of parsing and rasterizing with NanoSVG
+    // in parallel, with 1 to maxThreadCount threads. The work items,
+    // i.e., all the files at all the sizes runCount times, are spread among
+    // the threads of wxTestSVGThreadPool, each thread has its own parser
+    // and rasterizer. Only the work done by NanoSVG is measured:
+    // no wxWidgets objects are created, as that is not thread-safe.
+    bool RunThroughput(size_t maxThreadCount, size_t runCount,
+                       wxString& report, wxString* results = nullptr);
+
+    // Measures the latency of rasterizing a single document with
+    // wxSVGTileRasterizer, serially and in bands on 1 to maxThreadCount
+    // threads, see wxSVGTileRasterizer::RasterizeBands(), for each file at
+    // each size. Every banded bitmap must be identical to the serial one.
+    // Reports the speedup for each thread count at each size and
+    // the crossover, the smallest size from which on rasterizing in bands
+    // is faster.
+    bool RunBands(size_t maxThreadCount, size_t runCount,
+                  wxString& report, wxString* results = nullptr);
+
+    // Stress test of wxBitmapBundleImplSVGNanoMT: for each file, threadCount
+    // threads get images at all the sizes from a single shared bundle
+    // iterationCount times, the bundle cache is cleared every now and then
+    // so that the threads also rasterize concurrently. Every image is compared
+    // to the one rasterized by a single thread, the number of images that
+    // are not byte-identical is returned in mismatchCount.
+    // Returns false if the test could not be run.
+    bool RunStressTest(size_t threadCount, size_t iterationCount,
+                       wxString& report, size_t& mismatchCount);
+
+    // Checks the code paths replacing or caching NanoSVG against it for each
+    // file at all the sizes, see the SelfTest*() functions for the checks.
+    // threadCount threads are used by the multi-threaded ones. report gets
+    // a row for each check and file, failureCount the number of the failed
+    // ones. Returns false if the test could not be run.
+    bool RunSelfTest(size_t threadCount, wxString& report, size_t& failureCount);
+
+    // Measures the conversion of the pixels rasterized with NanoSVG to wxBitmap
+    // at each size: through wxImage as before and with
+    // wxBitmapBundleImplSVG::CreateBitmapFromRGBA() for every instruction set
+    // of wxSVGPixelConverter the CPU supports, reporting the conversion share
+    // of the total (parsing, rasterizing, and converting) time.
+    bool RunConversion(size_t runCount, wxString& report, wxString* results = nullptr);
+
+    // Measures only parsing, the same as Phase_Parse but without creating
+    // wxBitmapBundleImpl: NanoSVG, including copying the data it modifies and
+    // deleting the image, and wxSVGFlatDocument, reused for all the files.
+    // Reports the throughput in MB/s and documents/s for each top level
+    // subfolder and in total, and, if wxTestSVGAllocCounter is available,
+    // the heap allocations and peak memory per document.
+    bool RunParse(size_t runCount, wxString& report, wxString* results = nullptr);
+
+    // Measures loading all the files and getting their bitmaps at all
+    // the sizes with wxBitmapBundle::FromSVGFile() and with
+    // wxBitmapBundleImplSVGCompiled, which maps the files compiled by
+    // wxSVGCompiledImage into compiledDirName under the same relative paths
+    // as wxTestSVGCompile writes them. If compiledDirName is empty, the files
+    // are compiled into a temporary folder first. Before measuring, every
+    // bitmap of the compiled files is checked to be identical to that of
+    // wxBitmapBundleImplSVGNano.
+    bool RunCompiled(const wxString& compiledDirName, size_t runCount,
+                     wxString& report, wxString* results = nullptr);
+
+    // Builds wxSVGIconAtlas with all the files at all the sizes runCount
+    // times, using threadCount threads (0 means one per core). Reports
+    // the time to rasterize and pack the icons, the memory used by the atlas
+    // compared to individual bitmaps, and the cost of getting a bitmap
+    // from the atlas. detailedReport receives the rectangles of all the icons.
+    // If atlas is not null, it receives the last atlas built.
+    bool RunAtlas(size_t threadCount, size_t runCount, wxString& report, wxString& detailedReport,
+                  wxString* results = nullptr, std::shared_ptr<wxSVGIconAtlas>* atlas = nullptr);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
 
 private:
+    // Benchmarked phases. Reading and parsing is done once per file and run,
+    // so the times for these phases have only one "bitmap size".
+    enum Phase
+    {
+        Phase_IO = 0,    // reading the file into memory
+        Phase_Parse,     // creating wxBitmapBundleImpl from the file data
+        Phase_Rasterize, // rendering the SVG onto the backend buffer
+        Phase_Convert,   // creating wxBitmap from the backend buffer
+        Phase_Bitmap,    // Phase_Rasterize + Phase_Convert, i.e., wxBitmapBundle::GetBitmap()
+
+        Phase_Max
+    };
+
     // times in ms for one file and one bitmap size
     typedef std::vector<long>               VectorLong;
     typedef std::vector<VectorLong>         MatrixLong2;
     typedef std::vector<MatrixLong2>        MatrixLong3;
+    // times for one backend for all phases
+    typedef std::array<MatrixLong3, Phase_Max> PhaseTimes;
 
     struct Stats
     {
-        long min{0};
-        long max{0};
-        long mdn{0};
-        long avg{0};
+        size_t count{0}; // number of runs
+        long   min{0};
+        long   max{0};
+        long   mdn{0};
+        double avg{0};
+        double stdDev{0}; // sample standard deviation
+        long   mad{0};    // median absolute deviation from the median
+        long   p90{0};
+        long   p99{0};
+        // bootstrap 95% confidence interval of the median
+        long   mdnCILow{0};
+        long   mdnCIHigh{0};
     };
     typedef std::vector<Stats>       VectorStats;
     typedef std::vector<VectorStats> MatrixStats;
+    typedef std::array<MatrixStats, Phase_Max> PhaseStats;
+
+    // sums of the hardware counters of all the measured runs of a cell
+    struct CounterSums
+    {
+        size_t                        runCount{0};
+        wxTestSVGPerfCounters::Values values{};
+    };
+    typedef std::vector<CounterSums>       VectorCounterSums;
+    typedef std::vector<VectorCounterSums> MatrixCounterSums;
+
+    // allocations of all the measured runs of a cell
+    struct AllocSums
+    {
+        size_t runCount{0};
+        double allocCount{0};
+        double allocBytes{0};
+        double liveBytes{0};
+        size_t peakBytes{0}; // the maximum, not the sum
+    };
+    typedef std::vector<AllocSums>       VectorAllocSums;
+    typedef std::vector<VectorAllocSums> MatrixAllocSums;
+
+    // results of Run() for one backend
+    struct BackendResults
+    {
+        wxString   name;
+        // from wxTestSVGBackendRegistry, default if not registered
+        wxString   description;
+        int        flags{0};
+        // Run() keeps the times only of the file being benchmarked,
+        // the statistics of all the files
+        PhaseTimes times;
+        PhaseStats stats;
+        // only when the counters are enabled, [file][0] and [file][size]
+        MatrixCounterSums parseCounters;
+        MatrixCounterSums bitmapCounters;
+        // only when the allocations are counted, [file][0] and [file][size]
+        MatrixAllocSums   parseAllocs;
+        MatrixAllocSums   bitmapAllocs;
+    };
+    // the baseline backend always first
+    typedef std::vector<BackendResults> VectorBackendResults;
+
+    // returns nullptr if the data could not be parsed
+    typedef wxBitmapBundleImplSVG* (*CreateBitmapBundleImplFn)(const char*);
 
-    typedef wxBitmapBundle (*CreateBitmapBundleFn)(const wxString&);
+    // for each file, without edgeCounts if they could not be calculated
+    typedef std::vector<wxTestSVGDocumentMetrics> VectorMetrics;
 
     wxString            m_dirName;
     wxArrayString       m_fileNames;
     std::vector<wxSize> m_sizes;
+    SamplingOptions     m_samplingOptions;
 
-    // benchmarks a single file for all bitmap sizes
-    bool BenchmarkFile(CreateBitmapBundleFn createBundleFn,
-                       const wxString& fileName,
-                       size_t runCount, MatrixLong2& times);
+    wxTestSVGPerfCounters m_perfCounters;
+    bool                  m_isAllocCounterEnabled{false};
 
-    void CreateReport(const MatrixStats& statsNano, const MatrixStats* statsD2D,
-                      size_t runCount, wxString& reportText);
+    // resamples of the times used to estimate the confidence interval of the median
+    static const size_t BootstrapResampleCount = 1000;
 
-    void CreateDetailedReport(const MatrixLong3& timesNano, const MatrixStats& statsNano,
-                              const MatrixLong3* timesD2D, const MatrixStats* statsD2D,
-                              bool asHTML, wxString& reportText);
+    // results of RunThroughput() for one thread count
+    struct ThroughputResult
+    {
+        size_t threadCount{0};
+        long   time{0}; // in microseconds, for all the work items
+    };
 
-    static Stats CalcStatsForVectorLong(const VectorLong& data);
-};
+    // results of RunBands() for one file and size,
+    // median times in microseconds
+    struct BandsResult
+    {
+        size_t     fileIndex{0};
+        size_t     sizeIndex{0};
+        long       serial{0};
+        VectorLong bands; // for 1 to maxThreadCount threads
+    };
 
+    // results of RunStartup() for one run and cache state
+    struct StartupResult
+    {
+        bool   isWarm{false};
+        long   loadTime{0};   // in microseconds, for all files
+        long   bitmapTime{0}; // in microseconds, for all files and sizes
+        long   parseCount{-1}; // -1 if unknown, i.e., without NanoSVG headers
+        size_t diskHits{0};
+        size_t diskMisses{0};
+        size_t diskWrites{0};
+    };
 
-// ============================================================================
-// wxTestSVGBenchmarkReportFrame
-// ============================================================================
+    // results of RunConversion() for one run and size,
+    // times in microseconds for all the files
+    struct ConversionResult
+    {
+        size_t sizeIndex{0};
+        long   rasterize{0};
+        long   imageConvert{0}; // through wxImage
+        // indexed by wxSVGPixelConverter::InstructionSet, 0 if not supported
+        VectorLong kernel;  // wxSVGPixelConverter::PremultiplySwapRedBlue() only
+        VectorLong convert; // wxBitmapBundleImplSVG::CreateBitmapFromRGBA()
+    };
 
-class wxTestSVGBenchmarkReportFrame: public wxFrame
-{
-public:
-    wxTestSVGBenchmarkReportFrame(wxWindow* parent, const wxString& dirName,
-                                  const wxString& report, const wxString& detailedReport);
-private:
-    enum 
+    // files of RunParse() in one top level subfolder, with the values
+    // measured once, in the first pass which is not timed
+    struct ParseFolder
+    {
+        wxString            name;
+        std::vector<size_t> fileIndices;
+        size_t              bytes{0};
+        size_t              nanoShapes{0}; // visible, filled or stroked
+        size_t              flatShapes{0};
+        // for all the files, only if wxTestSVGAllocCounter is available
+        size_t              nanoAllocs{0};
+        size_t              flatAllocs{0};
+        size_t              nanoPeakBytes{0};
+        size_t              flatPeakBytes{0};
+        size_t              flatArenaBytes{0}; // wxSVGFlatDocument::GetUsedBytes()
+    };
+
+    // results of RunParse() for one run and folder,
+    // times in microseconds for all the files in the folder
+    struct ParseResult
+    {
+        size_t folderIndex{0};
+        long   nano{0};
+        long   flat{0};
+    };
+
+    // results of RunCompiled() for one run,
+    // times in microseconds for all the files
+    struct CompiledResult
     {
-        ID_SAVE_DETAILED = wxID_HIGHEST + 1
+        long svgLoad{0};
+        long svgBitmaps{0}; // at all the sizes
+        long compiledLoad{0};
+        long compiledBitmaps{0};
     };
 
-    wxString m_dirName;
-    wxString m_defaultName;
-    wxString m_report, m_detailedReport;
-    
-    void OnSaveReport(wxCommandEvent&);
-    void OnSaveDetailedReport(wxCommandEvent&);
+    // results of RunAtlas() for one run, times in microseconds
+    struct AtlasResult
+    {
+        long read{0};
+        long rasterize{0};
+        long pack{0};
+        long copy{0};
+        long lookup{0};      // for all the lookups, see AtlasLookupRepeatCount
+        long pageBitmaps{0}; // creating wxBitmaps for all the pages
+        long getBitmap{0};   // for all files and sizes
+    };
+
+    // how many times all the icons are looked up in the atlas index
+    static const size_t AtlasLookupRepeatCount = 100;
+
+    // a file and size is an outlier when the robust z-score of its time
+    // residual from wxTestSVGTimeModel is above OutlierMinRobustZ,
+    // the report lists at most OutlierMaxCount of them
+    static constexpr double OutlierMinRobustZ = 3.5;
+    static const size_t     OutlierMaxCount   = 20;
+
+    // benchmarks a single file for all bitmap sizes, appending
+    // the times of measured runs to results, see SamplingOptions
+    bool BenchmarkFile(CreateBitmapBundleImplFn createImplFn,
+                       size_t fileIndex, size_t runCount, BackendResults& results);
+    // do nothing if the counters are not enabled, the counters
+    // of the runs not measured are not added to sums
+    void StartPerfCounters();
+    void StopPerfCounters(bool isMeasured, CounterSums& sums);
+    // the same for the allocations
+    void StartAllocCounter();
+    void StopAllocCounter(bool isMeasured, AllocSums& sums);
+    // returns true if the confidence interval of the median of data
+    // is narrower than SamplingOptions::targetCIWidth
+    bool IsCIWidthReached(const VectorLong& data) const;
+
+    // the full path of the file and the relative path without the extension
+    wxString GetFilePath(size_t fileIndex) const;
+    wxString GetDisplayName(size_t fileIndex) const;
+
+    // not measured, logs a warning if the metrics could not be calculated
+    void CalcMetrics(size_t fileIndex, wxTestSVGDocumentMetrics& metrics) const;
+
+    void CreateReport(const VectorBackendResults& backends, const VectorMetrics& metrics,
+                      size_t runCount, wxString& reportText);
+    void AppendComplexityTables(const VectorBackendResults& backends, const VectorMetrics& metrics,
+                                wxArrayString& result);
+    void AppendPerfCountersTable(const VectorBackendResults& backends, wxArrayString& result);
+    void AppendAllocTable(const VectorBackendResults& backends, wxArrayString& result);
+
+    // the detailed report has a row for each file, size, phase, and backend,
+    // written as soon as the file is benchmarked, like the results
+    void BeginDetailedTable(wxTestSVGReportWriter& writer) const;
+    void WriteDetailedRows(const VectorBackendResults& backends, size_t fileIndex,
+                           wxTestSVGReportWriter& writer);
+
+    static void BeginResultsTable(wxTestSVGReportWriter& writer);
+    // the rows of one file, the table is begun and ended by the caller
+    void WriteResultsRows(const VectorBackendResults& backends, size_t fileIndex,
+                          wxTestSVGReportWriter& writer);
+
+    // clears samples and sets the metadata, the times are added for each file
+    void BeginSamples(size_t runCount, wxTestSVGBenchmarkResults& samples) const;
+    void AddFileSamples(const VectorBackendResults& backends, size_t fileIndex,
+                        wxTestSVGBenchmarkResults& samples) const;
+
+    bool RunStartupPass(StartupResult& result);
+
+    void CreateStartupReport(const std::vector<StartupResult>& startupResults,
+                             size_t runCount, wxString& reportText, wxString* resultsText);
+
+    void CreateConversionReport(const std::vector<ConversionResult>& conversionResults,
+                                size_t runCount, wxString& reportText, wxString* resultsText);
+
+    void CreateParseReport(const std::vector<ParseFolder>& folders,
+                           const std::vector<ParseResult>& parseResults,
+                           size_t runCount, wxString& reportText, wxString* resultsText);
+
+    void CreateCompiledReport(const std::vector<CompiledResult>& compiledResults,
+                              size_t svgBytes, size_t compiledBytes, bool isTemporary,
+                              size_t runCount, wxString& reportText, wxString* resultsText);
+
+    void CreateAtlasReport(const std::vector<AtlasResult>& atlasResults, const wxSVGIconAtlas& atlas,
+                           size_t threadCount, size_t runCount,
+                           wxString& reportText, wxString& detailedReportText, wxString* resultsText);
+
+    void CreateThroughputReport(const std::vector<ThroughputResult>& throughputResults,
+                                size_t itemCount, size_t runCount,
+                                wxString& reportText, wxString* resultsText);
+
+    void CreateBandsReport(const std::vector<BandsResult>& bandsResults,
+                           size_t maxThreadCount, size_t runCount,
+                           wxString& reportText, wxString* resultsText);
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    // The checks of RunSelfTest() for the file with data at all the sizes,
+    // each returns the description of the first failure or an empty string.
+
+    // all the threads of pool asking wxBitmapBundleImplSVGNanoMT for the same
+    // size at once get the same buffer, rasterized only once
+    wxString SelfTestThreadSafeBundle(const wxCharBuffer& data, wxTestSVGThreadPool& pool) const;
+
+    // the bitmaps at all the sizes, rasterized and written to the disk cache
+    // and then read back from it, are identical to references, and corrupt or
+    // truncated cache files are ignored and written again
+    wxString SelfTestDiskCache(const wxCharBuffer& data, const std::vector<wxImage>& references) const;
+
+    // wxSVGFlatDocument has the same size as nsvgParse() gives and the same
+    // painted shapes with the same paints, its bounds containing those of NanoSVG
+    wxString SelfTestFlatDocument(const wxCharBuffer& data) const;
+
+    // the file with fileIndex compiled into compiledFileName gives bitmaps
+    // identical to references, while its data with a bad header or truncated
+    // are rejected, both loaded from memory and mapped from the file
+    wxString SelfTestCompiled(size_t fileIndex, const wxString& compiledFileName,
+                              const std::vector<wxImage>& references) const;
+
+    // wxSVGTileRasterizer::RasterizeBands() on the threads of pool gives
+    // the same pixels as Rasterize() for band heights rounded up or not
+    wxString SelfTestBands(const wxCharBuffer& data, wxTestSVGThreadPool& pool) const;
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+    // no times and default statistics for all the files and sizes
+    void InitPhaseTimes(PhaseTimes& times, PhaseStats& stats) const;
+    void CalcFileStats(size_t fileIndex, const PhaseTimes& times, PhaseStats& stats) const;
+    // releases the memory of the times of the file, not only clears them
+    static void FreeFileTimes(size_t fileIndex, PhaseTimes& times);
+
+    static bool IsPerFilePhase(size_t phase) { return phase == Phase_IO || phase == Phase_Parse; }
+    static wxString GetPhaseName(size_t phase);
+
+    // columnLabels contains for each column its labels for all header rows,
+    // the same consecutive labels are merged
+    static void AppendHeaderRows(const wxString& firstColumnLabel,
+                                 const std::vector<wxArrayString>& columnLabels,
+                                 wxArrayString& result);
+
+    static bool ReadFile(const wxString& fileName, wxCharBuffer& data);
+
+    // true if both are valid and have the same size and pixels, including alpha
+    static bool AreImagesIdentical(const wxImage& image1, const wxImage& image2);
+
+    static Stats CalcStatsForVectorLong(const VectorLong& data);
 
-    static bool WriteHTMLReport(const wxString& fileName, const wxString& reportText);
+    // dataSorted must be sorted, percentile between 0 and 1
+    static long GetPercentile(const VectorLong& dataSorted, double percentile);
+    static long GetMedian(const VectorLong& dataSorted);
+    // percentile bootstrap 95% confidence interval of the median of data,
+    // the resampling is seeded with a constant, so the results are repeatable
+    static void CalcMedianCI(const VectorLong& data, long& low, long& high);
 };
 
-#endif // #ifndef TEST_SVG_BENCH_H_DEFINED
\ No newline at end of file
+#endif // #ifndef TEST_SVG_BENCH_H_DEFINED
@@ -0,0 +1,1047 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchapp.cpp
+// Purpose:     Console application running SVG rasterization benchmark
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/tokenzr.h>
+
+#include "bmpbndl_svg_atlas.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgbackendregistry.h"
+#include "svgbench.h"
+#include "svgbenchresults.h"
+#include "svgcorpus.h"
+#include "svgreportwriter.h"
+#include "svgthreadpool.h"
+
+// ============================================================================
+// wxTestSVGBenchApp
+// ============================================================================
+
+/*
+    Runs wxTestSVGRasterizationBenchmark without any GUI, so that it can be
+    used from scripts, e.g., on headless build machines. Example:
+
+    wxTestSVGBench --dir "Complex SVGs" --sizes 24,48,128,512 --runs 50 --output results.tsv
+
+    The options, grouped by what they are for (--help describes each mode):
+
+    --dir, --recursive, --glob, --exclude,    the files, see wxTestSVGCorpus
+    --sample, --sampling, --seed,
+    --max-files, --shard
+    --sizes, --backends, --list-backends      what is rasterized and by which
+                                              wxTestSVGBackendRegistry backends
+    --runs, --warmup, --adaptive, --target-ci, see SamplingOptions
+    --max-runs, --time-budget
+    --perf-counters, --memory                 see wxTestSVGPerfCounters and
+                                              wxTestSVGAllocCounter
+    --output, --report, --detailed-report     see wxTestSVGReportWriter
+    --save-results, --compare, --current,     see wxTestSVGBenchmarkResults
+    --tolerance, --alpha, --merge             and wxTestSVGBenchmarkComparison
+    --throughput, --bands, --stress,          modes run instead of comparing
+    --self-test, --startup, --conversion,     the backends, at most one
+    --parse, --compiled, --atlas, --threads,
+    --compiled-dir, --atlas-output
+ */
+
+class wxTestSVGBenchApp : public wxAppConsole
+{
+public:
+    void OnInitCmdLine(wxCmdLineParser& parser) wxOVERRIDE;
+    bool OnCmdLineParsed(wxCmdLineParser& parser) wxOVERRIDE;
+    int  OnRun() wxOVERRIDE;
+
+private:
+    wxString            m_dirName;
+    wxTestSVGCorpus::Options m_corpusOptions;
+    std::vector<wxSize> m_sizes;
+    long                m_runCount{25};
+    wxArrayString       m_backendNames;
+    bool                m_listBackends{false};
+    bool                m_throughput{false};
+    bool                m_bands{false};
+    bool                m_stressTest{false};
+    bool                m_selfTest{false};
+    bool                m_startup{false};
+    bool                m_atlas{false};
+    bool                m_conversion{false};
+    bool                m_parse{false};
+    bool                m_compiled{false};
+    bool                m_perfCounters{false};
+    bool                m_countAllocs{false};
+    long                m_threadCount{0};
+    wxTestSVGRasterizationBenchmark::SamplingOptions m_samplingOptions;
+    wxString            m_outputFileName;
+    wxString            m_reportFileName;
+    wxString            m_detailedReportFileName;
+    wxString            m_atlasOutputName;
+    wxString            m_compiledDirName;
+    wxString            m_saveResultsFileName;
+    wxString            m_baselineFileName;
+    wxString            m_currentFileName;
+    wxArrayString       m_mergeFileNames;
+    wxTestSVGBenchmarkComparison::Options m_comparisonOptions;
+
+    // returns the exit code
+    int Compare(const wxTestSVGBenchmarkResults& current);
+    // merges the results of m_mergeFileNames and writes them
+    // as if they were benchmarked, returns the exit code
+    int Merge();
+
+    bool ParseCorpusOptions(wxCmdLineParser& parser);
+
+    static bool ParseSizes(const wxString& sizesStr, std::vector<wxSize>& sizes);
+    static wxArrayString ParseList(const wxString& listStr);
+    static bool WriteTextFile(const wxString& fileName, const wxString& text);
+};
+
+void wxTestSVGBenchApp::OnInitCmdLine(wxCmdLineParser& parser)
+{
+    static const wxCmdLineEntryDesc cmdLineDesc[] =
+    {
+        { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+        { wxCMD_LINE_OPTION, "d", "dir", "folder with SVG files (required unless --current or --merge is used)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "recursive", "search the subfolders of --dir too",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, "g", "glob", "comma separated file name or relative path patterns (default: *.svg)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "exclude", "comma separated file name or relative path patterns to skip",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "sample", "use only a deterministic sample of N matching files",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "sampling", "with --sample, random, folder, or size (default: random)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "seed", "with --sample, seed of the sampling (default: 0)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_OPTION, "n", "max-files", "use only the first N matching (or sampled) files (default: all)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "shard", "benchmark only the i-th of N parts of the files, e.g. 2/4",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "merge", "merge the results saved with --save-results given as parameters instead of benchmarking",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, "s", "sizes", "comma separated bitmap sizes, e.g. 16,24x24,32 (default: 24,48,128)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, "r", "runs", "number of runs, minimum with --adaptive (default: 25)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "warmup", "number of warm-up runs not measured (default: 1)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "adaptive", "run each file and size until the median is precise enough",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "target-ci", "with --adaptive, target width of the median 95% confidence interval in percent (default: 2)",
+            wxCMD_LINE_VAL_DOUBLE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "max-runs", "with --adaptive, maximum number of runs (default: 1000 or --runs if more)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "time-budget", "with --adaptive, maximum seconds per file and backend (default: 10)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "perf-counters", "read hardware performance counters (Linux only)",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "memory", "count heap allocations and peak memory (glibc only)",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, "b", "backends", "comma separated backends, see --list-backends (default: nano)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "list-backends", "list the backends and whether they are available, then exit",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, "o", "output", "file for the results table, .csv, .json, or .html for other formats than TSV (default: standard output)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "report", "file for the HTML summary report",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "detailed-report", "file for the detailed report, .tsv, .csv, or .json for other formats than HTML",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "throughput", "measure multi-threaded throughput with NanoSVG",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "bands", "measure single document latency rasterizing in bands in parallel",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "stress", "stress test thread-safe bundles with NanoSVG",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "self-test", "check the optimized and cached code paths against NanoSVG",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "startup", "measure loading with the disk cache cold and warm",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "conversion", "measure conversion of NanoSVG pixels to wxBitmap with SIMD kernels",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "parse", "measure parsing with NanoSVG and wxSVGFlatDocument",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "compiled", "measure loading with FromSVGFile and from compiled SVG",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "compiled-dir", "with --compiled, folder with the files compiled by wxTestSVGCompile (default: compile them first)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "atlas", "build an icon atlas of all the files at all the sizes with NanoSVG",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "atlas-output", "save the atlas as NAME-N.png pages and NAME.tsv index",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "save-results", "save the raw times with metadata, e.g., as a baseline for --compare",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "compare", "compare the results with the baseline saved with --save-results",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "current", "with --compare, load the current results instead of benchmarking",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "tolerance", "with --compare, allowed slowdown in percent (default: 5)",
+            wxCMD_LINE_VAL_DOUBLE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "alpha", "with --compare, significance level of the Mann-Whitney U test (default: 0.01)",
+            wxCMD_LINE_VAL_DOUBLE, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "threads", "(maximum) number of threads for --throughput, --bands, --stress, --self-test, and --atlas (default: number of cores)",
+            wxCMD_LINE_VAL_NUMBER, 0 },
+        { wxCMD_LINE_PARAM, nullptr, nullptr, "results to --merge",
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
+        wxCMD_LINE_DESC_END
+    };
+
+    // shown before the options by --help
+    static const char* const modesHelp =
+        "Benchmarks parsing and rasterizing each file at each size with each backend --runs times.\n"
+        "The results are tab separated values, one row per file, size, backend, and run, written\n"
+        "as soon as each file is done. --save-results saves them with the metadata of this build\n"
+        "and machine, e.g., as the baseline for --compare, which exits with code 2 if --tolerance\n"
+        "is exceeded. The results of --shard i/N runs saved this way are combined with --merge.\n"
+        "\n"
+        "Instead of that, one of these modes can be run:\n"
+        "  --throughput  all the files are rasterized by 1 to --threads threads, one row per thread\n"
+        "                count shows how the throughput scales with the number of cores\n"
+        "  --bands       each file is rasterized by the tile rasterizer serially and in bands on 1 to\n"
+        "                --threads threads, reporting the latency speedup and the size it pays off from\n"
+        "  --stress      --threads threads get images from shared thread-safe bundles --runs times,\n"
+        "                exits with failure if any image differs from the reference\n"
+        "  --self-test   the code paths replacing or caching NanoSVG are checked against it on all\n"
+        "                the files at all the sizes, exits with failure if any check fails\n"
+        "  --startup     all the files are loaded and their bitmaps got with the disk cache cold\n"
+        "                and warm\n"
+        "  --conversion  converting NanoSVG pixels to wxBitmap with the SIMD kernels is compared\n"
+        "                to rasterization\n"
+        "  --parse       only parsing is measured, NanoSVG compared with wxSVGFlatDocument, MB/s\n"
+        "                and documents/s for each top level subfolder\n"
+        "  --compiled    loading with wxBitmapBundle::FromSVGFile() is compared with loading the files\n"
+        "                compiled by wxTestSVGCompile into --compiled-dir (or a temporary folder)\n"
+        "  --atlas       all the files are rasterized at all the sizes by --threads threads and packed\n"
+        "                into an icon atlas, saved with --atlas-output\n";
+
+    parser.SetDesc(cmdLineDesc);
+    parser.SetLogo(modesHelp);
+    parser.SetSwitchChars("-");
+}
+
+bool wxTestSVGBenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
+{
+    wxString sizesStr("24,48,128");
+    wxString backendsStr("nano");
+
+    // nothing else is needed for listing the backends
+    m_listBackends = parser.Found("list-backends");
+    if ( m_listBackends )
+        return wxAppConsole::OnCmdLineParsed(parser);
+
+    parser.Found("d", &m_dirName);
+    parser.Found("s", &sizesStr);
+    parser.Found("b", &backendsStr);
+    parser.Found("o", &m_outputFileName);
+    parser.Found("report", &m_reportFileName);
+    parser.Found("detailed-report", &m_detailedReportFileName);
+    m_throughput = parser.Found("throughput");
+    m_bands      = parser.Found("bands");
+    m_stressTest = parser.Found("stress");
+    m_selfTest   = parser.Found("self-test");
+    m_startup    = parser.Found("startup");
+    m_atlas      = parser.Found("atlas");
+    m_conversion = parser.Found("conversion");
+    m_parse      = parser.Found("parse");
+    m_compiled   = parser.Found("compiled");
+
+    if ( (m_throughput ? 1 : 0) + (m_bands ? 1 : 0) + (m_stressTest ? 1 : 0) + (m_selfTest ? 1 : 0)
+         + (m_startup ? 1 : 0) + (m_atlas ? 1 : 0) + (m_conversion ? 1 : 0) + (m_parse ? 1 : 0)
+         + (m_compiled ? 1 : 0) > 1 )
+    {
+        wxLogError("Only one of options --throughput, --bands, --stress, --self-test, --startup, --atlas, "
+                   "--conversion, --parse, and --compiled can be used.");
+        return false;
+    }
+
+#ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    // the only place checking it, the modes are not even declared without NanoSVG
+    if ( m_throughput || m_bands || m_stressTest || m_selfTest || m_atlas || m_conversion || m_parse
+         || m_compiled )
+    {
+        wxLogError("Options --throughput, --bands, --stress, --self-test, --atlas, --conversion, --parse, "
+                   "and --compiled require NanoSVG headers, set NANOSVG_INCLUDE_DIR when running CMake.");
+        return false;
+    }
+#endif // #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+    if ( parser.Found("atlas-output", &m_atlasOutputName) && !m_atlas )
+    {
+        wxLogError("Option --atlas-output can be used only with --atlas.");
+        return false;
+    }
+
+    if ( parser.Found("compiled-dir", &m_compiledDirName) )
+    {
+        if ( !m_compiled )
+        {
+            wxLogError("Option --compiled-dir can be used only with --compiled.");
+            return false;
+        }
+
+        if ( !wxDir::Exists(m_compiledDirName) )
+        {
+            wxLogError("Folder '%s' does not exist.", m_compiledDirName);
+            return false;
+        }
+    }
+
+    parser.Found("save-results", &m_saveResultsFileName);
+    parser.Found("compare", &m_baselineFileName);
+    parser.Found("current", &m_currentFileName);
+
+    if ( (!m_saveResultsFileName.empty() || !m_baselineFileName.empty())
+         && (m_throughput || m_bands || m_stressTest || m_selfTest || m_startup || m_atlas || m_conversion
+             || m_parse || m_compiled) )
+    {
+        wxLogError("Options --save-results and --compare cannot be used with "
+                   "--throughput, --bands, --stress, --self-test, --startup, --atlas, --conversion, --parse, "
+                   "or --compiled.");
+        return false;
+    }
+
+    m_perfCounters = parser.Found("perf-counters");
+    m_countAllocs  = parser.Found("memory");
+    if ( (m_perfCounters || m_countAllocs)
+         && (m_throughput || m_bands || m_stressTest || m_selfTest || m_startup || m_atlas || m_conversion
+             || m_parse || m_compiled) )
+    {
+        wxLogError("Options --perf-counters and --memory cannot be used with "
+                   "--throughput, --bands, --stress, --self-test, --startup, --atlas, --conversion, --parse, "
+                   "or --compiled.");
+        return false;
+    }
+
+    if ( m_baselineFileName.empty()
+         && (parser.Found("current") || parser.Found("tolerance") || parser.Found("alpha")) )
+    {
+        wxLogError("Options --current, --tolerance, and --alpha can be used only with --compare.");
+        return false;
+    }
+
+    if ( !m_currentFileName.empty() && !m_saveResultsFileName.empty() )
+    {
+        wxLogError("Options --current and --save-results cannot be used together.");
+        return false;
+    }
+
+    double tolerance = m_comparisonOptions.tolerance * 100;
+
+    if ( parser.Found("tolerance", &tolerance) && tolerance < 0 )
+    {
+        wxLogError("Invalid tolerance %g %%.", tolerance);
+        return false;
+    }
+    m_comparisonOptions.tolerance = tolerance / 100;
+
+    if ( parser.Found("alpha", &m_comparisonOptions.alpha)
+         && (m_comparisonOptions.alpha <= 0 || m_comparisonOptions.alpha >= 1) )
+    {
+        wxLogError("Invalid significance level %g.", m_comparisonOptions.alpha);
+        return false;
+    }
+
+    const bool merge = parser.Found("merge");
+
+    if ( !merge && parser.GetParamCount() > 0 )
+    {
+        wxLogError("Unexpected parameter '%s', results files can be given only with --merge.", parser.GetParam(0));
+        return false;
+    }
+
+    if ( merge )
+    {
+        if ( parser.GetParamCount() < 1 )
+        {
+            wxLogError("Option --merge requires at least one results file.");
+            return false;
+        }
+
+        if ( m_throughput || m_bands || m_stressTest || m_selfTest || m_startup || m_atlas || m_conversion
+             || m_parse || m_compiled || !m_currentFileName.empty() || m_perfCounters || m_countAllocs )
+        {
+            wxLogError("Option --merge cannot be used with --throughput, --bands, --stress, --self-test, "
+                       "--startup, --atlas, --conversion, --parse, --compiled, --current, --perf-counters, "
+                       "or --memory.");
+            return false;
+        }
+
+        for ( size_t i = 0; i < parser.GetParamCount(); ++i )
+            m_mergeFileNames.push_back(parser.GetParam(i));
+
+        // the folder is optional, only for the complexity metrics
+        return wxAppConsole::OnCmdLineParsed(parser);
+    }
+
+    // comparing two saved results does not need any SVG files
+    if ( !m_currentFileName.empty() )
+        return wxAppConsole::OnCmdLineParsed(parser);
+
+    if ( m_dirName.empty() )
+    {
+        wxLogError("Option --dir is required.");
+        return false;
+    }
+
+    if ( !wxDir::Exists(m_dirName) )
+    {
+        wxLogError("Folder '%s' does not exist.", m_dirName);
+        return false;
+    }
+
+    if ( !ParseSizes(sizesStr, m_sizes) )
+    {
+        wxLogError("Invalid bitmap sizes '%s'.", sizesStr);
+        return false;
+    }
+
+    if ( !ParseCorpusOptions(parser) )
+        return false;
+
+    if ( parser.Found("r", &m_runCount) && m_runCount < 1 )
+    {
+        wxLogError("Invalid number of runs %ld.", m_runCount);
+        return false;
+    }
+
+    long warmupRunCount = static_cast<long>(m_samplingOptions.warmupRunCount);
+
+    if ( parser.Found("warmup", &warmupRunCount) && warmupRunCount < 0 )
+    {
+        wxLogError("Invalid number of warm-up runs %ld.", warmupRunCount);
+        return false;
+    }
+    m_samplingOptions.warmupRunCount = static_cast<size_t>(warmupRunCount);
+
+    m_samplingOptions.adaptive = parser.Found("adaptive");
+
+    double targetCIWidth = m_samplingOptions.targetCIWidth * 100;
+    long   maxRunCount   = static_cast<long>(m_samplingOptions.maxRunCount);
+    long   timeBudget    = m_samplingOptions.timeBudget / 1000;
+
+    if ( parser.Found("target-ci", &targetCIWidth) && targetCIWidth <= 0 )
+    {
+        wxLogError("Invalid target confidence interval width %g %%.", targetCIWidth);
+        return false;
+    }
+
+    // the default maximum must not be lower than the minimum either
+    if ( !parser.Found("max-runs", &maxRunCount) )
+        maxRunCount = wxMax(maxRunCount, m_runCount);
+
+    if ( maxRunCount < m_runCount )
+    {
+        wxLogError("Maximum number of runs %ld is lower than the number of runs %ld.", maxRunCount, m_runCount);
+        return false;
+    }
+
+    if ( parser.Found("time-budget", &timeBudget) && timeBudget < 1 )
+    {
+        wxLogError("Invalid time budget %ld seconds.", timeBudget);
+        return false;
+    }
+
+    if ( !m_samplingOptions.adaptive
+         && (parser.Found("target-ci") || parser.Found("max-runs") || parser.Found("time-budget")) )
+    {
+        wxLogError("Options --target-ci, --max-runs, and --time-budget can be used only with --adaptive.");
+        return false;
+    }
+
+    m_samplingOptions.targetCIWidth = targetCIWidth / 100;
+    m_samplingOptions.maxRunCount   = static_cast<size_t>(maxRunCount);
+    m_samplingOptions.timeBudget    = timeBudget * 1000;
+
+    m_threadCount = static_cast<long>(wxTestSVGThreadPool::GetDefaultThreadCount());
+    if ( parser.Found("threads", &m_threadCount) && m_threadCount < 1 )
+    {
+        wxLogError("Invalid number of threads %ld.", m_threadCount);
+        return false;
+    }
+
+    const wxTestSVGBackend& baseline = wxTestSVGBackendRegistry::GetBaseline();
+    bool                    useBaseline = false;
+
+    for ( const auto& name : ParseList(backendsStr) )
+    {
+        const wxTestSVGBackend* backend = wxTestSVGBackendRegistry::Find(name);
+
+        if ( !backend )
+        {
+            wxLogError("Unknown backend '%s', available backends are: %s.", name,
+                       wxJoin(wxTestSVGBackendRegistry::GetAvailableNames(), ',', '\0'));
+            return false;
+        }
+
+        if ( !backend->IsAvailable() )
+        {
+            wxLogError("Backend '%s' is not available on this system.", backend->name);
+            return false;
+        }
+
+        if ( backend == &baseline )
+            useBaseline = true;
+        else if ( m_backendNames.Index(backend->name) == wxNOT_FOUND )
+            m_backendNames.push_back(backend->name);
+    }
+
+    // the results of the baseline are those the other backends are reported against
+    if ( !useBaseline )
+    {
+        wxLogError("Backend '%s' must be always benchmarked.", baseline.name);
+        return false;
+    }
+
+    return wxAppConsole::OnCmdLineParsed(parser);
+}
+
+int wxTestSVGBenchApp::OnRun()
+{
+    if ( m_listBackends )
+    {
+        for ( const auto& backend : wxTestSVGBackendRegistry::GetAll() )
+        {
+            wxPrintf("%s%s%s\n", backend.name,
+                     backend.HasFlag(wxTestSVGBackend::Flag_Baseline) ? " (baseline)" : "",
+                     backend.IsAvailable() ? "" : " (not available)");
+            if ( !backend.description.empty() )
+                wxPrintf("    %s\n", backend.description);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if ( !m_currentFileName.empty() )
+    {
+        wxTestSVGBenchmarkResults current;
+
+        if ( !current.Load(m_currentFileName) )
+            return EXIT_FAILURE;
+
+        return Compare(current);
+    }
+
+    if ( !m_mergeFileNames.empty() )
+        return Merge();
+
+    wxArrayString files;
+
+    if ( !wxTestSVGCorpus::FindFiles(m_dirName, m_corpusOptions, files) )
+        return EXIT_FAILURE;
+
+    if ( files.empty() )
+    {
+        wxLogError("No files matching '%s' found in folder '%s' (%s).",
+                   m_corpusOptions.includes.empty() ? wxString("*.svg") : wxJoin(m_corpusOptions.includes, ','),
+                   m_dirName, wxTestSVGCorpus::GetDescription(m_corpusOptions));
+        return EXIT_FAILURE;
+    }
+
+    wxTestSVGRasterizationBenchmark benchmark;
+    wxString                        report, detailedReport, results;
+
+    benchmark.Setup(m_dirName, files, m_sizes);
+    benchmark.SetSamplingOptions(m_samplingOptions);
+
+    if ( m_startup )
+    {
+        wxFprintf(stderr, "Benchmarking startup with %zu files at %zu sizes (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_runCount);
+
+        if ( !benchmark.RunStartup(m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    // OnCmdLineParsed() rejected these modes without NanoSVG
+    else if ( m_stressTest )
+    {
+        size_t mismatchCount = 0;
+
+        wxFprintf(stderr, "Stress testing %zu files at %zu sizes with %ld threads (%ld iterations)...\n",
+                  files.size(), m_sizes.size(), m_threadCount, m_runCount);
+
+        if ( !benchmark.RunStressTest(m_threadCount, m_runCount, results, mismatchCount) )
+            return EXIT_FAILURE;
+
+        if ( m_outputFileName.empty() )
+        {
+            fputs(results.utf8_str(), stdout);
+        }
+        else if ( !WriteTextFile(m_outputFileName, results) )
+        {
+            wxLogError("Couldn't write results to '%s'.", m_outputFileName);
+            return EXIT_FAILURE;
+        }
+
+        return mismatchCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else if ( m_selfTest )
+    {
+        size_t failureCount = 0;
+
+        wxFprintf(stderr, "Self-testing %zu files at %zu sizes with %ld threads...\n",
+                  files.size(), m_sizes.size(), m_threadCount);
+
+        if ( !benchmark.RunSelfTest(m_threadCount, results, failureCount) )
+            return EXIT_FAILURE;
+
+        if ( m_outputFileName.empty() )
+        {
+            fputs(results.utf8_str(), stdout);
+        }
+        else if ( !WriteTextFile(m_outputFileName, results) )
+        {
+            wxLogError("Couldn't write results to '%s'.", m_outputFileName);
+            return EXIT_FAILURE;
+        }
+
+        return failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else if ( m_atlas )
+    {
+        std::shared_ptr<wxSVGIconAtlas> atlas;
+
+        wxFprintf(stderr, "Building atlas of %zu files at %zu sizes with %ld threads (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_threadCount, m_runCount);
+
+        if ( !benchmark.RunAtlas(m_threadCount, m_runCount, report, detailedReport, &results, &atlas) )
+            return EXIT_FAILURE;
+
+        if ( !m_atlasOutputName.empty() )
+        {
+            if ( !atlas->SaveIndex(m_atlasOutputName + ".tsv") )
+            {
+                wxLogError("Couldn't write atlas index to '%s.tsv'.", m_atlasOutputName);
+                return EXIT_FAILURE;
+            }
+
+            if ( !atlas->SavePages(m_atlasOutputName) )
+                return EXIT_FAILURE;
+        }
+    }
+    else if ( m_conversion )
+    {
+        wxFprintf(stderr, "Benchmarking conversion of %zu files at %zu sizes (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_runCount);
+
+        if ( !benchmark.RunConversion(m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+    else if ( m_parse )
+    {
+        wxFprintf(stderr, "Benchmarking parsing of %zu files (%ld runs)...\n",
+                  files.size(), m_runCount);
+
+        if ( !benchmark.RunParse(m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+    else if ( m_compiled )
+    {
+        wxFprintf(stderr, "Benchmarking loading %zu files at %zu sizes from SVG and compiled (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_runCount);
+
+        if ( !benchmark.RunCompiled(m_compiledDirName, m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+    else if ( m_throughput )
+    {
+        wxFprintf(stderr, "Benchmarking throughput of %zu files at %zu sizes with 1 to %ld threads (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_threadCount, m_runCount);
+
+        if ( !benchmark.RunThroughput(m_threadCount, m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+    else if ( m_bands )
+    {
+        wxFprintf(stderr, "Benchmarking rasterization of %zu files at %zu sizes in bands with 1 to %ld threads (%ld runs)...\n",
+                  files.size(), m_sizes.size(), m_threadCount, m_runCount);
+
+        if ( !benchmark.RunBands(m_threadCount, m_runCount, report, &results) )
+            return EXIT_FAILURE;
+    }
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    else
+    {
+        if ( m_samplingOptions.adaptive )
+        {
+            wxFprintf(stderr, "Benchmarking %zu files at %zu sizes (%ld to %zu runs, %zu warm-up)...\n",
+                      files.size(), m_sizes.size(), m_runCount, m_samplingOptions.maxRunCount,
+                      m_samplingOptions.warmupRunCount);
+        }
+        else
+        {
+            wxFprintf(stderr, "Benchmarking %zu files at %zu sizes (%ld runs, %zu warm-up)...\n",
+                      files.size(), m_sizes.size(), m_runCount, m_samplingOptions.warmupRunCount);
+        }
+
+        wxTestSVGBenchmarkResults samples;
+
+        if ( m_perfCounters && !benchmark.EnablePerfCounters(true) )
+        {
+            wxLogWarning("Hardware performance counters are not available (%s), benchmarking without them.",
+                         strerror(benchmark.GetPerfCountersError()));
+        }
+
+        if ( m_countAllocs && !benchmark.EnableAllocCounter(true) )
+            wxLogWarning("Heap allocations cannot be counted with this C library, benchmarking without counting them.");
+
+        typedef wxTestSVGReportWriter Writer;
+
+        // the results are written while benchmarking, unless
+        // the comparison is written instead of them and the report
+        std::unique_ptr<Writer> resultsWriter, detailedReportWriter;
+
+        if ( m_baselineFileName.empty() )
+        {
+            resultsWriter = Writer::Create(Writer::GetFormatForFileName(m_outputFileName, Writer::Format_TSV),
+                                           m_outputFileName.empty() ? "-" : m_outputFileName);
+            if ( !resultsWriter )
+                return EXIT_FAILURE;
+        }
+
+        if ( !m_detailedReportFileName.empty() )
+        {
+            detailedReportWriter = Writer::Create(Writer::GetFormatForFileName(m_detailedReportFileName, Writer::Format_HTML),
+                                                  m_detailedReportFileName);
+            if ( !detailedReportWriter )
+                return EXIT_FAILURE;
+        }
+
+        // the raw times of all the runs are kept in memory only when needed
+        const bool needsSamples = !m_saveResultsFileName.empty() || !m_baselineFileName.empty();
+
+        if ( !benchmark.Run(m_backendNames, m_runCount, report, detailedReportWriter.get(),
+                            resultsWriter.get(), needsSamples ? &samples : nullptr) )
+            return EXIT_FAILURE;
+
+        if ( resultsWriter && !resultsWriter->Close() )
+        {
+            wxLogError("Couldn't write results to '%s'.", resultsWriter->GetFileName());
+            return EXIT_FAILURE;
+        }
+
+        if ( detailedReportWriter && !detailedReportWriter->Close() )
+        {
+            wxLogError("Couldn't write detailed report to '%s'.", m_detailedReportFileName);
+            return EXIT_FAILURE;
+        }
+
+        // so that the results of the shards can be told apart
+        samples.SetMetadata("Corpus", wxTestSVGCorpus::GetDescription(m_corpusOptions));
+
+        if ( !m_saveResultsFileName.empty() && !samples.Save(m_saveResultsFileName) )
+            return EXIT_FAILURE;
+
+        if ( !m_baselineFileName.empty() )
+            return Compare(samples);
+
+        if ( !m_reportFileName.empty() && !WriteTextFile(m_reportFileName, report) )
+        {
+            wxLogError("Couldn't write report to '%s'.", m_reportFileName);
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    if ( m_outputFileName.empty() )
+    {
+        fputs(results.utf8_str(), stdout);
+    }
+    else if ( !WriteTextFile(m_outputFileName, results) )
+    {
+        wxLogError("Couldn't write results to '%s'.", m_outputFileName);
+        return EXIT_FAILURE;
+    }
+
+    if ( !m_reportFileName.empty() && !WriteTextFile(m_reportFileName, report) )
+    {
+        wxLogError("Couldn't write report to '%s'.", m_reportFileName);
+        return EXIT_FAILURE;
+    }
+
+    if ( !m_detailedReportFileName.empty() && !WriteTextFile(m_detailedReportFileName, detailedReport) )
+    {
+        wxLogError("Couldn't write detailed report to '%s'.", m_detailedReportFileName);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int wxTestSVGBenchApp::Compare(const wxTestSVGBenchmarkResults& current)
+{
+    wxTestSVGBenchmarkResults    baseline;
+    wxTestSVGBenchmarkComparison comparison;
+    wxString                     report, results;
+
+    if ( !baseline.Load(m_baselineFileName) )
+        return EXIT_FAILURE;
+
+    if ( !comparison.Compare(baseline, current, m_comparisonOptions) )
+    {
+        wxLogError("The results have no file, size, and backend in common with the baseline '%s'.",
+                   m_baselineFileName);
+        return EXIT_FAILURE;
+    }
+
+    comparison.CreateReport(baseline, current, report, &results);
+
+    if ( m_outputFileName.empty() )
+    {
+        fputs(results.utf8_str(), stdout);
+    }
+    else if ( !WriteTextFile(m_outputFileName, results) )
+    {
+        wxLogError("Couldn't write comparison to '%s'.", m_outputFileName);
+        return EXIT_FAILURE;
+    }
+
+    if ( !m_reportFileName.empty() && !WriteTextFile(m_reportFileName, report) )
+    {
+        wxLogError("Couldn't write report to '%s'.", m_reportFileName);
+        return EXIT_FAILURE;
+    }
+
+    wxFprintf(stderr, "Compared %zu cells: %zu regressions, %zu improvements.\n",
+              comparison.GetCellResults().size(), comparison.GetRegressionCount(),
+              comparison.GetImprovementCount());
+
+    for ( const auto& s : comparison.GetSizeResults() )
+    {
+        wxFprintf(stderr, "%dx%d %s: geometric mean speedup %.3f%s\n", s.size.x, s.size.y, s.backend,
+                  s.geoMeanSpeedup, s.isToleranceExceeded ? " (tolerance exceeded)" : "");
+    }
+
+    if ( comparison.IsToleranceExceeded() )
+    {
+        wxFprintf(stderr, "Performance tolerance of %g %% exceeded.\n", m_comparisonOptions.tolerance * 100);
+        return 2;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int wxTestSVGBenchApp::Merge()
+{
+    wxTestSVGBenchmarkResults merged;
+
+    for ( const auto& fileName : m_mergeFileNames )
+    {
+        wxTestSVGBenchmarkResults shard;
+
+        if ( !shard.Load(fileName) )
+            return EXIT_FAILURE;
+
+        if ( !merged.Merge(shard) )
+        {
+            wxLogError("Couldn't merge results '%s'.", fileName);
+            return EXIT_FAILURE;
+        }
+    }
+
+    wxFprintf(stderr, "Merged %zu results files with %zu cells.\n",
+              m_mergeFileNames.size(), merged.GetSamples().size());
+
+    if ( !m_saveResultsFileName.empty() && !merged.Save(m_saveResultsFileName) )
+        return EXIT_FAILURE;
+
+    if ( !m_baselineFileName.empty() )
+        return Compare(merged);
+
+    typedef wxTestSVGReportWriter Writer;
+
+    wxTestSVGRasterizationBenchmark benchmark;
+    wxString                        report;
+    std::unique_ptr<Writer>         resultsWriter, detailedReportWriter;
+
+    benchmark.Setup(m_dirName, wxArrayString(), std::vector<wxSize>());
+
+    resultsWriter = Writer::Create(Writer::GetFormatForFileName(m_outputFileName, Writer::Format_TSV),
+                                   m_outputFileName.empty() ? "-" : m_outputFileName);
+    if ( !resultsWriter )
+        return EXIT_FAILURE;
+
+    if ( !m_detailedReportFileName.empty() )
+    {
+        detailedReportWriter = Writer::Create(Writer::GetFormatForFileName(m_detailedReportFileName, Writer::Format_HTML),
+                                              m_detailedReportFileName);
+        if ( !detailedReportWriter )
+            return EXIT_FAILURE;
+    }
+
+    if ( !benchmark.CreateReportFromResults(merged, report, detailedReportWriter.get(), resultsWriter.get()) )
+        return EXIT_FAILURE;
+
+    if ( !resultsWriter->Close() )
+    {
+        wxLogError("Couldn't write results to '%s'.", resultsWriter->GetFileName());
+        return EXIT_FAILURE;
+    }
+
+    if ( detailedReportWriter && !detailedReportWriter->Close() )
+    {
+        wxLogError("Couldn't write detailed report to '%s'.", m_detailedReportFileName);
+        return EXIT_FAILURE;
+    }
+
+    if ( !m_reportFileName.empty() && !WriteTextFile(m_reportFileName, report) )
+    {
+        wxLogError("Couldn't write report to '%s'.", m_reportFileName);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+bool wxTestSVGBenchApp::ParseCorpusOptions(wxCmdLineParser& parser)
+{
+    wxString listStr;
+
+    m_corpusOptions.recursive = parser.Found("recursive");
+    if ( parser.Found("g", &listStr) )
+        m_corpusOptions.includes = ParseList(listStr);
+    if ( parser.Found("exclude", &listStr) )
+        m_corpusOptions.excludes = ParseList(listStr);
+
+    long sampleCount = 0;
+
+    if ( parser.Found("sample", &sampleCount) )
+    {
+        if ( sampleCount < 1 )
+        {
+            wxLogError("Invalid sample size %ld.", sampleCount);
+            return false;
+        }
+
+        wxString samplingStr("random");
+
+        parser.Found("sampling", &samplingStr);
+        if ( !wxTestSVGCorpus::GetSamplingFromName(samplingStr, m_corpusOptions.sampling)
+             || m_corpusOptions.sampling == wxTestSVGCorpus::Sampling_None )
+        {
+            wxLogError("Invalid sampling '%s'.", samplingStr);
+            return false;
+        }
+        m_corpusOptions.sampleCount = static_cast<size_t>(sampleCount);
+
+        long seed = 0;
+
+        if ( parser.Found("seed", &seed) && seed < 0 )
+        {
+            wxLogError("Invalid seed %ld.", seed);
+            return false;
+        }
+        m_corpusOptions.seed = static_cast<unsigned long>(seed);
+    }
+    else if ( parser.Found("sampling") || parser.Found("seed") )
+    {
+        wxLogError("Options --sampling and --seed can be used only with --sample.");
+        return false;
+    }
+
+    long maxFileCount = 0;
+
+    if ( parser.Found("n", &maxFileCount) )
+    {
+        if ( maxFileCount < 1 )
+        {
+            wxLogError("Invalid maximum number of files %ld.", maxFileCount);
+            return false;
+        }
+        m_corpusOptions.maxFileCount = static_cast<size_t>(maxFileCount);
+    }
+
+    wxString shardStr;
+
+    if ( parser.Found("shard", &shardStr) )
+    {
+        unsigned long index = 0, count = 0;
+
+        if ( !shardStr.BeforeFirst('/').ToULong(&index) || !shardStr.AfterFirst('/').ToULong(&count)
+             || index < 1 || index > count )
+        {
+            wxLogError("Invalid shard '%s', expected i/N with i from 1 to N.", shardStr);
+            return false;
+        }
+        m_corpusOptions.shardIndex = index - 1;
+        m_corpusOptions.shardCount = count;
+    }
+
+    return true;
+}
+
+// accepts sizes as a comma separated list of either "N" or "WxH"
+bool wxTestSVGBenchApp::ParseSizes(const wxString& sizesStr, std::vector<wxSize>& sizes)
+{
+    wxStringTokenizer tokenizer(sizesStr, ",");
+
+    sizes.clear();
+    while ( tokenizer.HasMoreTokens() )
+    {
+        const wxString sizeStr = tokenizer.GetNextToken().Trim().Trim(false).Lower();
+        long width = 0, height = 0;
+
+        if ( sizeStr.Find('x') == wxNOT_FOUND )
+        {
+            if ( !sizeStr.ToLong(&width) )
+                return false;
+            height = width;
+        }
+        else if ( !sizeStr.BeforeFirst('x').ToLong(&width)
+                  || !sizeStr.AfterFirst('x').ToLong(&height) )
+        {
+            return false;
+        }
+
+        if ( width < 1 || height < 1 )
+            return false;
+
+        sizes.push_back(wxSize(width, height));
+    }
+
+    return !sizes.empty();
+}
+
+// returns the trimmed non-empty items of a comma separated list
+wxArrayString wxTestSVGBenchApp::ParseList(const wxString& listStr)
+{
+    wxStringTokenizer tokenizer(listStr, ",");
+    wxArrayString     items;
+
+    while ( tokenizer.HasMoreTokens() )
+    {
+        const wxString item = tokenizer.GetNextToken().Trim().Trim(false);
+
+        if ( !item.empty() )
+            items.push_back(item);
+    }
+
+    return items;
+}
+
+bool wxTestSVGBenchApp::WriteTextFile(const wxString& fileName, const wxString& text)
+{
+    wxFFile file(fileName, "w");
+
+    if ( !file.IsOpened() )
+        return false;
+
+    return file.Write(text, wxConvUTF8);
+}
+
+wxIMPLEMENT_APP_CONSOLE(wxTestSVGBenchApp);
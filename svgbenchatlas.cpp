@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchatlas.cpp
+// Purpose:     Benchmark of building wxSVGIconAtlas
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg_atlas.h"
+#include "svgbench.h"
+#include "svgthreadpool.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunAtlas()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunAtlas(size_t threadCount, size_t runCount,
+                                               wxString& report, wxString& detailedReport,
+                                               wxString* results, std::shared_ptr<wxSVGIconAtlas>* atlas)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+
+    if ( threadCount == 0 )
+        threadCount = wxTestSVGThreadPool::GetDefaultThreadCount();
+
+    std::vector<AtlasResult>        atlasResults;
+    std::shared_ptr<wxSVGIconAtlas> lastAtlas;
+    wxStopWatch                     stopWatch;
+
+    for ( size_t run = 0; run < runCount; ++run )
+    {
+        std::shared_ptr<wxSVGIconAtlas> currentAtlas(new wxSVGIconAtlas);
+
+        if ( !currentAtlas->Build(m_dirName, m_fileNames, m_sizes, threadCount) )
+            return false;
+
+        const wxSVGIconAtlas::BuildTimes& buildTimes = currentAtlas->GetBuildTimes();
+        AtlasResult                       result;
+
+        result.read      = buildTimes.read;
+        result.rasterize = buildTimes.rasterize;
+        result.pack      = buildTimes.pack;
+        result.copy      = buildTimes.copy;
+
+        // the lookups are too fast to be timed one by one
+        size_t foundCount = 0;
+
+        stopWatch.Start();
+        for ( size_t i = 0; i < AtlasLookupRepeatCount; ++i )
+        {
+            for ( const auto& fileName : m_fileNames )
+            {
+                for ( const auto& size : m_sizes )
+                {
+                    if ( currentAtlas->Find(fileName, size) )
+                        ++foundCount;
+                }
+            }
+        }
+        result.lookup = stopWatch.TimeInMicro().ToLong();
+
+        if ( foundCount != AtlasLookupRepeatCount * m_fileNames.size() * m_sizes.size() )
+        {
+            wxLogError("Couldn't find all the icons in the atlas.");
+            return false;
+        }
+
+        stopWatch.Start();
+        for ( size_t page = 0; page < currentAtlas->GetPageCount(); ++page )
+            currentAtlas->GetPageBitmap(page);
+        result.pageBitmaps = stopWatch.TimeInMicro().ToLong();
+
+        stopWatch.Start();
+        for ( const auto& fileName : m_fileNames )
+        {
+            const wxBitmapBundle bundle = CreateFromSVGIconAtlas(currentAtlas, fileName);
+
+            for ( const auto& size : m_sizes )
+            {
+                if ( !bundle.GetBitmap(size).IsOk() )
+                {
+                    wxLogError("Couldn't get bitmap for file '%s' at size %dx%d from the atlas.", fileName, size.x, size.y);
+                    return false;
+                }
+            }
+        }
+        result.getBitmap = stopWatch.TimeInMicro().ToLong();
+
+        atlasResults.push_back(result);
+        lastAtlas = currentAtlas;
+    }
+
+    CreateAtlasReport(atlasResults, *lastAtlas, threadCount, runCount, report, detailedReport, results);
+
+    if ( atlas )
+        *atlas = lastAtlas;
+
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateAtlasReport(const std::vector<AtlasResult>& atlasResults,
+                                                        const wxSVGIconAtlas& atlas,
+                                                        size_t threadCount, size_t runCount,
+                                                        wxString& reportText, wxString& detailedReportText,
+                                                        wxString* resultsText)
+{
+    // the pixels of each individual bitmap are allocated separately,
+    // e.g., as a DIB section on MSW, which takes whole memory pages
+    const size_t memoryPageBytes = 4096;
+
+    const std::vector<wxSVGIconAtlas::Entry>& entries = atlas.GetEntries();
+
+    size_t iconBytes       = 0;
+    size_t individualBytes = 0;
+
+    for ( const auto& entry : entries )
+    {
+        const size_t bytes = wxBitmapBundleImplSVG::GetBitmapBytes(entry.rect.GetSize());
+
+        iconBytes       += bytes;
+        individualBytes += (bytes + memoryPageBytes - 1) / memoryPageBytes * memoryPageBytes;
+    }
+
+    const size_t atlasBytes = atlas.GetBytes();
+    wxString     pageSizesStr;
+
+    for ( size_t page = 0; page < atlas.GetPageCount(); ++page )
+    {
+        const wxSize pageSize = atlas.GetPageSize(page);
+
+        if ( !pageSizesStr.empty() )
+            pageSizesStr += ", ";
+        pageSizesStr += wxString::Format("%dx%d", pageSize.x, pageSize.y);
+    }
+
+    VectorLong readTimes, rasterizeTimes, packTimes, copyTimes, totalTimes;
+    VectorLong lookupTimes, pageBitmapsTimes, getBitmapTimes;
+
+    if ( resultsText )
+        *resultsText = "Run\tRead\tRasterize\tPack\tCopy\tTotal\tLookup\tPageBitmaps\tGetBitmap\n";
+
+    for ( size_t run = 0; run < atlasResults.size(); ++run )
+    {
+        const AtlasResult& r = atlasResults[run];
+        const long total = r.read + r.rasterize + r.pack + r.copy;
+
+        readTimes.push_back(r.read);
+        rasterizeTimes.push_back(r.rasterize);
+        packTimes.push_back(r.pack);
+        copyTimes.push_back(r.copy);
+        totalTimes.push_back(total);
+        lookupTimes.push_back(r.lookup);
+        pageBitmapsTimes.push_back(r.pageBitmaps);
+        getBitmapTimes.push_back(r.getBitmap);
+
+        if ( resultsText )
+        {
+            *resultsText += wxString::Format("%zu\t%ld\t%ld\t%ld\t%ld\t%ld\t%ld\t%ld\t%ld\n",
+                run + 1, r.read, r.rasterize, r.pack, r.copy, total, r.lookup, r.pageBitmaps, r.getBitmap);
+        }
+    }
+
+    const double lookupCount = static_cast<double>(AtlasLookupRepeatCount * entries.size());
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Atlas Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "th[scope=row] {text-align: left;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Atlas of %zu files from folder '%s' at %zu sizes with NanoSVG (%zu runs, %zu threads)</h3>",
+        m_fileNames.size(), m_dirName, m_sizes.size(), runCount, threadCount));
+    result.push_back("<p>The times are in milliseconds (median of all runs), "
+                     "except for the lookup and GetBitmap times per icon.</p>");
+
+    result.push_back("<table><thead><tr><th>Read</th><th>Rasterize</th><th>Pack</th><th>Copy</th><th>Total</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+    result.push_back(wxString::Format("<tr><td>%.2f</td><td>%.2f</td><td>%.2f</td><td>%.2f</td><td>%.2f</td></tr>\n",
+        CalcStatsForVectorLong(readTimes).mdn / 1000., CalcStatsForVectorLong(rasterizeTimes).mdn / 1000.,
+        CalcStatsForVectorLong(packTimes).mdn / 1000., CalcStatsForVectorLong(copyTimes).mdn / 1000.,
+        CalcStatsForVectorLong(totalTimes).mdn / 1000.));
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    result.push_back(wxString::Format("<p>Individual bitmaps are rounded up to whole %zu byte memory pages. "
+                     "Fill is the part of the atlas pages covered by the icons.</p>", memoryPageBytes));
+
+    result.push_back("<table><tbody>\n");
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Icons</th><td>%zu</td></tr>\n", entries.size()));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Atlas pages</th><td>%zu (%s)</td></tr>\n",
+        atlas.GetPageCount(), pageSizesStr));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Icon pixels (KiB)</th><td>%.1f</td></tr>\n",
+        iconBytes / 1024.));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Individual bitmaps (KiB)</th><td>%.1f</td></tr>\n",
+        individualBytes / 1024.));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Atlas (KiB)</th><td>%.1f</td></tr>\n",
+        atlasBytes / 1024.));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Fill</th><td>%.1f %%</td></tr>\n",
+        atlasBytes ? 100. * iconBytes / atlasBytes : 0.));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Saved (KiB)</th><td>%.1f</td></tr>\n",
+        (static_cast<double>(individualBytes) - static_cast<double>(atlasBytes)) / 1024.));
+    result.push_back(wxString::Format("<tr><th scope=\"row\">Bitmaps saved</th><td>%zu</td></tr>\n",
+        entries.size() - atlas.GetPageCount()));
+    result.push_back("</tbody></table>\n");
+
+    result.push_back("<p>Lookup is finding the icon rectangle by the file name and size. "
+                     "GetBitmap is getting the icon from wxBitmapBundle using the atlas, "
+                     "i.e., the lookup and copying the rectangle from the page bitmap. "
+                     "Page bitmaps is creating the bitmaps for all the pages, done once.</p>");
+
+    result.push_back("<table><thead><tr><th>Lookup (ns)</th><th>GetBitmap (&micro;s)</th><th>Page bitmaps (ms)</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+    result.push_back(wxString::Format("<tr><td>%.1f</td><td>%.2f</td><td>%.2f</td></tr>\n",
+        CalcStatsForVectorLong(lookupTimes).mdn * 1000. / lookupCount,
+        static_cast<double>(CalcStatsForVectorLong(getBitmapTimes).mdn) / entries.size(),
+        CalcStatsForVectorLong(pageBitmapsTimes).mdn / 1000.));
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+
+    // the rectangle of every icon
+    result.clear();
+    result.push_back(rowStr);
+    result.push_back(wxString::Format("<h3>Atlas of %zu files from folder '%s' at %zu sizes</h3>",
+        m_fileNames.size(), m_dirName, m_sizes.size()));
+    result.push_back("<table><thead><tr><th>File</th><th>Width</th><th>Height</th>"
+                     "<th>Page</th><th>X</th><th>Y</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+
+    for ( const auto& entry : entries )
+    {
+        result.push_back(wxString::Format("<tr><th scope=\"row\">%s</th><td>%d</td><td>%d</td><td>%zu</td><td>%d</td><td>%d</td></tr>\n",
+            atlas.GetFileName(entry.fileIndex), entry.rect.width, entry.rect.height,
+            entry.page, entry.rect.x, entry.rect.y));
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        detailedReportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
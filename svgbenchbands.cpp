@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchbands.cpp
+// Purpose:     Benchmark of rasterizing a document in bands with wxSVGTileRasterizer
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg_tile.h"
+#include "svgbench.h"
+#include "svgthreadpool.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunBands()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunBands(size_t maxThreadCount, size_t runCount,
+                                               wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+    wxCHECK(maxThreadCount, false);
+
+    std::vector<BandsResult>   bandsResults;
+    wxSVGTileRasterizer        rasterizer;
+    std::vector<unsigned char> reference, buffer;
+    VectorLong                 times;
+    wxStopWatch                stopWatch;
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        wxCharBuffer data;
+
+        if ( !ReadFile(GetFilePath(f), data) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        // NanoSVG modifies the data while parsing it, but it is not needed afterwards
+        std::shared_ptr<NSVGimage> image(nsvgParse(data.data(), "px", 96), nsvgDelete);
+
+        if ( !image || image->width <= 0 || image->height <= 0 )
+        {
+            wxLogError("Couldn't parse file '%s' with NanoSVG.", m_fileNames[f]);
+            return false;
+        }
+
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        {
+            const wxSize size   = m_sizes[s];
+            const int    stride = size.x * 4;
+            // the same scaling and centering as wxBitmapBundleImplSVGTile
+            const float  scale  = wxMin(size.x / image->width, size.y / image->height);
+            const float  tx     = (size.x - image->width * scale) / 2.0f;
+            const float  ty     = (size.y - image->height * scale) / 2.0f;
+
+            BandsResult result;
+
+            result.fileIndex = f;
+            result.sizeIndex = s;
+
+            reference.resize(wxBitmapBundleImplSVG::GetBitmapBytes(size));
+            buffer.resize(reference.size());
+
+            // the first run of each is not timed, the serial one is
+            // the reference for the banded ones
+            if ( !rasterizer.Rasterize(image.get(), tx, ty, scale, &reference[0], size.x, size.y, stride) )
+            {
+                wxLogError("Couldn't rasterize file '%s' at size %dx%d.", m_fileNames[f], size.x, size.y);
+                return false;
+            }
+
+            times.clear();
+            for ( size_t run = 0; run < runCount; ++run )
+            {
+                stopWatch.Start();
+                rasterizer.Rasterize(image.get(), tx, ty, scale, &buffer[0], size.x, size.y, stride);
+                times.push_back(stopWatch.TimeInMicro().ToLong());
+            }
+            result.serial = CalcStatsForVectorLong(times).mdn;
+
+            for ( size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount )
+            {
+                // only one pool at a time, the first run also starts its threads
+                wxTestSVGThreadPool pool(threadCount);
+
+                rasterizer.RasterizeBands(image.get(), tx, ty, scale, &buffer[0], size.x, size.y, stride, pool);
+
+                if ( buffer != reference )
+                {
+                    wxLogError("Bitmap of file '%s' at size %dx%d rasterized in bands with %zu threads "
+                               "differs from the one rasterized serially.",
+                               m_fileNames[f], size.x, size.y, threadCount);
+                    return false;
+                }
+
+                times.clear();
+                for ( size_t run = 0; run < runCount; ++run )
+                {
+                    stopWatch.Start();
+                    rasterizer.RasterizeBands(image.get(), tx, ty, scale, &buffer[0], size.x, size.y, stride, pool);
+                    times.push_back(stopWatch.TimeInMicro().ToLong());
+                }
+                result.bands.push_back(CalcStatsForVectorLong(times).mdn);
+            }
+
+            bandsResults.push_back(result);
+        }
+    }
+
+    CreateBandsReport(bandsResults, maxThreadCount, runCount, report, results);
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateBandsReport(const std::vector<BandsResult>& bandsResults,
+                                                        size_t maxThreadCount, size_t runCount,
+                                                        wxString& reportText, wxString* resultsText)
+{
+    wxCHECK_RET(!bandsResults.empty(), "no results");
+
+    const size_t sizeCount = m_sizes.size();
+    const auto   getSizeStr = [&](size_t sizeIndex)
+    {
+        return wxString::Format("%dx%d", m_sizes[sizeIndex].x, m_sizes[sizeIndex].y);
+    };
+    const auto   getSpeedup = [](long serial, long bands) -> double
+    {
+        return static_cast<double>(serial) / (bands > 0 ? bands : 1);
+    };
+
+    // the sums of the median times of all the files at each size,
+    // serial and for each thread count
+    VectorLong  serialSums(sizeCount);
+    MatrixLong2 bandsSums(sizeCount, VectorLong(maxThreadCount));
+
+    for ( const auto& r : bandsResults )
+    {
+        serialSums[r.sizeIndex] += r.serial;
+        for ( size_t t = 0; t < maxThreadCount; ++t )
+            bandsSums[r.sizeIndex][t] += r.bands[t];
+    }
+
+    // The crossover is the smallest size from which on the best thread
+    // count is faster than serial rasterization at all the larger sizes
+    std::vector<size_t> sizesByArea(sizeCount);
+    std::vector<double> bestSpeedups(sizeCount);
+    std::vector<size_t> bestThreadCounts(sizeCount);
+
+    std::iota(sizesByArea.begin(), sizesByArea.end(), 0);
+    std::stable_sort(sizesByArea.begin(), sizesByArea.end(), [this](size_t a, size_t b)
+        {
+            return m_sizes[a].x * m_sizes[a].y < m_sizes[b].x * m_sizes[b].y;
+        });
+
+    for ( size_t s = 0; s < sizeCount; ++s )
+    {
+        for ( size_t t = 0; t < maxThreadCount; ++t )
+        {
+            const double speedup = getSpeedup(serialSums[s], bandsSums[s][t]);
+
+            if ( speedup > bestSpeedups[s] )
+            {
+                bestSpeedups[s]     = speedup;
+                bestThreadCounts[s] = t + 1;
+            }
+        }
+    }
+
+    size_t crossover = sizeCount;
+
+    for ( size_t i = sizeCount; i > 0 && bestSpeedups[sizesByArea[i - 1]] > 1; --i )
+        crossover = sizesByArea[i - 1];
+
+    std::vector<wxArrayString> columnLabels;
+    wxArrayString              labels;
+
+    labels.push_back("Serial");
+    labels.push_back("Time");
+    columnLabels.push_back(labels);
+
+    for ( size_t t = 1; t <= maxThreadCount; ++t )
+    {
+        labels[0] = wxString::Format("%zu thread%s", t, t > 1 ? "s" : "");
+        labels[1] = "Time";
+        columnLabels.push_back(labels);
+        labels[1] = "Speedup";
+        columnLabels.push_back(labels);
+    }
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Bands Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Rasterized %zu files from folder '%s' at %zu sizes with wxSVGTileRasterizer "
+                                      "serially and in bands with 1 to %zu threads (%zu runs)</h3>",
+        m_fileNames.size(), m_dirName, sizeCount, maxThreadCount, runCount));
+    result.push_back(wxString::Format("<p>Each document is rasterized into one buffer, in bands with %d bands per thread "
+                     "and all the banded bitmaps were checked to be identical to the serial ones. "
+                     "The times are the latency of rasterizing one document in microseconds "
+                     "(median of all runs, averaged over the files), "
+                     "speedup is relative to serial rasterization.</p>",
+                     wxSVGTileRasterizer::BandsPerThread));
+
+    if ( crossover == sizeCount )
+    {
+        result.push_back("<p>Rasterizing in bands was not faster at the largest size, "
+                         "it is not worth doing at any of the sizes.</p>");
+    }
+    else if ( crossover == sizesByArea.front() )
+    {
+        result.push_back(wxString::Format("<p>Rasterizing in bands was faster at all the sizes, "
+                                          "the crossover is below %s.</p>", getSizeStr(crossover)));
+    }
+    else
+    {
+        result.push_back(wxString::Format("<p>Crossover: rasterizing in bands is faster from %s up "
+                                          "(%.2fx with %zu threads), it is not worth doing below it.</p>",
+                                          getSizeStr(crossover), bestSpeedups[crossover],
+                                          bestThreadCounts[crossover]));
+    }
+
+    result.push_back("<table><thead>\n");
+    AppendHeaderRows("Size", columnLabels, result);
+    result.push_back("</thead>\n");
+    result.push_back("<tbody>\n");
+
+    for ( const auto s : sizesByArea )
+    {
+        const double fileCount = static_cast<double>(m_fileNames.size());
+
+        rowStr = wxString::Format("<tr><td>%s</td><td>%.0f</td>", getSizeStr(s), serialSums[s] / fileCount);
+        for ( size_t t = 0; t < maxThreadCount; ++t )
+        {
+            rowStr += wxString::Format("<td>%.0f</td><td>%.2f</td>",
+                bandsSums[s][t] / fileCount, getSpeedup(serialSums[s], bandsSums[s][t]));
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    // the same for each file
+    result.push_back("<h3>Files</h3>");
+    result.push_back("<table><thead>\n");
+    AppendHeaderRows("File", columnLabels, result);
+    result.push_back("</thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "File\tSize\tThreads\tTime\tSpeedup\n";
+
+    for ( const auto& r : bandsResults )
+    {
+        const wxString sizeStr = getSizeStr(r.sizeIndex);
+
+        rowStr = wxString::Format("<tr><td>%s %s</td><td>%ld</td>", GetDisplayName(r.fileIndex), sizeStr, r.serial);
+
+        // serial rasterization is written as 0 threads
+        if ( resultsText )
+        {
+            *resultsText += wxString::Format("%s\t%s\t0\t%ld\t1\n",
+                m_fileNames[r.fileIndex], sizeStr, r.serial);
+        }
+
+        for ( size_t t = 0; t < maxThreadCount; ++t )
+        {
+            const double speedup = getSpeedup(r.serial, r.bands[t]);
+
+            rowStr += wxString::Format("<td>%ld</td><td>%.2f</td>", r.bands[t], speedup);
+
+            if ( resultsText )
+            {
+                *resultsText += wxString::Format("%s\t%s\t%zu\t%ld\t%.3f\n",
+                    m_fileNames[r.fileIndex], sizeStr, t + 1, r.bands[t], speedup);
+            }
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
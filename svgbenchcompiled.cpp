@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchcompiled.cpp
+// Purpose:     Benchmark of loading SVG and compiled SVG files
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg_compiled.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgbench.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunCompiled()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunCompiled(const wxString& compiledDirName, size_t runCount,
+                                                  wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+
+    const bool     isTemporary = compiledDirName.empty();
+    const wxString dirName     = isTemporary
+        ? wxFileName(wxFileName::GetTempDir(),
+                     wxString::Format("wxTestSVGBench-compiled-%lu", wxGetProcessId())).GetFullPath()
+        : compiledDirName;
+    const wxSize   sizeDef     = m_sizes[0];
+
+    std::vector<wxString> compiledFileNames;
+    size_t                svgBytes = 0, compiledBytes = 0;
+    bool                  ok = true;
+
+    for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+    {
+        // not wxFileName(dirName, name), the name may include subfolders
+        wxFileName compiledFileName(wxSVGCompiledImage::GetCompiledFileName(m_fileNames[f]));
+
+        compiledFileName.MakeAbsolute(dirName);
+        compiledFileNames.push_back(compiledFileName.GetFullPath());
+
+        if ( isTemporary
+             && !(compiledFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)
+                  && wxSVGCompiledImage::CompileFile(GetFilePath(f), compiledFileNames[f])) )
+        {
+            wxLogError("Couldn't compile file '%s' to '%s'.", m_fileNames[f], compiledFileNames[f]);
+            ok = false;
+            break;
+        }
+
+        svgBytes      += static_cast<size_t>(wxFileName::GetSize(GetFilePath(f)).GetValue());
+        compiledBytes += static_cast<size_t>(wxFileName::GetSize(compiledFileNames[f]).GetValue());
+
+        // the compiled bitmaps must be identical to those rasterized from SVG
+        wxBitmapBundle reference = CreateFromImplSVGNano(GetFilePath(f), sizeDef);
+        wxBitmapBundle compiled  = CreateFromImplSVGCompiled(compiledFileNames[f], sizeDef);
+
+        if ( !reference.IsOk() || !compiled.IsOk() )
+        {
+            wxLogError("Couldn't create bitmap bundle for file '%s'%s.", m_fileNames[f],
+                       reference.IsOk() ? " from the compiled file" : "");
+            ok = false;
+            break;
+        }
+
+        for ( const auto& size : m_sizes )
+        {
+            if ( !AreImagesIdentical(reference.GetBitmap(size).ConvertToImage(),
+                                     compiled.GetBitmap(size).ConvertToImage()) )
+            {
+                wxLogError("Bitmap of compiled file '%s' at size %dx%d differs from the one rasterized from SVG.",
+                           m_fileNames[f], size.x, size.y);
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    std::vector<CompiledResult> compiledResults;
+    wxStopWatch                 stopWatch;
+
+    for ( size_t run = 0; run < runCount && ok; ++run )
+    {
+        CompiledResult result;
+
+        for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+        {
+            stopWatch.Start();
+            wxBitmapBundle bundle = wxBitmapBundle::FromSVGFile(GetFilePath(f), sizeDef);
+            result.svgLoad += stopWatch.TimeInMicro().ToLong();
+
+            stopWatch.Start();
+            for ( const auto& size : m_sizes )
+                ok = bundle.GetBitmap(size).IsOk() && ok;
+            result.svgBitmaps += stopWatch.TimeInMicro().ToLong();
+
+            stopWatch.Start();
+            bundle = CreateFromImplSVGCompiled(compiledFileNames[f], sizeDef);
+            result.compiledLoad += stopWatch.TimeInMicro().ToLong();
+
+            stopWatch.Start();
+            for ( const auto& size : m_sizes )
+                ok = bundle.GetBitmap(size).IsOk() && ok;
+            result.compiledBitmaps += stopWatch.TimeInMicro().ToLong();
+
+            if ( !ok )
+                wxLogError("Couldn't get bitmaps for file '%s'.", m_fileNames[f]);
+        }
+
+        compiledResults.push_back(result);
+    }
+
+    if ( isTemporary )
+        wxFileName::Rmdir(dirName, wxPATH_RMDIR_RECURSIVE);
+
+    if ( !ok )
+        return false;
+
+    CreateCompiledReport(compiledResults, svgBytes, compiledBytes, isTemporary, runCount, report, results);
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateCompiledReport(const std::vector<CompiledResult>& compiledResults,
+                                                           size_t svgBytes, size_t compiledBytes, bool isTemporary,
+                                                           size_t runCount, wxString& reportText, wxString* resultsText)
+{
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Compiled Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Loaded %zu files from folder '%s' at %zu sizes from SVG and compiled (%zu runs)</h3>",
+        m_fileNames.size(), m_dirName, m_sizes.size(), runCount));
+    result.push_back(wxString::Format("<p>The SVG files take %.1f KB, the compiled ones %.1f KB (%.0f %%)%s.</p>",
+        svgBytes / 1024., compiledBytes / 1024., svgBytes ? 100. * compiledBytes / svgBytes : 0.,
+        isTemporary ? ", compiled into a temporary folder before measuring" : ""));
+    result.push_back("<p>FromSVGFile is wxBitmapBundle::FromSVGFile(), which reads and parses the files, "
+                     "Compiled is wxBitmapBundleImplSVGCompiled, which maps the compiled files into memory. "
+                     "Load is creating the bundles, GetBitmap is getting the bitmaps at all the sizes, "
+                     "both rasterized with NanoSVG. The times are in milliseconds for all the files "
+                     "(median of all runs), the files are in the system cache after the first run. "
+                     "Speedup is the FromSVGFile time divided by the Compiled time.</p>");
+
+    result.push_back("<table><thead><tr><th>Bundle</th><th>Load</th><th>GetBitmap</th><th>Total</th>"
+                     "<th>Load Speedup</th><th>Total Speedup</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "Run\tSVGLoad\tSVGGetBitmap\tCompiledLoad\tCompiledGetBitmap\n";
+
+    VectorLong svgLoadTimes, svgBitmapTimes, svgTotalTimes;
+    VectorLong compiledLoadTimes, compiledBitmapTimes, compiledTotalTimes;
+
+    for ( size_t run = 0; run < compiledResults.size(); ++run )
+    {
+        const CompiledResult& r = compiledResults[run];
+
+        svgLoadTimes.push_back(r.svgLoad);
+        svgBitmapTimes.push_back(r.svgBitmaps);
+        svgTotalTimes.push_back(r.svgLoad + r.svgBitmaps);
+        compiledLoadTimes.push_back(r.compiledLoad);
+        compiledBitmapTimes.push_back(r.compiledBitmaps);
+        compiledTotalTimes.push_back(r.compiledLoad + r.compiledBitmaps);
+
+        if ( resultsText )
+        {
+            *resultsText += wxString::Format("%zu\t%ld\t%ld\t%ld\t%ld\n",
+                run + 1, r.svgLoad, r.svgBitmaps, r.compiledLoad, r.compiledBitmaps);
+        }
+    }
+
+    const double svgLoad       = CalcStatsForVectorLong(svgLoadTimes).mdn;
+    const double svgTotal      = CalcStatsForVectorLong(svgTotalTimes).mdn;
+    const double compiledLoad  = CalcStatsForVectorLong(compiledLoadTimes).mdn;
+    const double compiledTotal = CalcStatsForVectorLong(compiledTotalTimes).mdn;
+
+    result.push_back(wxString::Format("<tr><td>FromSVGFile</td><td>%.2f</td><td>%.2f</td><td>%.2f</td><td></td><td></td></tr>\n",
+        svgLoad / 1000., CalcStatsForVectorLong(svgBitmapTimes).mdn / 1000., svgTotal / 1000.));
+    result.push_back(wxString::Format("<tr><td>Compiled</td><td>%.2f</td><td>%.2f</td><td>%.2f</td><td>%.2f</td><td>%.2f</td></tr>\n",
+        compiledLoad / 1000., CalcStatsForVectorLong(compiledBitmapTimes).mdn / 1000., compiledTotal / 1000.,
+        compiledLoad > 0 ? svgLoad / compiledLoad : 0., compiledTotal > 0 ? svgTotal / compiledTotal : 0.));
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
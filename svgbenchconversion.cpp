@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchconversion.cpp
+// Purpose:     Benchmark of converting NanoSVG pixels to wxBitmap
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg_nano.h"
+#include "bmpbndl_svg_pixels.h"
+#include "svgbench.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunConversion()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunConversion(size_t runCount, wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+
+    typedef wxSVGPixelConverter::InstructionSet InstructionSet;
+
+    std::vector<wxCharBuffer> fileData(m_fileNames.size());
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        if ( !ReadFile(GetFilePath(f), fileData[f]) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+    }
+
+    const InstructionSet previousInstructionSet = wxSVGPixelConverter::GetInstructionSet();
+
+    std::vector<ConversionResult>                    conversionResults;
+    std::vector<wxBitmapBundleImplSVGNanoMT::Buffer> buffers(m_fileNames.size());
+    wxBitmapBundleImplSVGNanoMT::Buffer              kernelBuffer, referenceBuffer;
+    wxSVGNanoRasterizer                              rasterizer;
+    wxStopWatch                                      stopWatch;
+    bool                                             ok = true;
+
+    for ( size_t run = 0; run < runCount && ok; ++run )
+    {
+        for ( size_t s = 0; s < m_sizes.size() && ok; ++s )
+        {
+            const wxSize size       = m_sizes[s];
+            const size_t pixelCount = static_cast<size_t>(size.x) * size.y;
+            const size_t stride     = wxBitmapBundleImplSVG::GetBitmapBytes(wxSize(size.x, 1));
+
+            ConversionResult result;
+
+            result.sizeIndex = s;
+            result.kernel.resize(wxSVGPixelConverter::InstructionSet_Max);
+            result.convert.resize(wxSVGPixelConverter::InstructionSet_Max);
+
+            for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+            {
+                stopWatch.Start();
+                ok = rasterizer.Rasterize(fileData[f].data(), fileData[f].length(), size);
+                result.rasterize += stopWatch.TimeInMicro().ToLong();
+
+                if ( ok )
+                    buffers[f].assign(rasterizer.GetBuffer(), rasterizer.GetBuffer() + pixelCount * 4);
+                else
+                    wxLogError("Couldn't rasterize file '%s' at size %dx%d.", m_fileNames[f], size.x, size.y);
+            }
+
+            // the conversion used before wxSVGPixelConverter
+            stopWatch.Start();
+            for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+                ok = wxBitmap(wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(buffers[f], size)).IsOk();
+            result.imageConvert = stopWatch.TimeInMicro().ToLong();
+
+            kernelBuffer.resize(pixelCount * 4);
+
+            for ( int i = 0; i < wxSVGPixelConverter::InstructionSet_Max && ok; ++i )
+            {
+                const InstructionSet instructionSet = static_cast<InstructionSet>(i);
+
+                if ( !wxSVGPixelConverter::SetInstructionSet(instructionSet) )
+                    continue;
+
+                stopWatch.Start();
+                for ( size_t f = 0; f < m_fileNames.size(); ++f )
+                    wxSVGPixelConverter::PremultiplySwapRedBlue(buffers[f].data(), kernelBuffer.data(), pixelCount);
+                result.kernel[i] = stopWatch.TimeInMicro().ToLong();
+
+                stopWatch.Start();
+                for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+                    ok = wxBitmapBundleImplSVG::CreateBitmapFromRGBA(buffers[f].data(), stride, size, false).IsOk();
+                result.convert[i] = stopWatch.TimeInMicro().ToLong();
+
+                if ( !ok )
+                {
+                    wxLogError("Couldn't create bitmap at size %dx%d with %s.", size.x, size.y,
+                               wxSVGPixelConverter::GetInstructionSetName(instructionSet));
+                }
+
+                // the SIMD kernels must give exactly the same results as the scalar ones
+                if ( run == 0 && ok )
+                {
+                    for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+                    {
+                        wxSVGPixelConverter::SetInstructionSet(wxSVGPixelConverter::InstructionSet_Scalar);
+                        referenceBuffer.resize(pixelCount * 4);
+                        wxSVGPixelConverter::PremultiplySwapRedBlue(buffers[f].data(), referenceBuffer.data(), pixelCount);
+
+                        wxSVGPixelConverter::SetInstructionSet(instructionSet);
+                        wxSVGPixelConverter::PremultiplySwapRedBlue(buffers[f].data(), kernelBuffer.data(), pixelCount);
+
+                        if ( kernelBuffer != referenceBuffer )
+                        {
+                            wxLogError("Pixels of file '%s' at size %dx%d converted with %s differ from the scalar ones.",
+                                       m_fileNames[f], size.x, size.y,
+                                       wxSVGPixelConverter::GetInstructionSetName(instructionSet));
+                            ok = false;
+                        }
+                    }
+                }
+            }
+
+            conversionResults.push_back(result);
+        }
+    }
+
+    wxSVGPixelConverter::SetInstructionSet(previousInstructionSet);
+
+    if ( !ok )
+        return false;
+
+    CreateConversionReport(conversionResults, runCount, report, results);
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateConversionReport(const std::vector<ConversionResult>& conversionResults,
+                                                             size_t runCount, wxString& reportText, wxString* resultsText)
+{
+    typedef wxSVGPixelConverter::InstructionSet InstructionSet;
+
+    std::vector<InstructionSet> instructionSets;
+
+    for ( int i = 0; i < wxSVGPixelConverter::InstructionSet_Max; ++i )
+    {
+        if ( wxSVGPixelConverter::IsInstructionSetSupported(static_cast<InstructionSet>(i)) )
+            instructionSets.push_back(static_cast<InstructionSet>(i));
+    }
+
+    const double fileCount = static_cast<double>(m_fileNames.size());
+    // conversion share of the total time, in percent
+    const auto share = [](double convert, double rasterize) -> double
+    {
+        return rasterize + convert > 0 ? 100. * convert / (rasterize + convert) : 0.;
+    };
+
+    std::vector<wxArrayString> columnLabels;
+    wxArrayString              labels;
+
+    labels.push_back("NanoSVG");
+    labels.push_back("Rasterize");
+    columnLabels.push_back(labels);
+
+    labels[0] = "wxImage";
+    labels[1] = "Convert";
+    columnLabels.push_back(labels);
+    labels[1] = "Share";
+    columnLabels.push_back(labels);
+
+    for ( const auto instructionSet : instructionSets )
+    {
+        labels[0] = wxSVGPixelConverter::GetInstructionSetName(instructionSet);
+        labels[1] = "Kernel";
+        columnLabels.push_back(labels);
+        labels[1] = "Convert";
+        columnLabels.push_back(labels);
+        labels[1] = "Share";
+        columnLabels.push_back(labels);
+        labels[1] = "Speedup";
+        columnLabels.push_back(labels);
+    }
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Conversion Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Converted %zu files from folder '%s' rasterized with NanoSVG to wxBitmap (%zu runs)</h3>",
+        m_fileNames.size(), m_dirName, runCount));
+    result.push_back(wxString::Format("<p>The times are in microseconds per icon (median of all runs). "
+                     "Rasterize includes parsing. wxImage is the conversion through wxImage used before, "
+                     "the others use wxSVGPixelConverter with the given instruction set (%s is used by default). "
+                     "Kernel is premultiplying and swapping red and blue only, as for wxMSW; "
+                     "Convert includes creating wxBitmap. "
+                     "Share is the conversion share of Rasterize + Convert, "
+                     "Speedup is relative to the conversion through wxImage.</p>",
+                     wxSVGPixelConverter::GetInstructionSetName(wxSVGPixelConverter::GetInstructionSet())));
+
+    result.push_back("<table><thead>\n");
+    AppendHeaderRows("Size", columnLabels, result);
+    result.push_back("</thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "Run\tSize\tMethod\tRasterize\tKernel\tConvert\n";
+
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        const wxString sizeStr = wxString::Format("%dx%d", m_sizes[s].x, m_sizes[s].y);
+
+        VectorLong rasterizeTimes, imageConvertTimes;
+        std::vector<VectorLong> kernelTimes(wxSVGPixelConverter::InstructionSet_Max);
+        std::vector<VectorLong> convertTimes(wxSVGPixelConverter::InstructionSet_Max);
+        size_t run = 0;
+
+        for ( const auto& r : conversionResults )
+        {
+            if ( r.sizeIndex != s )
+                continue;
+
+            ++run;
+            rasterizeTimes.push_back(r.rasterize);
+            imageConvertTimes.push_back(r.imageConvert);
+
+            if ( resultsText )
+            {
+                *resultsText += wxString::Format("%zu\t%s\twxImage\t%ld\t\t%ld\n",
+                    run, sizeStr, r.rasterize, r.imageConvert);
+            }
+
+            for ( const auto instructionSet : instructionSets )
+            {
+                kernelTimes[instructionSet].push_back(r.kernel[instructionSet]);
+                convertTimes[instructionSet].push_back(r.convert[instructionSet]);
+
+                if ( resultsText )
+                {
+                    *resultsText += wxString::Format("%zu\t%s\t%s\t%ld\t%ld\t%ld\n",
+                        run, sizeStr, wxSVGPixelConverter::GetInstructionSetName(instructionSet),
+                        r.rasterize, r.kernel[instructionSet], r.convert[instructionSet]);
+                }
+            }
+        }
+
+        const double rasterize    = CalcStatsForVectorLong(rasterizeTimes).mdn / fileCount;
+        const double imageConvert = CalcStatsForVectorLong(imageConvertTimes).mdn / fileCount;
+
+        rowStr = wxString::Format("<tr><td>%s</td><td>%.1f</td><td>%.1f</td><td>%.1f %%</td>",
+            sizeStr, rasterize, imageConvert, share(imageConvert, rasterize));
+
+        for ( const auto instructionSet : instructionSets )
+        {
+            const double kernel  = CalcStatsForVectorLong(kernelTimes[instructionSet]).mdn / fileCount;
+            const double convert = CalcStatsForVectorLong(convertTimes[instructionSet]).mdn / fileCount;
+
+            rowStr += wxString::Format("<td>%.2f</td><td>%.1f</td><td>%.1f %%</td><td>%.2f</td>",
+                kernel, convert, share(convert, rasterize), convert > 0 ? imageConvert / convert : 0.);
+        }
+
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchparse.cpp
+// Purpose:     Benchmark of parsing with NanoSVG and wxSVGFlatDocument
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg_flat.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgbench.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunParse()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunParse(size_t runCount, wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(runCount, false);
+
+    std::vector<wxCharBuffer> fileData(m_fileNames.size());
+    std::vector<ParseFolder>  folders;
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        if ( !ReadFile(GetFilePath(f), fileData[f]) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        // the files directly in m_dirName are in "."
+        const wxArrayString dirs       = wxFileName(m_fileNames[f]).GetDirs();
+        const wxString      folderName = dirs.empty() ? wxString(".") : dirs[0];
+
+        auto it = std::find_if(folders.begin(), folders.end(),
+                               [&folderName](const ParseFolder& pf) { return pf.name == folderName; });
+
+        if ( it == folders.end() )
+        {
+            folders.push_back(ParseFolder());
+            folders.back().name = folderName;
+            it = folders.end() - 1;
+        }
+
+        it->fileIndices.push_back(f);
+        it->bytes += fileData[f].length();
+    }
+
+    const bool                    hasAllocs = wxTestSVGAllocCounter::IsAvailable();
+    wxTestSVGAllocCounter::Values allocs;
+
+    // the first pass is not timed, it checks that both parsers can parse
+    // all the files and counts their shapes and allocations
+    for ( auto& folder : folders )
+    {
+        for ( const auto f : folder.fileIndices )
+        {
+            if ( hasAllocs )
+                wxTestSVGAllocCounter::Start();
+
+            // NanoSVG modifies the data while parsing it, so we need a copy
+            wxCharBuffer dataCopy(fileData[f].data());
+            NSVGimage*   image = nsvgParse(dataCopy.data(), "px", 96);
+
+            if ( hasAllocs )
+            {
+                wxTestSVGAllocCounter::Stop(allocs);
+                folder.nanoAllocs    += allocs.allocCount;
+                folder.nanoPeakBytes += allocs.peakBytes;
+            }
+
+            if ( !image )
+            {
+                wxLogError("Couldn't parse file '%s' with NanoSVG.", m_fileNames[f]);
+                return false;
+            }
+
+            for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+            {
+                if ( (shape->flags & NSVG_FLAGS_VISIBLE)
+                     && (shape->fill.type != NSVG_PAINT_NONE
+                         || (shape->stroke.type != NSVG_PAINT_NONE && shape->strokeWidth > 0)) )
+                {
+                    ++folder.nanoShapes;
+                }
+            }
+            nsvgDelete(image);
+
+            // a new document, so that all its allocations are counted
+            wxSVGFlatDocument document;
+
+            if ( hasAllocs )
+                wxTestSVGAllocCounter::Start();
+
+            const bool parsed = document.Parse(fileData[f].data(), fileData[f].length());
+
+            if ( hasAllocs )
+            {
+                wxTestSVGAllocCounter::Stop(allocs);
+                folder.flatAllocs    += allocs.allocCount;
+                folder.flatPeakBytes += allocs.peakBytes;
+            }
+
+            if ( !parsed )
+            {
+                wxLogError("Couldn't parse file '%s' with wxSVGFlatDocument.", m_fileNames[f]);
+                return false;
+            }
+
+            folder.flatShapes     += document.GetShapeCount();
+            folder.flatArenaBytes += document.GetUsedBytes();
+        }
+    }
+
+    std::vector<ParseResult> parseResults;
+    wxSVGFlatDocument        document;
+    wxStopWatch              stopWatch;
+
+    for ( size_t run = 0; run < runCount; ++run )
+    {
+        for ( size_t i = 0; i < folders.size(); ++i )
+        {
+            ParseResult result;
+
+            result.folderIndex = i;
+
+            stopWatch.Start();
+            for ( const auto f : folders[i].fileIndices )
+            {
+                wxCharBuffer dataCopy(fileData[f].data());
+
+                nsvgDelete(nsvgParse(dataCopy.data(), "px", 96));
+            }
+            result.nano = stopWatch.TimeInMicro().ToLong();
+
+            // the document arena keeps the memory of the largest document so far
+            stopWatch.Start();
+            for ( const auto f : folders[i].fileIndices )
+                document.Parse(fileData[f].data(), fileData[f].length());
+            result.flat = stopWatch.TimeInMicro().ToLong();
+
+            parseResults.push_back(result);
+        }
+    }
+
+    CreateParseReport(folders, parseResults, runCount, report, results);
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateParseReport(const std::vector<ParseFolder>& folders,
+                                                        const std::vector<ParseResult>& parseResults,
+                                                        size_t runCount, wxString& reportText, wxString* resultsText)
+{
+    const bool hasAllocs = wxTestSVGAllocCounter::IsAvailable();
+
+    std::vector<wxArrayString> columnLabels;
+    wxArrayString              labels;
+
+    labels.push_back("Corpus");
+    labels.push_back("Files");
+    columnLabels.push_back(labels);
+    labels[1] = "KB";
+    columnLabels.push_back(labels);
+
+    for ( const auto& parser : { "NanoSVG", "wxSVGFlatDocument" } )
+    {
+        labels[0] = parser;
+        labels[1] = "Time";
+        columnLabels.push_back(labels);
+        labels[1] = "MB/s";
+        columnLabels.push_back(labels);
+        labels[1] = "Docs/s";
+        columnLabels.push_back(labels);
+        labels[1] = "Shapes";
+        columnLabels.push_back(labels);
+        if ( hasAllocs )
+        {
+            labels[1] = "Allocs/Doc";
+            columnLabels.push_back(labels);
+            labels[1] = "Peak KB/Doc";
+            columnLabels.push_back(labels);
+        }
+    }
+
+    labels[1] = "Arena KB/Doc";
+    columnLabels.push_back(labels);
+    labels[1] = "Speedup";
+    columnLabels.push_back(labels);
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Parse Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Parsed %zu files from folder '%s' with NanoSVG and wxSVGFlatDocument (%zu runs)</h3>",
+        m_fileNames.size(), m_dirName, runCount));
+    result.push_back("<p>The rows are the top level subfolders. Time is in milliseconds for all the files "
+                     "of the row (median of all runs), MB/s and Docs/s are computed from it. "
+                     "NanoSVG includes copying the data, which it modifies, and deleting the parsed image, "
+                     "wxSVGFlatDocument is reused for all the files, its arena keeping the memory. "
+                     "Shapes are the visible ones which are filled or stroked. "
+                     "Speedup is the NanoSVG time divided by the wxSVGFlatDocument time.</p>");
+    if ( hasAllocs )
+    {
+        result.push_back("<p>Allocs/Doc is the number of heap allocations while parsing a document, "
+                         "Peak KB/Doc their peak size, for wxSVGFlatDocument a new one for each document. "
+                         "Arena KB/Doc is the memory used from its arena.</p>");
+    }
+    else
+    {
+        result.push_back("<p>The heap allocations are not shown, they cannot be counted in this build. "
+                         "Arena KB/Doc is the memory wxSVGFlatDocument used from its arena.</p>");
+    }
+
+    result.push_back("<table><thead>\n");
+    AppendHeaderRows("Folder", columnLabels, result);
+    result.push_back("</thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "Run\tFolder\tFiles\tBytes\tNanoSVG\tFlat\n";
+
+    const auto appendRow = [&](const ParseFolder& folder, size_t fileCount,
+                               const VectorLong& nanoTimes, const VectorLong& flatTimes)
+    {
+        const double docs = static_cast<double>(fileCount);
+        const double nano = CalcStatsForVectorLong(nanoTimes).mdn;
+        const double flat = CalcStatsForVectorLong(flatTimes).mdn;
+        // bytes per microsecond are MB/s
+        const auto mbPerSecond   = [&folder](double time) { return time > 0 ? folder.bytes / time : 0.; };
+        const auto docsPerSecond = [docs](double time) { return time > 0 ? docs * 1000000. / time : 0.; };
+        const auto kbPerDoc      = [docs](size_t bytes) { return bytes / 1024. / docs; };
+
+        rowStr = wxString::Format("<tr><td>%s</td><td>%zu</td><td>%.1f</td>",
+            folder.name, fileCount, folder.bytes / 1024.);
+
+        rowStr += wxString::Format("<td>%.2f</td><td>%.1f</td><td>%.0f</td><td>%zu</td>",
+            nano / 1000., mbPerSecond(nano), docsPerSecond(nano), folder.nanoShapes);
+        if ( hasAllocs )
+        {
+            rowStr += wxString::Format("<td>%.1f</td><td>%.1f</td>",
+                folder.nanoAllocs / docs, kbPerDoc(folder.nanoPeakBytes));
+        }
+
+        rowStr += wxString::Format("<td>%.2f</td><td>%.1f</td><td>%.0f</td><td>%zu</td>",
+            flat / 1000., mbPerSecond(flat), docsPerSecond(flat), folder.flatShapes);
+        if ( hasAllocs )
+        {
+            rowStr += wxString::Format("<td>%.1f</td><td>%.1f</td>",
+                folder.flatAllocs / docs, kbPerDoc(folder.flatPeakBytes));
+        }
+
+        rowStr += wxString::Format("<td>%.1f</td><td>%.2f</td></tr>\n",
+            kbPerDoc(folder.flatArenaBytes), flat > 0 ? nano / flat : 0.);
+        result.push_back(rowStr);
+    };
+
+    ParseFolder total;
+    size_t      totalFileCount = 0;
+    VectorLong  totalNanoTimes(runCount, 0), totalFlatTimes(runCount, 0);
+
+    total.name = "Total";
+
+    for ( size_t i = 0; i < folders.size(); ++i )
+    {
+        const ParseFolder& folder = folders[i];
+        VectorLong         nanoTimes, flatTimes;
+        size_t             run = 0;
+
+        for ( const auto& r : parseResults )
+        {
+            if ( r.folderIndex != i )
+                continue;
+
+            nanoTimes.push_back(r.nano);
+            flatTimes.push_back(r.flat);
+            totalNanoTimes[run] += r.nano;
+            totalFlatTimes[run] += r.flat;
+
+            if ( resultsText )
+            {
+                *resultsText += wxString::Format("%zu\t%s\t%zu\t%zu\t%ld\t%ld\n",
+                    run + 1, folder.name, folder.fileIndices.size(), folder.bytes, r.nano, r.flat);
+            }
+            ++run;
+        }
+
+        appendRow(folder, folder.fileIndices.size(), nanoTimes, flatTimes);
+
+        totalFileCount       += folder.fileIndices.size();
+        total.bytes          += folder.bytes;
+        total.nanoShapes     += folder.nanoShapes;
+        total.flatShapes     += folder.flatShapes;
+        total.nanoAllocs     += folder.nanoAllocs;
+        total.flatAllocs     += folder.flatAllocs;
+        total.nanoPeakBytes  += folder.nanoPeakBytes;
+        total.flatPeakBytes  += folder.flatPeakBytes;
+        total.flatArenaBytes += folder.flatArenaBytes;
+    }
+
+    if ( folders.size() > 1 )
+        appendRow(total, totalFileCount, totalNanoTimes, totalFlatTimes);
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
@@ -0,0 +1,705 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchresults.cpp
+// Purpose:     Saving, loading, and comparing SVG benchmark results
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/platinfo.h>
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#ifdef __WINDOWS__
+    #include <wx/msw/registry.h>
+#endif // #ifdef __WINDOWS__
+
+#ifdef __APPLE__
+    #include <sys/sysctl.h>
+#endif // #ifdef __APPLE__
+
+#include "bmpbndl_svg_nano.h"
+#include "bmpbndl_svg_pixels.h"
+
+#include "svgbenchresults.h"
+#include "svgreportwriter.h"
+
+namespace
+{
+
+const char ResultsFileFormatName[] = "wxTestSVGBenchmarkResults";
+
+// the phases compared, see GetPhaseName() in svgbench.cpp
+const char ComparedPhaseParse[] = "Parse";
+const char ComparedPhaseTotal[] = "Total";
+
+// escapes the characters which would break the tab separated lines
+wxString EscapeField(const wxString& text)
+{
+    wxString result;
+
+    result.reserve(text.length());
+    for ( wxUniChar ch : text )
+    {
+        if ( ch == '\\' )
+            result += "\\\\";
+        else if ( ch == '\t' )
+            result += "\\t";
+        else if ( ch == '\n' )
+            result += "\\n";
+        else if ( ch == '\r' )
+            result += "\\r";
+        else
+            result += ch;
+    }
+
+    return result;
+}
+
+// the inverse of EscapeField(), the unknown escapes are kept as they are
+wxString UnescapeField(const wxString& text)
+{
+    wxString result;
+
+    result.reserve(text.length());
+    for ( wxString::const_iterator it = text.begin(); it != text.end(); ++it )
+    {
+        wxString::const_iterator next = it + 1;
+
+        if ( *it != '\\' || next == text.end() )
+        {
+            result += *it;
+            continue;
+        }
+
+        if ( *next == '\\' )
+            result += '\\';
+        else if ( *next == 't' )
+            result += '\t';
+        else if ( *next == 'n' )
+            result += '\n';
+        else if ( *next == 'r' )
+            result += '\r';
+        else
+        {
+            result += *it;
+            continue;
+        }
+
+        it = next;
+    }
+
+    return result;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGBenchmarkResults
+// ============================================================================
+
+bool wxTestSVGBenchmarkResults::Key::operator<(const Key& other) const
+{
+    return std::make_tuple(fileName, size.x, size.y, backend, phase)
+           < std::make_tuple(other.fileName, other.size.x, other.size.y, other.backend, other.phase);
+}
+
+void wxTestSVGBenchmarkResults::Clear()
+{
+    m_metadata.clear();
+    m_samples.clear();
+}
+
+void wxTestSVGBenchmarkResults::SetMetadata(const wxString& name, const wxString& value)
+{
+    for ( auto& m : m_metadata )
+    {
+        if ( m.first == name )
+        {
+            m.second = value;
+            return;
+        }
+    }
+
+    m_metadata.push_back(std::make_pair(name, value));
+}
+
+wxString wxTestSVGBenchmarkResults::GetMetadata(const wxString& name) const
+{
+    for ( const auto& m : m_metadata )
+    {
+        if ( m.first == name )
+            return m.second;
+    }
+
+    return wxString();
+}
+
+void wxTestSVGBenchmarkResults::SetSystemMetadata()
+{
+    SetMetadata("wxVersion", wxGetLibraryVersionInfo().GetVersionString());
+    SetMetadata("Compiler", GetCompilerName());
+    SetMetadata("CPU", GetCPUModel());
+    SetMetadata("Architecture", wxGetCpuArchitectureName());
+    SetMetadata("CPUCount", wxString::Format("%d", wxThread::GetCPUCount()));
+    SetMetadata("OS", wxGetOsDescription());
+#ifdef NDEBUG
+    SetMetadata("BuildType", "Release");
+#else
+    SetMetadata("BuildType", "Debug");
+#endif // #ifdef NDEBUG
+#ifdef wxTESTSVG_CXX_FLAGS
+    // CMAKE_CXX_FLAGS or the build type flags may be empty
+    SetMetadata("CompilerFlags", wxString(wxTESTSVG_CXX_FLAGS).Trim(false).Trim());
+#else
+    SetMetadata("CompilerFlags", "Unknown");
+#endif // #ifdef wxTESTSVG_CXX_FLAGS
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    SetMetadata("NanoSVG", "Yes");
+#else
+    SetMetadata("NanoSVG", "No (wxBitmapBundle::FromSVG())");
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    SetMetadata("PixelConverter",
+                wxSVGPixelConverter::GetInstructionSetName(wxSVGPixelConverter::GetInstructionSet()));
+    SetMetadata("Date", wxDateTime::Now().FormatISOCombined(' '));
+}
+
+void wxTestSVGBenchmarkResults::AddSamples(const wxString& fileName, const wxSize& size, const wxString& backend,
+                                           const wxString& phase, const VectorLong& times)
+{
+    Key key;
+
+    key.fileName = fileName;
+    key.size     = size;
+    key.backend  = backend;
+    key.phase    = phase;
+
+    VectorLong& samples = m_samples[key];
+
+    samples.insert(samples.end(), times.begin(), times.end());
+}
+
+bool wxTestSVGBenchmarkResults::Save(const wxString& fileName) const
+{
+    wxString text;
+
+    text.Printf("%s\t%ld\n", ResultsFileFormatName, FormatVersion);
+    for ( const auto& m : m_metadata )
+        text += wxString::Format("%s\t%s\n", EscapeField(m.first), EscapeField(m.second));
+
+    text += "\nFile\tWidth\tHeight\tBackend\tPhase\tTimes\n";
+
+    for ( const auto& s : m_samples )
+    {
+        text += wxString::Format("%s\t%d\t%d\t%s\t%s",
+                                 EscapeField(s.first.fileName), s.first.size.x, s.first.size.y,
+                                 EscapeField(s.first.backend), EscapeField(s.first.phase));
+        for ( const auto& t : s.second )
+            text += wxString::Format("\t%ld", t);
+        text += "\n";
+    }
+
+    wxFFile file(fileName, "wb");
+
+    if ( !file.IsOpened() || !file.Write(text, wxConvUTF8) || !file.Close() )
+    {
+        wxLogError("Couldn't write benchmark results to '%s'.", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+bool wxTestSVGBenchmarkResults::Load(const wxString& fileName)
+{
+    Clear();
+
+    wxFFile  file(fileName, "rb");
+    wxString text;
+
+    if ( !file.IsOpened() || !file.ReadAll(&text, wxConvUTF8) )
+    {
+        wxLogError("Couldn't read benchmark results from '%s'.", fileName);
+        return false;
+    }
+
+    text.Replace("\r", "");
+
+    const wxArrayString lines = wxSplit(text, '\n', '\0');
+    size_t              l     = 0;
+    long                formatVersion = 0;
+
+    if ( lines.empty()
+         || lines[0].BeforeFirst('\t') != ResultsFileFormatName
+         || !lines[0].AfterFirst('\t').ToLong(&formatVersion) )
+    {
+        wxLogError("'%s' is not a benchmark results file.", fileName);
+        return false;
+    }
+
+    if ( formatVersion < 1 || formatVersion > FormatVersion )
+    {
+        wxLogError("Benchmark results file '%s' has unsupported format version %ld (supported: 1 to %ld).",
+                   fileName, formatVersion, FormatVersion);
+        return false;
+    }
+
+    // version 1 did not escape anything
+    const auto unescape = [formatVersion](const wxString& field)
+    {
+        return formatVersion >= 2 ? UnescapeField(field) : field;
+    };
+
+    for ( l = 1; l < lines.size() && !lines[l].empty(); ++l )
+        SetMetadata(unescape(lines[l].BeforeFirst('\t')), unescape(lines[l].AfterFirst('\t')));
+
+    // skip the empty line and the header
+    for ( l += 2; l < lines.size(); ++l )
+    {
+        if ( lines[l].empty() )
+            continue;
+
+        const wxArrayString fields = wxSplit(lines[l], '\t', '\0');
+        long                width = 0, height = 0;
+        VectorLong          times;
+
+        if ( fields.size() < 6 || !fields[1].ToLong(&width) || !fields[2].ToLong(&height) )
+        {
+            wxLogError("Invalid line %zu in benchmark results file '%s'.", l + 1, fileName);
+            return false;
+        }
+
+        for ( size_t f = 5; f < fields.size(); ++f )
+        {
+            long time = 0;
+
+            if ( !fields[f].ToLong(&time) )
+            {
+                wxLogError("Invalid time '%s' on line %zu in benchmark results file '%s'.",
+                           fields[f], l + 1, fileName);
+                return false;
+            }
+            times.push_back(time);
+        }
+
+        AddSamples(unescape(fields[0]), wxSize(width, height), unescape(fields[3]), unescape(fields[4]), times);
+    }
+
+    return true;
+}
+
+bool wxTestSVGBenchmarkResults::Merge(const wxTestSVGBenchmarkResults& other)
+{
+    if ( m_metadata.empty() && m_samples.empty() )
+    {
+        *this = other;
+        return true;
+    }
+
+    static const char* const requiredSameNames[] =
+    {
+        "wxVersion", "Compiler", "CPU", "Architecture", "BuildType", "NanoSVG", "PixelConverter", "Sizes"
+    };
+
+    for ( const auto& name : requiredSameNames )
+    {
+        if ( GetMetadata(name) != other.GetMetadata(name) )
+        {
+            wxLogError("Benchmark results with different %s ('%s' and '%s') cannot be merged.",
+                       name, GetMetadata(name), other.GetMetadata(name));
+            return false;
+        }
+    }
+
+    for ( const auto& m : other.GetAllMetadata() )
+    {
+        const wxString value = GetMetadata(m.first);
+        long           fileCount = 0, otherFileCount = 0;
+
+        if ( m.first == "Files" && value.ToLong(&fileCount) && m.second.ToLong(&otherFileCount) )
+            SetMetadata(m.first, wxString::Format("%ld", fileCount + otherFileCount));
+        else if ( value.empty() )
+            SetMetadata(m.first, m.second);
+        else if ( value != m.second )
+            SetMetadata(m.first, value + "; " + m.second);
+    }
+
+    size_t commonCellCount = 0;
+
+    for ( const auto& s : other.GetSamples() )
+    {
+        if ( m_samples.find(s.first) != m_samples.end() )
+            ++commonCellCount;
+
+        AddSamples(s.first.fileName, s.first.size, s.first.backend, s.first.phase, s.second);
+    }
+
+    if ( commonCellCount > 0 )
+        wxLogWarning("%zu cells were in both merged results, their times were combined.", commonCellCount);
+
+    return true;
+}
+
+// static
+wxString wxTestSVGBenchmarkResults::GetCPUModel()
+{
+    wxString model;
+
+#if defined(__WINDOWS__)
+    wxRegKey key(wxRegKey::HKLM, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0");
+
+    if ( key.Exists() )
+        key.QueryValue("ProcessorNameString", model);
+#elif defined(__APPLE__)
+    char   brand[256];
+    size_t brandLength = sizeof(brand);
+
+    if ( sysctlbyname("machdep.cpu.brand_string", brand, &brandLength, nullptr, 0) == 0 )
+        model = wxString::FromUTF8(brand);
+#elif defined(__LINUX__)
+    wxFFile  file("/proc/cpuinfo", "r");
+    wxString text;
+
+    // /proc files have zero length, so wxFFile::ReadAll() cannot be used
+    if ( file.IsOpened() )
+    {
+        char   buffer[4096];
+        size_t count = 0;
+
+        while ( (count = file.Read(buffer, sizeof(buffer))) > 0 )
+            text += wxString::FromUTF8(buffer, count);
+    }
+
+    for ( const auto& line : wxSplit(text, '\n', '\0') )
+    {
+        if ( line.StartsWith("model name") )
+        {
+            model = line.AfterFirst(':');
+            break;
+        }
+    }
+#endif
+
+    model.Trim().Trim(false);
+    return model.empty() ? wxString("Unknown") : model;
+}
+
+// static
+wxString wxTestSVGBenchmarkResults::GetCompilerName()
+{
+#if defined(__clang__)
+    return wxString::Format("Clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+    return wxString::Format("GCC %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_FULL_VER)
+    return wxString::Format("MSVC %d", _MSC_FULL_VER);
+#else
+    return "Unknown";
+#endif
+}
+
+// ============================================================================
+// wxTestSVGBenchmarkComparison
+// ============================================================================
+
+bool wxTestSVGBenchmarkComparison::Compare(const wxTestSVGBenchmarkResults& baseline,
+                                           const wxTestSVGBenchmarkResults& current,
+                                           const Options& options)
+{
+    m_options = options;
+    m_cellResults.clear();
+    m_sizeResults.clear();
+
+    const double slowerLimit = 1 / (1 + options.tolerance);
+    const double fasterLimit = 1 + options.tolerance;
+
+    // sums of logarithms of the speedups for the geometric means, by size and backend
+    std::map<std::tuple<int, int, wxString>, std::pair<double, size_t>> logSpeedupSums;
+
+    for ( const auto& s : current.GetSamples() )
+    {
+        const wxTestSVGBenchmarkResults::Key& key = s.first;
+
+        if ( key.phase != ComparedPhaseParse && key.phase != ComparedPhaseTotal )
+            continue;
+
+        const auto baselineIt = baseline.GetSamples().find(key);
+
+        if ( baselineIt == baseline.GetSamples().end()
+             || baselineIt->second.empty() || s.second.empty() )
+            continue;
+
+        CellResult cell;
+
+        cell.key            = key;
+        cell.baselineCount  = baselineIt->second.size();
+        cell.currentCount   = s.second.size();
+        cell.baselineMedian = GetMedian(baselineIt->second);
+        cell.currentMedian  = GetMedian(s.second);
+        // the times are in whole microseconds, so shorter ones are counted as 1
+        cell.speedup        = wxMax(cell.baselineMedian, 1.) / wxMax(cell.currentMedian, 1.);
+        cell.pValue         = MannWhitneyUTest(baselineIt->second, s.second);
+
+        if ( cell.pValue < options.alpha )
+        {
+            if ( cell.speedup < slowerLimit )
+                cell.verdict = Verdict_Regression;
+            else if ( cell.speedup > fasterLimit )
+                cell.verdict = Verdict_Improvement;
+        }
+
+        m_cellResults.push_back(cell);
+
+        if ( key.phase == ComparedPhaseTotal )
+        {
+            auto& sum = logSpeedupSums[std::make_tuple(key.size.x, key.size.y, key.backend)];
+
+            sum.first  += log(cell.speedup);
+            sum.second += 1;
+        }
+    }
+
+    for ( const auto& sum : logSpeedupSums )
+    {
+        SizeResult sizeResult;
+
+        sizeResult.size                = wxSize(std::get<0>(sum.first), std::get<1>(sum.first));
+        sizeResult.backend             = std::get<2>(sum.first);
+        sizeResult.fileCount           = sum.second.second;
+        sizeResult.geoMeanSpeedup      = exp(sum.second.first / sum.second.second);
+        sizeResult.isToleranceExceeded = sizeResult.geoMeanSpeedup < slowerLimit;
+        m_sizeResults.push_back(sizeResult);
+    }
+
+    return !m_cellResults.empty();
+}
+
+size_t wxTestSVGBenchmarkComparison::GetRegressionCount() const
+{
+    return std::count_if(m_cellResults.begin(), m_cellResults.end(),
+                         [](const CellResult& c) { return c.verdict == Verdict_Regression; });
+}
+
+size_t wxTestSVGBenchmarkComparison::GetImprovementCount() const
+{
+    return std::count_if(m_cellResults.begin(), m_cellResults.end(),
+                         [](const CellResult& c) { return c.verdict == Verdict_Improvement; });
+}
+
+bool wxTestSVGBenchmarkComparison::IsToleranceExceeded() const
+{
+    if ( GetRegressionCount() > 0 )
+        return true;
+
+    for ( const auto& s : m_sizeResults )
+    {
+        if ( s.isToleranceExceeded )
+            return true;
+    }
+
+    return false;
+}
+
+void wxTestSVGBenchmarkComparison::CreateReport(const wxTestSVGBenchmarkResults& baseline,
+                                                const wxTestSVGBenchmarkResults& current,
+                                                wxString& reportText, wxString* resultsText) const
+{
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Comparison Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += ".regression {color: red;} .improvement {color: green;} .differs {font-weight: bold;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Compared %zu cells: %zu regressions, %zu improvements, tolerance %s</h3>",
+        m_cellResults.size(), GetRegressionCount(), GetImprovementCount(),
+        IsToleranceExceeded() ? "exceeded" : "not exceeded"));
+    result.push_back(wxString::Format("<p>The times are in microseconds (median of all runs). "
+        "Speedup is the baseline median divided by the current one. A cell is a regression (improvement) "
+        "when the two-sided Mann-Whitney U test p-value is below %g and it is more than %.1f %% slower (faster). "
+        "The tolerance is exceeded when any cell is a regression or the geometric mean speedup "
+        "of a size is below %.3f.</p>",
+        m_options.alpha, m_options.tolerance * 100, 1 / (1 + m_options.tolerance)));
+
+    // the metadata of both, the values differing are in bold
+    result.push_back("<h4>Metadata</h4>");
+    result.push_back("<table><thead><tr><th>Name</th><th>Baseline</th><th>Current</th></tr></thead><tbody>\n");
+
+    wxArrayString metadataNames;
+
+    for ( const auto& m : baseline.GetAllMetadata() )
+        metadataNames.push_back(m.first);
+    for ( const auto& m : current.GetAllMetadata() )
+    {
+        if ( metadataNames.Index(m.first) == wxNOT_FOUND )
+            metadataNames.push_back(m.first);
+    }
+
+    for ( const auto& name : metadataNames )
+    {
+        const wxString baselineValue = baseline.GetMetadata(name);
+        const wxString currentValue  = current.GetMetadata(name);
+
+        result.push_back(wxString::Format(R"(<tr%s><td>%s</td><td>%s</td><td>%s</td></tr>)",
+            baselineValue != currentValue ? R"( class="differs")" : "",
+            wxTestSVGReportWriter::EscapeHTML(name), wxTestSVGReportWriter::EscapeHTML(baselineValue),
+            wxTestSVGReportWriter::EscapeHTML(currentValue)));
+    }
+    result.push_back("</tbody></table>\n");
+
+    result.push_back("<h4>Geometric Mean Speedup of Total by Size</h4>");
+    result.push_back("<table><thead><tr><th>Size</th><th>Backend</th><th>Files</th><th>Speedup</th></tr></thead><tbody>\n");
+    for ( const auto& s : m_sizeResults )
+    {
+        result.push_back(wxString::Format(R"(<tr%s><td>%dx%d</td><td>%s</td><td>%zu</td><td>%.3f</td></tr>)",
+            s.isToleranceExceeded ? R"( class="regression")" : "",
+            s.size.x, s.size.y, wxTestSVGReportWriter::EscapeHTML(s.backend), s.fileCount, s.geoMeanSpeedup));
+    }
+    result.push_back("</tbody></table>\n");
+
+    result.push_back("<h4>Cells</h4>");
+    result.push_back("<table><thead><tr><th>File</th><th>Size</th><th>Backend</th><th>Phase</th>"
+                     "<th>Baseline Runs</th><th>Current Runs</th><th>Baseline</th><th>Current</th>"
+                     "<th>Speedup</th><th>p-value</th><th>Verdict</th></tr></thead><tbody>\n");
+
+    if ( resultsText )
+    {
+        *resultsText = "File\tWidth\tHeight\tBackend\tPhase\tBaselineRuns\tCurrentRuns"
+                       "\tBaselineMedian\tCurrentMedian\tSpeedup\tPValue\tVerdict\n";
+    }
+
+    for ( const auto& c : m_cellResults )
+    {
+        const wxString sizeStr = c.key.size.x > 0 ? wxString::Format("%dx%d", c.key.size.x, c.key.size.y)
+                                                  : wxString("-");
+        const char*    rowClass = "";
+
+        if ( c.verdict == Verdict_Regression )
+            rowClass = R"( class="regression")";
+        else if ( c.verdict == Verdict_Improvement )
+            rowClass = R"( class="improvement")";
+
+        result.push_back(wxString::Format(R"(<tr%s><td>%s</td><td>%s</td><td>%s</td><td>%s</td>)"
+            R"(<td>%zu</td><td>%zu</td><td>%.1f</td><td>%.1f</td><td>%.3f</td><td>%.4f</td><td>%s</td></tr>)",
+            rowClass, wxTestSVGReportWriter::EscapeHTML(c.key.fileName), sizeStr,
+            wxTestSVGReportWriter::EscapeHTML(c.key.backend), wxTestSVGReportWriter::EscapeHTML(c.key.phase),
+            c.baselineCount, c.currentCount, c.baselineMedian, c.currentMedian,
+            c.speedup, c.pValue, GetVerdictName(c.verdict)));
+
+        if ( resultsText )
+        {
+            *resultsText += wxString::Format("%s\t%d\t%d\t%s\t%s\t%zu\t%zu\t%.1f\t%.1f\t%.4f\t%.6f\t%s\n",
+                EscapeField(c.key.fileName), c.key.size.x, c.key.size.y,
+                EscapeField(c.key.backend), EscapeField(c.key.phase), c.baselineCount, c.currentCount, c.baselineMedian, c.currentMedian,
+                c.speedup, c.pValue, GetVerdictName(c.verdict));
+        }
+    }
+    result.push_back("</tbody></table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+// static
+double wxTestSVGBenchmarkComparison::MannWhitneyUTest(const wxTestSVGBenchmarkResults::VectorLong& a,
+                                                      const wxTestSVGBenchmarkResults::VectorLong& b)
+{
+    const size_t n1 = a.size();
+    const size_t n2 = b.size();
+    const size_t n  = n1 + n2;
+
+    if ( n1 == 0 || n2 == 0 )
+        return 1;
+
+    // the values of both samples, true for the values from a
+    std::vector<std::pair<long, bool>> values;
+
+    values.reserve(n);
+    for ( const auto& v : a )
+        values.push_back(std::make_pair(v, true));
+    for ( const auto& v : b )
+        values.push_back(std::make_pair(v, false));
+
+    std::sort(values.begin(), values.end());
+
+    // the tied values get the average of their ranks
+    double rankSumA = 0;
+    double tieSum   = 0; // sum of t^3 - t over the groups of t tied values
+
+    for ( size_t i = 0; i < n; )
+    {
+        size_t j = i + 1;
+
+        while ( j < n && values[j].first == values[i].first )
+            ++j;
+
+        const double t    = static_cast<double>(j - i);
+        const double rank = (i + 1 + j) / 2.0;
+
+        for ( size_t k = i; k < j; ++k )
+        {
+            if ( values[k].second )
+                rankSumA += rank;
+        }
+
+        tieSum += t * t * t - t;
+        i = j;
+    }
+
+    const double u     = rankSumA - n1 * (n1 + 1) / 2.0;
+    const double mean  = n1 * n2 / 2.0;
+    const double var   = n1 * n2 / 12.0 * ((n + 1) - tieSum / (static_cast<double>(n) * (n - 1)));
+
+    if ( var <= 0 )
+        return 1; // all the values are the same
+
+    const double z = (fabs(u - mean) - 0.5) / sqrt(var);
+
+    if ( z <= 0 )
+        return 1;
+
+    return erfc(z / sqrt(2.0));
+}
+
+// static
+double wxTestSVGBenchmarkComparison::GetMedian(const wxTestSVGBenchmarkResults::VectorLong& data)
+{
+    wxCHECK(!data.empty(), 0);
+
+    wxTestSVGBenchmarkResults::VectorLong dataSorted(data);
+
+    std::sort(dataSorted.begin(), dataSorted.end());
+
+    const size_t middle = dataSorted.size() / 2;
+
+    if ( dataSorted.size() % 2 )
+        return dataSorted[middle];
+
+    return (dataSorted[middle - 1] + dataSorted[middle]) / 2.0;
+}
+
+// static
+const char* wxTestSVGBenchmarkComparison::GetVerdictName(Verdict verdict)
+{
+    switch ( verdict )
+    {
+        case Verdict_Same:        return "Same";
+        case Verdict_Regression:  return "Regression";
+        case Verdict_Improvement: return "Improvement";
+    }
+
+    wxFAIL_MSG("invalid verdict");
+    return "";
+}
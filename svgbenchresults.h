@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchresults.h
+// Purpose:     Saving, loading, and comparing SVG benchmark results
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_BENCH_RESULTS_H_DEFINED
+#define TEST_SVG_BENCH_RESULTS_H_DEFINED
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGBenchmarkResults
+// ============================================================================
+
+/*
+    Raw times of all the runs of wxTestSVGRasterizationBenchmark::Run(),
+    for each file, bitmap size, backend, and phase, together with metadata
+    describing where they were measured (wxWidgets version, compiler, CPU,
+    build flags...), so that they can be saved, e.g., as a baseline, and
+    compared later with wxTestSVGBenchmarkComparison.
+
+    The file is tab separated text: the first line is the format name and
+    version, followed by "name, value" metadata lines, an empty line,
+    the header line, and one line per cell: file, width, height, backend,
+    phase, and the times in microseconds of all its runs. The phases loaded
+    once per file (I/O and Parse) have zero width and height. Backslashes,
+    tabs, and line breaks in the metadata, file names, backends, and phases
+    are saved as \\, \t, \n, and \r, so that they cannot break the lines.
+ */
+
+class wxTestSVGBenchmarkResults
+{
+public:
+    typedef std::vector<long> VectorLong;
+
+    struct Key
+    {
+        wxString fileName;
+        wxSize   size;
+        wxString backend;
+        wxString phase;
+
+        bool operator<(const Key& other) const;
+    };
+
+    typedef std::map<Key, VectorLong>                 Samples;
+    typedef std::vector<std::pair<wxString, wxString>> Metadata;
+
+    // increase when the format of the file changes
+    // (2: the text fields are escaped)
+    static const long FormatVersion = 2;
+
+    void Clear();
+
+    // replaces the value if there already is metadata with this name
+    void SetMetadata(const wxString& name, const wxString& value);
+    // returns an empty string if there is no such metadata
+    wxString GetMetadata(const wxString& name) const;
+    const Metadata& GetAllMetadata() const { return m_metadata; }
+
+    // sets the metadata describing this build and machine:
+    // wxWidgets version, compiler, CPU model, OS, build flags, and date
+    void SetSystemMetadata();
+
+    void AddSamples(const wxString& fileName, const wxSize& size, const wxString& backend,
+                    const wxString& phase, const VectorLong& times);
+    const Samples& GetSamples() const { return m_samples; }
+
+    // both log the error on failure
+    bool Save(const wxString& fileName) const;
+    bool Load(const wxString& fileName);
+
+    // Adds the samples of other, e.g., of another shard of the same corpus
+    // benchmarked by another process, see wxTestSVGCorpus. The times of
+    // the cells present in both are combined. The metadata describing
+    // the build, machine, and bitmap sizes must be the same, otherwise
+    // the times would not be comparable and the error is logged and false
+    // returned. The numbers of files are added, the other metadata with
+    // different values are joined.
+    bool Merge(const wxTestSVGBenchmarkResults& other);
+
+private:
+    Metadata m_metadata;
+    Samples  m_samples;
+
+    static wxString GetCPUModel();
+    static wxString GetCompilerName();
+};
+
+// ============================================================================
+// wxTestSVGBenchmarkComparison
+// ============================================================================
+
+/*
+    Compares the current results with the baseline ones. The cells present
+    in both are aligned by file, bitmap size, backend, and phase. Only
+    the phases the user waits for are compared: Parse and Total (i.e.,
+    wxBitmapBundle::GetBitmap()).
+
+    The times of each cell are compared with the two-sided Mann-Whitney U
+    test, which does not assume that they are normally distributed. A cell is
+    a regression (improvement) when its difference is significant and its
+    median is slower (faster) by more than the tolerance. For each bitmap
+    size and backend, the geometric mean of the speedups of all the files
+    (baseline median / current median) of the Total phase is reported too.
+
+    The tolerance is exceeded when any cell is a regression or when
+    a geometric mean speedup is below 1 / (1 + tolerance).
+ */
+
+class wxTestSVGBenchmarkComparison
+{
+public:
+    struct Options
+    {
+        double tolerance{0.05}; // relative slowdown allowed
+        double alpha{0.01};     // significance level of the test
+    };
+
+    enum Verdict
+    {
+        Verdict_Same = 0,
+        Verdict_Regression,
+        Verdict_Improvement
+    };
+
+    struct CellResult
+    {
+        wxTestSVGBenchmarkResults::Key key;
+
+        size_t  baselineCount{0};
+        size_t  currentCount{0};
+        double  baselineMedian{0};
+        double  currentMedian{0};
+        double  speedup{1};   // baselineMedian / currentMedian
+        double  pValue{1};
+        Verdict verdict{Verdict_Same};
+    };
+
+    struct SizeResult
+    {
+        wxSize   size;
+        wxString backend;
+        size_t   fileCount{0};
+        double   geoMeanSpeedup{1};
+        bool     isToleranceExceeded{false};
+    };
+
+    // returns false if the results have no cells in common
+    bool Compare(const wxTestSVGBenchmarkResults& baseline,
+                 const wxTestSVGBenchmarkResults& current,
+                 const Options& options);
+
+    const std::vector<CellResult>& GetCellResults() const { return m_cellResults; }
+    const std::vector<SizeResult>& GetSizeResults() const { return m_sizeResults; }
+
+    size_t GetRegressionCount() const;
+    size_t GetImprovementCount() const;
+    bool   IsToleranceExceeded() const;
+
+    // resultsText receives a tab separated row for each cell
+    void CreateReport(const wxTestSVGBenchmarkResults& baseline,
+                      const wxTestSVGBenchmarkResults& current,
+                      wxString& reportText, wxString* resultsText = nullptr) const;
+
+    // returns the two-sided p-value of the Mann-Whitney U test, using
+    // the normal approximation with tie and continuity corrections
+    static double MannWhitneyUTest(const wxTestSVGBenchmarkResults::VectorLong& a,
+                                   const wxTestSVGBenchmarkResults::VectorLong& b);
+
+private:
+    Options                 m_options;
+    std::vector<CellResult> m_cellResults;
+    std::vector<SizeResult> m_sizeResults;
+
+    static double GetMedian(const wxTestSVGBenchmarkResults::VectorLong& data);
+    static const char* GetVerdictName(Verdict verdict);
+};
+
+#endif // #ifndef TEST_SVG_BENCH_RESULTS_H_DEFINED
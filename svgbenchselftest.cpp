@@ -0,0 +1,608 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchselftest.cpp
+// Purpose:     Self-test of the code paths replacing or caching NanoSVG
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include "bmpbndl_svg_cache.h"
+#include "bmpbndl_svg_compiled.h"
+#include "bmpbndl_svg_diskcache.h"
+#include "bmpbndl_svg_flat.h"
+#include "bmpbndl_svg_nano.h"
+#include "bmpbndl_svg_tile.h"
+#include "svgbench.h"
+#include "svgthreadpool.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+namespace
+{
+
+bool ReadBinaryFile(const wxString& fileName, std::vector<unsigned char>& data)
+{
+    wxFFile file(fileName, "rb");
+
+    if ( !file.IsOpened() )
+        return false;
+
+    const wxFileOffset length = file.Length();
+
+    if ( length == wxInvalidOffset )
+        return false;
+
+    data.resize(static_cast<size_t>(length));
+    return data.empty() || file.Read(&data[0], data.size()) == data.size();
+}
+
+bool WriteBinaryFile(const wxString& fileName, const std::vector<unsigned char>& data)
+{
+    wxFFile file(fileName, "wb");
+
+    return file.IsOpened()
+           && (data.empty() || file.Write(&data[0], data.size()) == data.size())
+           && file.Close();
+}
+
+wxString FormatSize(const wxSize& size)
+{
+    return wxString::Format("%dx%d", size.x, size.y);
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunSelfTest()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunSelfTest(size_t threadCount, wxString& report, size_t& failureCount)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(threadCount, false);
+
+    failureCount = 0;
+
+    // the bundles must parse their own data and get their bitmaps
+    // from the disk cache, not from the other bundles
+    wxBitmapBundleSVGSharedCacheDisabler sharedCacheDisabler;
+
+    wxBitmapBundleSVGDiskCache& diskCache = wxBitmapBundleSVGDiskCache::Get();
+
+    // use a private folder, so that the user cache is not affected,
+    // also for the compiled file
+    const wxString previousDirName  = diskCache.GetDirName();
+    const wxString dirName          = wxFileName(wxFileName::GetTempDir(),
+        wxString::Format("wxTestSVGBench-selftest-%lu", wxGetProcessId())).GetFullPath();
+    const wxString compiledFileName = wxFileName(dirName, "selftest",
+        wxSVGCompiledImage::GetFileExtension()).GetFullPath();
+
+    if ( !diskCache.Enable(dirName) )
+    {
+        wxLogError("Couldn't create disk cache folder '%s'.", dirName);
+        return false;
+    }
+
+    wxTestSVGThreadPool  pool(threadCount);
+    std::vector<wxImage> references(m_sizes.size());
+    size_t               checkCount = 0;
+    bool                 ok = true;
+
+    report += wxString::Format("Self-testing %zu files at %zu sizes with %zu threads\n",
+        m_fileNames.size(), m_sizes.size(), threadCount);
+    report += "Check\tFile\tResult\n";
+
+    const auto addResult = [&](const char* check, size_t fileIndex, const wxString& failure)
+    {
+        report += wxString::Format("%s\t%s\t%s\n", check, m_fileNames[fileIndex],
+            failure.empty() ? wxString("OK") : "FAILED: " + failure);
+        ++checkCount;
+        if ( !failure.empty() )
+            ++failureCount;
+    };
+
+    for ( size_t f = 0; f < m_fileNames.size() && ok; ++f )
+    {
+        wxCharBuffer data;
+
+        if ( !ReadFile(GetFilePath(f), data) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            ok = false;
+            break;
+        }
+
+        // the bitmaps the disk cache and the compiled file must reproduce,
+        // rasterized bypassing all the caches
+        wxBitmapBundleImplSVGNano* impl = new wxBitmapBundleImplSVGNano(data.data(), wxSize(2, 2));
+
+        for ( size_t s = 0; s < m_sizes.size() && ok; ++s )
+        {
+            ok = impl->RasterizeToBuffer(m_sizes[s]);
+            if ( ok )
+                references[s] = impl->ConvertBufferToBitmap(m_sizes[s]).ConvertToImage();
+        }
+
+        impl->DecRef();
+
+        if ( !ok )
+        {
+            wxLogError("Couldn't rasterize file '%s'.", m_fileNames[f]);
+            break;
+        }
+
+        addResult("ThreadSafeBundle", f, SelfTestThreadSafeBundle(data, pool));
+        addResult("DiskCache", f, SelfTestDiskCache(data, references));
+        addResult("FlatDocument", f, SelfTestFlatDocument(data));
+        addResult("Compiled", f, SelfTestCompiled(f, compiledFileName, references));
+        addResult("Bands", f, SelfTestBands(data, pool));
+    }
+
+    diskCache.Clear();
+    wxFileName::Rmdir(dirName, wxPATH_RMDIR_RECURSIVE);
+
+    if ( previousDirName.empty() )
+        diskCache.Disable();
+    else
+        diskCache.Enable(previousDirName);
+
+    if ( !ok )
+        return false;
+
+    report += wxString::Format("%zu of %zu checks failed\n", failureCount, checkCount);
+    return true;
+}
+
+wxString wxTestSVGRasterizationBenchmark::SelfTestThreadSafeBundle(const wxCharBuffer& data,
+                                                                   wxTestSVGThreadPool& pool) const
+{
+    typedef wxBitmapBundleImplSVGNanoMT::BufferPtr BufferPtr;
+
+    const size_t           threadCount = pool.GetThreadCount();
+    wxSVGNanoRasterizer    rasterizer;
+    std::vector<BufferPtr> buffers(threadCount);
+    wxString               failure;
+
+    wxBitmapBundleImplSVGNanoMT* impl = new wxBitmapBundleImplSVGNanoMT(data.data(), wxSize(2, 2));
+
+    if ( !impl->IsOk() )
+        failure = "couldn't create the bundle";
+
+    for ( size_t s = 0; s < m_sizes.size() && failure.empty(); ++s )
+    {
+        const wxSize size  = m_sizes[s];
+        const size_t bytes = wxBitmapBundleImplSVG::GetBitmapBytes(size);
+
+        if ( !rasterizer.Rasterize(data.data(), data.length(), size) )
+        {
+            failure.Printf("couldn't rasterize at %s", FormatSize(size));
+            break;
+        }
+
+        // only this size is cached, so that it is cached however large it is
+        impl->ClearCache();
+        impl->SetCacheLimits(1, bytes);
+
+        const size_t        hitCount  = impl->GetCacheHitCount();
+        const size_t        missCount = impl->GetCacheMissCount();
+        std::atomic<size_t> startedCount{0};
+
+        // there is a call for each thread of the pool, they wait for
+        // each other here, so that they all ask for the size at once
+        pool.ParallelFor(threadCount, [&](size_t index, size_t)
+            {
+                ++startedCount;
+                while ( startedCount < threadCount )
+                    std::this_thread::yield();
+
+                buffers[index] = impl->GetBuffer(size);
+            });
+
+        if ( impl->GetCacheMissCount() - missCount != 1 || impl->GetCacheHitCount() - hitCount != threadCount - 1 )
+        {
+            failure.Printf("%s was rasterized %zu times for %zu threads", FormatSize(size),
+                           impl->GetCacheMissCount() - missCount, threadCount);
+        }
+        else if ( static_cast<size_t>(std::count(buffers.begin(), buffers.end(), buffers[0])) != threadCount )
+        {
+            failure.Printf("the threads got different buffers at %s", FormatSize(size));
+        }
+        else if ( !buffers[0] || buffers[0]->size() != bytes
+                  || memcmp(buffers[0]->data(), rasterizer.GetBuffer(), bytes) != 0 )
+        {
+            failure.Printf("the buffer at %s differs from the one rasterized by a single thread", FormatSize(size));
+        }
+    }
+
+    impl->DecRef();
+    return failure;
+}
+
+wxString wxTestSVGRasterizationBenchmark::SelfTestDiskCache(const wxCharBuffer& data,
+                                                            const std::vector<wxImage>& references) const
+{
+    wxBitmapBundleSVGDiskCache& diskCache = wxBitmapBundleSVGDiskCache::Get();
+
+    // gets all the bitmaps from a new bundle, so that none of them is in its
+    // memory cache, they must be read from the disk without parsing if isWarm
+    // and rasterized and written to the disk otherwise
+    const auto getBitmaps = [&](const char* state, bool isWarm) -> wxString
+    {
+        wxBitmapBundleImplSVGNano* impl = new wxBitmapBundleImplSVGNano(data.data(), wxSize(2, 2));
+        const size_t               parseCount = GetNSVGParseCount();
+        wxString                   failure;
+
+        diskCache.ResetStatistics();
+        for ( size_t s = 0; s < m_sizes.size() && failure.empty(); ++s )
+        {
+            if ( !AreImagesIdentical(impl->GetBitmap(m_sizes[s]).ConvertToImage(), references[s]) )
+                failure.Printf("bitmap at %s differs from the rasterized one %s", FormatSize(m_sizes[s]), state);
+        }
+
+        impl->DecRef();
+
+        const wxBitmapBundleSVGDiskCache::Statistics stats = diskCache.GetStatistics();
+        const bool isParsed = GetNSVGParseCount() != parseCount;
+
+        if ( failure.empty()
+             && (isWarm ? stats.misses != 0 || isParsed
+                        : stats.hits != 0 || stats.writes != stats.misses || !isParsed) )
+        {
+            failure.Printf("%zu hits, %zu misses, and %zu writes %s, the data was %sparsed",
+                           stats.hits, stats.misses, stats.writes, state, isParsed ? "" : "not ");
+        }
+
+        return failure;
+    };
+
+    diskCache.Clear();
+
+    wxString failure = getBitmaps("with the cache empty", false);
+
+    if ( failure.empty() )
+        failure = getBitmaps("with the cache filled", true);
+
+    wxArrayString fileNames;
+
+    if ( failure.empty() )
+    {
+        wxDir::GetAllFiles(diskCache.GetDirName(), &fileNames, "*.raster", wxDIR_FILES);
+        if ( fileNames.empty() )
+            failure = "no cache files were written";
+    }
+
+    // all the files are corrupted in the same way, the bundle must
+    // rasterize the bitmaps again and replace the files
+    static const char* const corruptions[] =
+    {
+        "with the files truncated",
+        "with the files extended",
+        "with the files empty",
+        "with the files with a bad header"
+    };
+
+    for ( size_t c = 0; c < WXSIZEOF(corruptions) && failure.empty(); ++c )
+    {
+        for ( const auto& fileName : fileNames )
+        {
+            std::vector<unsigned char> content;
+
+            if ( !ReadBinaryFile(fileName, content) || content.empty() )
+            {
+                failure.Printf("couldn't read cache file '%s'", fileName);
+                break;
+            }
+
+            switch ( c )
+            {
+                case 0:
+                    content.resize(content.size() / 2);
+                    break;
+
+                case 1:
+                    content.push_back(0);
+                    break;
+
+                case 2:
+                    content.clear();
+                    break;
+
+                default:
+                    content[0] ^= 0xff;
+                    break;
+            }
+
+            if ( !WriteBinaryFile(fileName, content) )
+            {
+                failure.Printf("couldn't write cache file '%s'", fileName);
+                break;
+            }
+        }
+
+        if ( failure.empty() )
+            failure = getBitmaps(corruptions[c], false);
+    }
+
+    if ( failure.empty() )
+        failure = getBitmaps("with the files written again", true);
+
+    diskCache.Clear();
+    return failure;
+}
+
+wxString wxTestSVGRasterizationBenchmark::SelfTestFlatDocument(const wxCharBuffer& data) const
+{
+    typedef wxSVGFlatDocument Doc;
+
+    // NanoSVG modifies the data while parsing it, so it needs a copy
+    wxCharBuffer               dataCopy(data.data());
+    std::shared_ptr<NSVGimage> image(nsvgParse(dataCopy.data(), "px", 96), nsvgDelete);
+    wxSVGFlatDocument          document;
+
+    if ( !image )
+        return "couldn't parse with NanoSVG";
+
+    if ( !document.Parse(data.data(), data.length()) )
+        return "couldn't parse with wxSVGFlatDocument";
+
+    // the arcs are split into cubic curves a bit differently
+    const float tolerance = wxMax(image->width, image->height) / 1000;
+
+    if ( std::fabs(document.GetWidth() - image->width) > tolerance
+         || std::fabs(document.GetHeight() - image->height) > tolerance )
+    {
+        return wxString::Format("size %gx%g differs from %gx%g of NanoSVG",
+                                document.GetWidth(), document.GetHeight(), image->width, image->height);
+    }
+
+    // only the shapes which paint anything, the same as RunParse() counts:
+    // NanoSVG keeps the others, while wxSVGFlatDocument skips those with
+    // no paint given but keeps those whose gradient could not be resolved,
+    // and NanoSVG drops the paths with no segments
+    std::vector<const NSVGshape*>  nanoShapes;
+    std::vector<const Doc::Shape*> flatShapes;
+    const Doc::Paint*              paints = document.GetPaints();
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        if ( (shape->flags & NSVG_FLAGS_VISIBLE)
+             && (shape->fill.type != NSVG_PAINT_NONE
+                 || (shape->stroke.type != NSVG_PAINT_NONE && shape->strokeWidth > 0)) )
+        {
+            nanoShapes.push_back(shape);
+        }
+    }
+
+    for ( size_t i = 0; i < document.GetShapeCount(); ++i )
+    {
+        const Doc::Shape&    shape    = document.GetShapes()[i];
+        const unsigned char* commands = document.GetCommands() + shape.firstCommand;
+        const bool           hasSegments = std::any_of(commands, commands + shape.commandCount,
+            [](unsigned char command) { return command != Doc::Command_MoveTo && command != Doc::Command_Close; });
+
+        if ( hasSegments
+             && (paints[shape.fillPaint].type != Doc::Paint_None
+                 || (paints[shape.strokePaint].type != Doc::Paint_None && shape.strokeWidth > 0)) )
+        {
+            flatShapes.push_back(&shape);
+        }
+    }
+
+    if ( flatShapes.size() != nanoShapes.size() )
+    {
+        return wxString::Format("%zu shapes instead of %zu parsed by NanoSVG",
+                                flatShapes.size(), nanoShapes.size());
+    }
+
+    // NanoSVG keeps a gradient with a single stop, which wxSVGFlatDocument
+    // makes a colour, and truncates the opacity, which wxSVGFlatDocument rounds
+    const auto isSamePaint = [](const NSVGpaint& nano, const Doc::Paint& flat)
+    {
+        switch ( nano.type )
+        {
+            case NSVG_PAINT_NONE:
+                return flat.type == Doc::Paint_None;
+
+            case NSVG_PAINT_COLOR:
+                return flat.type == Doc::Paint_Color
+                       && (flat.color & 0xffffff) == (nano.color & 0xffffff)
+                       && std::abs(static_cast<int>(flat.color >> 24) - static_cast<int>(nano.color >> 24)) <= 1;
+
+            case NSVG_PAINT_LINEAR_GRADIENT:
+                return flat.type == Doc::Paint_LinearGradient
+                       || (flat.type == Doc::Paint_Color && nano.gradient->nstops == 1);
+
+            case NSVG_PAINT_RADIAL_GRADIENT:
+                return flat.type == Doc::Paint_RadialGradient
+                       || (flat.type == Doc::Paint_Color && nano.gradient->nstops == 1);
+        }
+
+        return false;
+    };
+
+    for ( size_t i = 0; i < nanoShapes.size(); ++i )
+    {
+        const NSVGshape&  nano = *nanoShapes[i];
+        const Doc::Shape& flat = *flatShapes[i];
+
+        // the bounds of wxSVGFlatDocument include the control points,
+        // so they may be larger than those of NanoSVG, but not smaller
+        if ( flat.bounds[0] > nano.bounds[0] + tolerance || flat.bounds[1] > nano.bounds[1] + tolerance
+             || flat.bounds[2] < nano.bounds[2] - tolerance || flat.bounds[3] < nano.bounds[3] - tolerance )
+        {
+            return wxString::Format("bounds %g,%g,%g,%g of shape %zu do not contain %g,%g,%g,%g of NanoSVG",
+                                    flat.bounds[0], flat.bounds[1], flat.bounds[2], flat.bounds[3], i,
+                                    nano.bounds[0], nano.bounds[1], nano.bounds[2], nano.bounds[3]);
+        }
+
+        if ( !isSamePaint(nano.fill, paints[flat.fillPaint]) )
+            return wxString::Format("fill of shape %zu differs from NanoSVG", i);
+
+        const bool isNanoStroked = nano.stroke.type != NSVG_PAINT_NONE && nano.strokeWidth > 0;
+        const bool isFlatStroked = paints[flat.strokePaint].type != Doc::Paint_None && flat.strokeWidth > 0;
+
+        if ( isNanoStroked != isFlatStroked
+             || (isNanoStroked && !isSamePaint(nano.stroke, paints[flat.strokePaint])) )
+        {
+            return wxString::Format("stroke of shape %zu differs from NanoSVG", i);
+        }
+    }
+
+    return wxString();
+}
+
+wxString wxTestSVGRasterizationBenchmark::SelfTestCompiled(size_t fileIndex, const wxString& compiledFileName,
+                                                           const std::vector<wxImage>& references) const
+{
+    std::vector<unsigned char> compiled;
+
+    if ( !wxSVGCompiledImage::CompileFile(GetFilePath(fileIndex), compiledFileName)
+         || !ReadBinaryFile(compiledFileName, compiled) )
+    {
+        return "couldn't compile";
+    }
+
+    // the bundle must be released before the file is overwritten below
+    wxBitmapBundleImplSVGCompiled* impl = new wxBitmapBundleImplSVGCompiled(compiledFileName, wxSize(2, 2));
+    wxString                       failure;
+
+    for ( size_t s = 0; s < m_sizes.size() && failure.empty(); ++s )
+    {
+        if ( !impl->RasterizeToBuffer(m_sizes[s])
+             || !AreImagesIdentical(impl->ConvertBufferToBitmap(m_sizes[s]).ConvertToImage(), references[s]) )
+        {
+            failure.Printf("bitmap at %s differs from the one rasterized from SVG", FormatSize(m_sizes[s]));
+        }
+    }
+
+    impl->DecRef();
+
+    if ( !failure.empty() )
+        return failure;
+
+    wxSVGCompiledImage image;
+
+    if ( !image.Load(&compiled[0], compiled.size()) )
+        return "couldn't load the compiled data";
+
+    // the header starts with the magic, the format version,
+    // and the byte order mark, 16 bytes in total
+    for ( size_t i = 0; i < 16; ++i )
+    {
+        std::vector<unsigned char> changed(compiled);
+
+        changed[i] ^= 0xff;
+        if ( image.Load(&changed[0], changed.size()) )
+            return wxString::Format("loaded with byte %zu of the header changed", i);
+    }
+
+    // the header contains the size, so any shorter data are rejected
+    const size_t truncatedSizes[] = { 0, 1, 16, compiled.size() / 2, compiled.size() - 4, compiled.size() - 1 };
+
+    for ( const auto size : truncatedSizes )
+    {
+        if ( image.Load(&compiled[0], size) )
+            return wxString::Format("loaded truncated to %zu of %zu bytes", size, compiled.size());
+    }
+
+    // the same when the file is mapped
+    static const char* const corruptions[] = { "truncated", "empty", "with a bad header" };
+
+    for ( size_t c = 0; c < WXSIZEOF(corruptions); ++c )
+    {
+        std::vector<unsigned char> changed(compiled);
+
+        switch ( c )
+        {
+            case 0:
+                changed.resize(changed.size() / 2);
+                break;
+
+            case 1:
+                changed.clear();
+                break;
+
+            default:
+                changed[0] ^= 0xff;
+                break;
+        }
+
+        if ( !WriteBinaryFile(compiledFileName, changed) )
+            return wxString::Format("couldn't write file '%s'", compiledFileName);
+
+        impl = new wxBitmapBundleImplSVGCompiled(compiledFileName, wxSize(2, 2));
+
+        const bool isOk = impl->IsOk();
+
+        impl->DecRef();
+
+        if ( isOk )
+            return wxString::Format("loaded the file %s", corruptions[c]);
+    }
+
+    return wxString();
+}
+
+wxString wxTestSVGRasterizationBenchmark::SelfTestBands(const wxCharBuffer& data, wxTestSVGThreadPool& pool) const
+{
+    // NanoSVG modifies the data while parsing it, so it needs a copy
+    wxCharBuffer               dataCopy(data.data());
+    std::shared_ptr<NSVGimage> image(nsvgParse(dataCopy.data(), "px", 96), nsvgDelete);
+
+    if ( !image || image->width <= 0 || image->height <= 0 )
+        return "couldn't parse with NanoSVG";
+
+    wxSVGTileRasterizer        rasterizer;
+    std::vector<unsigned char> reference, buffer;
+
+    // the default, a single tile row, and rounded up to whole tile rows
+    const int bandHeights[] = { 0, 1, wxSVGTileRasterizer::TileSize, 3 * wxSVGTileRasterizer::TileSize - 1 };
+
+    for ( const auto& size : m_sizes )
+    {
+        const int   stride = size.x * 4;
+        // the same scaling and centering as wxBitmapBundleImplSVGTile
+        const float scale  = wxMin(size.x / image->width, size.y / image->height);
+        const float tx     = (size.x - image->width * scale) / 2.0f;
+        const float ty     = (size.y - image->height * scale) / 2.0f;
+
+        reference.resize(wxBitmapBundleImplSVG::GetBitmapBytes(size));
+
+        if ( !rasterizer.Rasterize(image.get(), tx, ty, scale, &reference[0], size.x, size.y, stride) )
+            return wxString::Format("couldn't rasterize at %s", FormatSize(size));
+
+        for ( const auto bandHeight : bandHeights )
+        {
+            // so that any row not rasterized differs
+            buffer.assign(reference.size(), 0xcd);
+
+            if ( !rasterizer.RasterizeBands(image.get(), tx, ty, scale, &buffer[0], size.x, size.y, stride,
+                                            pool, bandHeight)
+                 || buffer != reference )
+            {
+                return wxString::Format("bitmap at %s rasterized in bands of %d rows differs from the serial one",
+                                        FormatSize(size), bandHeight);
+            }
+        }
+    }
+
+    return wxString();
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchstartup.cpp
+// Purpose:     Benchmark of loading with wxBitmapBundleSVGDiskCache
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <wx/filename.h>
+#include <wx/stopwatch.h>
+
+#include "bmpbndl_svg.h"
+#include "bmpbndl_svg_cache.h"
+#include "bmpbndl_svg_diskcache.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgbackendregistry.h"
+#include "svgbench.h"
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunStartup()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunStartup(size_t runCount, wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+
+    wxBitmapBundleSVGDiskCache& diskCache = wxBitmapBundleSVGDiskCache::Get();
+
+    // a new process starts with empty memory caches
+    wxBitmapBundleSVGSharedCacheDisabler sharedCacheDisabler;
+
+    // use a private folder, so that the user cache is not affected
+    const wxString previousDirName = diskCache.GetDirName();
+    const wxString dirName = wxFileName(wxFileName::GetTempDir(),
+        wxString::Format("wxTestSVGBench-startup-%lu", wxGetProcessId())).GetFullPath();
+
+    if ( !diskCache.Enable(dirName) )
+    {
+        wxLogError("Couldn't create disk cache folder '%s'.", dirName);
+        return false;
+    }
+
+    std::vector<StartupResult> startupResults;
+    bool                       ok = true;
+
+    for ( size_t run = 0; run < runCount && ok; ++run )
+    {
+        diskCache.Clear();
+
+        for ( size_t pass = 0; pass < 2 && ok; ++pass )
+        {
+            StartupResult result;
+
+            result.isWarm = pass == 1;
+            diskCache.ResetStatistics();
+            ok = RunStartupPass(result);
+
+            const wxBitmapBundleSVGDiskCache::Statistics stats = diskCache.GetStatistics();
+
+            result.diskHits   = stats.hits;
+            result.diskMisses = stats.misses;
+            result.diskWrites = stats.writes;
+            startupResults.push_back(result);
+        }
+    }
+
+    diskCache.Clear();
+    wxFileName::Rmdir(dirName);
+
+    if ( previousDirName.empty() )
+        diskCache.Disable();
+    else
+        diskCache.Enable(previousDirName);
+
+    if ( !ok )
+        return false;
+
+    CreateStartupReport(startupResults, runCount, report, results);
+    return true;
+}
+
+bool wxTestSVGRasterizationBenchmark::RunStartupPass(StartupResult& result)
+{
+    wxStopWatch stopWatch;
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    const size_t parseCount = GetNSVGParseCount();
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        wxCharBuffer data;
+
+        stopWatch.Start();
+
+        if ( !ReadFile(GetFilePath(f), data) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        wxBitmapBundleImplSVG* impl = wxTestSVGBackendRegistry::GetBaseline().createImpl(data.data());
+
+        result.loadTime += stopWatch.TimeInMicro().ToLong();
+
+        if ( !impl )
+        {
+            wxLogError("Couldn't create bitmap bundle for file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        stopWatch.Start();
+        for ( const auto& size : m_sizes )
+        {
+            if ( !impl->GetBitmap(size).IsOk() )
+            {
+                wxLogError("Couldn't get bitmap for file '%s' at size %dx%d.", m_fileNames[f], size.x, size.y);
+                impl->DecRef();
+                return false;
+            }
+        }
+        result.bitmapTime += stopWatch.TimeInMicro().ToLong();
+
+        impl->DecRef();
+    }
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    result.parseCount = static_cast<long>(GetNSVGParseCount() - parseCount);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateStartupReport(const std::vector<StartupResult>& startupResults,
+                                                          size_t runCount, wxString& reportText, wxString* resultsText)
+{
+    const auto formatParseCount = [](long parseCount)
+    {
+        return parseCount >= 0 ? wxString::Format("%ld", parseCount) : wxString("n/a");
+    };
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Startup Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Loaded %zu files from folder '%s' at %zu sizes (%zu runs)</h3>",
+        m_fileNames.size(), m_dirName, m_sizes.size(), runCount));
+    result.push_back("<p>Cold: the disk cache is empty, all the bitmaps are rasterized and stored. "
+                     "Warm: all the bitmaps are read from the disk cache. "
+                     "Load is reading the files and creating the bundles, "
+                     "GetBitmap is getting the bitmaps at all the sizes, "
+                     "including parsing the files for the bitmaps not in the disk cache. "
+                     "Parses is the number of the files parsed with nsvgParse(), "
+                     "which must be 0 when warm. "
+                     "The times are in milliseconds (median of all runs).</p>");
+
+    result.push_back("<table><thead><tr><th>Cache</th><th>Load</th><th>GetBitmap</th><th>Total</th><th>Parses</th>"
+                     "<th>Disk Hits</th><th>Disk Misses</th><th>Disk Writes</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "Run\tCache\tLoad\tGetBitmap\tTotal\tParses\tDiskHits\tDiskMisses\tDiskWrites\n";
+
+    for ( size_t pass = 0; pass < 2; ++pass )
+    {
+        const bool isWarm = pass == 1;
+        VectorLong loadTimes, bitmapTimes, totalTimes;
+        size_t     run = 0;
+
+        for ( const auto& r : startupResults )
+        {
+            if ( r.isWarm != isWarm )
+                continue;
+
+            loadTimes.push_back(r.loadTime);
+            bitmapTimes.push_back(r.bitmapTime);
+            totalTimes.push_back(r.loadTime + r.bitmapTime);
+
+            if ( resultsText )
+            {
+                *resultsText += wxString::Format("%zu\t%s\t%ld\t%ld\t%ld\t%s\t%zu\t%zu\t%zu\n",
+                    ++run, isWarm ? "Warm" : "Cold", r.loadTime, r.bitmapTime, r.loadTime + r.bitmapTime,
+                    formatParseCount(r.parseCount), r.diskHits, r.diskMisses, r.diskWrites);
+            }
+        }
+
+        // the cache counts are the same in every run
+        const StartupResult& last = startupResults[startupResults.size() - 2 + pass];
+
+        result.push_back(wxString::Format("<tr><td>%s</td><td>%.2f</td><td>%.2f</td><td>%.2f</td><td>%s</td><td>%zu</td><td>%zu</td><td>%zu</td></tr>\n",
+            isWarm ? "Warm" : "Cold",
+            CalcStatsForVectorLong(loadTimes).mdn / 1000., CalcStatsForVectorLong(bitmapTimes).mdn / 1000.,
+            CalcStatsForVectorLong(totalTimes).mdn / 1000., formatParseCount(last.parseCount),
+            last.diskHits, last.diskMisses, last.diskWrites));
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
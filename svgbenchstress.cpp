@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchstress.cpp
+// Purpose:     Stress test of wxBitmapBundleImplSVGNanoMT
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+
+#include "bmpbndl_svg_cache.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgbench.h"
+#include "svgthreadpool.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunStressTest()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunStressTest(size_t threadCount, size_t iterationCount,
+                                                    wxString& report, size_t& mismatchCount)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(iterationCount, false);
+    wxCHECK(threadCount, false);
+
+    mismatchCount = 0;
+
+    // the bundles must parse their own data
+    wxBitmapBundleSVGSharedCacheDisabler sharedCacheDisabler;
+
+    const size_t        sizeCount = m_sizes.size();
+    const size_t        itemCount = sizeCount * iterationCount;
+    wxTestSVGThreadPool pool(threadCount);
+    wxSVGNanoRasterizer referenceRasterizer;
+
+    report += wxString::Format("Stress testing %zu files at %zu sizes with %zu threads (%zu iterations)\n",
+        m_fileNames.size(), sizeCount, threadCount, iterationCount);
+    report += "File\tCacheHits\tCacheMisses\tMismatches\n";
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        wxCharBuffer data;
+
+        if ( !ReadFile(GetFilePath(f), data) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+
+        // single-threaded reference images
+        std::vector<std::vector<unsigned char>> references(sizeCount);
+
+        for ( size_t s = 0; s < sizeCount; ++s )
+        {
+            if ( !referenceRasterizer.Rasterize(data.data(), data.length(), m_sizes[s]) )
+            {
+                wxLogError("Couldn't rasterize file '%s'.", m_fileNames[f]);
+                return false;
+            }
+
+            const unsigned char* buffer = referenceRasterizer.GetBuffer();
+
+            references[s].assign(buffer, buffer + wxBitmapBundleImplSVG::GetBitmapBytes(m_sizes[s]));
+        }
+
+        wxBitmapBundleImplSVGNanoMT* impl = new wxBitmapBundleImplSVGNanoMT(data.data(), wxSize(2, 2));
+
+        if ( !impl->IsOk() )
+        {
+            wxLogError("Couldn't create bitmap bundle for file '%s'.", m_fileNames[f]);
+            impl->DecRef();
+            return false;
+        }
+
+        std::atomic<size_t> fileMismatchCount{0};
+
+        pool.ParallelFor(itemCount, [&](size_t index, size_t)
+            {
+                const size_t s = index % sizeCount;
+
+                // make the threads rasterize concurrently every now and then,
+                // instead of just getting the cached buffers
+                if ( index % (2 * sizeCount + 1) == 0 )
+                    impl->ClearCache();
+
+                const wxImage image = impl->GetImage(m_sizes[s]);
+
+                if ( !image.IsOk() || image.GetSize() != m_sizes[s] || !image.HasAlpha() )
+                {
+                    ++fileMismatchCount;
+                    return;
+                }
+
+                const unsigned char* reference  = references[s].data();
+                const unsigned char* rgb        = image.GetData();
+                const unsigned char* alpha      = image.GetAlpha();
+                const size_t         pixelCount = static_cast<size_t>(m_sizes[s].x) * m_sizes[s].y;
+
+                for ( size_t i = 0; i < pixelCount; ++i, reference += 4, rgb += 3, ++alpha )
+                {
+                    if ( rgb[0] != reference[0] || rgb[1] != reference[1]
+                         || rgb[2] != reference[2] || *alpha != reference[3] )
+                    {
+                        ++fileMismatchCount;
+                        return;
+                    }
+                }
+            });
+
+        report += wxString::Format("%s\t%zu\t%zu\t%zu\n", m_fileNames[f],
+            impl->GetCacheHitCount(), impl->GetCacheMissCount(), fileMismatchCount.load());
+        mismatchCount += fileMismatchCount;
+
+        impl->DecRef();
+    }
+
+    report += wxString::Format("%zu of %zu images were not identical to the reference\n",
+        mismatchCount, m_fileNames.size() * itemCount);
+    return true;
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchthroughput.cpp
+// Purpose:     Benchmark of parsing and rasterizing with NanoSVG on many threads
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <memory>
+
+#include "bmpbndl_svg_nano.h"
+#include "svgbench.h"
+#include "svgthreadpool.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGRasterizationBenchmark::RunThroughput()
+// ============================================================================
+
+bool wxTestSVGRasterizationBenchmark::RunThroughput(size_t maxThreadCount, size_t runCount,
+                                                    wxString& report, wxString* results)
+{
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(runCount, false);
+    wxCHECK(maxThreadCount, false);
+
+    std::vector<wxCharBuffer> fileData(m_fileNames.size());
+
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        if ( !ReadFile(GetFilePath(f), fileData[f]) )
+        {
+            wxLogError("Couldn't read file '%s'.", m_fileNames[f]);
+            return false;
+        }
+    }
+
+    // work item index = (file * sizeCount + size) * runCount + run
+    const size_t sizeCount = m_sizes.size();
+    const size_t itemCount = m_fileNames.size() * sizeCount * runCount;
+
+    // untimed warm-up, so that the first timed pass does not pay for
+    // filling the CPU caches and the memory allocator pools
+    {
+        wxSVGNanoRasterizer rasterizer;
+
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+        {
+            for ( size_t s = 0; s < sizeCount; ++s )
+                rasterizer.Rasterize(fileData[f].data(), fileData[f].length(), m_sizes[s]);
+        }
+    }
+
+    std::vector<ThroughputResult> throughputResults;
+    wxStopWatch                   stopWatch;
+
+    for ( size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount )
+    {
+        wxTestSVGThreadPool pool(threadCount);
+        std::vector<std::unique_ptr<wxSVGNanoRasterizer>> rasterizers;
+        std::atomic<size_t> failedItem{itemCount};
+
+        for ( size_t i = 0; i < threadCount; ++i )
+            rasterizers.push_back(std::unique_ptr<wxSVGNanoRasterizer>(new wxSVGNanoRasterizer));
+
+        stopWatch.Start();
+        pool.ParallelFor(itemCount, [&](size_t index, size_t workerIndex)
+            {
+                const size_t f = index / (sizeCount * runCount);
+                const size_t s = (index / runCount) % sizeCount;
+
+                if ( !rasterizers[workerIndex]->Rasterize(fileData[f].data(), fileData[f].length(), m_sizes[s]) )
+                    failedItem = index;
+            });
+        const long time = stopWatch.TimeInMicro().ToLong();
+
+        if ( failedItem != itemCount )
+        {
+            const size_t f = failedItem / (sizeCount * runCount);
+            const size_t s = (failedItem / runCount) % sizeCount;
+
+            wxLogError("Couldn't rasterize file '%s' at size %dx%d.", m_fileNames[f], m_sizes[s].x, m_sizes[s].y);
+            return false;
+        }
+
+        ThroughputResult result;
+
+        result.threadCount = threadCount;
+        result.time = time;
+        throughputResults.push_back(result);
+    }
+
+    CreateThroughputReport(throughputResults, itemCount, runCount, report, results);
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateThroughputReport(const std::vector<ThroughputResult>& throughputResults,
+                                                             size_t itemCount, size_t runCount,
+                                                             wxString& reportText, wxString* resultsText)
+{
+    wxCHECK_RET(!throughputResults.empty(), "no results");
+
+    // speedup and efficiency are relative to the single thread
+    const double baseTime = static_cast<double>(throughputResults.front().time);
+
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG Throughput Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Rasterized %zu files from folder '%s' at %zu sizes with NanoSVG (%zu runs, %zu icons)</h3>",
+        m_fileNames.size(), m_dirName, m_sizes.size(), runCount, itemCount));
+    result.push_back("<p>Every icon is parsed and rasterized to a buffer, each thread uses its own rasterizer. "
+                     "Speedup and efficiency are relative to one thread.</p>");
+
+    result.push_back("<table><thead><tr><th>Threads</th><th>Time (ms)</th><th>Icons/s</th>"
+                     "<th>Speedup</th><th>Efficiency</th></tr></thead>\n");
+    result.push_back("<tbody>\n");
+
+    if ( resultsText )
+        *resultsText = "Threads\tTime\tIconsPerSecond\tSpeedup\tEfficiency\n";
+
+    for ( const auto& r : throughputResults )
+    {
+        const double time           = r.time > 0 ? static_cast<double>(r.time) : 1.;
+        const double iconsPerSecond = itemCount * 1000000. / time;
+        const double speedup        = baseTime / time;
+        const double efficiency     = speedup / r.threadCount;
+
+        result.push_back(wxString::Format("<tr><td>%zu</td><td>%.2f</td><td>%.0f</td><td>%.2f</td><td>%.0f %%</td></tr>\n",
+            r.threadCount, r.time / 1000., iconsPerSecond, speedup, efficiency * 100.));
+
+        if ( resultsText )
+        {
+            *resultsText += wxString::Format("%zu\t%ld\t%.0f\t%.3f\t%.3f\n",
+                r.threadCount, r.time, iconsPerSecond, speedup, efficiency);
+        }
+    }
+
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
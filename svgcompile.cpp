@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgcompile.cpp
+// Purpose:     Console application compiling SVG files for wxBitmapBundleImplSVGCompiled
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/tokenzr.h>
+
+#include "bmpbndl_svg_compiled.h"
+#include "svgcorpus.h"
+
+// ============================================================================
+// wxTestSVGCompileApp
+// ============================================================================
+
+/*
+    Compiles SVG files into the binary format loaded by
+    wxBitmapBundleImplSVGCompiled, see wxSVGCompiledImage. Each file found
+    in --dir (and its subfolders with --recursive) is written to --output
+    under its path relative to --dir, with the extension replaced by .svgc:
+
+    wxTestSVGCompile --dir material-design-icons --recursive --output compiled-svg
+
+    A file whose compiled file is not older than the file itself is skipped
+    unless --force is used, so that the build step compiling a folder
+    at build time (see CMakeLists.txt) compiles only the changed files.
+    The application exits with EXIT_FAILURE if any file could not be compiled,
+    the other files are compiled anyway.
+ */
+
+class wxTestSVGCompileApp : public wxAppConsole
+{
+public:
+    void OnInitCmdLine(wxCmdLineParser& parser) wxOVERRIDE;
+    bool OnCmdLineParsed(wxCmdLineParser& parser) wxOVERRIDE;
+    int  OnRun() wxOVERRIDE;
+
+private:
+    wxString                 m_dirName;
+    wxString                 m_outputDirName;
+    wxTestSVGCorpus::Options m_corpusOptions;
+    bool                     m_force{false};
+    bool                     m_verbose{false};
+
+    static wxArrayString ParseList(const wxString& listStr);
+};
+
+void wxTestSVGCompileApp::OnInitCmdLine(wxCmdLineParser& parser)
+{
+    static const wxCmdLineEntryDesc cmdLineDesc[] =
+    {
+        { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+        { wxCMD_LINE_OPTION, "d", "dir", "folder with SVG files (required)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, "o", "output", "folder for the compiled files, created if needed (required)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "recursive", "search the subfolders of --dir too",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_OPTION, "g", "glob", "comma separated file name or relative path patterns (default: *.svg)",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_OPTION, nullptr, "exclude", "comma separated file name or relative path patterns to skip",
+            wxCMD_LINE_VAL_STRING, 0 },
+        { wxCMD_LINE_SWITCH, nullptr, "force", "compile also the files whose compiled files are up to date",
+            wxCMD_LINE_VAL_NONE, 0 },
+        { wxCMD_LINE_SWITCH, "v", "verbose", "print the name of each compiled file",
+            wxCMD_LINE_VAL_NONE, 0 },
+        wxCMD_LINE_DESC_END
+    };
+
+    parser.SetDesc(cmdLineDesc);
+    parser.SetSwitchChars("-");
+}
+
+bool wxTestSVGCompileApp::OnCmdLineParsed(wxCmdLineParser& parser)
+{
+    wxString listStr;
+
+    parser.Found("d", &m_dirName);
+    parser.Found("o", &m_outputDirName);
+    m_corpusOptions.recursive = parser.Found("recursive");
+    if ( parser.Found("g", &listStr) )
+        m_corpusOptions.includes = ParseList(listStr);
+    if ( parser.Found("exclude", &listStr) )
+        m_corpusOptions.excludes = ParseList(listStr);
+    m_force   = parser.Found("force");
+    m_verbose = parser.Found("v");
+
+    if ( m_dirName.empty() || m_outputDirName.empty() )
+    {
+        wxLogError("Options --dir and --output are required.");
+        return false;
+    }
+
+    if ( !wxDir::Exists(m_dirName) )
+    {
+        wxLogError("Folder '%s' does not exist.", m_dirName);
+        return false;
+    }
+
+    return wxAppConsole::OnCmdLineParsed(parser);
+}
+
+int wxTestSVGCompileApp::OnRun()
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+    wxArrayString files;
+
+    if ( !wxTestSVGCorpus::FindFiles(m_dirName, m_corpusOptions, files) )
+        return EXIT_FAILURE;
+
+    size_t compiledCount = 0, upToDateCount = 0, failedCount = 0;
+    double svgBytes = 0, compiledBytes = 0;
+
+    for ( const auto& file : files )
+    {
+        // not wxFileName(m_dirName, file), the name may include subfolders
+        wxFileName svgFileName(file);
+        wxFileName compiledFileName(wxSVGCompiledImage::GetCompiledFileName(file));
+
+        svgFileName.MakeAbsolute(m_dirName);
+        compiledFileName.MakeAbsolute(m_outputDirName);
+
+        if ( !m_force && compiledFileName.FileExists()
+             && wxFileModificationTime(compiledFileName.GetFullPath()) >= wxFileModificationTime(svgFileName.GetFullPath()) )
+        {
+            ++upToDateCount;
+            continue;
+        }
+
+        if ( !compiledFileName.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL) )
+        {
+            wxLogError("Couldn't create folder '%s'.", compiledFileName.GetPath());
+            return EXIT_FAILURE;
+        }
+
+        if ( !wxSVGCompiledImage::CompileFile(svgFileName.GetFullPath(), compiledFileName.GetFullPath()) )
+        {
+            wxLogError("Couldn't compile file '%s'.", svgFileName.GetFullPath());
+            ++failedCount;
+            continue;
+        }
+
+        if ( m_verbose )
+            wxPrintf("%s\n", compiledFileName.GetFullPath());
+
+        ++compiledCount;
+        svgBytes      += svgFileName.GetSize().ToDouble();
+        compiledBytes += compiledFileName.GetSize().ToDouble();
+    }
+
+    wxFprintf(stderr, "Compiled %zu files (%.1f KB) into %.1f KB, %zu up to date, %zu failed.\n",
+              compiledCount, svgBytes / 1024, compiledBytes / 1024, upToDateCount, failedCount);
+
+    return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+    wxLogError("Compiling SVG requires NanoSVG headers.");
+    return EXIT_FAILURE;
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_COMPILED
+}
+
+// returns the trimmed non-empty items of a comma separated list
+wxArrayString wxTestSVGCompileApp::ParseList(const wxString& listStr)
+{
+    wxStringTokenizer tokenizer(listStr, ",");
+    wxArrayString     items;
+
+    while ( tokenizer.HasMoreTokens() )
+    {
+        const wxString item = tokenizer.GetNextToken().Trim().Trim(false);
+
+        if ( !item.empty() )
+            items.push_back(item);
+    }
+
+    return items;
+}
+
+wxIMPLEMENT_APP_CONSOLE(wxTestSVGCompileApp);
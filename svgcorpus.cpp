@@ -0,0 +1,285 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgcorpus.cpp
+// Purpose:     Finding, sampling, and sharding the SVG files to benchmark
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include "svgcorpus.h"
+
+namespace
+{
+
+struct Candidate
+{
+    wxString    path;     // relative
+    wxUint64    key{0};   // the lower the key, the sooner selected
+    wxULongLong fileSize; // only for Sampling_FileSize
+    size_t      stratum{0};
+};
+
+// Returns a pseudo-random key for the path, the same on all platforms,
+// unlike the distributions of the standard library
+wxUint64 GetSamplingKey(unsigned long seed, const wxString& path)
+{
+    // 64-bit FNV-1a of the seed and the path...
+    wxUint64 hash = wxULL(14695981039346656037);
+
+    for ( int i = 0; i < 8; ++i )
+    {
+        hash ^= (static_cast<wxUint64>(seed) >> (i * 8)) & 0xff;
+        hash *= wxULL(1099511628211);
+    }
+
+    const wxScopedCharBuffer utf8 = path.utf8_str();
+
+    for ( const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8.data()); *p; ++p )
+    {
+        hash ^= *p;
+        hash *= wxULL(1099511628211);
+    }
+
+    // ...mixed with the SplitMix64 finalizer, as paths differing only
+    // in their last characters would get too similar keys
+    hash ^= hash >> 30;
+    hash *= wxULL(0xbf58476d1ce4e5b9);
+    hash ^= hash >> 27;
+    hash *= wxULL(0x94d049bb133111eb);
+    hash ^= hash >> 31;
+
+    return hash;
+}
+
+// Keeps count of the candidates, those with the lowest keys from each
+// stratum, the number of them proportional to the size of the stratum.
+// The remaining ones are distributed by the largest remainder method.
+void SelectStratified(std::vector<Candidate>& candidates, size_t stratumCount, size_t count)
+{
+    if ( count >= candidates.size() )
+        return;
+
+    std::vector<std::vector<Candidate>> strata(stratumCount);
+
+    for ( auto& c : candidates )
+        strata[c.stratum].push_back(c);
+
+    std::vector<size_t>                    quotas(stratumCount);
+    std::vector<std::pair<size_t, size_t>> remainders; // scaled remainder, stratum
+    size_t                                 assignedCount = 0;
+
+    for ( size_t s = 0; s < stratumCount; ++s )
+    {
+        const size_t scaled = strata[s].size() * count;
+
+        quotas[s] = scaled / candidates.size();
+        assignedCount += quotas[s];
+        remainders.push_back(std::make_pair(scaled % candidates.size(), s));
+    }
+
+    // the largest remainders first, then the lowest strata
+    std::sort(remainders.begin(), remainders.end(),
+              [](const std::pair<size_t, size_t>& r1, const std::pair<size_t, size_t>& r2)
+        {
+            return r1.first != r2.first ? r1.first > r2.first : r1.second < r2.second;
+        });
+
+    for ( size_t i = 0; assignedCount < count && i < remainders.size(); ++i )
+    {
+        ++quotas[remainders[i].second];
+        ++assignedCount;
+    }
+
+    candidates.clear();
+    for ( size_t s = 0; s < stratumCount; ++s )
+    {
+        std::vector<Candidate>& stratum = strata[s];
+
+        std::sort(stratum.begin(), stratum.end(),
+                  [](const Candidate& c1, const Candidate& c2) { return c1.key < c2.key; });
+        candidates.insert(candidates.end(), stratum.begin(), stratum.begin() + quotas[s]);
+    }
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGCorpus
+// ============================================================================
+
+// static
+bool wxTestSVGCorpus::FindFiles(const wxString& dirName, const Options& options, wxArrayString& files)
+{
+    wxCHECK(options.shardCount > 0 && options.shardIndex < options.shardCount, false);
+
+    files.clear();
+
+    if ( !wxDir::Exists(dirName) )
+    {
+        wxLogError("Folder '%s' does not exist.", dirName);
+        return false;
+    }
+
+    wxArrayString allFiles;
+    wxArrayString includes(options.includes);
+
+    if ( includes.empty() )
+        includes.push_back("*.svg");
+
+    wxDir::GetAllFiles(dirName, &allFiles, wxEmptyString,
+                       options.recursive ? wxDIR_FILES | wxDIR_DIRS : wxDIR_FILES);
+
+    std::vector<Candidate> candidates;
+
+    for ( const auto& fullPath : allFiles )
+    {
+        wxFileName fileName(fullPath);
+
+        fileName.MakeRelativeTo(dirName);
+
+        const wxString path = fileName.GetFullPath(wxPATH_UNIX);
+
+        const auto matches = [&path](const wxArrayString& globs)
+        {
+            for ( const auto& g : globs )
+            {
+                if ( MatchesGlob(path, g) )
+                    return true;
+            }
+            return false;
+        };
+
+        if ( !matches(includes) || matches(options.excludes) )
+            continue;
+
+        candidates.push_back(Candidate());
+        candidates.back().path = path;
+        candidates.back().key  = GetSamplingKey(options.seed, path);
+        if ( options.sampling == Sampling_FileSize )
+            candidates.back().fileSize = wxFileName::GetSize(fullPath);
+    }
+
+    if ( options.sampling != Sampling_None )
+    {
+        size_t stratumCount = 1;
+
+        if ( options.sampling == Sampling_Folder )
+        {
+            std::map<wxString, size_t> folders;
+
+            for ( auto& c : candidates )
+            {
+                const wxString folder = c.path.BeforeLast('/');
+                const auto     it     = folders.find(folder);
+
+                if ( it != folders.end() )
+                {
+                    c.stratum = it->second;
+                }
+                else
+                {
+                    c.stratum = folders.size();
+                    folders[folder] = c.stratum;
+                }
+            }
+            stratumCount = wxMax(folders.size(), static_cast<size_t>(1));
+        }
+        else if ( options.sampling == Sampling_FileSize )
+        {
+            // quantiles of equal numbers of files, ties broken by the key
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& c1, const Candidate& c2)
+                {
+                    return c1.fileSize != c2.fileSize ? c1.fileSize < c2.fileSize : c1.key < c2.key;
+                });
+
+            stratumCount = FileSizeStratumCount;
+            for ( size_t i = 0; i < candidates.size(); ++i )
+                candidates[i].stratum = i * stratumCount / candidates.size();
+        }
+
+        SelectStratified(candidates, stratumCount, options.sampleCount);
+    }
+
+    for ( const auto& c : candidates )
+        files.push_back(c.path);
+
+    files.Sort(wxNaturalStringSortAscending);
+
+    if ( options.maxFileCount > 0 && files.size() > options.maxFileCount )
+        files.resize(options.maxFileCount);
+
+    if ( options.shardCount > 1 )
+    {
+        wxArrayString shardFiles;
+
+        for ( size_t i = options.shardIndex; i < files.size(); i += options.shardCount )
+            shardFiles.push_back(files[i]);
+
+        files = shardFiles;
+    }
+
+    return true;
+}
+
+// static
+bool wxTestSVGCorpus::MatchesGlob(const wxString& relativePath, const wxString& glob)
+{
+    const wxString text = glob.Find('/') == wxNOT_FOUND ? relativePath.AfterLast('/') : relativePath;
+
+    return text.Lower().Matches(glob.Lower());
+}
+
+// static
+wxString wxTestSVGCorpus::GetSamplingName(Sampling sampling)
+{
+    static const char* const names[Sampling_Max] = { "none", "random", "folder", "size" };
+
+    wxCHECK(sampling >= 0 && sampling < Sampling_Max, wxString());
+
+    return names[sampling];
+}
+
+// static
+bool wxTestSVGCorpus::GetSamplingFromName(const wxString& name, Sampling& sampling)
+{
+    for ( int s = 0; s < Sampling_Max; ++s )
+    {
+        if ( name.IsSameAs(GetSamplingName(static_cast<Sampling>(s)), false) )
+        {
+            sampling = static_cast<Sampling>(s);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// static
+wxString wxTestSVGCorpus::GetDescription(const Options& options)
+{
+    wxString description;
+
+    description = options.recursive ? "recursive" : "flat";
+    description += ", include " + (options.includes.empty() ? wxString("*.svg") : wxJoin(options.includes, ','));
+    if ( !options.excludes.empty() )
+        description += ", exclude " + wxJoin(options.excludes, ',');
+    if ( options.sampling != Sampling_None )
+    {
+        description += wxString::Format(", %s sampling of %zu (seed %lu)", GetSamplingName(options.sampling),
+                                        options.sampleCount, options.seed);
+    }
+    if ( options.maxFileCount > 0 )
+        description += wxString::Format(", first %zu", options.maxFileCount);
+    if ( options.shardCount > 1 )
+        description += wxString::Format(", shard %zu/%zu", options.shardIndex + 1, options.shardCount);
+
+    return description;
+}
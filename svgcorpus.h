@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgcorpus.h
+// Purpose:     Finding, sampling, and sharding the SVG files to benchmark
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_CORPUS_H_DEFINED
+#define TEST_SVG_CORPUS_H_DEFINED
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGCorpus
+// ============================================================================
+
+/*
+    Selects the files of a corpus to benchmark, which may be a large tree
+    of folders, such as material-design-icons with thousands of SVGs.
+
+    The files are given as paths relative to the corpus folder, separated
+    by "/" on all platforms, so that the results from different machines
+    can be compared and merged. A glob without "/" is matched against
+    the file name, otherwise against the whole relative path, "*" matching
+    any characters including "/". Globs are matched case-insensitively.
+
+    Sampling is deterministic: each file gets a pseudo-random key computed
+    from the seed and its relative path, and the files with the lowest keys
+    are selected. The same seed therefore selects the same files on every
+    machine and adding files to the corpus changes the sample only a little.
+    Stratified sampling selects from each stratum (folder or file size
+    quantile) proportionally to its number of files, so that the sample
+    does not miss, e.g., small folders or the largest files by chance.
+
+    Sharding splits the selected files round-robin into shardCount parts,
+    so that each shard gets files from all the folders. Each shard can be
+    benchmarked by a separate process, and their results merged with
+    wxTestSVGBenchmarkResults::Merge().
+ */
+
+class wxTestSVGCorpus
+{
+public:
+    enum Sampling
+    {
+        Sampling_None = 0,
+        Sampling_Random,   // uniformly from all the files
+        Sampling_Folder,   // stratified by the folder containing the file
+        Sampling_FileSize, // stratified by file size, see FileSizeStratumCount
+
+        Sampling_Max
+    };
+
+    struct Options
+    {
+        bool          recursive{false};
+        wxArrayString includes;        // empty means "*.svg"
+        wxArrayString excludes;
+        Sampling      sampling{Sampling_None};
+        size_t        sampleCount{0};  // ignored without sampling
+        unsigned long seed{0};
+        size_t        maxFileCount{0}; // the first files of the sample, 0 means all
+        size_t        shardIndex{0};   // 0-based
+        size_t        shardCount{1};
+    };
+
+    // the number of file size quantiles of Sampling_FileSize
+    static const size_t FileSizeStratumCount = 10;
+
+    // Fills files with the selected paths relative to dirName in natural
+    // order. Returns false if dirName cannot be read, not when no file matches.
+    static bool FindFiles(const wxString& dirName, const Options& options, wxArrayString& files);
+
+    // relativePath is separated by "/"
+    static bool MatchesGlob(const wxString& relativePath, const wxString& glob);
+
+    // "none", "random", "folder", and "size"
+    static wxString GetSamplingName(Sampling sampling);
+    // returns false if name is not one of the above
+    static bool GetSamplingFromName(const wxString& name, Sampling& sampling);
+
+    // describes options, e.g., for the benchmark results metadata
+    static wxString GetDescription(const Options& options);
+};
+
+#endif // #ifndef TEST_SVG_CORPUS_H_DEFINED
@@ -8,6 +8,12 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 
+#include <algorithm>
+#include <climits>
+#include <list>
+#include <memory>
+#include <vector>
+
 #include <wx/wx.h>
 #include <wx/busyinfo.h>
 #include <wx/choicdlg.h>
@@ -21,30 +27,149 @@
 #include <wx/slider.h>
 #include <wx/splitter.h>
 #include <wx/statline.h>
+#include <wx/stopwatch.h>
 #include <wx/utils.h>
 
 #include "svgframe.h"
+#include "svgbackendregistry.h"
 #include "svgbench.h"
+#include "svgcorpus.h"
+#include "svgreportframe.h"
+#include "svgreportwriter.h"
 #include "bmpbndl_svg_d2d.h"
+#include "bmpbndl_svg_nano.h"
+#include "svgrasterscheduler.h"
 
 #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
     #pragma message("Direct2D support for SVG unavailable")
 #endif // #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
 
+// declared only when NanoSVG headers are available
+class wxBitmapBundleImplSVGNanoMT;
+
 // ============================================================================
 // wxBitmapBundlePanel
 // ============================================================================
 
+/*
+    Shows the bitmap from a bundle at the given size.
+
+    When the bundle impl can be used from a worker thread (currently only
+    wxBitmapBundleImplSVGNanoMT), the bitmaps can be rasterized in the background:
+    while the bitmap at the current size is not available yet, the most
+    similar bitmap already rasterized is painted scaled instead. Only the last
+    requested size is rasterized, so that dragging the size slider does not
+    queue the rasterization of every size it went through.
+
+    With such an impl, the bitmap can be also rasterized in tiles of
+    ms_tileSize pixels, only those visible in the window, see
+    wxBitmapBundleImplSVGNanoMT::GetRectBuffer(). The most recently painted
+    tiles are kept, so scrolling back and forth rasterizes nothing, but at
+    most ms_maxTiles of them, so that even bitmaps of several thousand pixels
+    are previewed with the memory and the paint time of a few screens.
+    When rasterizing in the background, the tiles not available yet are left
+    hatched and the tiles scrolled out of view before they were rasterized
+    are skipped, the same as the sizes the slider went through.
+
+    The time spent in OnPaint() is measured, so that the time the UI thread
+    is blocked with the synchronous and asynchronous rasterization can be compared.
+ */
+
 class wxBitmapBundlePanel : public wxScrolledCanvas
 {
 public:
     wxBitmapBundlePanel(wxWindow* parent, const wxSize& bitmapSize);
+    ~wxBitmapBundlePanel();
 
-    void SetBitmapBundle(const wxBitmapBundle& bundle);
+    // if asyncImpl is not null, it must be the impl of the bundle
+    void SetBitmapBundle(const wxBitmapBundle& bundle,
+                         wxBitmapBundleImplSVGNanoMT* asyncImpl = nullptr);
     void SetBitmapSize(const wxSize& size);
+
+    // have effect only for the bundles with asyncImpl
+    void EnableAsyncRasterization(bool enable);
+    void EnableTiledRasterization(bool enable);
+
+    // the times spent painting, in microseconds
+    struct PaintTimes
+    {
+        size_t     count{0};
+        long       last{0};
+        long       max{0};
+        wxLongLong total{0};
+        // paints that took longer than one frame at 60 Hz
+        size_t     slowCount{0};
+    };
+
+    const PaintTimes& GetPaintTimes() const { return m_paintTimes; }
+    void ResetPaintTimes() { m_paintTimes = PaintTimes(); }
+
+    // number of rasterizations skipped because the size changed
+    // before they started
+    size_t GetSkippedRasterizationCount() const;
+
 private:
+    typedef std::shared_ptr<const std::vector<unsigned char>> BufferPtr;
+
+    // a part of the bitmap of the given size
+    struct Tile
+    {
+        wxSize   size;
+        wxRect   rect;
+        wxBitmap bitmap;
+    };
+
+    // the maximum number of bitmaps in m_bitmaps
+    static const size_t ms_maxBitmaps = 8;
+    // only the tiles at the right and bottom edges of the bitmap are smaller
+    static const int    ms_tileSize = 256;
+    // the maximum number of tiles in m_tiles, more than are visible
+    // in the panel maximized on a 2560 x 1440 display, but never less than
+    // m_visibleTileCount, otherwise the visible tiles would replace each other
+    static const size_t ms_maxTiles = 96;
+
     wxBitmapBundle m_bitmapBundle;
     wxSize         m_bitmapSize;
+    PaintTimes     m_paintTimes;
+
+    // the bitmaps of the current bundle, the most recently used first
+    std::list<wxBitmap> m_bitmaps;
+    // the tiles of the current bundle, the most recently used first
+    std::list<Tile>     m_tiles;
+    // the number of the tiles visible when painted last time
+    size_t              m_visibleTileCount{0};
+
+    wxBitmapBundleImplSVGNanoMT*              m_asyncImpl{nullptr};
+    bool                                      m_asyncEnabled{true};
+    bool                                      m_tiledEnabled{false};
+    // incremented when the bundle changes, to ignore the results
+    // of rasterizing the previous bundle still waiting to be delivered
+    size_t                                    m_bundleId{0};
+    // size the last scheduled rasterization is for
+    wxSize                                    m_scheduledSize;
+    // the tiles of m_scheduledTilesSize the last scheduled rasterization
+    // is for, without those already rasterized
+    wxSize                                    m_scheduledTilesSize;
+    std::vector<wxRect>                       m_scheduledTiles;
+    std::unique_ptr<wxTestSVGRasterScheduler> m_scheduler;
+
+    // returns the bitmap of m_bitmapSize or, when rasterizing in the background,
+    // the most similar bitmap available, which may be invalid
+    wxBitmap GetBitmapToPaint();
+    void     AddBitmap(const wxBitmap& bitmap);
+    void     ScheduleRasterization(const wxSize& size);
+    void     OnRasterized(size_t bundleId, const wxSize& size, const BufferPtr& buffer);
+
+    // paints the visible tiles of m_bitmapSize available, rasterizing
+    // or scheduling the rasterization of the others
+    void     PaintTiles(wxDC& dc);
+    // returns the tile of m_bitmapSize, which may be invalid
+    wxBitmap GetTile(const wxRect& rect);
+    wxBitmap RasterizeTile(const wxRect& rect);
+    void     AddTile(const wxSize& size, const wxRect& rect, const wxBitmap& bitmap);
+    void     ScheduleTiles(const std::vector<wxRect>& rects);
+    void     OnTileRasterized(size_t bundleId, const wxSize& size, const wxRect& rect,
+                              const BufferPtr& buffer);
 
     void OnPaint(wxPaintEvent&);
 };
@@ -61,9 +186,31 @@ wxBitmapBundlePanel::wxBitmapBundlePanel(wxWindow* parent, const wxSize& bitmapS
     Bind(wxEVT_PAINT, &wxBitmapBundlePanel::OnPaint, this);
 }
 
-void wxBitmapBundlePanel::SetBitmapBundle(const wxBitmapBundle& bundle)
+wxBitmapBundlePanel::~wxBitmapBundlePanel()
 {
-    m_bitmapBundle = bundle;
+    // the running job uses m_asyncImpl
+    if ( m_scheduler )
+        m_scheduler->CancelAndWait();
+}
+
+void wxBitmapBundlePanel::SetBitmapBundle(const wxBitmapBundle& bundle,
+                                          wxBitmapBundleImplSVGNanoMT* asyncImpl)
+{
+    // the running job must finish before the previous impl may be deleted
+    if ( m_scheduler )
+        m_scheduler->CancelAndWait();
+
+    m_bitmapBundle  = bundle;
+    m_asyncImpl     = asyncImpl;
+    m_scheduledSize = wxDefaultSize;
+    m_bitmaps.clear();
+    m_tiles.clear();
+    m_scheduledTiles.clear();
+    ++m_bundleId;
+
+    if ( m_asyncImpl && !m_scheduler )
+        m_scheduler.reset(new wxTestSVGRasterScheduler);
+
     Refresh(); Update();
 }
 
@@ -82,29 +229,320 @@ void wxBitmapBundlePanel::SetBitmapSize(const wxSize& size)
     Refresh(); Update();
 }
 
-void wxBitmapBundlePanel::OnPaint(wxPaintEvent&)
+void wxBitmapBundlePanel::EnableAsyncRasterization(bool enable)
+{
+    m_asyncEnabled = enable;
+    Refresh();
+}
+
+void wxBitmapBundlePanel::EnableTiledRasterization(bool enable)
+{
+    m_tiledEnabled = enable;
+    Refresh();
+}
+
+size_t wxBitmapBundlePanel::GetSkippedRasterizationCount() const
+{
+    return m_scheduler ? m_scheduler->GetSupersededCount() : 0;
+}
+
+wxBitmap wxBitmapBundlePanel::GetBitmapToPaint()
 {
-    const wxSize   clientSize(GetClientSize());
+    std::list<wxBitmap>::iterator nearest = m_bitmaps.end();
+    int                           nearestDistance = INT_MAX;
 
-    wxAutoBufferedPaintDC dc(this);
-    wxBitmap              bitmap;
+    for ( std::list<wxBitmap>::iterator it = m_bitmaps.begin(); it != m_bitmaps.end(); ++it )
+    {
+        const wxSize size = it->GetSize();
 
-    DoPrepareDC(dc);
+        if ( size == m_bitmapSize )
+        {
+            m_bitmaps.splice(m_bitmaps.begin(), m_bitmaps, it);
+            return m_bitmaps.front();
+        }
 
-    dc.SetBackground(*wxWHITE);
-    dc.Clear();
-    bitmap = m_bitmapBundle.GetBitmap(m_bitmapSize);
+        const int distance = abs(size.x - m_bitmapSize.x) + abs(size.y - m_bitmapSize.y);
 
+        if ( distance < nearestDistance )
+        {
+            nearest = it;
+            nearestDistance = distance;
+        }
+    }
 
-    if ( bitmap.IsOk() )
+    if ( !m_asyncImpl || !m_asyncEnabled )
     {
-        wxBrush          hatchBrush(*wxBLUE, wxBRUSHSTYLE_CROSSDIAG_HATCH);
-        wxDCBrushChanger bc(dc, hatchBrush);
-        wxDCPenChanger   pc(dc, wxNullPen);
+        const wxBitmap bitmap = m_bitmapBundle.GetBitmap(m_bitmapSize);
 
-        dc.DrawRectangle(wxPoint(0, 0), m_bitmapSize);
-        dc.DrawBitmap(bitmap, 0, 0, true);
+        if ( bitmap.IsOk() )
+            AddBitmap(bitmap);
+        return bitmap;
     }
+
+    if ( m_scheduledSize != m_bitmapSize )
+        ScheduleRasterization(m_bitmapSize);
+
+    return nearest != m_bitmaps.end() ? *nearest : wxBitmap();
+}
+
+void wxBitmapBundlePanel::AddBitmap(const wxBitmap& bitmap)
+{
+    m_bitmaps.push_front(bitmap);
+    if ( m_bitmaps.size() > ms_maxBitmaps )
+        m_bitmaps.pop_back();
+}
+
+void wxBitmapBundlePanel::ScheduleRasterization(const wxSize& size)
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    wxBitmapBundleImplSVGNanoMT* impl      = m_asyncImpl;
+    wxTestSVGRasterScheduler*    scheduler = m_scheduler.get();
+    const size_t                 bundleId  = m_bundleId;
+
+    m_scheduledSize = size;
+    m_scheduledTiles.clear();
+
+    // impl stays alive while the job runs, as it is released only after
+    // CancelAndWait(), which waits for the running job to finish
+    scheduler->Schedule([=](wxUint64 generation)
+        {
+            if ( !scheduler->IsCurrent(generation) )
+                return;
+
+            const BufferPtr buffer = impl->GetBuffer(size);
+
+            // deliver the result even if it is stale by now, the bitmap
+            // can be still painted scaled while a better one is rasterized
+            CallAfter([=] { OnRasterized(bundleId, size, buffer); });
+        });
+#else
+    wxUnusedVar(size);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+void wxBitmapBundlePanel::OnRasterized(size_t bundleId, const wxSize& size, const BufferPtr& buffer)
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    if ( bundleId != m_bundleId || !buffer )
+        return;
+
+    AddBitmap(wxBitmap(wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(*buffer, size)));
+
+    if ( size == m_bitmapSize )
+        Refresh();
+#else
+    wxUnusedVar(bundleId);
+    wxUnusedVar(size);
+    wxUnusedVar(buffer);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+void wxBitmapBundlePanel::PaintTiles(wxDC& dc)
+{
+    const wxRect        bitmapRect(m_bitmapSize);
+    const wxRect        visibleRect = wxRect(CalcUnscrolledPosition(wxPoint(0, 0)), GetClientSize()).Intersect(bitmapRect);
+    std::vector<wxRect> missingRects;
+    bool                isScheduled = m_scheduledTilesSize == m_bitmapSize;
+
+    if ( visibleRect.IsEmpty() )
+        return;
+
+    const int firstX = visibleRect.x / ms_tileSize, lastX = visibleRect.GetRight() / ms_tileSize;
+    const int firstY = visibleRect.y / ms_tileSize, lastY = visibleRect.GetBottom() / ms_tileSize;
+
+    m_visibleTileCount = static_cast<size_t>(lastX - firstX + 1) * (lastY - firstY + 1);
+
+    for ( int y = firstY; y <= lastY; ++y )
+    {
+        for ( int x = firstX; x <= lastX; ++x )
+        {
+            const wxRect rect = wxRect(x * ms_tileSize, y * ms_tileSize, ms_tileSize, ms_tileSize).Intersect(bitmapRect);
+            wxBitmap     bitmap = GetTile(rect);
+
+            if ( !bitmap.IsOk() && !m_asyncEnabled )
+                bitmap = RasterizeTile(rect);
+
+            if ( bitmap.IsOk() )
+            {
+                dc.DrawBitmap(bitmap, rect.GetPosition(), true);
+                continue;
+            }
+
+            missingRects.push_back(rect);
+            if ( isScheduled
+                 && std::find(m_scheduledTiles.begin(), m_scheduledTiles.end(), rect) == m_scheduledTiles.end() )
+            {
+                isScheduled = false;
+            }
+        }
+    }
+
+    // reschedule only when scrolling revealed a tile not being rasterized
+    // yet, the tiles scrolled out of view are skipped then
+    if ( !missingRects.empty() && !isScheduled && m_asyncEnabled )
+        ScheduleTiles(missingRects);
+}
+
+wxBitmap wxBitmapBundlePanel::GetTile(const wxRect& rect)
+{
+    for ( std::list<Tile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it )
+    {
+        if ( it->size == m_bitmapSize && it->rect == rect )
+        {
+            m_tiles.splice(m_tiles.begin(), m_tiles, it);
+            return m_tiles.front().bitmap;
+        }
+    }
+
+    return wxBitmap();
+}
+
+wxBitmap wxBitmapBundlePanel::RasterizeTile(const wxRect& rect)
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    const BufferPtr buffer = m_asyncImpl->GetRectBuffer(m_bitmapSize, rect);
+
+    if ( !buffer )
+        return wxBitmap();
+
+    const wxBitmap bitmap(wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(*buffer, rect.GetSize()));
+
+    AddTile(m_bitmapSize, rect, bitmap);
+    return bitmap;
+#else
+    wxUnusedVar(rect);
+    return wxBitmap();
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+void wxBitmapBundlePanel::AddTile(const wxSize& size, const wxRect& rect, const wxBitmap& bitmap)
+{
+    // the same tile may be delivered by a stale job too
+    for ( std::list<Tile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it )
+    {
+        if ( it->size == size && it->rect == rect )
+        {
+            m_tiles.erase(it);
+            break;
+        }
+    }
+
+    m_tiles.push_front({ size, rect, bitmap });
+    if ( m_tiles.size() > wxMax(ms_maxTiles, m_visibleTileCount) )
+        m_tiles.pop_back();
+}
+
+void wxBitmapBundlePanel::ScheduleTiles(const std::vector<wxRect>& rects)
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    wxBitmapBundleImplSVGNanoMT* impl      = m_asyncImpl;
+    wxTestSVGRasterScheduler*    scheduler = m_scheduler.get();
+    const size_t                 bundleId  = m_bundleId;
+    const wxSize                 size      = m_bitmapSize;
+
+    // the job replaces that rasterizing the whole bitmap, if any
+    m_scheduledSize      = wxDefaultSize;
+    m_scheduledTilesSize = size;
+    m_scheduledTiles     = rects;
+
+    // see ScheduleRasterization() for the lifetime of impl
+    scheduler->Schedule([=](wxUint64 generation)
+        {
+            for ( const wxRect& rect : rects )
+            {
+                if ( !scheduler->IsCurrent(generation) )
+                    return;
+
+                const BufferPtr buffer = impl->GetRectBuffer(size, rect);
+
+                CallAfter([=] { OnTileRasterized(bundleId, size, rect, buffer); });
+            }
+        });
+#else
+    wxUnusedVar(rects);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+void wxBitmapBundlePanel::OnTileRasterized(size_t bundleId, const wxSize& size, const wxRect& rect,
+                                           const BufferPtr& buffer)
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    // a tile which could not be rasterized stays scheduled,
+    // so that it is not scheduled again with every paint
+    if ( bundleId != m_bundleId || !buffer )
+        return;
+
+    AddTile(size, rect, wxBitmap(wxBitmapBundleImplSVGNanoMT::CreateImageFromBuffer(*buffer, rect.GetSize())));
+
+    if ( size == m_scheduledTilesSize )
+    {
+        const std::vector<wxRect>::iterator it = std::find(m_scheduledTiles.begin(), m_scheduledTiles.end(), rect);
+
+        if ( it != m_scheduledTiles.end() )
+            m_scheduledTiles.erase(it);
+    }
+
+    if ( size == m_bitmapSize )
+        RefreshRect(wxRect(CalcScrolledPosition(rect.GetPosition()), rect.GetSize()));
+#else
+    wxUnusedVar(bundleId);
+    wxUnusedVar(size);
+    wxUnusedVar(rect);
+    wxUnusedVar(buffer);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+void wxBitmapBundlePanel::OnPaint(wxPaintEvent&)
+{
+    wxStopWatch stopWatch;
+
+    {
+        wxAutoBufferedPaintDC dc(this);
+        // only the visible part of the bitmap is rasterized then
+        const bool            isTiled = m_asyncImpl && m_tiledEnabled;
+        const wxBitmap        bitmap  = isTiled ? wxBitmap() : GetBitmapToPaint();
+
+        DoPrepareDC(dc);
+
+        dc.SetBackground(*wxWHITE);
+        dc.Clear();
+
+        if ( isTiled || bitmap.IsOk() )
+        {
+            wxBrush          hatchBrush(*wxBLUE, wxBRUSHSTYLE_CROSSDIAG_HATCH);
+            wxDCBrushChanger bc(dc, hatchBrush);
+            wxDCPenChanger   pc(dc, wxNullPen);
+
+            dc.DrawRectangle(wxPoint(0, 0), m_bitmapSize);
+
+            if ( isTiled )
+            {
+                PaintTiles(dc);
+            }
+            else if ( bitmap.GetSize() == m_bitmapSize )
+            {
+                dc.DrawBitmap(bitmap, 0, 0, true);
+            }
+            else // the bitmap of the right size is being rasterized
+            {
+                wxMemoryDC memDC;
+
+                memDC.SelectObjectAsSource(bitmap);
+                dc.StretchBlit(0, 0, m_bitmapSize.x, m_bitmapSize.y,
+                               &memDC, 0, 0, bitmap.GetWidth(), bitmap.GetHeight(), wxCOPY, true);
+            }
+        }
+    } // the buffered DC is blitted to the window here
+
+    const long time = stopWatch.TimeInMicro().ToLong();
+
+    m_paintTimes.count++;
+    m_paintTimes.last = time;
+    m_paintTimes.total += time;
+    if ( time > m_paintTimes.max )
+        m_paintTimes.max = time;
+    if ( time > 16667 )
+        m_paintTimes.slowCount++;
 }
 
 // ============================================================================
@@ -126,19 +564,44 @@ wxTestSVGFrame::wxTestSVGFrame()
     controlPanelSizer->Add(new wxStaticText(controlPanel, wxID_ANY, "&Bitmap Size"),
                            wxSizerFlags().CenterHorizontal().Border(wxALL & ~wxBOTTOM));
 
-    m_bitmapSizeSlider = new wxSlider(controlPanel, wxID_ANY, m_bitmapSize.x, 16, 512,
+    m_bitmapSizeSlider = new wxSlider(controlPanel, wxID_ANY, m_bitmapSize.x, 16, ms_maxBitmapSize,
                                       wxDefaultPosition, wxDefaultSize,
                                       wxSL_HORIZONTAL | wxSL_AUTOTICKS | wxSL_LABELS );
     m_bitmapSizeSlider->SetTickFreq(16);
     m_bitmapSizeSlider->Bind(wxEVT_SLIDER, &wxTestSVGFrame::OnBitmapSizeChanged, this);
     controlPanelSizer->Add(m_bitmapSizeSlider, wxSizerFlags().Expand().Border(wxALL & ~wxTOP));
 
+    // only NanoSVG bundles can be rasterized in a background thread
+    m_asyncRasterizationCheckBox = new wxCheckBox(controlPanel, wxID_ANY, "Rasterize NanoSVG in B&ackground");
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    m_asyncRasterizationCheckBox->SetValue(true);
+#else
+    m_asyncRasterizationCheckBox->Disable();
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    m_asyncRasterizationCheckBox->Bind(wxEVT_CHECKBOX, &wxTestSVGFrame::OnAsyncRasterizationChanged, this);
+    controlPanelSizer->Add(m_asyncRasterizationCheckBox, wxSizerFlags().Border());
+
+    // only NanoSVG bundles can be rasterized in tiles, which allows larger sizes
+    m_tiledRasterizationCheckBox = new wxCheckBox(controlPanel, wxID_ANY, "Rasterize NanoSVG in &Visible Tiles");
+#ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    m_tiledRasterizationCheckBox->Disable();
+#endif // #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    m_tiledRasterizationCheckBox->Bind(wxEVT_CHECKBOX, &wxTestSVGFrame::OnTiledRasterizationChanged, this);
+    controlPanelSizer->Add(m_tiledRasterizationCheckBox, wxSizerFlags().Border(wxALL & ~wxTOP));
+
     controlPanelSizer->Add(new wxStaticLine(controlPanel), wxSizerFlags().Expand().Border());
 
     wxButton* benchmarkFolderBtn = new wxButton(controlPanel, wxID_ANY, "Benchmark &Curent Folder...");
     benchmarkFolderBtn->Bind(wxEVT_BUTTON, &wxTestSVGFrame::OnBenchmarkFolder, this);
     controlPanelSizer->Add(benchmarkFolderBtn, wxSizerFlags().Expand().Border());
 
+    wxButton* buildAtlasBtn = new wxButton(controlPanel, wxID_ANY, "Build Icon A&tlas...");
+    buildAtlasBtn->Bind(wxEVT_BUTTON, &wxTestSVGFrame::OnBuildAtlas, this);
+#ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    buildAtlasBtn->Disable();
+#endif // #ifndef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    controlPanelSizer->Add(buildAtlasBtn, wxSizerFlags().Expand().Border());
+
     wxButton* changeFolderBtn = new wxButton(controlPanel, wxID_ANY, "Change &Folder...");
     changeFolderBtn->Bind(wxEVT_BUTTON, &wxTestSVGFrame::OnChangeFolder, this);
     controlPanelSizer->Add(changeFolderBtn, wxSizerFlags().Expand().Border());
@@ -184,6 +647,10 @@ wxTestSVGFrame::wxTestSVGFrame()
     splitterMain->SetSashGravity(0.3);
     splitterMain->SplitVertically(controlPanel, bitmapPanel, FromDIP(256));
 
+    CreateStatusBar(m_panelD2D ? 2 : 1);
+    m_paintTimesTimer.Bind(wxEVT_TIMER, &wxTestSVGFrame::OnUpdatePaintTimes, this);
+    m_paintTimesTimer.Start(500);
+
     if ( !m_panelD2D )
         CallAfter([] { wxLogWarning("SVG rasterization with Direct2D unavailable."); } );
 }
@@ -192,7 +659,13 @@ void wxTestSVGFrame::OnFileSelected(wxFileCtrlEvent& event)
 {
     const wxFileName fileName(event.GetDirectory(), event.GetFile());
 
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    wxBitmapBundleImplSVGNanoMT* implNano = CreateImplSVGNanoMT(fileName.GetFullPath(), m_bitmapSize);
+
+    m_panelNano->SetBitmapBundle(implNano ? wxBitmapBundle::FromImpl(implNano) : wxBitmapBundle(), implNano);
+#else
     m_panelNano->SetBitmapBundle(wxBitmapBundle::FromSVGFile(fileName.GetFullPath(), m_bitmapSize));
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
 #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_D2D
     if ( m_panelD2D )
         m_panelD2D->SetBitmapBundle(CreateFromImplSVGD2D(fileName.GetFullPath(), m_bitmapSize));
@@ -208,46 +681,53 @@ void wxTestSVGFrame::OnFileActivated(wxFileCtrlEvent& event)
    wxLaunchDefaultApplication(fileName.GetFullPath());
 }
 
-void wxTestSVGFrame::OnBenchmarkFolder(wxCommandEvent&)
+bool wxTestSVGFrame::SelectFilesAndSizes(const wxString& caption, const wxString& dirName,
+                                         wxArrayString& files, std::vector<wxSize>& sizes)
 {
 #ifndef NDEBUG
     if ( wxMessageBox("It appears you are running the debug version of the application, "
                       "which is much slower than the release one. Continue anyway?",
                       "Warning", wxYES_NO | wxNO_DEFAULT) != wxYES )
     {
-        return;
+        return false;
     }
 #endif
-    const wxString dirName = m_fileCtrl->GetDirectory();
-    wxArrayString  dirFiles;
-    wxArrayString  files;
-    wxArrayInt     selections;
+    wxTestSVGCorpus::Options corpusOptions;
+    wxArrayString            dirFiles;
+    wxArrayInt               selections;
+
+    if ( wxDir(dirName).HasSubDirs() )
+    {
+        const int answer = wxMessageBox("Include SVG files in the subfolders?", caption,
+                                        wxYES_NO | wxCANCEL | wxNO_DEFAULT, this);
+
+        if ( answer == wxCANCEL )
+            return false;
+        corpusOptions.recursive = answer == wxYES;
+    }
 
     {
         wxBusyCursor bc;
-        wxDir::GetAllFiles(dirName, &dirFiles, "*.svg", wxDIR_FILES);
+
+        if ( !wxTestSVGCorpus::FindFiles(dirName, corpusOptions, dirFiles) )
+            return false;
     }
 
     if ( dirFiles.empty() )
     {
         wxLogMessage("No SVG files found in the current folder.");
-        return;
+        return false;
     }
 
-    for ( auto& f : dirFiles )
-        f = wxFileName(f).GetFullName();
-
-    dirFiles.Sort(wxNaturalStringSortAscending);
-
     selections.reserve(dirFiles.size());
     for ( size_t i = 0; i < dirFiles.size(); ++i )
         selections.push_back(i);
 
     if ( wxGetSelectedChoices(selections, wxString::Format("Select Files (%zu files available)", dirFiles.size()),
-                              "Benchmark Rasterization", dirFiles, this) == -1
+                              caption, dirFiles, this) == -1
          || selections.empty() )
     {
-        return;
+        return false;
     }
 
     for ( const auto& s : selections )
@@ -274,8 +754,23 @@ void wxTestSVGFrame::OnBenchmarkFolder(wxCommandEvent&)
     selections.push_back(3); //48
     selections.push_back(6); //128
 
-    if ( wxGetSelectedChoices(selections, "Select Bitmap Sizes", "Benchmark Rasterization", bitmapSizesStrings, this) == -1
+    if ( wxGetSelectedChoices(selections, "Select Bitmap Sizes", caption, bitmapSizesStrings, this) == -1
          || selections.empty() )
+        return false;
+
+    for ( const auto& s : selections )
+        sizes.push_back(bitmapSizes[s]);
+
+    return true;
+}
+
+void wxTestSVGFrame::OnBenchmarkFolder(wxCommandEvent&)
+{
+    const wxString      dirName = m_fileCtrl->GetDirectory();
+    wxArrayString       files;
+    std::vector<wxSize> sizes;
+
+    if ( !SelectFilesAndSizes("Benchmark Rasterization", dirName, files, sizes) )
         return;
 
     long runCount = wxGetNumberFromUser("Number of runs (between 10 and 100)", "Number", "Benchmark Rasterization", 25, 10, 100);
@@ -285,10 +780,61 @@ void wxTestSVGFrame::OnBenchmarkFolder(wxCommandEvent&)
 
     wxTestSVGRasterizationBenchmark benchmark;
 
+    benchmark.Setup(dirName, files, sizes);
+
+    // written while benchmarking, see wxTestSVGBenchmarkReportFrame
+    const wxString detailedReportFileName = wxFileName::CreateTempFileName("wxTestSVG");
+    const std::unique_ptr<wxTestSVGReportWriter> detailedReport
+        = wxTestSVGReportWriter::Create(wxTestSVGReportWriter::Format_HTML, detailedReportFileName);
+
+    if ( !detailedReport )
+    {
+        wxRemoveFile(detailedReportFileName);
+        return;
+    }
+
+    wxString report;
+    bool result = false;
+
+    // compare all the backends available on this system, e.g., NanoSVG
+    // rasterizing into its own buffer and into wxBitmap pixels on GTK
+    const wxArrayString backendNames = wxTestSVGBackendRegistry::GetAvailableNames();
+
+    {
+        wxBusyInfo info(wxString::Format("Benchmarking %zu files at %zu sizes, please wait...", 
+            files.size(), sizes.size()), this);
+        result = benchmark.Run(backendNames, runCount, report, detailedReport.get());
+    }
+
+    if ( !detailedReport->Close() )
+    {
+        wxLogError("Couldn't write detailed report to '%s'.", detailedReportFileName);
+        result = false;
+    }
+
+    if ( result )
+        new wxTestSVGBenchmarkReportFrame(this, dirName, report, detailedReportFileName);
+    else
+        wxRemoveFile(detailedReportFileName);
+}
+
+void wxTestSVGFrame::OnBuildAtlas(wxCommandEvent&)
+{
+    // the button is disabled without NanoSVG
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    const wxString      dirName = m_fileCtrl->GetDirectory();
+    wxArrayString       files;
     std::vector<wxSize> sizes;
 
-    for ( const auto& s : selections )
-        sizes.push_back(bitmapSizes[s]);
+    if ( !SelectFilesAndSizes("Build Icon Atlas", dirName, files, sizes) )
+        return;
+
+    long runCount = wxGetNumberFromUser("Number of runs (between 1 and 100)", "Number", "Build Icon Atlas", 10, 1, 100);
+
+    if ( runCount == -1 )
+        return;
+
+    wxTestSVGRasterizationBenchmark benchmark;
 
     benchmark.Setup(dirName, files, sizes);
 
@@ -296,13 +842,24 @@ void wxTestSVGFrame::OnBenchmarkFolder(wxCommandEvent&)
     bool result = false;
 
     {
-        wxBusyInfo info(wxString::Format("Benchmarking %zu files at %zu sizes, please wait...", 
+        wxBusyInfo info(wxString::Format("Building atlas of %zu files at %zu sizes, please wait...",
             files.size(), sizes.size()), this);
-        result = benchmark.Run(m_panelD2D != nullptr, runCount, report, detailedReport);
+        result = benchmark.RunAtlas(0, runCount, report, detailedReport);
     }
 
-    if ( result )
-        new wxTestSVGBenchmarkReportFrame(this, dirName, report, detailedReport);
+    if ( !result )
+        return;
+
+    const wxString detailedReportFileName = wxTestSVGBenchmarkReportFrame::WriteTempHTMLReport(detailedReport);
+
+    if ( detailedReportFileName.empty() )
+    {
+        wxLogError("Couldn't write detailed report to a temporary file.");
+        return;
+    }
+
+    new wxTestSVGBenchmarkReportFrame(this, dirName, report, detailedReportFileName);
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
 }
 
 void wxTestSVGFrame::OnChangeFolder(wxCommandEvent&)
@@ -313,11 +870,66 @@ void wxTestSVGFrame::OnChangeFolder(wxCommandEvent&)
         m_fileCtrl->SetDirectory(dir);
 }
 
-void wxTestSVGFrame::OnBitmapSizeChanged(wxCommandEvent& event)
+void wxTestSVGFrame::SetBitmapSize(const wxSize& size)
 {
-    m_bitmapSize = wxSize(event.GetInt(), event.GetInt());
+    m_bitmapSize = size;
 
     m_panelNano->SetBitmapSize(m_bitmapSize);
+    // Direct2D bitmap is always rasterized whole
+    if ( m_panelD2D )
+        m_panelD2D->SetBitmapSize(wxSize(wxMin(m_bitmapSize.x, ms_maxBitmapSize),
+                                         wxMin(m_bitmapSize.y, ms_maxBitmapSize)));
+}
+
+void wxTestSVGFrame::OnBitmapSizeChanged(wxCommandEvent& event)
+{
+    SetBitmapSize(wxSize(event.GetInt(), event.GetInt()));
+}
+
+void wxTestSVGFrame::OnAsyncRasterizationChanged(wxCommandEvent& event)
+{
+    // start measuring anew, so that the times for the synchronous
+    // and asynchronous rasterization can be compared
+    m_panelNano->EnableAsyncRasterization(event.IsChecked());
+    m_panelNano->ResetPaintTimes();
+    if ( m_panelD2D )
+        m_panelD2D->ResetPaintTimes();
+}
+
+void wxTestSVGFrame::OnTiledRasterizationChanged(wxCommandEvent& event)
+{
+    const bool isTiled = event.IsChecked();
+    const int  maxSize = isTiled ? ms_maxTiledBitmapSize : ms_maxBitmapSize;
+
+    m_bitmapSizeSlider->SetRange(m_bitmapSizeSlider->GetMin(), maxSize);
+    m_bitmapSizeSlider->SetTickFreq(isTiled ? 256 : 16);
+    if ( m_bitmapSizeSlider->GetValue() > maxSize )
+        m_bitmapSizeSlider->SetValue(maxSize);
+
+    m_panelNano->EnableTiledRasterization(isTiled);
+    if ( m_bitmapSizeSlider->GetValue() != m_bitmapSize.x )
+        SetBitmapSize(wxSize(m_bitmapSizeSlider->GetValue(), m_bitmapSizeSlider->GetValue()));
+
+    m_panelNano->ResetPaintTimes();
+    if ( m_panelD2D )
+        m_panelD2D->ResetPaintTimes();
+}
+
+void wxTestSVGFrame::OnUpdatePaintTimes(wxTimerEvent&)
+{
+    const auto formatPaintTimes = [](const wxString& name, const wxBitmapBundlePanel* panel) -> wxString
+    {
+        const wxBitmapBundlePanel::PaintTimes& times = panel->GetPaintTimes();
+
+        if ( times.count == 0 )
+            return wxString::Format("%s: not painted yet", name);
+
+        return wxString::Format("%s paint (ms): last %.1f, avg %.1f, max %.1f, over 16.7 ms %zu of %zu, skipped rasterizations %zu",
+            name, times.last / 1000., times.total.ToDouble() / times.count / 1000., times.max / 1000.,
+            times.slowCount, times.count, panel->GetSkippedRasterizationCount());
+    };
+
+    SetStatusText(formatPaintTimes("NanoSVG", m_panelNano), 0);
     if ( m_panelD2D )
-        m_panelD2D->SetBitmapSize(m_bitmapSize);
+        SetStatusText(formatPaintTimes("Direct2D", m_panelD2D), 1);
 }
\ No newline at end of file
@@ -10,7 +10,10 @@
 #ifndef TEST_SVG_FRAME_H_DEFINED
 #define TEST_SVG_FRAME_H_DEFINED
 
+#include <vector>
+
 #include <wx/wx.h>
+#include <wx/timer.h>
 
 class wxFileCtrl;
 class wxFileCtrlEvent;
@@ -22,18 +25,39 @@ class wxTestSVGFrame : public wxFrame
 public:
     wxTestSVGFrame();
 private:
+    // the maximum bitmap size when rasterizing the whole bitmap
+    // and when rasterizing only its visible tiles
+    static const int     ms_maxBitmapSize = 512;
+    static const int     ms_maxTiledBitmapSize = 8192;
+
     wxSize               m_bitmapSize{128, 128};
 
     wxSlider*            m_bitmapSizeSlider{nullptr};
+    wxCheckBox*          m_asyncRasterizationCheckBox{nullptr};
+    wxCheckBox*          m_tiledRasterizationCheckBox{nullptr};
     wxFileCtrl*          m_fileCtrl{nullptr};
     wxBitmapBundlePanel* m_panelNano{nullptr};
     wxBitmapBundlePanel* m_panelD2D{nullptr};
 
+    // updates the paint times shown in the status bar
+    wxTimer              m_paintTimesTimer;
+
+    // asks the user to select the files from dirName and the bitmap sizes
+    bool SelectFilesAndSizes(const wxString& caption, const wxString& dirName,
+                             wxArrayString& files, std::vector<wxSize>& sizes);
+
+    // sets the size of the bitmaps in the panels
+    void SetBitmapSize(const wxSize& size);
+
     void OnBenchmarkFolder(wxCommandEvent&);
+    void OnBuildAtlas(wxCommandEvent&);
     void OnChangeFolder(wxCommandEvent&);
     void OnFileSelected(wxFileCtrlEvent& event);
     void OnFileActivated(wxFileCtrlEvent& event);
     void OnBitmapSizeChanged(wxCommandEvent& event);
+    void OnAsyncRasterizationChanged(wxCommandEvent& event);
+    void OnTiledRasterizationChanged(wxCommandEvent& event);
+    void OnUpdatePaintTimes(wxTimerEvent&);
 };
 
 #endif // #ifndef TEST_SVG_FRAME_H_DEFINED
\ No newline at end of file
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgmetrics.cpp
+// Purpose:     Structural complexity of SVG documents and modelling its cost
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "bmpbndl_svg_nano.h"
+
+#include "svgmetrics.h"
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// only the declarations, NanoSVG is implemented in bmpbndl_svg_nano.cpp
+#include <nanosvg.h>
+
+namespace
+{
+
+// the same as NSVGrasterizer uses
+const float TessellationTolerance = 0.25f;
+const int   MaxSubdivisionLevel   = 10;
+
+// Returns the number of points nsvg__flattenCubicBez() adds for the segment,
+// the recursion and the flatness test must stay the same as there
+size_t CountFlattenedCubicPoints(float x1, float y1, float x2, float y2,
+                                 float x3, float y3, float x4, float y4, int level)
+{
+    if ( level > MaxSubdivisionLevel )
+        return 0;
+
+    const float dx = x4 - x1;
+    const float dy = y4 - y1;
+    const float d2 = std::fabs((x2 - x4) * dy - (y2 - y4) * dx);
+    const float d3 = std::fabs((x3 - x4) * dy - (y3 - y4) * dx);
+
+    if ( (d2 + d3) * (d2 + d3) < TessellationTolerance * (dx * dx + dy * dy) )
+        return 1;
+
+    const float x12   = (x1 + x2) * 0.5f,     y12   = (y1 + y2) * 0.5f;
+    const float x23   = (x2 + x3) * 0.5f,     y23   = (y2 + y3) * 0.5f;
+    const float x34   = (x3 + x4) * 0.5f,     y34   = (y3 + y4) * 0.5f;
+    const float x123  = (x12 + x23) * 0.5f,   y123  = (y12 + y23) * 0.5f;
+    const float x234  = (x23 + x34) * 0.5f,   y234  = (y23 + y34) * 0.5f;
+    const float x1234 = (x123 + x234) * 0.5f, y1234 = (y123 + y234) * 0.5f;
+
+    return CountFlattenedCubicPoints(x1, y1, x12, y12, x123, y123, x1234, y1234, level + 1)
+         + CountFlattenedCubicPoints(x1234, y1234, x234, y234, x34, y34, x4, y4, level + 1);
+}
+
+// Returns the number of edges of the path flattened at the scale, the same
+// as of its points, as the rasterizer closes the polygon
+size_t CountFlattenedPathEdges(const NSVGpath* path, float scale)
+{
+    const float* p     = path->pts;
+    size_t       count = 1;
+
+    for ( int i = 0; i + 3 < path->npts; i += 3, p += 6 )
+    {
+        count += CountFlattenedCubicPoints(p[0] * scale, p[1] * scale, p[2] * scale, p[3] * scale,
+                                           p[4] * scale, p[5] * scale, p[6] * scale, p[7] * scale, 0);
+    }
+
+    return count;
+}
+
+bool IsGradient(const NSVGpaint& paint)
+{
+    return paint.type == NSVG_PAINT_LINEAR_GRADIENT || paint.type == NSVG_PAINT_RADIAL_GRADIENT;
+}
+
+} // anonymous namespace
+
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+
+// ============================================================================
+// wxTestSVGDocumentMetrics
+// ============================================================================
+
+// static
+bool wxTestSVGDocumentMetrics::IsAvailable()
+{
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    return true;
+#else
+    return false;
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+bool wxTestSVGDocumentMetrics::Calculate(const char* data, const std::vector<wxSize>& sizes)
+{
+    *this = wxTestSVGDocumentMetrics();
+
+#ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+    wxCHECK(data, false);
+
+    // NanoSVG modifies the data while parsing it, so we need a copy
+    wxCharBuffer dataCopy(data);
+    NSVGimage*   image = nsvgParse(dataCopy.data(), "px", 96);
+
+    if ( !image )
+        return false;
+
+    if ( image->width <= 0 || image->height <= 0 )
+    {
+        nsvgDelete(image);
+        return false;
+    }
+
+    std::vector<float> scales;
+    double             bboxArea = 0;
+
+    // the same scale as RasterizeNSVGImage() uses
+    for ( const auto& size : sizes )
+        scales.push_back(wxMin(size.x / image->width, size.y / image->height));
+    edgeCounts.assign(sizes.size(), 0);
+
+    for ( const NSVGshape* shape = image->shapes; shape; shape = shape->next )
+    {
+        if ( !(shape->flags & NSVG_FLAGS_VISIBLE) )
+            continue;
+
+        const bool isFilled  = shape->fill.type != NSVG_PAINT_NONE;
+        const bool isStroked = shape->stroke.type != NSVG_PAINT_NONE && shape->strokeWidth > 0;
+
+        ++shapeCount;
+        if ( isFilled )
+            ++fillCount;
+        if ( isStroked )
+            ++strokeCount;
+        if ( IsGradient(shape->fill) )
+            ++gradientCount;
+        if ( IsGradient(shape->stroke) )
+            ++gradientCount;
+
+        const double left   = wxMax(shape->bounds[0], 0.0f);
+        const double top    = wxMax(shape->bounds[1], 0.0f);
+        const double right  = wxMin(shape->bounds[2], image->width);
+        const double bottom = wxMin(shape->bounds[3], image->height);
+
+        if ( right > left && bottom > top )
+            bboxArea += (right - left) * (bottom - top);
+
+        for ( const NSVGpath* path = shape->paths; path; path = path->next )
+        {
+            ++pathCount;
+            if ( path->npts > 1 )
+                cubicCount += (path->npts - 1) / 3;
+
+            for ( size_t s = 0; s < scales.size(); ++s )
+            {
+                const size_t pathEdges = CountFlattenedPathEdges(path, scales[s]);
+
+                if ( isFilled )
+                    edgeCounts[s] += pathEdges;
+                if ( isStroked )
+                    edgeCounts[s] += 2 * pathEdges;
+            }
+        }
+    }
+
+    bboxCoverage = bboxArea / (static_cast<double>(image->width) * image->height);
+
+    nsvgDelete(image);
+    return true;
+#else
+    wxUnusedVar(data);
+    wxUnusedVar(sizes);
+    return false;
+#endif // #ifdef wxHAS_BMPBUNDLE_IMPL_SVG_NANO
+}
+
+double wxTestSVGDocumentMetrics::GetStrokeShare() const
+{
+    const size_t paintCount = fillCount + strokeCount;
+
+    return paintCount ? static_cast<double>(strokeCount) / paintCount : 0;
+}
+
+// ============================================================================
+// wxTestSVGTimeModel
+// ============================================================================
+
+bool wxTestSVGTimeModel::Fit(const VectorSamples& samples)
+{
+    *this = wxTestSVGTimeModel();
+
+    if ( samples.size() < 2 )
+        return false;
+
+    const double n = static_cast<double>(samples.size());
+    double       meanEdges = 0, meanPixels = 0, meanTime = 0;
+
+    for ( const auto& s : samples )
+    {
+        meanEdges  += s.edges;
+        meanPixels += s.pixels;
+        meanTime   += s.time;
+    }
+    meanEdges  /= n;
+    meanPixels /= n;
+    meanTime   /= n;
+
+    // the centered sums of squares and products,
+    // so that the intercept drops out of the normal equations
+    double see = 0, spp = 0, sep = 0, set = 0, spt = 0, stt = 0;
+
+    for ( const auto& s : samples )
+    {
+        const double e = s.edges - meanEdges;
+        const double p = s.pixels - meanPixels;
+        const double t = s.time - meanTime;
+
+        see += e * e;
+        spp += p * p;
+        sep += e * p;
+        set += e * t;
+        spt += p * t;
+        stt += t * t;
+    }
+
+    // relative to the variances, so that it does not depend on the units
+    const double det = see * spp - sep * sep;
+
+    if ( see > 0 && spp > 0 && det > 1e-9 * see * spp )
+    {
+        m_perEdge  = (set * spp - spt * sep) / det;
+        m_perPixel = (spt * see - set * sep) / det;
+    }
+    else if ( see > 0 )
+    {
+        m_perEdge = set / see;
+    }
+    else if ( spp > 0 )
+    {
+        m_perPixel = spt / spp;
+    }
+
+    m_intercept   = meanTime - m_perEdge * meanEdges - m_perPixel * meanPixels;
+    m_sampleCount = samples.size();
+
+    double residualSquares = 0;
+
+    for ( const auto& s : samples )
+    {
+        const double r = s.time - Predict(s.edges, s.pixels);
+
+        residualSquares += r * r;
+    }
+    m_rSquared = stt > 0 ? 1 - residualSquares / stt : 1;
+
+    return true;
+}
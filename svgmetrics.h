@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgmetrics.h
+// Purpose:     Structural complexity of SVG documents and modelling its cost
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_METRICS_H_DEFINED
+#define TEST_SVG_METRICS_H_DEFINED
+
+#include <vector>
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGDocumentMetrics
+// ============================================================================
+
+/*
+    Structural metrics of an SVG document parsed with NanoSVG, which tell
+    why rasterizing one file costs much more than another.
+
+    The flattened edges are what the NanoSVG scanline rasterizer actually
+    processes: the cubic segments subdivided with its tolerance at the scale
+    of each bitmap size, so their number grows with the size. The edges of
+    a stroke are estimated as twice those of its flattened centerline,
+    i.e., ignoring the joins, caps, and dashes.
+
+    Requires NanoSVG headers, otherwise Calculate() always returns false.
+ */
+
+struct wxTestSVGDocumentMetrics
+{
+    size_t shapeCount{0};    // visible shapes
+    size_t pathCount{0};     // of the visible shapes
+    size_t cubicCount{0};    // cubic Bezier segments, NanoSVG converts everything to them
+    size_t gradientCount{0}; // linear and radial gradient fills and strokes
+    size_t fillCount{0};     // shapes with a fill
+    size_t strokeCount{0};   // shapes with a stroke
+    // the sum of the shape bounding boxes clipped to the document,
+    // relative to its area, i.e., roughly how many times each pixel is painted
+    double bboxCoverage{0};
+    // for each bitmap size given to Calculate()
+    std::vector<size_t> edgeCounts;
+
+    // returns true if the metrics can be calculated, i.e., NanoSVG headers are available
+    static bool IsAvailable();
+
+    // data must be 0 terminated, returns false if it could not be parsed
+    bool Calculate(const char* data, const std::vector<wxSize>& sizes);
+
+    // stroked shapes relative to all the painted fills and strokes, between 0 and 1
+    double GetStrokeShare() const;
+};
+
+// ============================================================================
+// wxTestSVGTimeModel
+// ============================================================================
+
+/*
+    Linear model of the time to get a bitmap: time = a + b * edges + c * pixels,
+    fitted by ordinary least squares to the samples of all files and sizes.
+
+    When one of the regressors does not vary, e.g., pixels with only one
+    bitmap size, or both are collinear, the model falls back to the other one
+    and its coefficient is 0.
+ */
+
+class wxTestSVGTimeModel
+{
+public:
+    struct Sample
+    {
+        double edges{0};
+        double pixels{0};
+        double time{0};
+    };
+    typedef std::vector<Sample> VectorSamples;
+
+    // returns false if there are fewer than 2 samples
+    bool Fit(const VectorSamples& samples);
+
+    double Predict(double edges, double pixels) const
+    {
+        return m_intercept + m_perEdge * edges + m_perPixel * pixels;
+    }
+
+    double GetIntercept() const { return m_intercept; }
+    double GetPerEdge() const { return m_perEdge; }
+    double GetPerPixel() const { return m_perPixel; }
+    // coefficient of determination, 1 if the model explains all the variance
+    double GetRSquared() const { return m_rSquared; }
+    size_t GetSampleCount() const { return m_sampleCount; }
+
+private:
+    double m_intercept{0};
+    double m_perEdge{0};
+    double m_perPixel{0};
+    double m_rSquared{0};
+    size_t m_sampleCount{0};
+};
+
+#endif // #ifndef TEST_SVG_METRICS_H_DEFINED
@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgperfcounters.cpp
+// Purpose:     Hardware performance counters of the calling thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cerrno>
+
+#include "svgperfcounters.h"
+
+#ifdef wxHAS_TEST_SVG_PERF_COUNTERS
+
+#include <cstring>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+// there is no glibc wrapper for perf_event_open()
+int PerfEventOpen(perf_event_attr* attr, int groupFd)
+{
+    // the calling thread on any CPU
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, 0, -1, groupFd, 0UL));
+}
+
+// sets the type and config of attr
+void SetCounterAttr(wxTestSVGPerfCounters::Counter counter, perf_event_attr& attr)
+{
+    const wxUint64 cacheReadMiss = (static_cast<wxUint64>(PERF_COUNT_HW_CACHE_OP_READ) << 8)
+                                   | (static_cast<wxUint64>(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+
+    switch ( counter )
+    {
+        case wxTestSVGPerfCounters::Counter_Cycles:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            return;
+        case wxTestSVGPerfCounters::Counter_Instructions:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            return;
+        case wxTestSVGPerfCounters::Counter_BranchMisses:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            return;
+        case wxTestSVGPerfCounters::Counter_L1DMisses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | cacheReadMiss;
+            return;
+        case wxTestSVGPerfCounters::Counter_LLCMisses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | cacheReadMiss;
+            return;
+        case wxTestSVGPerfCounters::Counter_PageFaults:
+            attr.type   = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+            return;
+        case wxTestSVGPerfCounters::Counter_Max:
+            break;
+    }
+
+    wxFAIL_MSG("invalid counter");
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGPerfCounters
+// ============================================================================
+
+bool wxTestSVGPerfCounters::Open()
+{
+    Close();
+
+    for ( size_t c = 0; c < Counter_Max; ++c )
+    {
+        perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        SetCounterAttr(static_cast<Counter>(c), attr);
+        // the whole group is enabled and disabled through its leader
+        attr.disabled       = m_groupFd == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+                              | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int fd = PerfEventOpen(&attr, m_groupFd);
+
+        if ( fd == -1 )
+        {
+            // e.g., EACCES when not allowed, ENOENT when the CPU has no such counter
+            if ( !m_error )
+                m_error = errno;
+            continue;
+        }
+
+        wxUint64 id = 0;
+
+        if ( ioctl(fd, PERF_EVENT_IOC_ID, &id) == -1 )
+        {
+            if ( !m_error )
+                m_error = errno;
+            close(fd);
+            continue;
+        }
+
+        m_fds[c] = fd;
+        m_ids[c] = id;
+        if ( m_groupFd == -1 )
+            m_groupFd = fd;
+    }
+
+    return IsOpened();
+}
+
+void wxTestSVGPerfCounters::Close()
+{
+    // the group members must be closed before the leader
+    for ( size_t c = Counter_Max; c > 0; --c )
+    {
+        int& fd = m_fds[c - 1];
+
+        if ( fd != -1 && fd != m_groupFd )
+            close(fd);
+        fd = -1;
+    }
+
+    if ( m_groupFd != -1 )
+        close(m_groupFd);
+
+    m_groupFd = -1;
+    m_error   = 0;
+}
+
+void wxTestSVGPerfCounters::Start()
+{
+    if ( !IsOpened() )
+        return;
+
+    ioctl(m_groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+bool wxTestSVGPerfCounters::Stop(Values& values)
+{
+    values.fill(0);
+
+    if ( !IsOpened() )
+        return false;
+
+    ioctl(m_groupFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // nr, time_enabled, time_running, and then value and id for each counter
+    std::vector<wxUint64> data(3 + 2 * Counter_Max);
+    const ssize_t         bytesRead = read(m_groupFd, data.data(), data.size() * sizeof(wxUint64));
+
+    if ( bytesRead < static_cast<ssize_t>(3 * sizeof(wxUint64)) )
+        return false;
+
+    const wxUint64 count       = wxMin(data[0], static_cast<wxUint64>(Counter_Max));
+    const wxUint64 timeEnabled = data[1];
+    const wxUint64 timeRunning = data[2];
+
+    if ( timeRunning == 0 )
+        return false; // the counters were never scheduled
+
+    // not 1 when the counters had to be multiplexed
+    const double scale = static_cast<double>(timeEnabled) / timeRunning;
+
+    for ( wxUint64 i = 0; i < count; ++i )
+    {
+        const wxUint64 value = data[3 + 2 * i];
+        const wxUint64 id    = data[3 + 2 * i + 1];
+
+        for ( size_t c = 0; c < Counter_Max; ++c )
+        {
+            if ( m_fds[c] != -1 && m_ids[c] == id )
+            {
+                values[c] = value * scale;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+#else // !wxHAS_TEST_SVG_PERF_COUNTERS
+
+bool wxTestSVGPerfCounters::Open()
+{
+    m_error = ENOSYS;
+    return false;
+}
+
+void wxTestSVGPerfCounters::Close()
+{
+}
+
+void wxTestSVGPerfCounters::Start()
+{
+}
+
+bool wxTestSVGPerfCounters::Stop(Values& values)
+{
+    values.fill(0);
+    return false;
+}
+
+#endif // #ifdef wxHAS_TEST_SVG_PERF_COUNTERS
+
+// static
+const char* wxTestSVGPerfCounters::GetCounterName(Counter counter)
+{
+    switch ( counter )
+    {
+        case Counter_Cycles:       return "Cycles";
+        case Counter_Instructions: return "Instructions";
+        case Counter_BranchMisses: return "Branch Misses";
+        case Counter_L1DMisses:    return "L1D Misses";
+        case Counter_LLCMisses:    return "LLC Misses";
+        case Counter_PageFaults:   return "Page Faults";
+        case Counter_Max:          break;
+    }
+
+    wxFAIL_MSG("invalid counter");
+    return "";
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgperfcounters.h
+// Purpose:     Hardware performance counters of the calling thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_PERF_COUNTERS_H_DEFINED
+#define TEST_SVG_PERF_COUNTERS_H_DEFINED
+
+#include <array>
+
+#include <wx/wx.h>
+
+#ifdef __LINUX__
+    #define wxHAS_TEST_SVG_PERF_COUNTERS
+#endif // #ifdef __LINUX__
+
+// ============================================================================
+// wxTestSVGPerfCounters
+// ============================================================================
+
+/*
+    Counts hardware events (cycles, instructions, cache misses...) of
+    the calling thread between Start() and Stop(), in the user space only.
+
+    It is available only on Linux, where it uses perf_event_open() with all
+    the counters in one group, so that they are all counting at the same time.
+    The kernel may not allow it (see /proc/sys/kernel/perf_event_paranoid)
+    or the CPU (e.g., in a virtual machine) may not have some of the counters:
+    Open() fails only when none of the counters can be opened, the counters
+    which could not be opened are just not available. If the kernel had to
+    multiplex the counters, the values are scaled to the time they were
+    enabled for.
+ */
+
+class wxTestSVGPerfCounters
+{
+public:
+    enum Counter
+    {
+        Counter_Cycles = 0,
+        Counter_Instructions,
+        Counter_BranchMisses,
+        Counter_L1DMisses,  // L1 data cache read misses
+        Counter_LLCMisses,  // last level cache read misses
+        Counter_PageFaults,
+
+        Counter_Max
+    };
+
+    typedef std::array<double, Counter_Max> Values;
+
+    wxTestSVGPerfCounters() {}
+    ~wxTestSVGPerfCounters() { Close(); }
+
+    // returns false if no counter could be opened,
+    // GetError() then returns errno of the first failure
+    bool Open();
+    void Close();
+
+    bool IsOpened() const { return m_groupFd != -1; }
+    bool IsAvailable(Counter counter) const { return m_fds[counter] != -1; }
+    int  GetError() const { return m_error; }
+
+    // the counters must be used by the same thread which opened them
+    void Start();
+    // the values of the counters not available are 0
+    bool Stop(Values& values);
+
+    static const char* GetCounterName(Counter counter);
+
+private:
+    int                               m_groupFd{-1};
+    std::array<int, Counter_Max>      m_fds{{-1, -1, -1, -1, -1, -1}};
+    std::array<wxUint64, Counter_Max> m_ids{{0, 0, 0, 0, 0, 0}};
+    int                               m_error{0};
+
+    wxDECLARE_NO_COPY_CLASS(wxTestSVGPerfCounters);
+};
+
+#endif // #ifndef TEST_SVG_PERF_COUNTERS_H_DEFINED
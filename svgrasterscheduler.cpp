@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgrasterscheduler.cpp
+// Purpose:     Runs the latest rasterization job in a background thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include "svgrasterscheduler.h"
+
+// ============================================================================
+// wxTestSVGRasterScheduler
+// ============================================================================
+
+wxTestSVGRasterScheduler::wxTestSVGRasterScheduler()
+{
+    m_thread = std::thread(&wxTestSVGRasterScheduler::ThreadMain, this);
+}
+
+wxTestSVGRasterScheduler::~wxTestSVGRasterScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_job = Job();
+        ++m_generation;
+        m_stop = true;
+    }
+    m_jobAvailable.notify_one();
+
+    m_thread.join();
+}
+
+wxUint64 wxTestSVGRasterScheduler::Schedule(const Job& job)
+{
+    wxCHECK(job, 0);
+
+    wxUint64 generation;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if ( m_job )
+            ++m_supersededCount;
+
+        generation      = ++m_generation;
+        m_job           = job;
+        m_jobGeneration = generation;
+    }
+    m_jobAvailable.notify_one();
+
+    return generation;
+}
+
+void wxTestSVGRasterScheduler::CancelAndWait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_job = Job();
+    ++m_generation;
+
+    m_jobDone.wait(lock, [this] { return !m_running; });
+}
+
+size_t wxTestSVGRasterScheduler::GetSupersededCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_supersededCount;
+}
+
+void wxTestSVGRasterScheduler::ThreadMain()
+{
+    for ( ;; )
+    {
+        Job      job;
+        wxUint64 generation;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_jobAvailable.wait(lock, [this] { return m_stop || m_job; });
+
+            if ( m_stop )
+                return;
+
+            job        = std::move(m_job);
+            generation = m_jobGeneration;
+            m_job      = Job();
+            m_running  = true;
+        }
+
+        job(generation);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_running = false;
+        }
+        m_jobDone.notify_all();
+    }
+}
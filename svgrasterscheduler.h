@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgrasterscheduler.h
+// Purpose:     Runs the latest rasterization job in a background thread
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_RASTER_SCHEDULER_H_DEFINED
+#define TEST_SVG_RASTER_SCHEDULER_H_DEFINED
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGRasterScheduler
+// ============================================================================
+
+/*
+    Runs jobs one at a time in its own thread, but only the most recently
+    scheduled one matters: scheduling a job replaces the job waiting to be run
+    and makes the running one stale. A running job cannot be interrupted,
+    so it should check IsCurrent() with its generation before doing anything
+    expensive or publishing its result.
+
+    E.g., when the user drags a slider changing the bitmap size, only
+    the bitmap for the last size is rasterized once the current
+    rasterization finishes, all the sizes in between are skipped.
+ */
+
+class wxTestSVGRasterScheduler
+{
+public:
+    // generation identifies the job, see IsCurrent()
+    typedef std::function<void(wxUint64 generation)> Job;
+
+    wxTestSVGRasterScheduler();
+    // cancels the waiting job and waits for the running one
+    ~wxTestSVGRasterScheduler();
+
+    // returns the generation of the scheduled job
+    wxUint64 Schedule(const Job& job);
+
+    // cancels the waiting job, makes the running one stale and
+    // waits for it to finish
+    void CancelAndWait();
+
+    // whether the job of this generation was not superseded or cancelled;
+    // can be called from any thread
+    bool IsCurrent(wxUint64 generation) const { return generation == m_generation; }
+
+    // number of jobs replaced before they started
+    size_t GetSupersededCount() const;
+
+private:
+    std::thread             m_thread;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobDone;
+
+    Job                     m_job;
+    wxUint64                m_jobGeneration{0};
+    bool                    m_running{false};
+    bool                    m_stop{false};
+    size_t                  m_supersededCount{0};
+
+    std::atomic<wxUint64>   m_generation{0};
+
+    void ThreadMain();
+
+    wxDECLARE_NO_COPY_CLASS(wxTestSVGRasterScheduler);
+};
+
+#endif // #ifndef TEST_SVG_RASTER_SCHEDULER_H_DEFINED
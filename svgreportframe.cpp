@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgreportframe.cpp
+// Purpose:     wxFrame displaying results of SVG rasterization benchmark
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/webview.h>
+
+#include "svgreportframe.h"
+
+// ============================================================================
+// wxTestSVGBenchmarkReportFrame
+// ============================================================================
+
+wxTestSVGBenchmarkReportFrame::wxTestSVGBenchmarkReportFrame(wxWindow* parent,
+                    const wxString& dirName,
+                    const wxString& report,
+                    const wxString& detailedReportFileName)
+    : wxFrame(parent, wxID_ANY, "Benchmark Report"),
+      m_dirName(dirName), m_report(report), m_detailedReportFileName(detailedReportFileName)
+{
+    m_defaultName = "wxTestSVG Benchmark - " + dirName.AfterLast(wxFileName::GetPathSeparator());
+
+    wxMenu* menuFile = new wxMenu;
+
+    menuFile->Append(wxID_SAVEAS);
+    menuFile->Append(ID_SAVE_DETAILED, "Save &Detailed Report...");
+
+    Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveReport, this, wxID_SAVEAS);
+    Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveDetailedReport, this, ID_SAVE_DETAILED);
+
+    wxMenuBar* menuBar = new wxMenuBar();
+
+    menuBar->Append(menuFile, "&Report");
+    SetMenuBar(menuBar);
+
+    wxWebView* webView = wxWebView::New(this, wxID_ANY);
+    webView->SetPage(report, wxWebViewDefaultURLStr);
+
+    SetMinClientSize(FromDIP(wxSize(800, 600)));
+    Show();
+}
+
+wxTestSVGBenchmarkReportFrame::~wxTestSVGBenchmarkReportFrame()
+{
+    wxRemoveFile(m_detailedReportFileName);
+}
+
+// static
+wxString wxTestSVGBenchmarkReportFrame::WriteTempHTMLReport(const wxString& reportText)
+{
+    const wxString fileName = wxFileName::CreateTempFileName("wxTestSVG");
+
+    if ( fileName.empty() )
+        return wxString();
+
+    if ( !WriteHTMLReport(fileName, reportText) )
+    {
+        wxRemoveFile(fileName);
+        return wxString();
+    }
+
+    return fileName;
+}
+
+void wxTestSVGBenchmarkReportFrame::OnSaveReport(wxCommandEvent&)
+{
+    const wxString fileName = wxFileSelector("Select file name",
+        m_dirName, m_defaultName, "html", "HTML files (*.html)|*.html",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+
+    if ( fileName.empty() )
+        return;
+
+    WriteHTMLReport(fileName, m_report);
+}
+
+void wxTestSVGBenchmarkReportFrame::OnSaveDetailedReport(wxCommandEvent&)
+{
+    const wxString fileName = wxFileSelector("Select file name",
+        m_dirName, m_defaultName + "_details", "html", "HTML files (*.html)|*.html",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+
+    if ( fileName.empty() )
+        return;
+
+    wxCopyFile(m_detailedReportFileName, fileName);
+}
+
+bool wxTestSVGBenchmarkReportFrame::WriteHTMLReport(const wxString& fileName, const wxString& reportText)
+{
+    wxFFile reportFile(fileName, "w");
+
+    if ( !reportFile.IsOpened() )
+        return false;
+
+    return reportFile.Write(reportText, wxConvUTF8);
+}
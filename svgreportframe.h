@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgreportframe.h
+// Purpose:     wxFrame displaying results of SVG rasterization benchmark
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_REPORT_FRAME_H_DEFINED
+#define TEST_SVG_REPORT_FRAME_H_DEFINED
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGBenchmarkReportFrame
+// ============================================================================
+
+class wxTestSVGBenchmarkReportFrame: public wxFrame
+{
+public:
+    // the detailed report can be huge, so it is not kept in memory but
+    // in a temporary HTML file, which is deleted with the frame
+    wxTestSVGBenchmarkReportFrame(wxWindow* parent, const wxString& dirName,
+                                  const wxString& report, const wxString& detailedReportFileName);
+    ~wxTestSVGBenchmarkReportFrame();
+
+    // returns an empty string if the file could not be created or written
+    static wxString WriteTempHTMLReport(const wxString& reportText);
+private:
+    enum
+    {
+        ID_SAVE_DETAILED = wxID_HIGHEST + 1
+    };
+
+    wxString m_dirName;
+    wxString m_defaultName;
+    wxString m_report, m_detailedReportFileName;
+
+    void OnSaveReport(wxCommandEvent&);
+    void OnSaveDetailedReport(wxCommandEvent&);
+
+    static bool WriteHTMLReport(const wxString& fileName, const wxString& reportText);
+};
+
+#endif // #ifndef TEST_SVG_REPORT_FRAME_H_DEFINED
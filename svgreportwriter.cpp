@@ -0,0 +1,486 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgreportwriter.cpp
+// Purpose:     Writing benchmark reports row by row as HTML, TSV, CSV, or JSON
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+
+#include <wx/filename.h>
+
+#include "svgreportwriter.h"
+
+namespace
+{
+
+// ============================================================================
+// wxTestSVGHTMLReportWriter
+// ============================================================================
+
+class wxTestSVGHTMLReportWriter : public wxTestSVGReportWriter
+{
+protected:
+    virtual void DoBeginDocument(const wxString& title) wxOVERRIDE
+    {
+        wxString str;
+
+        str = R"(<!DOCTYPE html><html><head><meta charset="UTF-8">)";
+        str += wxString::Format("<title>%s</title>", EscapeHTML(title));
+        str += "<style>";
+        str += "table, th, td {border: 1px solid black; border-collapse: collapse} td {text-align: right}";
+        str += "body {font-family: Verdana, Arial, Helvetica, sans-serif}";
+        str += "</style></head><body>\n";
+        str += wxString::Format("<h3>%s</h3>\n", EscapeHTML(title));
+        Write(str);
+    }
+
+    virtual void DoEndDocument() wxOVERRIDE
+    {
+        Write("</body></html>\n");
+    }
+
+    virtual void DoAddParagraph(const wxString& text) wxOVERRIDE
+    {
+        Write(wxString::Format("<p>%s</p>\n", EscapeHTML(text)));
+    }
+
+    virtual void DoBeginTable(const wxString& name) wxOVERRIDE
+    {
+        const VectorColumns& columns    = GetColumns();
+        size_t               levelCount = 0;
+        wxString             str;
+
+        for ( const auto& c : columns )
+            levelCount = wxMax(levelCount, c.labels.size());
+
+        if ( !name.empty() )
+            str += wxString::Format("<h4>%s</h4>\n", EscapeHTML(name));
+        str += "<table><thead>\n";
+
+        for ( size_t level = 0; level < levelCount; ++level )
+        {
+            str += "<tr>";
+            for ( size_t c = 0; c < columns.size(); )
+            {
+                size_t span = 1;
+
+                // a column without groups spans all the header rows
+                if ( columns[c].labels.size() == 1 && levelCount > 1 )
+                {
+                    if ( level == 0 )
+                    {
+                        str += wxString::Format(R"(<th rowspan="%zu">%s</th>)",
+                                                levelCount, EscapeHTML(columns[c].labels[0]));
+                    }
+                    ++c;
+                    continue;
+                }
+
+                // merge columns with the same labels at this and all the upper levels
+                for ( ; c + span < columns.size(); ++span )
+                {
+                    // but not with a column spanning all the rows
+                    bool same = columns[c + span].labels.size() > 1 || levelCount == 1;
+
+                    for ( size_t l = 0; l <= level && same; ++l )
+                        same = GetLabel(columns[c], l) == GetLabel(columns[c + span], l);
+
+                    if ( !same )
+                        break;
+                }
+
+                if ( span > 1 )
+                    str += wxString::Format(R"(<th colspan="%zu">)", span);
+                else
+                    str += "<th>";
+                str += EscapeHTML(GetLabel(columns[c], level));
+                str += "</th>";
+
+                c += span;
+            }
+            str += "</tr>\n";
+        }
+        str += "</thead><tbody>\n";
+        Write(str);
+    }
+
+    virtual void DoAddRow(const wxArrayString& values) wxOVERRIDE
+    {
+        wxString str("<tr>");
+
+        for ( const auto& v : values )
+        {
+            str += "<td>";
+            str += EscapeHTML(v);
+            str += "</td>";
+        }
+        str += "</tr>\n";
+        Write(str);
+    }
+
+    virtual void DoEndTable() wxOVERRIDE
+    {
+        Write("</tbody></table>\n");
+    }
+
+private:
+    static wxString GetLabel(const Column& column, size_t level)
+    {
+        return level < column.labels.size() ? column.labels[level] : wxString();
+    }
+};
+
+// ============================================================================
+// wxTestSVGDelimitedReportWriter
+// ============================================================================
+
+// TSV or CSV
+class wxTestSVGDelimitedReportWriter : public wxTestSVGReportWriter
+{
+public:
+    explicit wxTestSVGDelimitedReportWriter(wxChar separator)
+        : m_separator(separator)
+    {}
+
+protected:
+    virtual void DoBeginDocument(const wxString&) wxOVERRIDE {}
+    virtual void DoEndDocument() wxOVERRIDE {}
+    virtual void DoAddParagraph(const wxString&) wxOVERRIDE {}
+
+    virtual void DoBeginTable(const wxString&) wxOVERRIDE
+    {
+        wxArrayString names;
+
+        for ( const auto& c : GetColumns() )
+            names.push_back(GetColumnName(c));
+
+        if ( GetTableCount() > 1 )
+            Write("\n");
+        WriteRow(names);
+    }
+
+    virtual void DoAddRow(const wxArrayString& values) wxOVERRIDE
+    {
+        WriteRow(values);
+    }
+
+    virtual void DoEndTable() wxOVERRIDE {}
+
+private:
+    wxChar m_separator;
+
+    void WriteRow(const wxArrayString& values)
+    {
+        wxString str;
+
+        for ( size_t i = 0; i < values.size(); ++i )
+        {
+            if ( i > 0 )
+                str += m_separator;
+            str += Quote(values[i]);
+        }
+        str += "\n";
+        Write(str);
+    }
+
+    // TSV cannot quote, so the separators and line breaks are replaced,
+    // CSV is quoted as in RFC 4180
+    wxString Quote(const wxString& value) const
+    {
+        if ( value.find_first_of(wxString(m_separator) + "\"\r\n") == wxString::npos )
+            return value;
+
+        wxString result(value);
+
+        if ( m_separator == '\t' )
+        {
+            result.Replace("\t", " ");
+            result.Replace("\r", " ");
+            result.Replace("\n", " ");
+            return result;
+        }
+
+        result.Replace("\"", "\"\"");
+        return "\"" + result + "\"";
+    }
+};
+
+// ============================================================================
+// wxTestSVGJSONReportWriter
+// ============================================================================
+
+class wxTestSVGJSONReportWriter : public wxTestSVGReportWriter
+{
+protected:
+    virtual void DoBeginDocument(const wxString& title) wxOVERRIDE
+    {
+        Write(wxString::Format("{\n\"title\": %s,\n\"tables\": [", Quote(title)));
+    }
+
+    virtual void DoEndDocument() wxOVERRIDE
+    {
+        Write("\n]}\n");
+    }
+
+    virtual void DoAddParagraph(const wxString&) wxOVERRIDE {}
+
+    virtual void DoBeginTable(const wxString& name) wxOVERRIDE
+    {
+        const VectorColumns& columns = GetColumns();
+        wxString             str;
+
+        m_keys.clear();
+        for ( const auto& c : columns )
+            m_keys.push_back(Quote(GetColumnName(c)));
+
+        str = GetTableCount() > 1 ? ",\n{" : "\n{";
+        str += wxString::Format("\"name\": %s,\n\"columns\": [", Quote(name));
+        for ( size_t i = 0; i < m_keys.size(); ++i )
+        {
+            if ( i > 0 )
+                str += ", ";
+            str += m_keys[i];
+        }
+        str += "],\n\"rows\": [";
+        Write(str);
+    }
+
+    virtual void DoAddRow(const wxArrayString& values) wxOVERRIDE
+    {
+        const VectorColumns& columns = GetColumns();
+        wxString             str;
+
+        str = GetRowCount() > 0 ? ",\n{" : "\n{";
+        for ( size_t i = 0; i < values.size(); ++i )
+        {
+            if ( i > 0 )
+                str += ", ";
+            str += m_keys[i];
+            str += ": ";
+            if ( values[i].empty() )
+                str += "null";
+            else if ( columns[i].isNumeric )
+                str += values[i];
+            else
+                str += Quote(values[i]);
+        }
+        str += "}";
+        Write(str);
+    }
+
+    virtual void DoEndTable() wxOVERRIDE
+    {
+        Write("\n]}");
+    }
+
+private:
+    // the quoted column names of the current table
+    wxArrayString m_keys;
+
+    static wxString Quote(const wxString& text)
+    {
+        wxString result("\"");
+
+        for ( wxUniChar ch : text )
+        {
+            if ( ch == '"' )
+                result += "\\\"";
+            else if ( ch == '\\' )
+                result += "\\\\";
+            else if ( ch == '\n' )
+                result += "\\n";
+            else if ( ch == '\r' )
+                result += "\\r";
+            else if ( ch == '\t' )
+                result += "\\t";
+            else if ( ch.GetValue() < 0x20 )
+                result += wxString::Format("\\u%04x", static_cast<unsigned>(ch.GetValue()));
+            else
+                result += ch;
+        }
+        result += "\"";
+
+        return result;
+    }
+};
+
+} // anonymous namespace
+
+// ============================================================================
+// wxTestSVGReportWriter
+// ============================================================================
+
+// static
+std::unique_ptr<wxTestSVGReportWriter> wxTestSVGReportWriter::Create(Format format, const wxString& fileName)
+{
+    std::unique_ptr<wxTestSVGReportWriter> writer;
+
+    switch ( format )
+    {
+        case Format_HTML:
+            writer.reset(new wxTestSVGHTMLReportWriter);
+            break;
+        case Format_TSV:
+            writer.reset(new wxTestSVGDelimitedReportWriter('\t'));
+            break;
+        case Format_CSV:
+            writer.reset(new wxTestSVGDelimitedReportWriter(','));
+            break;
+        case Format_JSON:
+            writer.reset(new wxTestSVGJSONReportWriter);
+            break;
+    }
+
+    wxCHECK_MSG(writer, nullptr, "invalid format");
+
+    if ( !writer->Open(fileName) )
+    {
+        wxLogError("Couldn't create file '%s'.", fileName);
+        writer.reset();
+    }
+
+    return writer;
+}
+
+// static
+wxTestSVGReportWriter::Format wxTestSVGReportWriter::GetFormatForFileName(const wxString& fileName,
+                                                                          Format defaultFormat)
+{
+    const wxString ext = wxFileName(fileName).GetExt().Lower();
+
+    if ( ext == "html" || ext == "htm" )
+        return Format_HTML;
+    if ( ext == "tsv" || ext == "txt" )
+        return Format_TSV;
+    if ( ext == "csv" )
+        return Format_CSV;
+    if ( ext == "json" )
+        return Format_JSON;
+
+    return defaultFormat;
+}
+
+bool wxTestSVGReportWriter::Open(const wxString& fileName)
+{
+    m_fileName = fileName;
+
+    if ( fileName == "-" )
+        m_file.Attach(stdout);
+    else
+        m_file.Open(fileName, "w");
+
+    m_isOk = m_file.IsOpened();
+    return m_isOk;
+}
+
+bool wxTestSVGReportWriter::Close()
+{
+    if ( !m_file.IsOpened() )
+        return m_isOk;
+
+    if ( !m_file.Flush() || m_file.Error() )
+        m_isOk = false;
+
+    if ( m_file.fp() == stdout )
+        m_file.Detach();
+    else if ( !m_file.Close() )
+        m_isOk = false;
+
+    return m_isOk;
+}
+
+void wxTestSVGReportWriter::Write(const wxString& text)
+{
+    if ( m_isOk && !m_file.Write(text, wxConvUTF8) )
+        m_isOk = false;
+}
+
+// static
+wxString wxTestSVGReportWriter::EscapeHTML(const wxString& text)
+{
+    wxString result;
+
+    result.reserve(text.length());
+    for ( wxUniChar ch : text )
+    {
+        if ( ch == '&' )
+            result += "&amp;";
+        else if ( ch == '<' )
+            result += "&lt;";
+        else if ( ch == '>' )
+            result += "&gt;";
+        else
+            result += ch;
+    }
+
+    return result;
+}
+
+// static
+wxString wxTestSVGReportWriter::GetColumnName(const Column& column)
+{
+    wxString name;
+
+    for ( const auto& l : column.labels )
+    {
+        if ( l.empty() )
+            continue;
+        if ( !name.empty() )
+            name += '/';
+        name += l;
+    }
+
+    return name;
+}
+
+void wxTestSVGReportWriter::BeginDocument(const wxString& title)
+{
+    DoBeginDocument(title);
+}
+
+void wxTestSVGReportWriter::EndDocument()
+{
+    wxCHECK_RET(!m_isInTable, "table not ended");
+
+    DoEndDocument();
+}
+
+void wxTestSVGReportWriter::AddParagraph(const wxString& text)
+{
+    wxCHECK_RET(!m_isInTable, "paragraph inside table");
+
+    DoAddParagraph(text);
+}
+
+void wxTestSVGReportWriter::BeginTable(const wxString& name, const VectorColumns& columns)
+{
+    wxCHECK_RET(!m_isInTable, "table not ended");
+    wxCHECK_RET(!columns.empty(), "no columns");
+
+    m_isInTable = true;
+    m_columns   = columns;
+    m_rowCount  = 0;
+    ++m_tableCount;
+
+    DoBeginTable(name);
+}
+
+void wxTestSVGReportWriter::AddRow(const wxArrayString& values)
+{
+    wxCHECK_RET(m_isInTable, "row outside table");
+    wxCHECK_RET(values.size() == m_columns.size(), "invalid number of values");
+
+    DoAddRow(values);
+    ++m_rowCount;
+}
+
+void wxTestSVGReportWriter::EndTable()
+{
+    wxCHECK_RET(m_isInTable, "table not begun");
+
+    DoEndTable();
+    m_isInTable = false;
+}
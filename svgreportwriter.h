@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgreportwriter.h
+// Purpose:     Writing benchmark reports row by row as HTML, TSV, CSV, or JSON
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_REPORT_WRITER_H_DEFINED
+#define TEST_SVG_REPORT_WRITER_H_DEFINED
+
+#include <memory>
+#include <vector>
+
+#include <wx/wx.h>
+#include <wx/ffile.h>
+
+// ============================================================================
+// wxTestSVGReportWriter
+// ============================================================================
+
+/*
+    Writes a document consisting of tables directly to a file, each row as
+    soon as it is added, so that even reports with millions of cells are
+    written in constant memory, e.g., while the benchmark is still running.
+
+    The calls must be: BeginDocument(), any number of tables, each being
+    BeginTable(), AddRow() for each row, and EndTable(), and EndDocument().
+    Paragraphs can be added outside tables, but only HTML shows them.
+
+    HTML merges the labels of the column groups into multiple header rows.
+    The other formats have one header row, with the labels of each column
+    joined by "/". TSV and CSV separate tables by an empty line, JSON writes
+    {"title": ..., "tables": [{"name": ..., "columns": [...], "rows": [...]}]},
+    with each row being an object with the column names as keys.
+ */
+
+class wxTestSVGReportWriter
+{
+public:
+    enum Format
+    {
+        Format_HTML = 0,
+        Format_TSV,
+        Format_CSV,
+        Format_JSON
+    };
+
+    struct Column
+    {
+        // from the outermost group to the name of the column
+        wxArrayString labels;
+        // if false, the values are quoted in JSON
+        bool          isNumeric{true};
+    };
+    typedef std::vector<Column> VectorColumns;
+
+    virtual ~wxTestSVGReportWriter() {}
+
+    // fileName "-" means the standard output,
+    // returns nullptr and logs the error if the file cannot be created
+    static std::unique_ptr<wxTestSVGReportWriter> Create(Format format, const wxString& fileName);
+
+    // from the extension of fileName (.html, .htm, .tsv, .txt, .csv, .json),
+    // returns defaultFormat if the extension is not known
+    static Format GetFormatForFileName(const wxString& fileName, Format defaultFormat);
+
+    // replaces &, <, and > with the HTML entities, for the HTML reports
+    // not written with wxTestSVGReportWriter too
+    static wxString EscapeHTML(const wxString& text);
+
+    void BeginDocument(const wxString& title);
+    void EndDocument();
+
+    void AddParagraph(const wxString& text);
+
+    void BeginTable(const wxString& name, const VectorColumns& columns);
+    // the number of values must be the same as the number of columns,
+    // empty values are missing ones
+    void AddRow(const wxArrayString& values);
+    void EndTable();
+
+    // flushes and closes the file, returns false if anything failed to write
+    bool Close();
+
+    const wxString& GetFileName() const { return m_fileName; }
+
+protected:
+    wxTestSVGReportWriter() {}
+
+    // returns false if the file could not be opened
+    bool Open(const wxString& fileName);
+    void Write(const wxString& text);
+
+    const VectorColumns& GetColumns() const { return m_columns; }
+    size_t GetTableCount() const { return m_tableCount; }
+    size_t GetRowCount() const { return m_rowCount; }
+
+    // returns the labels of the column joined by "/"
+    static wxString GetColumnName(const Column& column);
+
+    virtual void DoBeginDocument(const wxString& title) = 0;
+    virtual void DoEndDocument() = 0;
+    virtual void DoAddParagraph(const wxString& text) = 0;
+    virtual void DoBeginTable(const wxString& name) = 0;
+    virtual void DoAddRow(const wxArrayString& values) = 0;
+    virtual void DoEndTable() = 0;
+
+private:
+    wxFFile       m_file;
+    wxString      m_fileName;
+    bool          m_isOk{false};
+    bool          m_isInTable{false};
+    VectorColumns m_columns;
+    size_t        m_tableCount{0}; // including the current one
+    size_t        m_rowCount{0};   // of the current table
+
+    wxDECLARE_NO_COPY_CLASS(wxTestSVGReportWriter);
+};
+
+#endif // #ifndef TEST_SVG_REPORT_WRITER_H_DEFINED
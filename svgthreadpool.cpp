@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgthreadpool.cpp
+// Purpose:     Simple work-stealing thread pool
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include "svgthreadpool.h"
+
+// ============================================================================
+// wxTestSVGThreadPool
+// ============================================================================
+
+wxTestSVGThreadPool::wxTestSVGThreadPool(size_t threadCount)
+{
+    if ( threadCount == 0 )
+        threadCount = GetDefaultThreadCount();
+
+    for ( size_t i = 0; i < threadCount; ++i )
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker));
+
+    for ( size_t i = 0; i < threadCount; ++i )
+        m_threads.push_back(std::thread(&wxTestSVGThreadPool::WorkerMain, this, i));
+}
+
+wxTestSVGThreadPool::~wxTestSVGThreadPool()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for ( auto& t : m_threads )
+        t.join();
+}
+
+void wxTestSVGThreadPool::Submit(const Task& task)
+{
+    size_t workerIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        workerIndex = m_nextWorker;
+        m_nextWorker = (m_nextWorker + 1) % m_workers.size();
+
+        // increased before the task is queued, so that m_queued is never
+        // lower than the real number of the queued tasks
+        ++m_queued;
+        ++m_pending;
+    }
+
+    {
+        Worker& worker = *m_workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        worker.tasks.push_back(task);
+    }
+
+    m_taskAvailable.notify_one();
+}
+
+void wxTestSVGThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_allDone.wait(lock, [this] { return m_pending == 0; });
+}
+
+void wxTestSVGThreadPool::ParallelFor(size_t count,
+                                      const std::function<void(size_t index, size_t workerIndex)>& fn)
+{
+    for ( size_t i = 0; i < count; ++i )
+        Submit([i, &fn](size_t workerIndex) { fn(i, workerIndex); });
+
+    Wait();
+}
+
+// static
+size_t wxTestSVGThreadPool::GetDefaultThreadCount()
+{
+    const unsigned count = std::thread::hardware_concurrency();
+
+    return count ? count : 1;
+}
+
+bool wxTestSVGThreadPool::PopTask(size_t workerIndex, Task& task)
+{
+    // first try own queue, newest task first
+    {
+        Worker& worker = *m_workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        if ( !worker.tasks.empty() )
+        {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+
+    // then steal the oldest task from the other queues
+    for ( size_t i = 1; i < m_workers.size(); ++i )
+    {
+        Worker& victim = *m_workers[(workerIndex + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if ( !victim.tasks.empty() )
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void wxTestSVGThreadPool::WorkerMain(size_t workerIndex)
+{
+    for ( ;; )
+    {
+        Task task;
+
+        if ( PopTask(workerIndex, task) )
+        {
+            task(workerIndex);
+
+            if ( --m_pending == 0 )
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_taskAvailable.wait(lock, [this] { return m_stop || m_queued > 0; });
+
+        if ( m_stop && m_queued == 0 )
+            return;
+    }
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgthreadpool.h
+// Purpose:     Simple work-stealing thread pool
+// Author:      PB
+// Created:     2022-01-20
+// Copyright:   (c) 2022 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_THREAD_POOL_H_DEFINED
+#define TEST_SVG_THREAD_POOL_H_DEFINED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <wx/wx.h>
+
+// ============================================================================
+// wxTestSVGThreadPool
+// ============================================================================
+
+/*
+    Each worker thread has its own queue of tasks, the submitted tasks
+    are distributed among the queues round-robin. A worker takes the tasks
+    from the back of its queue and when the queue is empty, it steals
+    a task from the front of another worker's queue.
+
+    The tasks get the index of the worker thread running them,
+    so that they can use per-thread data without any locking.
+ */
+
+class wxTestSVGThreadPool
+{
+public:
+    typedef std::function<void(size_t workerIndex)> Task;
+
+    // threadCount = 0 means as many threads as there are CPU cores
+    explicit wxTestSVGThreadPool(size_t threadCount = 0);
+    // waits for all the submitted tasks to finish
+    ~wxTestSVGThreadPool();
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    void Submit(const Task& task);
+
+    // blocks until all the submitted tasks are finished
+    void Wait();
+
+    // calls fn(index, workerIndex) for all indices in [0, count)
+    // and waits for all the calls to finish
+    void ParallelFor(size_t count, const std::function<void(size_t index, size_t workerIndex)>& fn);
+
+    static size_t GetDefaultThreadCount();
+
+private:
+    struct Worker
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread>             m_threads;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_allDone;
+    bool                    m_stop{false};
+    size_t                  m_nextWorker{0};
+
+    // number of tasks in all the queues
+    std::atomic<size_t>     m_queued{0};
+    // number of tasks submitted and not yet finished
+    std::atomic<size_t>     m_pending{0};
+
+    bool PopTask(size_t workerIndex, Task& task);
+    void WorkerMain(size_t workerIndex);
+
+    wxDECLARE_NO_COPY_CLASS(wxTestSVGThreadPool);
+};
+
+#endif // #ifndef TEST_SVG_THREAD_POOL_H_DEFINED